@@ -5,9 +5,20 @@
 
 #include "FutureverseAssetLoadData.h"
 #include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerSettings.h"
 #include "ControllerLayers/AssetProfileUtils.h"
-#include "GlobalArtifactProvider/DownloadRequestManager.h"
+#include "Downloads/ControllerDownloadManager.h"
 #include "Kismet/GameplayStatics.h"
+#include "Snapshots/AssetSnapshot.h"
+
+namespace AssetProfileRegistry
+{
+	// negative cache key of an asset missing from its profile document
+	FString GetMissKey(const FFutureverseAssetLoadData& LoadData)
+	{
+		return FString::Printf(TEXT("%s %s"), *LoadData.AssetID, *LoadData.ProfileURI);
+	}
+}
 
 UAssetProfileRegistrySubsystem* UAssetProfileRegistrySubsystem::Get(const UObject* WorldContext)
 {
@@ -24,19 +35,68 @@ TFuture<FLoadAssetProfileResult> UAssetProfileRegistrySubsystem::GetAssetProfile
 	TSharedPtr<TPromise<FLoadAssetProfileResult>> Promise = MakeShareable(new TPromise<FLoadAssetProfileResult>());
 	TFuture<FLoadAssetProfileResult> Future = Promise->GetFuture();
 
-	if (AssetProfiles.Contains(LoadData.AssetID))
+	const FString CachedKey = AssetProfiles.FindKey(LoadData.AssetID);
+	if (!CachedKey.IsEmpty())
 	{
+		CacheCounters.Hits++;
+		INC_DWORD_STAT(STAT_UBFAssetProfileCacheHits);
+		AssetProfileLru.Touch(CachedKey);
+		
 		auto Result = FLoadAssetProfileResult();
 		Result.SetResult(AssetProfiles.Get(LoadData.AssetID));
 		Promise->SetValue(Result);
 		return Future;
 	}
 
+	CacheCounters.Misses++;
+	INC_DWORD_STAT(STAT_UBFAssetProfileCacheMisses);
+
+	if (const FAssetProfilePtr SnapshotProfile = LoadSnapshotProfile(LoadData.AssetID))
+	{
+		auto Result = FLoadAssetProfileResult();
+		Result.SetResult(SnapshotProfile);
+		Promise->SetValue(Result);
+		return Future;
+	}
+
+	// legacy collections without a profile for every token ask for the same missing entry on every render. Keyed by
+	// profile URI too, an asset missing from one profile document may be in the one it is given next
+	if (FControllerDownloadManager::GetInstance()->GetNegativeCache().Contains(EUBFNegativeCacheScope::AssetProfile, AssetProfileRegistry::GetMissKey(LoadData)))
+	{
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UAssetProfileRegistrySubsystem::GetAssetProfile AssetId %s is a known miss in '%s'"), *LoadData.AssetID, *LoadData.ProfileURI);
+		auto Result = FLoadAssetProfileResult();
+		Result.SetFailure();
+		Promise->SetValue(Result);
+		return Future;
+	}
+
+	DownloadAssetProfile(LoadData, EUBFDownloadPriority::Render).Next([Promise](const FLoadAssetProfileResult& Result)
+	{
+		Promise->SetValue(Result);
+	});
+	
+	return Future;
+}
+
+TFuture<FLoadAssetProfileResult> UAssetProfileRegistrySubsystem::RefreshAssetProfile(const FFutureverseAssetLoadData& LoadData)
+{
+	return DownloadAssetProfile(LoadData, EUBFDownloadPriority::Prefetch);
+}
+
+TFuture<FLoadAssetProfileResult> UAssetProfileRegistrySubsystem::DownloadAssetProfile(const FFutureverseAssetLoadData& LoadData,
+	EUBFDownloadPriority Priority)
+{
+	TSharedPtr<TPromise<FLoadAssetProfileResult>> Promise = MakeShareable(new TPromise<FLoadAssetProfileResult>());
+	TFuture<FLoadAssetProfileResult> Future = Promise->GetFuture();
+	
 	TWeakObjectPtr<UAssetProfileRegistrySubsystem> WeakThis = this;
+	const double StartTime = FUBFRuntimeStats::Get().BeginLoad(EUBFLoadStage::AssetProfile);
 	
-	FDownloadRequestManager::GetInstance()->LoadStringFromURI(TEXT("AssetProfile"), LoadData.ProfileURI).Next(
-	[WeakThis, Promise, LoadData] (const UBF::FLoadStringResult& AssetProfileResult)
+	FControllerDownloadManager::GetInstance()->LoadStringFromURI(TEXT("AssetProfile"), LoadData.ProfileURI, Priority, LoadData.Deadline).Next(
+	[WeakThis, Promise, LoadData, StartTime] (const UBF::FLoadStringResult& AssetProfileResult)
 	{
+		FUBFContinuationScope ContinuationScope;
+		FUBFRuntimeStats::Get().EndLoad(EUBFLoadStage::AssetProfile, StartTime, AssetProfileResult.bSuccess);
 		auto Result = FLoadAssetProfileResult();
 				
 		if (!AssetProfileResult.bSuccess)
@@ -47,13 +107,15 @@ TFuture<FLoadAssetProfileResult> UAssetProfileRegistrySubsystem::GetAssetProfile
 			return;
 		}
 
-		if (!WeakThis.IsValid() && !WeakThis->IsSubsystemValid())
+		if (!WeakThis.IsValid() || !WeakThis->IsSubsystemValid())
 		{
 			Result.SetFailure();
 			Promise->SetValue(Result);
 			return;
 		}
 					
+		LLM_SCOPE_BYTAG(FutureverseUBFController_AssetProfiles);
+		
 		TArray<FAssetProfile> AssetProfileEntries;
 		AssetProfileUtils::ParseAssetProfileJson(AssetProfileResult.Value, AssetProfileEntries);
 					
@@ -70,16 +132,30 @@ TFuture<FLoadAssetProfileResult> UAssetProfileRegistrySubsystem::GetAssetProfile
 			if (!AssetProfile.GetId().Contains(LoadData.GetContractID()))
 				AssetProfile.ModifyId(FString::Printf(TEXT("%s:%s"), *LoadData.GetCollectionID(), *AssetProfile.GetId()));
 			
-			WeakThis->AssetProfiles.Add(AssetProfile.GetId(), AssetProfile);
 			UE_LOG(LogFutureverseUBFController, VeryVerbose, TEXT("UAssetProfileRegistrySubsystem::GetAssetProfile AssetId %s AssetProfile %s loaded."), *AssetProfile.GetId(), *AssetProfile.ToString());
+			WeakThis->AddAssetProfile(MoveTemp(AssetProfile));
 		}
 			
-		Result.SetResult(WeakThis->AssetProfiles.Get(LoadData.AssetID));
+		// keep the requested profile most recent so it survives eviction of the rest of a large multi-profile file
+		WeakThis->AssetProfileLru.Touch(WeakThis->AssetProfiles.FindKey(LoadData.AssetID));
+		const FAssetProfilePtr AssetProfile = WeakThis->AssetProfiles.Get(LoadData.AssetID);
+		WeakThis->EvictAssetProfiles();
+
+		if (AssetProfile.IsValid())
+		{
+			Result.SetResult(AssetProfile);
+		}
+		else
+		{
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UAssetProfileRegistrySubsystem::GetAssetProfile AssetProfile from URI '%s' has no entry for AssetId %s"), *LoadData.ProfileURI, *LoadData.AssetID);
+			FControllerDownloadManager::GetInstance()->GetNegativeCache().Add(EUBFNegativeCacheScope::AssetProfile, AssetProfileRegistry::GetMissKey(LoadData));
+			Result.SetFailure();
+		}
+		
 		Promise->SetValue(Result);
 	});
 	
 	return Future;
-	
 }
 
 bool UAssetProfileRegistrySubsystem::IsSubsystemValid() const
@@ -87,16 +163,178 @@ bool UAssetProfileRegistrySubsystem::IsSubsystemValid() const
 	return IsValid(this) && bIsInitialized;
 }
 
+void UAssetProfileRegistrySubsystem::PinAssetProfile(const FString& AssetId)
+{
+	// pin both possible keys as the profile may only be known through its collection override
+	AssetProfileLru.Pin(AssetIdUtils::FormatAssetId(AssetId));
+	AssetProfileLru.Pin(AssetIdUtils::FormatAssetId(AssetIdUtils::ConvertAssetIdToOverrideId(AssetId)));
+}
+
+void UAssetProfileRegistrySubsystem::UnpinAssetProfile(const FString& AssetId)
+{
+	AssetProfileLru.Unpin(AssetIdUtils::FormatAssetId(AssetId));
+	AssetProfileLru.Unpin(AssetIdUtils::FormatAssetId(AssetIdUtils::ConvertAssetIdToOverrideId(AssetId)));
+}
+
+void UAssetProfileRegistrySubsystem::ResetCacheCounters()
+{
+	CacheCounters = FUBFCacheCounters();
+	SET_DWORD_STAT(STAT_UBFAssetProfileCacheHits, 0);
+	SET_DWORD_STAT(STAT_UBFAssetProfileCacheMisses, 0);
+	SET_DWORD_STAT(STAT_UBFAssetProfileEvictions, 0);
+}
+
+void UAssetProfileRegistrySubsystem::AppendMemoryReport(FUBFMemoryReport& Report) const
+{
+	Report.AddCounters(TEXT("AssetProfiles"), CacheCounters);
+	
+	for (const auto& AssetProfile : AssetProfiles)
+	{
+		Report.Add(TEXT("AssetProfiles"), AssetIdUtils::GetCollectionID(AssetProfile.Key),
+			AssetProfile.Key.GetAllocatedSize() + sizeof(FAssetProfile) + AssetProfile.Value->GetAllocatedSize());
+	}
+}
+
+void UAssetProfileRegistrySubsystem::AppendToSnapshot(FAssetSnapshotWriter& Writer) const
+{
+	for (const auto& AssetProfile : AssetProfiles)
+	{
+		Writer.AddProfile(*AssetProfile.Value);
+	}
+}
+
+FAssetProfilePtr UAssetProfileRegistrySubsystem::LoadSnapshotProfile(const FString& AssetId)
+{
+	FAssetProfile SnapshotProfile;
+	if (!FControllerDownloadManager::GetInstance()->FindSnapshotProfile(AssetId, SnapshotProfile))
+		return nullptr;
+
+	UE_LOG(LogFutureverseUBFController, VeryVerbose, TEXT("UAssetProfileRegistrySubsystem::LoadSnapshotProfile AssetId %s loaded from snapshot"), *AssetId);
+	AddAssetProfile(MoveTemp(SnapshotProfile));
+	
+	const FAssetProfilePtr AssetProfile = AssetProfiles.Get(AssetId);
+	EvictAssetProfiles();
+	return AssetProfile;
+}
+
+void UAssetProfileRegistrySubsystem::AddAssetProfile(FAssetProfile&& AssetProfile)
+{
+	LLM_SCOPE_BYTAG(FutureverseUBFController_AssetProfiles);
+	
+	if (const FAssetProfilePtr* ExistingProfile = AssetProfiles.FindExact(AssetProfile.GetId()))
+	{
+		DEC_MEMORY_STAT_BY(STAT_UBFAssetProfilesMemory, sizeof(FAssetProfile) + (*ExistingProfile)->GetAllocatedSize());
+		DEC_DWORD_STAT(STAT_UBFAssetProfilesCount);
+	}
+
+	// profiles are frozen from here on, requests already holding the previous entry keep it alive
+	AssetProfile.PrepareForSharing();
+	const FAssetProfilePtr SharedProfile = MakeShared<const FAssetProfile, ESPMode::ThreadSafe>(MoveTemp(AssetProfile));
+	const SIZE_T ProfileSize = sizeof(FAssetProfile) + SharedProfile->GetAllocatedSize();
+	
+	AssetProfiles.Add(SharedProfile->GetId(), SharedProfile);
+	AssetProfileLru.Add(AssetIdUtils::FormatAssetId(SharedProfile->GetId()), ProfileSize);
+	
+	INC_MEMORY_STAT_BY(STAT_UBFAssetProfilesMemory, ProfileSize);
+	INC_DWORD_STAT(STAT_UBFAssetProfilesCount);
+}
+
+void UAssetProfileRegistrySubsystem::RemoveAssetProfile(const FString& Key)
+{
+	if (const FAssetProfilePtr* ExistingProfile = AssetProfiles.FindExact(Key))
+	{
+		DEC_MEMORY_STAT_BY(STAT_UBFAssetProfilesMemory, sizeof(FAssetProfile) + (*ExistingProfile)->GetAllocatedSize());
+		DEC_DWORD_STAT(STAT_UBFAssetProfilesCount);
+		AssetProfiles.Remove(Key);
+	}
+	AssetProfileLru.Remove(Key);
+}
+
+void UAssetProfileRegistrySubsystem::EvictAssetProfiles()
+{
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+	
+	TArray<FString> EvictedKeys;
+	AssetProfileLru.GetEvictionCandidates(Settings->GetMaxCachedAssetProfiles(), Settings->GetMaxAssetProfileCacheBytes(), EvictedKeys);
+	
+	TArray<FAssetProfilePtr> EvictedProfiles;
+	for (const FString& Key : EvictedKeys)
+	{
+		if (const FAssetProfilePtr* EvictedProfile = AssetProfiles.FindExact(Key))
+		{
+			EvictedProfiles.Add(*EvictedProfile);
+		}
+		RemoveAssetProfile(Key);
+	}
+
+	if (EvictedKeys.Num() > 0)
+	{
+		CacheCounters.Evictions += EvictedKeys.Num();
+		INC_DWORD_STAT_BY(STAT_UBFAssetProfileEvictions, EvictedKeys.Num());
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UAssetProfileRegistrySubsystem::EvictAssetProfiles evicted %d AssetProfiles, %d remaining"), EvictedKeys.Num(), AssetProfiles.Num());
+	}
+
+	if (EvictedProfiles.Num() > 0)
+	{
+		OnAssetProfilesEvicted.Broadcast(EvictedProfiles);
+	}
+}
+
 void UAssetProfileRegistrySubsystem::Deinitialize()
 {
 	Super::Deinitialize();
 
+	for (const auto& AssetProfile : AssetProfiles)
+	{
+		DEC_MEMORY_STAT_BY(STAT_UBFAssetProfilesMemory, sizeof(FAssetProfile) + AssetProfile.Value->GetAllocatedSize());
+		DEC_DWORD_STAT(STAT_UBFAssetProfilesCount);
+	}
+	AssetProfiles.Clear();
+	AssetProfileLru.Clear();
+
 	bIsInitialized = false;
 }
 
 void UAssetProfileRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+
+	// bundles and snapshots have to be in place before the first profile, catalog or graph request
+	FControllerDownloadManager::GetInstance()->MountConfiguredSnapshots();
 	
 	bIsInitialized = true;
 }
+
+namespace AssetProfileRegistrySnapshot
+{
+	static FAutoConsoleCommand CaptureCommand(
+		TEXT("ubf.Snapshot.Capture"),
+		TEXT("ubf.Snapshot.Capture 1|0. Keeps the source of every catalog loaded from the network so ubf.Snapshot.Save can include it"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const bool bCapture = Args.Num() == 0 || FCString::ToBool(*Args[0]);
+			FControllerDownloadManager::GetInstance()->SetCaptureCatalogSources(bCapture);
+			UE_LOG(LogFutureverseUBFController, Log, TEXT("ubf.Snapshot.Capture catalog capture %s"), bCapture ? TEXT("enabled") : TEXT("disabled"));
+		}));
+	
+	static FAutoConsoleCommandWithWorldAndArgs SaveCommand(
+		TEXT("ubf.Snapshot.Save"),
+		TEXT("ubf.Snapshot.Save <Path>. Writes the resident asset profiles and captured catalog sources to a binary snapshot"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const UAssetProfileRegistrySubsystem* AssetProfileRegistry = UAssetProfileRegistrySubsystem::Get(World);
+			if (Args.Num() == 0 || !AssetProfileRegistry)
+			{
+				UE_LOG(LogFutureverseUBFController, Warning, TEXT("ubf.Snapshot.Save requires a path and a running game instance"));
+				return;
+			}
+
+			FAssetSnapshotWriter Writer;
+			AssetProfileRegistry->AppendToSnapshot(Writer);
+			for (const auto& CatalogSource : FControllerDownloadManager::GetInstance()->GetCapturedCatalogSources())
+			{
+				Writer.AddCatalogSource(CatalogSource.Key, CatalogSource.Value);
+			}
+			Writer.Save(Args[0]);
+		}));
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "BindingObjectReferencer.h"
+
+#include "FutureverseUBFControllerStats.h"
+#include "Async/Async.h"
+
+FBindingObjectLease::~FBindingObjectLease()
+{
+	if (BindingObjects.IsEmpty())
+		return;
+
+	// render requests can be destroyed by a future continuation on any thread, the objects stay referenced until released
+	if (!IsInGameThread())
+	{
+		AsyncTask(ENamedThreads::GameThread, [Referencer = Referencer, BindingObjects = MoveTemp(BindingObjects)]()
+		{
+			if (const TSharedPtr<FBindingObjectReferencer> PinnedReferencer = Referencer.Pin())
+			{
+				PinnedReferencer->Release(BindingObjects);
+			}
+		});
+		return;
+	}
+
+	if (const TSharedPtr<FBindingObjectReferencer> PinnedReferencer = Referencer.Pin())
+	{
+		PinnedReferencer->Release(BindingObjects);
+	}
+}
+
+TSharedPtr<FBindingObjectLease> FBindingObjectReferencer::Acquire(const TMap<FString, UBF::FDynamicHandle>& Values)
+{
+	check(IsInGameThread());
+
+	TSharedPtr<FBindingObjectLease> Lease = MakeShared<FBindingObjectLease>(AsShared());
+	if (Values.IsEmpty())
+		return Lease;
+
+	Lease->BindingObjects = UBFUtils::AsBindingObjectMap(Values);
+	for (const auto& BindingObject : Lease->BindingObjects)
+	{
+		if (BindingObject.Value)
+		{
+			LeasedObjects.Add(BindingObject.Value);
+		}
+	}
+
+	NumCreated += Lease->BindingObjects.Num();
+	INC_DWORD_STAT_BY(STAT_UBFBindingObjectsCreated, Lease->BindingObjects.Num());
+	return Lease;
+}
+
+void FBindingObjectReferencer::Release(const TMap<FString, UUBFBindingObject*>& BindingObjects)
+{
+	check(IsInGameThread());
+
+	for (const auto& BindingObject : BindingObjects)
+	{
+		LeasedObjects.Remove(BindingObject.Value);
+	}
+}
+
+void FBindingObjectReferencer::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObjects(LeasedObjects);
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "Util/UBFUtils.h"
+
+class UUBFBindingObject;
+class FBindingObjectReferencer;
+
+/**
+ * Binding objects created for one render request, released when the last request sharing the lease is destroyed
+ */
+class FBindingObjectLease
+{
+public:
+	FBindingObjectLease(const TWeakPtr<FBindingObjectReferencer>& InReferencer) : Referencer(InReferencer) {}
+	~FBindingObjectLease();
+
+	const TMap<FString, UUBFBindingObject*>& GetBindingObjects() const { return BindingObjects; }
+
+private:
+	friend class FBindingObjectReferencer;
+
+	TWeakPtr<FBindingObjectReferencer> Referencer;
+	TMap<FString, UUBFBindingObject*> BindingObjects;
+};
+
+/**
+ * Creates the binding objects the parsing graph outputs are wrapped in and references them while a lease holds them,
+ * so none is collected mid render. UUBFBindingObject has no way to be re-initialised, so released objects are left to GC
+ * rather than reused. Game thread only.
+ */
+class FBindingObjectReferencer : public FGCObject, public TSharedFromThis<FBindingObjectReferencer>
+{
+public:
+	TSharedPtr<FBindingObjectLease> Acquire(const TMap<FString, UBF::FDynamicHandle>& Values);
+	void Release(const TMap<FString, UUBFBindingObject*>& BindingObjects);
+
+	int32 GetNumLeased() const { return LeasedObjects.Num(); }
+	uint64 GetNumCreated() const { return NumCreated; }
+
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("FBindingObjectReferencer"); }
+
+private:
+	TSet<TObjectPtr<UUBFBindingObject>> LeasedObjects;
+	uint64 NumCreated = 0;
+};
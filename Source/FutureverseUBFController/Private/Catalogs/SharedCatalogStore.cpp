@@ -0,0 +1,153 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "Catalogs/SharedCatalogStore.h"
+
+#include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerStats.h"
+#include "Hash/CityHash.h"
+#include "Util/CatalogUtils.h"
+
+FSharedCatalogPtr FSharedCatalogStore::FindByUri(const FString& URI) const
+{
+	FScopeLock Lock(&CriticalSection);
+	
+	if (const auto* Catalog = CatalogsByUri.Find(URI))
+	{
+		if (FSharedCatalogPtr PinnedCatalog = Catalog->Pin())
+		{
+			ParseCounters.Hits++;
+			INC_DWORD_STAT(STAT_UBFCatalogParseHits);
+			return PinnedCatalog;
+		}
+	}
+	return nullptr;
+}
+
+FSharedCatalogPtr FSharedCatalogStore::FindOrParse(const FString& URI, const FString& Content)
+{
+	const uint64 ContentHash = HashContent(Content);
+	const uint64 VerifyHash = HashContentForVerification(Content);
+	uint64 FreeKey = ContentHash;
+
+	{
+		FScopeLock Lock(&CriticalSection);
+		
+		if (FSharedCatalogPtr Catalog = FindSameContent(ContentHash, Content.Len(), VerifyHash, FreeKey))
+		{
+			ParseCounters.Hits++;
+			INC_DWORD_STAT(STAT_UBFCatalogParseHits);
+			CatalogsByUri.Add(URI, Catalog);
+			UE_LOG(LogFutureverseUBFController, VeryVerbose, TEXT("FSharedCatalogStore::FindOrParse reusing catalog %llx for %s"), Catalog->ContentHash, *URI);
+			return Catalog;
+		}
+	}
+
+	LLM_SCOPE_BYTAG(FutureverseUBFController_Catalogs);
+	
+	// parse outside the lock, if two identical catalogs race the first one stored wins
+	TSharedRef<FSharedCatalog, ESPMode::ThreadSafe> NewCatalog = MakeShared<FSharedCatalog, ESPMode::ThreadSafe>();
+	NewCatalog->ContentLength = Content.Len();
+	NewCatalog->VerifyHash = VerifyHash;
+	CatalogUtils::ParseCatalog(Content, NewCatalog->Elements);
+	
+	NewCatalog->ApproximateBytes = sizeof(FSharedCatalog) + NewCatalog->Elements.GetAllocatedSize();
+	for (const auto& Element : NewCatalog->Elements)
+	{
+		NewCatalog->ApproximateBytes += Element.Key.GetAllocatedSize() + sizeof(UBF::FCatalogElement);
+	}
+
+	FScopeLock Lock(&CriticalSection);
+	
+	if (FSharedCatalogPtr Catalog = FindSameContent(ContentHash, Content.Len(), VerifyHash, FreeKey))
+	{
+		ParseCounters.Hits++;
+		INC_DWORD_STAT(STAT_UBFCatalogParseHits);
+		CatalogsByUri.Add(URI, Catalog);
+		return Catalog;
+	}
+
+	if (FreeKey != ContentHash)
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("FSharedCatalogStore::FindOrParse %s collides with another catalog's content hash %llx, stored as %llx"),
+			*URI, ContentHash, FreeKey);
+	}
+
+	ParseCounters.Misses++;
+	INC_DWORD_STAT(STAT_UBFCatalogParseMisses);
+	NewCatalog->ContentHash = FreeKey;
+	CatalogsByHash.Add(FreeKey, NewCatalog);
+	CatalogsByUri.Add(URI, NewCatalog);
+	PruneExpired();
+	
+	return NewCatalog;
+}
+
+FSharedCatalogPtr FSharedCatalogStore::FindSameContent(uint64 ContentHash, int32 ContentLength, uint64 VerifyHash, uint64& OutFreeKey) const
+{
+	uint64 Key = ContentHash;
+	while (const auto* Existing = CatalogsByHash.Find(Key))
+	{
+		FSharedCatalogPtr Catalog = Existing->Pin();
+		if (!Catalog)
+			break;
+		
+		if (Catalog->ContentLength == ContentLength && Catalog->VerifyHash == VerifyHash)
+			return Catalog;
+		
+		++Key;
+	}
+	
+	OutFreeKey = Key;
+	return nullptr;
+}
+
+void FSharedCatalogStore::ForgetUri(const FString& URI)
+{
+	FScopeLock Lock(&CriticalSection);
+	CatalogsByUri.Remove(URI);
+}
+
+FUBFCacheCounters FSharedCatalogStore::GetParseCounters() const
+{
+	FScopeLock Lock(&CriticalSection);
+	return ParseCounters;
+}
+
+void FSharedCatalogStore::ResetParseCounters()
+{
+	FScopeLock Lock(&CriticalSection);
+	ParseCounters = FUBFCacheCounters();
+	SET_DWORD_STAT(STAT_UBFCatalogParseHits, 0);
+	SET_DWORD_STAT(STAT_UBFCatalogParseMisses, 0);
+}
+
+uint64 FSharedCatalogStore::HashContent(const FString& Content)
+{
+	return CityHash64(reinterpret_cast<const char*>(*Content), Content.Len() * sizeof(TCHAR));
+}
+
+uint64 FSharedCatalogStore::HashContentForVerification(const FString& Content)
+{
+	constexpr uint64 VerifySeed = 0x9E3779B97F4A7C15ull;
+	return CityHash64WithSeed(reinterpret_cast<const char*>(*Content), Content.Len() * sizeof(TCHAR), VerifySeed);
+}
+
+void FSharedCatalogStore::PruneExpired()
+{
+	if (CatalogsByUri.Num() < PruneThreshold)
+		return;
+
+	for (auto It = CatalogsByHash.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+			It.RemoveCurrent();
+	}
+	for (auto It = CatalogsByUri.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+			It.RemoveCurrent();
+	}
+
+	// only prune again once the live set has doubled to keep this amortized
+	PruneThreshold = FMath::Max(64, CatalogsByUri.Num() * 2);
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FutureverseUBFControllerStats.h"
+#include "GlobalArtifactProvider/CatalogElement.h"
+
+/**
+ * A parsed catalog, shared by every asset and variant whose catalog file has the same content
+ */
+struct FSharedCatalog
+{
+	// Unique among live catalogs, a content hash collision moves the second catalog to the next free value
+	uint64 ContentHash = 0;
+	// Length and an independently seeded hash of the content, compared whenever ContentHash matches
+	int32 ContentLength = 0;
+	uint64 VerifyHash = 0;
+	TMap<FString, UBF::FCatalogElement> Elements;
+	SIZE_T ApproximateBytes = 0;
+};
+
+typedef TSharedPtr<const FSharedCatalog, ESPMode::ThreadSafe> FSharedCatalogPtr;
+
+/**
+ * Dedupes catalogs by content hash so a catalog used by many assets of a collection is parsed and stored once.
+ * Only weak references are held here, catalogs stay alive as long as a loaded variant references them.
+ */
+class FSharedCatalogStore
+{
+public:
+	// Catalog previously loaded from URI, lets callers skip the download entirely
+	FSharedCatalogPtr FindByUri(const FString& URI) const;
+	
+	// Returns the catalog with the same content if one is alive, otherwise parses Content into a new one
+	FSharedCatalogPtr FindOrParse(const FString& URI, const FString& Content);
+
+	// Makes the next load of URI download and parse it again, for catalogs whose content changed
+	void ForgetUri(const FString& URI);
+
+	// Identifies catalogs with the same content, FSharedCatalog::ContentHash
+	static uint64 HashContent(const FString& Content);
+	static uint64 HashContentForVerification(const FString& Content);
+	
+	// a hit is a catalog found by URI or content instead of being parsed
+	FUBFCacheCounters GetParseCounters() const;
+	void ResetParseCounters();
+	
+private:
+	// Live catalog with the same content, probing past collisions. OutFreeKey is the first unused key of the probe
+	// sequence, called with CriticalSection held
+	FSharedCatalogPtr FindSameContent(uint64 ContentHash, int32 ContentLength, uint64 VerifyHash, uint64& OutFreeKey) const;
+	void PruneExpired();
+	
+	TMap<uint64, TWeakPtr<const FSharedCatalog, ESPMode::ThreadSafe>> CatalogsByHash;
+	TMap<FString, TWeakPtr<const FSharedCatalog, ESPMode::ThreadSafe>> CatalogsByUri;
+	mutable FUBFCacheCounters ParseCounters;
+	int32 PruneThreshold = 64;
+	mutable FCriticalSection CriticalSection;
+};
@@ -0,0 +1,300 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+
+#include "Commandlets/UBFBundleCommandlet.h"
+
+#include "AssetIdUtils.h"
+#include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerSettings.h"
+#include "HttpManager.h"
+#include "HttpModule.h"
+#include "CollectionData/CollectionIdData.h"
+#include "Containers/Ticker.h"
+#include "ControllerLayers/AssetProfileUtils.h"
+#include "Downloads/ControllerDownloadManager.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Snapshots/AssetSnapshot.h"
+
+namespace UBFBundleCommandlet
+{
+	constexpr double RequestTimeoutSeconds = 120.0;
+
+	// keeps the commandlet from opening thousands of connections at once for large artifact sets
+	constexpr int32 MaxConcurrentRequests = 32;
+
+	struct FCatalogResource
+	{
+		FString Id;
+		FString Type;
+		FString Uri;
+	};
+
+	// Nothing ticks HTTP or the game thread task queue in a commandlet, so pump both until the request completes
+	template<typename T>
+	bool WaitForFuture(const TFuture<T>& Future)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		double LastTime = StartTime;
+
+		while (!Future.IsReady())
+		{
+			const double Now = FPlatformTime::Seconds();
+			if (Now - StartTime > RequestTimeoutSeconds)
+				return false;
+
+			FHttpModule::Get().GetHttpManager().Tick(Now - LastTime);
+			FTSTicker::GetCoreTicker().Tick(Now - LastTime);
+			FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+			LastTime = Now;
+
+			FPlatformProcess::Sleep(0.005f);
+		}
+		return true;
+	}
+
+	// Returns the number of URIs that failed to load or were rejected by Handle
+	template<typename ResultType>
+	int32 LoadAll(const TArray<FString>& URIs, TFunctionRef<TFuture<ResultType>(const FString&)> Load,
+		TFunctionRef<bool(const FString&, const ResultType&)> Handle)
+	{
+		int32 NumFailures = 0;
+
+		for (int32 BatchStart = 0; BatchStart < URIs.Num(); BatchStart += MaxConcurrentRequests)
+		{
+			const int32 BatchEnd = FMath::Min(BatchStart + MaxConcurrentRequests, URIs.Num());
+
+			TArray<TFuture<ResultType>> Futures;
+			for (int32 Index = BatchStart; Index < BatchEnd; ++Index)
+			{
+				Futures.Add(Load(URIs[Index]));
+			}
+
+			for (int32 Index = BatchStart; Index < BatchEnd; ++Index)
+			{
+				const TFuture<ResultType>& Future = Futures[Index - BatchStart];
+				if (!WaitForFuture(Future))
+				{
+					UE_LOG(LogFutureverseUBFController, Error, TEXT("UUBFBundleCommandlet timed out loading %s"), *URIs[Index]);
+					NumFailures++;
+					continue;
+				}
+
+				const ResultType& Result = Future.Get();
+				if (!Result.bSuccess)
+				{
+					UE_LOG(LogFutureverseUBFController, Error, TEXT("UUBFBundleCommandlet failed to load %s"), *URIs[Index]);
+					NumFailures++;
+					continue;
+				}
+
+				if (!Handle(URIs[Index], Result))
+				{
+					NumFailures++;
+				}
+			}
+		}
+
+		return NumFailures;
+	}
+
+	bool GetCollectionIds(const FString& Params, TArray<FString>& OutCollectionIds)
+	{
+		FString CollectionList;
+		if (FParse::Value(*Params, TEXT("Collections="), CollectionList, false))
+		{
+			CollectionList.ParseIntoArray(OutCollectionIds, TEXT(","), true);
+		}
+
+		FString CollectionDataPath;
+		if (FParse::Value(*Params, TEXT("CollectionData="), CollectionDataPath))
+		{
+			const UCollectionIdData* CollectionData = LoadObject<UCollectionIdData>(nullptr, *CollectionDataPath);
+			if (!CollectionData)
+			{
+				UE_LOG(LogFutureverseUBFController, Error, TEXT("UUBFBundleCommandlet could not load UCollectionIdData %s"), *CollectionDataPath);
+				return false;
+			}
+
+			FString EnvironmentName = TEXT("Production");
+			FParse::Value(*Params, TEXT("Environment="), EnvironmentName);
+
+			const int64 Environment = StaticEnum<EEnvironment>()->GetValueByNameString(EnvironmentName);
+			if (Environment == INDEX_NONE)
+			{
+				UE_LOG(LogFutureverseUBFController, Error, TEXT("UUBFBundleCommandlet unknown environment %s"), *EnvironmentName);
+				return false;
+			}
+
+			OutCollectionIds.Append(CollectionData->GetCollectionQueryIds(static_cast<EEnvironment>(Environment)));
+		}
+
+		for (FString& CollectionId : OutCollectionIds)
+		{
+			CollectionId.TrimStartAndEndInline();
+		}
+		OutCollectionIds.RemoveAll([](const FString& CollectionId) { return CollectionId.IsEmpty(); });
+
+		return OutCollectionIds.Num() > 0;
+	}
+
+	// Reads the resources of a catalog without going through UBF::FCatalogElement, so the commandlet only depends on the JSON layout
+	void ParseCatalogResources(const FString& Source, TArray<FCatalogResource>& OutResources)
+	{
+		TSharedPtr<FJsonObject> CatalogObject;
+		const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Source);
+		if (!FJsonSerializer::Deserialize(Reader, CatalogObject) || !CatalogObject.IsValid())
+			return;
+
+		const TArray<TSharedPtr<FJsonValue>>* Resources;
+		if (!CatalogObject->TryGetArrayField(TEXT("resources"), Resources))
+			return;
+
+		for (const TSharedPtr<FJsonValue>& ResourceValue : *Resources)
+		{
+			const TSharedPtr<FJsonObject>* ResourceObject;
+			if (!ResourceValue.IsValid() || !ResourceValue->TryGetObject(ResourceObject))
+				continue;
+
+			FCatalogResource Resource;
+			(*ResourceObject)->TryGetStringField(TEXT("id"), Resource.Id);
+			(*ResourceObject)->TryGetStringField(TEXT("type"), Resource.Type);
+			(*ResourceObject)->TryGetStringField(TEXT("uri"), Resource.Uri);
+
+			if (!Resource.Uri.IsEmpty())
+			{
+				OutResources.Add(MoveTemp(Resource));
+			}
+		}
+	}
+}
+
+UUBFBundleCommandlet::UUBFBundleCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UUBFBundleCommandlet::Main(const FString& Params)
+{
+	using namespace UBFBundleCommandlet;
+
+	TArray<FString> CollectionIds;
+	if (!GetCollectionIds(Params, CollectionIds))
+	{
+		UE_LOG(LogFutureverseUBFController, Error, TEXT("UUBFBundleCommandlet requires -Collections=<id,id,...> or -CollectionData=<asset path>"));
+		return 1;
+	}
+
+	FString OutputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("UBFBundles"), TEXT("Bundle.ubfb"));
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	if (FPaths::IsRelative(OutputPath))
+	{
+		OutputPath = FPaths::Combine(FPaths::ProjectDir(), OutputPath);
+	}
+
+	const bool bIncludeArtifacts = FParse::Param(*Params, TEXT("Artifacts"));
+
+	TArray<FString> GraphTypes = {TEXT("Blueprint"), TEXT("BlueprintInstance"), TEXT("Graph")};
+	FString GraphTypeList;
+	if (FParse::Value(*Params, TEXT("GraphTypes="), GraphTypeList, false))
+	{
+		GraphTypeList.ParseIntoArray(GraphTypes, TEXT(","), true);
+	}
+
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+	FControllerDownloadManager* DownloadManager = FControllerDownloadManager::GetInstance();
+	FAssetSnapshotWriter Writer;
+	int32 NumFailures = 0;
+
+	// Profiles, one multi-profile file per contract as in FLoadAssetProfilesAction
+	TMap<FString, FString> ProfileURIToCollectionId;
+	for (const FString& CollectionId : CollectionIds)
+	{
+		// collection ids are {chain}:{chainType}:{contract}, so the last segment is the contract
+		const FString ProfileURI = FPaths::Combine(Settings->GetDefaultAssetProfilePath(),
+			FString::Printf(TEXT("%s.json"), *AssetIdUtils::GetTokenID(CollectionId))).Replace(TEXT(" "), TEXT(""));
+		ProfileURIToCollectionId.Add(ProfileURI, CollectionId);
+	}
+
+	TArray<FString> ProfileURIs;
+	ProfileURIToCollectionId.GetKeys(ProfileURIs);
+
+	TSet<FString> CatalogURIs;
+	NumFailures += LoadAll<UBF::FLoadStringResult>(ProfileURIs,
+		[DownloadManager](const FString& URI) { return DownloadManager->LoadStringFromURI(TEXT("AssetProfile"), URI, EUBFDownloadPriority::Prefetch); },
+		[&Writer, &CatalogURIs, &ProfileURIToCollectionId](const FString& URI, const UBF::FLoadStringResult& Result)
+		{
+			const FString& CollectionId = ProfileURIToCollectionId[URI];
+			const FString ContractId = AssetIdUtils::GetTokenID(CollectionId);
+
+			TArray<FAssetProfile> AssetProfileEntries;
+			AssetProfileUtils::ParseAssetProfileJson(Result.Value, AssetProfileEntries);
+
+			for (FAssetProfile& AssetProfile : AssetProfileEntries)
+			{
+				AssetProfile.OverrideRelativePaths("");
+
+				// a single profile file applies to every token, which is what the override id resolves to
+				if (AssetProfile.GetId().IsEmpty())
+					AssetProfile.ModifyId(FString::Printf(TEXT("%s:override"), *CollectionId));
+
+				if (!AssetProfile.GetId().Contains(ContractId))
+					AssetProfile.ModifyId(FString::Printf(TEXT("%s:%s"), *CollectionId, *AssetProfile.GetId()));
+
+				for (const FAssetProfileVariant& Variant : AssetProfile.GetVariants())
+				{
+					if (!Variant.GetRenderCatalogUri().IsEmpty()) CatalogURIs.Add(Variant.GetRenderCatalogUri());
+					if (!Variant.GetParsingCatalogUri().IsEmpty()) CatalogURIs.Add(Variant.GetParsingCatalogUri());
+				}
+
+				Writer.AddProfile(AssetProfile);
+			}
+
+			UE_LOG(LogFutureverseUBFController, Display, TEXT("UUBFBundleCommandlet %s: %d profiles"), *CollectionId, AssetProfileEntries.Num());
+			return AssetProfileEntries.Num() > 0;
+		});
+
+	// Catalogs, stored under the URI the profiles reference
+	TMap<FString, FString> BlobURIToType;
+	NumFailures += LoadAll<UBF::FLoadStringResult>(CatalogURIs.Array(),
+		[DownloadManager](const FString& URI) { return DownloadManager->LoadStringFromURI(TEXT("Catalog"), URI, EUBFDownloadPriority::Prefetch); },
+		[&Writer, &BlobURIToType, &GraphTypes, bIncludeArtifacts](const FString& URI, const UBF::FLoadStringResult& Result)
+		{
+			Writer.AddCatalogSource(URI, Result.Value);
+
+			TArray<FCatalogResource> Resources;
+			ParseCatalogResources(Result.Value, Resources);
+			for (const FCatalogResource& Resource : Resources)
+			{
+				if (bIncludeArtifacts || GraphTypes.Contains(Resource.Type))
+				{
+					BlobURIToType.Add(Resource.Uri, Resource.Type);
+				}
+			}
+			return true;
+		});
+
+	// Graphs and artifacts
+	TArray<FString> BlobURIs;
+	BlobURIToType.GetKeys(BlobURIs);
+	NumFailures += LoadAll<UBF::FLoadDataArrayResult>(BlobURIs,
+		[DownloadManager, &BlobURIToType](const FString& URI) { return DownloadManager->LoadDataFromURI(BlobURIToType[URI], URI, EUBFDownloadPriority::Prefetch); },
+		[&Writer, &BlobURIToType](const FString& URI, const UBF::FLoadDataArrayResult& Result)
+		{
+			TArray<uint8> Data = Result.Value;
+			Writer.AddBlob(URI, BlobURIToType[URI], MoveTemp(Data));
+			return true;
+		});
+
+	if (!Writer.Save(OutputPath))
+		return 1;
+
+	UE_LOG(LogFutureverseUBFController, Display, TEXT("UUBFBundleCommandlet bundled %d collections into %s: %d profiles, %d catalogs, %d graphs/artifacts, %d failures"),
+		CollectionIds.Num(), *OutputPath, Writer.NumProfiles(), Writer.NumCatalogs(), Writer.NumBlobs(), NumFailures);
+
+	// a partial bundle is still written so it can be inspected, but the run fails so build pipelines notice
+	return NumFailures > 0 ? 1 : 0;
+}
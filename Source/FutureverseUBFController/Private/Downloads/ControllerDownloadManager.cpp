@@ -0,0 +1,428 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "Downloads/ControllerDownloadManager.h"
+
+#include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerSettings.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Snapshots/AssetSnapshot.h"
+
+TSharedPtr<FControllerDownloadManager> FControllerDownloadManager::Instance;
+
+FControllerDownloadManager* FControllerDownloadManager::GetInstance()
+{
+	if (!Instance.IsValid())
+	{
+		Instance = MakeShared<FControllerDownloadManager>();
+		Instance->TrafficArchive.StartFromCommandLine();
+	}
+	
+	return Instance.Get();
+}
+
+FString FControllerDownloadManager::ResolveEndpoint(const FString& URI) const
+{
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+	if (!Settings) return URI;
+
+	const FString* BestPrefix = nullptr;
+	const FString* BestReplacement = nullptr;
+	
+	for (const auto& Override : Settings->GetEndpointOverrides())
+	{
+		if (Override.Key.IsEmpty() || !URI.StartsWith(Override.Key)) continue;
+
+		if (!BestPrefix || Override.Key.Len() > BestPrefix->Len())
+		{
+			BestPrefix = &Override.Key;
+			BestReplacement = &Override.Value;
+		}
+	}
+
+	if (!BestPrefix) return URI;
+
+	FString ResolvedURI = *BestReplacement + URI.RightChop(BestPrefix->Len());
+	UE_LOG(LogFutureverseUBFController, VeryVerbose, TEXT("FControllerDownloadManager::ResolveEndpoint %s -> %s"), *URI, *ResolvedURI);
+	return ResolvedURI;
+}
+
+TFuture<UBF::FLoadStringResult> FControllerDownloadManager::LoadStringFromURI(const FString& TypeId, const FString& URI,
+	EUBFDownloadPriority Priority, const FUBFRenderDeadline& Deadline)
+{
+	if (TypeId == TEXT("Catalog"))
+	{
+		UBF::FLoadStringResult SnapshotResult;
+		if (FindSnapshotCatalog(URI, SnapshotResult.Value))
+		{
+			UE_LOG(LogFutureverseUBFController, VeryVerbose, TEXT("FControllerDownloadManager::LoadStringFromURI served %s from snapshot"), *URI);
+			SnapshotResult.bSuccess = true;
+			return MakeFulfilledPromise<UBF::FLoadStringResult>(MoveTemp(SnapshotResult)).GetFuture();
+		}
+	}
+
+	return LoadStringFromNetwork(TypeId, URI, Priority, Deadline);
+}
+
+TFuture<UBF::FLoadStringResult> FControllerDownloadManager::LoadStringFromNetwork(const FString& TypeId, const FString& URI,
+	EUBFDownloadPriority Priority, const FUBFRenderDeadline& Deadline)
+{
+	const bool bIsCatalog = TypeId == TEXT("Catalog");
+	if (NegativeCache.Contains(EUBFNegativeCacheScope::URI, URI))
+	{
+		UE_LOG(LogFutureverseUBFController, VeryVerbose, TEXT("FControllerDownloadManager::LoadStringFromNetwork %s is a known miss"), *URI);
+		return MakeFulfilledPromise<UBF::FLoadStringResult>(UBF::FLoadStringResult()).GetFuture();
+	}
+	
+	if (Deadline.HasExpired())
+	{
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("FControllerDownloadManager::LoadStringFromNetwork %s requested after its render deadline"), *URI);
+		return MakeFulfilledPromise<UBF::FLoadStringResult>(UBF::FLoadStringResult()).GetFuture();
+	}
+	
+	const FString ResolvedURI = ResolveEndpoint(URI);
+	TFuture<UBF::FLoadStringResult> Future = FetchClassified<UBF::FLoadStringResult>(URI, ResolvedURI, Priority, Deadline,
+		[this, TypeId, ResolvedURI]() { return FetchString(TypeId, ResolvedURI); },
+		[](const UBF::FLoadStringResult& Result) { return static_cast<int64>(Result.Value.Len()); });
+	if (!bIsCatalog || !IsCapturingCatalogSources())
+		return Future;
+
+	// captured under the unresolved URI, which is what profiles reference and what snapshots are looked up by
+	return Future.Next([this, URI](const UBF::FLoadStringResult& Result)
+	{
+		if (Result.bSuccess)
+		{
+			FScopeLock Lock(&CaptureLock);
+			CapturedCatalogSources.Add(URI, Result.Value);
+		}
+		return Result;
+	});
+}
+
+TFuture<UBF::FLoadDataArrayResult> FControllerDownloadManager::LoadDataFromURI(const FString& TypeId, const FString& URI,
+	EUBFDownloadPriority Priority, const FUBFRenderDeadline& Deadline)
+{
+	UBF::FLoadDataArrayResult BundleResult;
+	TArray<uint8> BundleData;
+	if (FindSnapshotBlob(URI, BundleData))
+	{
+		UE_LOG(LogFutureverseUBFController, VeryVerbose, TEXT("FControllerDownloadManager::LoadDataFromURI served %s from bundle"), *URI);
+		BundleResult.SetResult(MoveTemp(BundleData));
+		return MakeFulfilledPromise<UBF::FLoadDataArrayResult>(MoveTemp(BundleResult)).GetFuture();
+	}
+	
+	if (NegativeCache.Contains(EUBFNegativeCacheScope::URI, URI))
+	{
+		UE_LOG(LogFutureverseUBFController, VeryVerbose, TEXT("FControllerDownloadManager::LoadDataFromURI %s is a known miss"), *URI);
+		return MakeFulfilledPromise<UBF::FLoadDataArrayResult>(UBF::FLoadDataArrayResult()).GetFuture();
+	}
+	
+	if (Deadline.HasExpired())
+	{
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("FControllerDownloadManager::LoadDataFromURI %s requested after its render deadline"), *URI);
+		return MakeFulfilledPromise<UBF::FLoadDataArrayResult>(UBF::FLoadDataArrayResult()).GetFuture();
+	}
+	
+	const FString ResolvedURI = ResolveEndpoint(URI);
+	return FetchClassified<UBF::FLoadDataArrayResult>(URI, ResolvedURI, Priority, Deadline,
+		[this, TypeId, ResolvedURI]() { return FetchData(TypeId, ResolvedURI); },
+		[](const UBF::FLoadDataArrayResult& Result) { return static_cast<int64>(Result.Value.Num()); });
+}
+
+TFuture<UBF::FLoadStringResult> FControllerDownloadManager::FetchString(const FString& TypeId, const FString& ResolvedURI)
+{
+	if (!TrafficArchive.IsActive())
+		return FDownloadRequestManager::GetInstance()->LoadStringFromURI(TypeId, ResolvedURI);
+	
+	return TrafficArchive.Exchange(EUBFTrafficKind::String, ResolvedURI, [&TypeId, &ResolvedURI]()
+	{
+		return FDownloadRequestManager::GetInstance()->LoadStringFromURI(TypeId, ResolvedURI).Next([](const UBF::FLoadStringResult& Result)
+		{
+			return FUBFTrafficResponse::FromString(Result.bSuccess, Result.Value);
+		});
+	})
+	.Next([](const FUBFTrafficResponse& Response)
+	{
+		UBF::FLoadStringResult Result;
+		Result.bSuccess = Response.bSuccess;
+		Result.Value = Response.GetPayloadAsString();
+		return Result;
+	});
+}
+
+TFuture<UBF::FLoadDataArrayResult> FControllerDownloadManager::FetchData(const FString& TypeId, const FString& ResolvedURI)
+{
+	if (!TrafficArchive.IsActive())
+		return FDownloadRequestManager::GetInstance()->LoadDataFromURI(TypeId, ResolvedURI);
+	
+	return TrafficArchive.Exchange(EUBFTrafficKind::Data, ResolvedURI, [&TypeId, &ResolvedURI]()
+	{
+		return FDownloadRequestManager::GetInstance()->LoadDataFromURI(TypeId, ResolvedURI).Next([](const UBF::FLoadDataArrayResult& Result)
+		{
+			FUBFTrafficResponse Response;
+			Response.bSuccess = Result.bSuccess;
+			Response.Payload = Result.Value;
+			return Response;
+		});
+	})
+	.Next([](const FUBFTrafficResponse& Response)
+	{
+		UBF::FLoadDataArrayResult Result;
+		if (Response.bSuccess)
+		{
+			Result.SetResult(Response.Payload);
+		}
+		return Result;
+	});
+}
+
+template<typename TResult>
+TFuture<TResult> FControllerDownloadManager::FetchClassified(const FString& URI, const FString& ResolvedURI, EUBFDownloadPriority Priority,
+	const FUBFRenderDeadline& Deadline, TFunction<TFuture<TResult>()>&& Start, TFunction<int64(const TResult&)>&& GetBytes)
+{
+	// plain GETs, safe to hedge
+	return Resilience->Fetch<TClassifiedDownload<TResult>>(ResolvedURI, Priority, true,
+		[this, ResolvedURI, Start = MoveTemp(Start)]()
+		{
+			// a retry of a URI the probe found missing fails without sending the GET again
+			if (FindProbedFailure(ResolvedURI) == EUBFLookupFailure::Permanent)
+			{
+				return MakeFulfilledPromise<TClassifiedDownload<TResult>>(TClassifiedDownload<TResult>{TResult(), EUBFLookupFailure::Permanent}).GetFuture();
+			}
+			
+			return Start().Next([this, ResolvedURI](const TResult& Result)
+			{
+				if (Result.bSuccess)
+					return TClassifiedDownload<TResult>{Result, EUBFLookupFailure::Transient};
+				
+				return TClassifiedDownload<TResult>{Result, ClassifyFailedDownload(ResolvedURI)};
+			});
+		},
+		[GetBytes = MoveTemp(GetBytes)](const TClassifiedDownload<TResult>& Download) { return GetBytes(Download.Result); },
+		[](const TClassifiedDownload<TResult>& Download) { return Download.Result.bSuccess; },
+		[](const TClassifiedDownload<TResult>& Download) { return Download.Failure != EUBFLookupFailure::Permanent; },
+		Deadline.ExpiresAt)
+	.Next([this, URI](const TClassifiedDownload<TResult>& Download)
+	{
+		if (!Download.Result.bSuccess && Download.Failure == EUBFLookupFailure::Permanent
+			&& GetDefault<UFutureverseUBFControllerSettings>()->GetNegativeCacheTTLSeconds() > 0.f)
+		{
+			NegativeCache.Add(EUBFNegativeCacheScope::URI, URI);
+		}
+		return Download.Result;
+	});
+}
+
+EUBFLookupFailure FControllerDownloadManager::FindProbedFailure(const FString& ResolvedURI) const
+{
+	FScopeLock Lock(&ProbeLock);
+	const FDownloadProbe* Probe = DownloadProbes.Find(ResolvedURI);
+	if (!Probe || Probe->bInFlight || FPlatformTime::Seconds() >= Probe->ExpiresAt)
+		return EUBFLookupFailure::Transient;
+	
+	return Probe->Failure;
+}
+
+EUBFLookupFailure FControllerDownloadManager::ClassifyFailedDownload(const FString& ResolvedURI)
+{
+	// snapshots, bundles and Sylo DIDs have no response code to go by
+	if (!ResolvedURI.StartsWith(TEXT("http://")) && !ResolvedURI.StartsWith(TEXT("https://")))
+		return EUBFLookupFailure::Transient;
+	
+	{
+		FScopeLock Lock(&ProbeLock);
+		const double Now = FPlatformTime::Seconds();
+		
+		if (const FDownloadProbe* Probe = DownloadProbes.Find(ResolvedURI))
+		{
+			if (Probe->bInFlight)
+				return EUBFLookupFailure::Transient;
+			if (Now < Probe->ExpiresAt)
+				return Probe->Failure;
+		}
+		
+		for (auto It = DownloadProbes.CreateIterator(); It; ++It)
+		{
+			if (!It->Value.bInFlight && Now >= It->Value.ExpiresAt)
+			{
+				It.RemoveCurrent();
+			}
+		}
+		
+		DownloadProbes.FindOrAdd(ResolvedURI).bInFlight = true;
+	}
+	
+	// queued behind the failed attempt rather than awaited inside its slot, a retry picks the answer up once it arrives
+	Governor->Schedule<FUBFTrafficResponse>(ResolvedURI, EUBFDownloadPriority::Prefetch, [this, ResolvedURI]()
+	{
+		return TrafficArchive.Exchange(EUBFTrafficKind::Head, ResolvedURI, [&ResolvedURI]()
+		{
+			TSharedRef<TPromise<FUBFTrafficResponse>> Promise = MakeShared<TPromise<FUBFTrafficResponse>>();
+			TFuture<FUBFTrafficResponse> Future = Promise->GetFuture();
+			
+			const TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+			Request->SetURL(ResolvedURI);
+			Request->SetVerb(TEXT("HEAD"));
+			Request->OnProcessRequestComplete().BindLambda([Promise](FHttpRequestPtr, const FHttpResponsePtr& Response, bool)
+			{
+				FUBFTrafficResponse TrafficResponse;
+				TrafficResponse.bSuccess = Response.IsValid();
+				TrafficResponse.ResponseCode = Response.IsValid() ? Response->GetResponseCode() : 0;
+				Promise->SetValue(MoveTemp(TrafficResponse));
+			});
+			Request->ProcessRequest();
+			
+			return Future;
+		});
+	},
+	[](const FUBFTrafficResponse&) { return static_cast<int64>(0); })
+	.Next([this, ResolvedURI](const FUBFTrafficResponse& Response)
+	{
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("FControllerDownloadManager::ClassifyFailedDownload %s answered %d"), *ResolvedURI, Response.ResponseCode);
+		
+		FScopeLock Lock(&ProbeLock);
+		FDownloadProbe& Probe = DownloadProbes.FindOrAdd(ResolvedURI);
+		Probe.Failure = FNegativeCache::ClassifyResponseCode(Response.ResponseCode);
+		Probe.ExpiresAt = FPlatformTime::Seconds() + GetDefault<UFutureverseUBFControllerSettings>()->GetNegativeCacheTTLSeconds();
+		Probe.bInFlight = false;
+	});
+	
+	return EUBFLookupFailure::Transient;
+}
+
+void FControllerDownloadManager::MountConfiguredSnapshots()
+{
+	{
+		FScopeLock Lock(&SnapshotLock);
+		if (bMountedConfiguredSnapshots) return;
+		bMountedConfiguredSnapshots = true;
+	}
+	
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+	
+	// mounted last so the snapshot captured from a live session is searched before bundles
+	TArray<FString> Paths = Settings->GetBundlePaths();
+	Paths.Add(Settings->GetSnapshotPath());
+	
+	for (const FString& Path : Paths)
+	{
+		if (Path.IsEmpty()) continue;
+		
+		MountSnapshot(FAssetSnapshot::Open(Path));
+	}
+}
+
+void FControllerDownloadManager::MountSnapshot(const TSharedPtr<const FAssetSnapshot>& Snapshot)
+{
+	if (!Snapshot.IsValid()) return;
+	
+	FScopeLock Lock(&SnapshotLock);
+	MountedSnapshots.Remove(Snapshot);
+	MountedSnapshots.Insert(Snapshot, 0);
+	
+	UE_LOG(LogFutureverseUBFController, Log, TEXT("FControllerDownloadManager::MountSnapshot mounted %s (%d profiles, %d catalogs)"),
+		*Snapshot->GetSourcePath(), Snapshot->NumProfiles(), Snapshot->NumCatalogs());
+}
+
+void FControllerDownloadManager::UnmountSnapshot(const TSharedPtr<const FAssetSnapshot>& Snapshot)
+{
+	FScopeLock Lock(&SnapshotLock);
+	MountedSnapshots.Remove(Snapshot);
+}
+
+bool FControllerDownloadManager::FindSnapshotProfile(const FString& AssetId, FAssetProfile& OutProfile) const
+{
+	FScopeLock Lock(&SnapshotLock);
+	for (const TSharedPtr<const FAssetSnapshot>& Snapshot : MountedSnapshots)
+	{
+		if (Snapshot->FindProfile(AssetId, OutProfile))
+			return true;
+	}
+	return false;
+}
+
+bool FControllerDownloadManager::FindSnapshotCatalog(const FString& URI, FString& OutSource) const
+{
+	FScopeLock Lock(&SnapshotLock);
+	for (const TSharedPtr<const FAssetSnapshot>& Snapshot : MountedSnapshots)
+	{
+		if (Snapshot->FindCatalogSource(URI, OutSource))
+			return true;
+	}
+	return false;
+}
+
+bool FControllerDownloadManager::FindSnapshotBlob(const FString& URI, TArray<uint8>& OutData) const
+{
+	FScopeLock Lock(&SnapshotLock);
+	for (const TSharedPtr<const FAssetSnapshot>& Snapshot : MountedSnapshots)
+	{
+		TConstArrayView<uint8> Data;
+		if (Snapshot->FindBlob(URI, Data))
+		{
+			OutData = TArray<uint8>(Data.GetData(), Data.Num());
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FControllerDownloadManager::ContainsSnapshotBlob(const FString& URI) const
+{
+	FScopeLock Lock(&SnapshotLock);
+	for (const TSharedPtr<const FAssetSnapshot>& Snapshot : MountedSnapshots)
+	{
+		if (Snapshot->ContainsBlob(URI))
+			return true;
+	}
+	return false;
+}
+
+int32 FControllerDownloadManager::NumMountedSnapshots() const
+{
+	FScopeLock Lock(&SnapshotLock);
+	return MountedSnapshots.Num();
+}
+
+void FControllerDownloadManager::SetCaptureCatalogSources(bool bCapture)
+{
+	FScopeLock Lock(&CaptureLock);
+	bCaptureCatalogSources = bCapture;
+	if (!bCapture)
+	{
+		CapturedCatalogSources.Empty();
+	}
+}
+
+bool FControllerDownloadManager::IsCapturingCatalogSources() const
+{
+	FScopeLock Lock(&CaptureLock);
+	return bCaptureCatalogSources;
+}
+
+TMap<FString, FString> FControllerDownloadManager::GetCapturedCatalogSources() const
+{
+	FScopeLock Lock(&CaptureLock);
+	return CapturedCatalogSources;
+}
+
+namespace ControllerDownloadManager
+{
+	static FAutoConsoleCommandWithOutputDevice DownloadsCommand(
+		TEXT("ubf.Downloads"),
+		TEXT("Prints requests, queue waits, Retry-After holds, retries, hedges, circuit state and latency percentiles per host for the downloads issued by the controller"),
+		FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+		{
+			FControllerDownloadManager::GetInstance()->GetGovernor().LogStats(Ar);
+			FControllerDownloadManager::GetInstance()->GetResilience().LogStats(Ar);
+		}));
+	
+	static FAutoConsoleCommand ClearNegativeCacheCommand(
+		TEXT("ubf.NegativeCache.Clear"),
+		TEXT("Forgets every remembered miss so the next request for a missing profile, asset or URI reaches the network again"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FControllerDownloadManager::GetInstance()->GetNegativeCache().Clear();
+		}));
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Downloads/DownloadGovernor.h"
+#include "Downloads/DownloadResilience.h"
+#include "Downloads/NegativeCache.h"
+#include "Downloads/TrafficArchive.h"
+#include "UBFRenderDeadline.h"
+#include "GlobalArtifactProvider/DownloadRequestManager.h"
+
+class FAssetSnapshot;
+struct FAssetProfile;
+
+/**
+ * Single entry point for every profile, catalog and Asset Register request the controller issues.
+ * Applies the configured endpoint overrides and passes network requests through FDownloadResilience and
+ * FDownloadGovernor before handing them to FDownloadRequestManager.
+ */
+class FControllerDownloadManager
+{
+public:
+	static FControllerDownloadManager* GetInstance();
+
+	// Rewrites URI using the longest matching prefix in UFutureverseUBFControllerSettings::EndpointOverrides
+	FString ResolveEndpoint(const FString& URI) const;
+	
+	// Catalog requests are answered from mounted snapshots first and only reach the network on a miss.
+	// Requests made after Deadline fail without reaching the network and failed ones aren't retried past it
+	TFuture<UBF::FLoadStringResult> LoadStringFromURI(const FString& TypeId, const FString& URI,
+		EUBFDownloadPriority Priority = EUBFDownloadPriority::Render, const FUBFRenderDeadline& Deadline = FUBFRenderDeadline());
+	
+	// Skips mounted snapshots, for checking whether what they served is still current
+	TFuture<UBF::FLoadStringResult> LoadStringFromNetwork(const FString& TypeId, const FString& URI,
+		EUBFDownloadPriority Priority = EUBFDownloadPriority::Render, const FUBFRenderDeadline& Deadline = FUBFRenderDeadline());
+	
+	// Graph and artifact requests, answered from mounted bundles first
+	TFuture<UBF::FLoadDataArrayResult> LoadDataFromURI(const FString& TypeId, const FString& URI,
+		EUBFDownloadPriority Priority = EUBFDownloadPriority::Render, const FUBFRenderDeadline& Deadline = FUBFRenderDeadline());
+
+	FDownloadGovernor& GetGovernor() const { return *Governor; }
+	FDownloadResilience& GetResilience() const { return *Resilience; }
+	// Requests for a URI that recently answered 404 or similar fail without reaching the network
+	FNegativeCache& GetNegativeCache() { return NegativeCache; }
+	// Records or replays the responses of every request that reaches the network, see FTrafficArchive
+	FTrafficArchive& GetTrafficArchive() { return TrafficArchive; }
+
+	// Mounts UFutureverseUBFControllerSettings::GetBundlePaths and GetSnapshotPath, only the first call does anything
+	void MountConfiguredSnapshots();
+
+	// Snapshots are searched most recently mounted first
+	void MountSnapshot(const TSharedPtr<const FAssetSnapshot>& Snapshot);
+	void UnmountSnapshot(const TSharedPtr<const FAssetSnapshot>& Snapshot);
+	bool FindSnapshotProfile(const FString& AssetId, FAssetProfile& OutProfile) const;
+	bool FindSnapshotCatalog(const FString& URI, FString& OutSource) const;
+	bool FindSnapshotBlob(const FString& URI, TArray<uint8>& OutData) const;
+	bool ContainsSnapshotBlob(const FString& URI) const;
+	int32 NumMountedSnapshots() const;
+
+	// While capturing, the source of every catalog loaded from the network is kept so it can be written to a snapshot
+	void SetCaptureCatalogSources(bool bCapture);
+	bool IsCapturingCatalogSources() const;
+	TMap<FString, FString> GetCapturedCatalogSources() const;
+	
+private:
+	// A FDownloadRequestManager result and, when it failed, whether the server says the URI doesn't exist
+	template<typename TResult>
+	struct TClassifiedDownload
+	{
+		TResult Result;
+		EUBFLookupFailure Failure = EUBFLookupFailure::Transient;
+	};
+	
+	// Fetches through FDownloadResilience. A failure the server confirms as permanent is neither retried nor counted
+	// against the host's circuit breaker, and URI is remembered as a miss. The first failure of a URI is retried while
+	// its probe runs, the retry ends the fetch without a GET if the probe found it missing
+	template<typename TResult>
+	TFuture<TResult> FetchClassified(const FString& URI, const FString& ResolvedURI, EUBFDownloadPriority Priority,
+		const FUBFRenderDeadline& Deadline, TFunction<TFuture<TResult>()>&& Start, TFunction<int64(const TResult&)>&& GetBytes);
+	// FDownloadRequestManager only reports that a download failed, so a HEAD request tells a missing URI from a transient
+	// error. The probe is queued through the governor once per URI and its answer is kept for the negative cache TTL,
+	// until it arrives the failure counts as transient
+	EUBFLookupFailure ClassifyFailedDownload(const FString& ResolvedURI);
+	// What a finished probe of ResolvedURI answered, Transient while none has
+	EUBFLookupFailure FindProbedFailure(const FString& ResolvedURI) const;
+	
+	// FDownloadRequestManager requests, passed through the traffic archive while it records or replays
+	TFuture<UBF::FLoadStringResult> FetchString(const FString& TypeId, const FString& ResolvedURI);
+	TFuture<UBF::FLoadDataArrayResult> FetchData(const FString& TypeId, const FString& ResolvedURI);
+	
+	TSharedRef<FDownloadGovernor> Governor = MakeShared<FDownloadGovernor>();
+	TSharedRef<FDownloadResilience> Resilience = MakeShared<FDownloadResilience>(*Governor);
+	FNegativeCache NegativeCache;
+	FTrafficArchive TrafficArchive;
+	
+	struct FDownloadProbe
+	{
+		EUBFLookupFailure Failure = EUBFLookupFailure::Transient;
+		double ExpiresAt = 0.0;
+		bool bInFlight = false;
+	};
+	
+	mutable FCriticalSection ProbeLock;
+	TMap<FString, FDownloadProbe> DownloadProbes;
+	
+	mutable FCriticalSection SnapshotLock;
+	TArray<TSharedPtr<const FAssetSnapshot>> MountedSnapshots;
+	bool bMountedConfiguredSnapshots = false;
+	
+	mutable FCriticalSection CaptureLock;
+	bool bCaptureCatalogSources = false;
+	TMap<FString, FString> CapturedCatalogSources;
+	
+	static TSharedPtr<FControllerDownloadManager> Instance;
+};
@@ -0,0 +1,210 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "Downloads/DownloadGovernor.h"
+
+#include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerSettings.h"
+#include "FutureverseUBFControllerStats.h"
+
+FDownloadGovernor::~FDownloadGovernor()
+{
+	if (TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	}
+}
+
+void FDownloadGovernor::ReportRetryAfter(const FString& URI, double Seconds)
+{
+	const FString HostName = GetHost(URI);
+	UE_LOG(LogFutureverseUBFController, Warning, TEXT("FDownloadGovernor::ReportRetryAfter %s asked to retry after %.1f s"), *HostName, Seconds);
+
+	FScopeLock ScopeLock(&Lock);
+	FHost& Host = Hosts.FindOrAdd(HostName);
+	Host.BlockedUntil = FMath::Max(Host.BlockedUntil, FPlatformTime::Seconds() + Seconds);
+	Host.Stats.NumRetryAfter++;
+}
+
+double FDownloadGovernor::ParseRetryAfter(const FString& Header, double DefaultSeconds)
+{
+	const FString TrimmedHeader = Header.TrimStartAndEnd();
+	if (TrimmedHeader.IsNumeric())
+		return FMath::Max(FCString::Atod(*TrimmedHeader), 0.0);
+
+	FDateTime RetryTime;
+	if (FDateTime::ParseHttpDate(TrimmedHeader, RetryTime))
+		return FMath::Max((RetryTime - FDateTime::UtcNow()).GetTotalSeconds(), 0.0);
+
+	return DefaultSeconds;
+}
+
+FString FDownloadGovernor::GetHost(const FString& URI)
+{
+	int32 HostStart = URI.Find(TEXT("://"));
+	HostStart = HostStart == INDEX_NONE ? 0 : HostStart + 3;
+
+	int32 HostEnd = URI.Find(TEXT("/"), ESearchCase::CaseSensitive, ESearchDir::FromStart, HostStart);
+	if (HostEnd == INDEX_NONE)
+		HostEnd = URI.Len();
+
+	return URI.Mid(HostStart, HostEnd - HostStart).ToLower();
+}
+
+TMap<FString, FDownloadGovernor::FHostStats> FDownloadGovernor::GetHostStats() const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	TMap<FString, FHostStats> HostStats;
+	for (const auto& Host : Hosts)
+	{
+		HostStats.Add(Host.Key, Host.Value.Stats);
+	}
+	return HostStats;
+}
+
+void FDownloadGovernor::LogStats(FOutputDevice& Ar) const
+{
+	for (const auto& Host : GetHostStats())
+	{
+		const FHostStats& Stats = Host.Value;
+		Ar.Logf(TEXT("%s: %llu requests, %d active, %d waiting, %llu queued (avg wait %.1f ms, max %.1f ms), %llu Retry-After, %.1f KB"),
+			*Host.Key, Stats.NumRequests, Stats.NumActive, Stats.NumWaiting, Stats.NumQueued,
+			Stats.NumQueued > 0 ? Stats.TotalQueueWaitSeconds * 1000.0 / Stats.NumQueued : 0.0, Stats.MaxQueueWaitSeconds * 1000.0,
+			Stats.NumRetryAfter, Stats.BytesReceived / 1024.0);
+	}
+}
+
+void FDownloadGovernor::Enqueue(const FString& HostName, EUBFDownloadPriority Priority, TUniqueFunction<void()>&& Start)
+{
+	TArray<TUniqueFunction<void()>> Starts;
+	{
+		FScopeLock ScopeLock(&Lock);
+		FHost& Host = Hosts.FindOrAdd(HostName);
+		Host.Stats.NumRequests++;
+		Host.Stats.NumWaiting++;
+		Host.Queues[static_cast<int32>(Priority)].Add({MoveTemp(Start), FPlatformTime::Seconds()});
+		INC_DWORD_STAT(STAT_UBFQueuedDownloads);
+
+		PumpHost(Host, FPlatformTime::Seconds(), Starts);
+		if (Host.Stats.NumWaiting > 0)
+		{
+			EnsureTicking();
+		}
+	}
+
+	for (TUniqueFunction<void()>& RequestStart : Starts)
+	{
+		RequestStart();
+	}
+}
+
+void FDownloadGovernor::CompleteRequest(const FString& HostName, int64 Bytes)
+{
+	TArray<TUniqueFunction<void()>> Starts;
+	{
+		FScopeLock ScopeLock(&Lock);
+		FHost* Host = Hosts.Find(HostName);
+		if (!Host)
+			return;
+
+		Host->Stats.NumActive--;
+		Host->Stats.BytesReceived += Bytes;
+		DEC_DWORD_STAT(STAT_UBFActiveDownloads);
+		CSV_CUSTOM_STAT(FutureverseUBFController, DownloadedKB, static_cast<float>(Bytes / 1024.0), ECsvCustomStatOp::Accumulate);
+		if (GetDefault<UFutureverseUBFControllerSettings>()->GetMaxDownloadBytesPerSecondPerHost() > 0)
+		{
+			Host->Tokens -= Bytes;
+		}
+
+		PumpHost(*Host, FPlatformTime::Seconds(), Starts);
+	}
+
+	for (TUniqueFunction<void()>& RequestStart : Starts)
+	{
+		RequestStart();
+	}
+}
+
+void FDownloadGovernor::PumpHost(FHost& Host, double Now, TArray<TUniqueFunction<void()>>& OutStarts)
+{
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+	const int32 MaxConcurrentRequests = Settings->GetMaxConcurrentDownloadsPerHost();
+	const double BytesPerSecond = static_cast<double>(Settings->GetMaxDownloadBytesPerSecondPerHost());
+
+	if (BytesPerSecond > 0.0)
+	{
+		// one second of burst
+		Host.Tokens = FMath::Min(Host.Tokens + (Now - Host.LastRefillTime) * BytesPerSecond, BytesPerSecond);
+	}
+	Host.LastRefillTime = Now;
+
+	while (Host.Stats.NumWaiting > 0 && Host.Stats.NumActive < MaxConcurrentRequests && Now >= Host.BlockedUntil
+		&& (BytesPerSecond <= 0.0 || Host.Tokens >= 0.0))
+	{
+		TArray<FQueuedRequest>& RenderQueue = Host.Queues[static_cast<int32>(EUBFDownloadPriority::Render)];
+		TArray<FQueuedRequest>& PrefetchQueue = Host.Queues[static_cast<int32>(EUBFDownloadPriority::Prefetch)];
+
+		// the last slot is kept for render fetches
+		const bool bCanStartPrefetch = MaxConcurrentRequests == 1 || Host.Stats.NumActive < MaxConcurrentRequests - 1;
+		TArray<FQueuedRequest>* Queue = !RenderQueue.IsEmpty() ? &RenderQueue : (bCanStartPrefetch ? &PrefetchQueue : nullptr);
+		if (!Queue || Queue->IsEmpty())
+			break;
+
+		FQueuedRequest Request = MoveTemp((*Queue)[0]);
+		Queue->RemoveAt(0);
+
+		const double QueueWaitSeconds = Now - Request.QueueTime;
+		// anything past a frame counts as queued rather than started on arrival
+		if (QueueWaitSeconds > 0.001)
+		{
+			Host.Stats.NumQueued++;
+			Host.Stats.TotalQueueWaitSeconds += QueueWaitSeconds;
+			Host.Stats.MaxQueueWaitSeconds = FMath::Max(Host.Stats.MaxQueueWaitSeconds, QueueWaitSeconds);
+		}
+
+		Host.Stats.NumWaiting--;
+		Host.Stats.NumActive++;
+		DEC_DWORD_STAT(STAT_UBFQueuedDownloads);
+		INC_DWORD_STAT(STAT_UBFActiveDownloads);
+		OutStarts.Add(MoveTemp(Request.Start));
+	}
+}
+
+bool FDownloadGovernor::Tick(float DeltaTime)
+{
+	TArray<TUniqueFunction<void()>> Starts;
+	bool bAnyWaiting = false;
+	{
+		FScopeLock ScopeLock(&Lock);
+		const double Now = FPlatformTime::Seconds();
+		for (auto& Host : Hosts)
+		{
+			PumpHost(Host.Value, Now, Starts);
+			bAnyWaiting |= Host.Value.Stats.NumWaiting > 0;
+		}
+
+		if (!bAnyWaiting)
+		{
+			TickerHandle.Reset();
+		}
+	}
+
+	for (TUniqueFunction<void()>& RequestStart : Starts)
+	{
+		RequestStart();
+	}
+	return bAnyWaiting;
+}
+
+void FDownloadGovernor::EnsureTicking()
+{
+	if (TickerHandle.IsValid())
+		return;
+
+	TWeakPtr<FDownloadGovernor> WeakThis = AsShared();
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThis](float DeltaTime)
+	{
+		const TSharedPtr<FDownloadGovernor> Governor = WeakThis.Pin();
+		return Governor.IsValid() && Governor->Tick(DeltaTime);
+	}));
+}
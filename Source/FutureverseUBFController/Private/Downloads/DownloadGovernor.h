@@ -0,0 +1,105 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+enum class EUBFDownloadPriority : uint8
+{
+	// needed by a render that is waiting on it
+	Render,
+	// warms caches ahead of time, never takes the last free slot of a host
+	Prefetch,
+	Num
+};
+
+/**
+ * Admission control for controller downloads, per host.
+ * Limits the requests in flight and the bytes per second received from each host, queues the rest with render
+ * fetches ahead of prefetches, and holds a host back for the Retry-After period it asked for.
+ * Bandwidth is charged once a response arrives, so a large response delays the next requests rather than itself.
+ */
+class FDownloadGovernor : public TSharedFromThis<FDownloadGovernor>
+{
+public:
+	struct FHostStats
+	{
+		uint64 NumRequests = 0;
+		// requests that had to wait for a slot, bandwidth or a Retry-After period
+		uint64 NumQueued = 0;
+		uint64 NumRetryAfter = 0;
+		uint64 BytesReceived = 0;
+		double TotalQueueWaitSeconds = 0.0;
+		double MaxQueueWaitSeconds = 0.0;
+		int32 NumActive = 0;
+		int32 NumWaiting = 0;
+	};
+
+	~FDownloadGovernor();
+
+	// Calls Start once the host of URI has room for another request. GetBytes returns the size of a completed response
+	template<typename TResult>
+	TFuture<TResult> Schedule(const FString& URI, EUBFDownloadPriority Priority, TUniqueFunction<TFuture<TResult>()>&& Start,
+		TFunction<int64(const TResult&)>&& GetBytes)
+	{
+		TSharedRef<TPromise<TResult>> Promise = MakeShared<TPromise<TResult>>();
+		TFuture<TResult> Future = Promise->GetFuture();
+
+		const FString Host = GetHost(URI);
+		TWeakPtr<FDownloadGovernor> WeakThis = AsShared();
+		Enqueue(Host, Priority, [WeakThis, Host, Promise, Start = MoveTemp(Start), GetBytes = MoveTemp(GetBytes)]() mutable
+		{
+			Start().Next([WeakThis, Host, Promise, GetBytes = MoveTemp(GetBytes)](const TResult& Result)
+			{
+				if (const TSharedPtr<FDownloadGovernor> Governor = WeakThis.Pin())
+				{
+					Governor->CompleteRequest(Host, GetBytes(Result));
+				}
+				Promise->SetValue(Result);
+			});
+		});
+
+		return Future;
+	}
+
+	// Holds back new requests to the host of URI, for 429 and 503 responses
+	void ReportRetryAfter(const FString& URI, double Seconds);
+	// Seconds in a Retry-After header given as seconds or as an HTTP date, DefaultSeconds if it is missing or malformed
+	static double ParseRetryAfter(const FString& Header, double DefaultSeconds = 1.0);
+
+	static FString GetHost(const FString& URI);
+
+	TMap<FString, FHostStats> GetHostStats() const;
+	void LogStats(FOutputDevice& Ar) const;
+
+private:
+	struct FQueuedRequest
+	{
+		TUniqueFunction<void()> Start;
+		double QueueTime = 0.0;
+	};
+
+	struct FHost
+	{
+		TArray<FQueuedRequest> Queues[static_cast<int32>(EUBFDownloadPriority::Num)];
+		double BlockedUntil = 0.0;
+		// bandwidth token bucket in bytes, negative while the host is over its budget
+		double Tokens = 0.0;
+		double LastRefillTime = 0.0;
+		FHostStats Stats;
+	};
+
+	void Enqueue(const FString& Host, EUBFDownloadPriority Priority, TUniqueFunction<void()>&& Start);
+	void CompleteRequest(const FString& Host, int64 Bytes);
+
+	// Moves every request the host has room for into OutStarts, called with Lock held
+	void PumpHost(FHost& Host, double Now, TArray<TUniqueFunction<void()>>& OutStarts);
+	bool Tick(float DeltaTime);
+	// Polls the queues while a host is held back by time rather than by a request in flight
+	void EnsureTicking();
+
+	mutable FCriticalSection Lock;
+	TMap<FString, FHost> Hosts;
+	FTSTicker::FDelegateHandle TickerHandle;
+};
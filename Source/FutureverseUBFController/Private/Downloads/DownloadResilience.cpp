@@ -0,0 +1,165 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "Downloads/DownloadResilience.h"
+
+namespace DownloadResilience
+{
+	constexpr int32 MaxLatencySamples = 256;
+	// p95 needs a few samples before it means anything, requests aren't hedged until then
+	constexpr int32 MinHedgeLatencySamples = 20;
+}
+
+TMap<FString, FDownloadResilience::FHostStats> FDownloadResilience::GetHostStats() const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	const double Now = FPlatformTime::Seconds();
+	TMap<FString, FHostStats> HostStats;
+	for (const auto& Host : Hosts)
+	{
+		FHostStats& Stats = HostStats.Add(Host.Key, Host.Value.Stats);
+		Stats.bCircuitOpen = Host.Value.bTripped && Now < Host.Value.OpenUntil;
+
+		TArray<float> SortedSamples = Host.Value.LatencySamples;
+		SortedSamples.Sort();
+		Stats.P50Milliseconds = GetPercentile(SortedSamples, 0.5f);
+		Stats.P95Milliseconds = GetPercentile(SortedSamples, 0.95f);
+		Stats.P99Milliseconds = GetPercentile(SortedSamples, 0.99f);
+		Stats.MaxMilliseconds = SortedSamples.IsEmpty() ? 0.f : SortedSamples.Last();
+	}
+	return HostStats;
+}
+
+void FDownloadResilience::LogStats(FOutputDevice& Ar) const
+{
+	for (const auto& Host : GetHostStats())
+	{
+		const FHostStats& Stats = Host.Value;
+		Ar.Logf(TEXT("%s: %llu attempts, %llu failed, %llu retries, %llu hedges (%llu won), %llu rejected%s, latency p50 %.0f ms p95 %.0f ms p99 %.0f ms max %.0f ms"),
+			*Host.Key, Stats.NumAttempts, Stats.NumFailedAttempts, Stats.NumRetries, Stats.NumHedges, Stats.NumHedgeWins, Stats.NumRejected,
+			Stats.bCircuitOpen ? TEXT(", circuit open") : TEXT(""), Stats.P50Milliseconds, Stats.P95Milliseconds, Stats.P99Milliseconds, Stats.MaxMilliseconds);
+	}
+}
+
+bool FDownloadResilience::AllowRequest(const FString& HostName)
+{
+	FScopeLock ScopeLock(&Lock);
+	FHost& Host = Hosts.FindOrAdd(HostName);
+	if (!Host.bTripped)
+		return true;
+
+	if (FPlatformTime::Seconds() < Host.OpenUntil || Host.bTrialInFlight)
+	{
+		Host.Stats.NumRejected++;
+		return false;
+	}
+
+	Host.bTrialInFlight = true;
+	return true;
+}
+
+bool FDownloadResilience::IsCircuitClosed(const FString& HostName) const
+{
+	FScopeLock ScopeLock(&Lock);
+	const FHost* Host = Hosts.Find(HostName);
+	return !Host || !Host->bTripped;
+}
+
+void FDownloadResilience::RecordAttempt(const FString& HostName, bool bSuccess, bool bHostHealthy, double LatencySeconds, bool bIsHedge)
+{
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+
+	FScopeLock ScopeLock(&Lock);
+	FHost& Host = Hosts.FindOrAdd(HostName);
+	Host.Stats.NumAttempts++;
+
+	if (bSuccess)
+	{
+		const float LatencyMilliseconds = static_cast<float>(LatencySeconds * 1000.0);
+		if (Host.LatencySamples.Num() < DownloadResilience::MaxLatencySamples)
+		{
+			Host.LatencySamples.Add(LatencyMilliseconds);
+		}
+		else
+		{
+			Host.LatencySamples[Host.NextSample] = LatencyMilliseconds;
+		}
+		Host.NextSample = (Host.NextSample + 1) % DownloadResilience::MaxLatencySamples;
+	}
+	else
+	{
+		Host.Stats.NumFailedAttempts++;
+	}
+
+	// a 404 is a healthy host answering, it closes the circuit like a success
+	if (bHostHealthy)
+	{
+		Host.ConsecutiveFailures = 0;
+		Host.bTripped = false;
+		Host.bTrialInFlight = false;
+		return;
+	}
+
+	Host.ConsecutiveFailures++;
+
+	// a failed trial reopens the circuit straight away
+	if (Host.bTrialInFlight || (!Host.bTripped && Host.ConsecutiveFailures >= Settings->GetCircuitBreakerFailureThreshold()))
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("FDownloadResilience opened the circuit for %s after %d consecutive failures, requests fail for %.0f s"),
+			*HostName, Host.ConsecutiveFailures, Settings->GetCircuitBreakerCooldownSeconds());
+		Host.bTripped = true;
+		Host.bTrialInFlight = false;
+		Host.OpenUntil = FPlatformTime::Seconds() + Settings->GetCircuitBreakerCooldownSeconds();
+	}
+}
+
+void FDownloadResilience::RecordRetry(const FString& HostName)
+{
+	FScopeLock ScopeLock(&Lock);
+	Hosts.FindOrAdd(HostName).Stats.NumRetries++;
+}
+
+void FDownloadResilience::RecordHedge(const FString& HostName)
+{
+	FScopeLock ScopeLock(&Lock);
+	Hosts.FindOrAdd(HostName).Stats.NumHedges++;
+}
+
+void FDownloadResilience::RecordHedgeWin(const FString& HostName)
+{
+	FScopeLock ScopeLock(&Lock);
+	Hosts.FindOrAdd(HostName).Stats.NumHedgeWins++;
+}
+
+float FDownloadResilience::GetHedgeDelayMilliseconds(const FString& HostName) const
+{
+	TArray<float> SortedSamples;
+	{
+		FScopeLock ScopeLock(&Lock);
+		const FHost* Host = Hosts.Find(HostName);
+		if (!Host || Host->LatencySamples.Num() < DownloadResilience::MinHedgeLatencySamples)
+			return 0.f;
+		SortedSamples = Host->LatencySamples;
+	}
+
+	SortedSamples.Sort();
+	return GetPercentile(SortedSamples, 0.95f);
+}
+
+float FDownloadResilience::GetRetryDelaySeconds(int32 Attempt)
+{
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+	const float BackoffSeconds = FMath::Min(Settings->GetRetryBaseDelaySeconds() * FMath::Pow(2.f, static_cast<float>(Attempt - 1)),
+		Settings->GetRetryMaxDelaySeconds());
+	// equal jitter, clients that failed together don't retry together
+	return BackoffSeconds * FMath::FRandRange(0.5f, 1.f);
+}
+
+float FDownloadResilience::GetPercentile(const TArray<float>& SortedSamples, float Percentile)
+{
+	if (SortedSamples.IsEmpty())
+		return 0.f;
+
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+	return SortedSamples[Index];
+}
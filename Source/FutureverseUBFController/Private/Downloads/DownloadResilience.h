@@ -0,0 +1,265 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Downloads/DownloadGovernor.h"
+#include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerSettings.h"
+
+/**
+ * Retries, hedging and circuit breaking for controller downloads, on top of FDownloadGovernor.
+ * A failed attempt is retried after an exponential backoff with jitter. An idempotent attempt still running after
+ * the p95 latency of its host gets one duplicate request and the first success wins. A host whose requests keep
+ * failing is cut off for a cooldown, then a single trial request decides whether it is used again.
+ * Latency is measured per attempt from the moment the governor starts it, so queue waits don't trigger hedges.
+ */
+class FDownloadResilience : public TSharedFromThis<FDownloadResilience>
+{
+public:
+	struct FHostStats
+	{
+		uint64 NumAttempts = 0;
+		uint64 NumFailedAttempts = 0;
+		uint64 NumRetries = 0;
+		uint64 NumHedges = 0;
+		// hedged requests that answered before the request they duplicated
+		uint64 NumHedgeWins = 0;
+		// requests failed without reaching the network because the circuit breaker was open
+		uint64 NumRejected = 0;
+		bool bCircuitOpen = false;
+		float P50Milliseconds = 0.f;
+		float P95Milliseconds = 0.f;
+		float P99Milliseconds = 0.f;
+		float MaxMilliseconds = 0.f;
+	};
+
+	explicit FDownloadResilience(FDownloadGovernor& InGovernor) : Governor(InGovernor) {}
+
+	// IsRetryable lets a caller stop retrying failures that will never succeed, every failure is retried without it.
+	// A failure it rejects is the host answering, so it doesn't count toward the circuit breaker.
+	// No retry is started that would begin after ExpiresAt (FPlatformTime::Seconds), 0 means no deadline
+	template<typename TResult>
+	TFuture<TResult> Fetch(const FString& URI, EUBFDownloadPriority Priority, bool bIdempotent, TFunction<TFuture<TResult>()>&& Start,
+		TFunction<int64(const TResult&)>&& GetBytes, TFunction<bool(const TResult&)>&& IsSuccess, TFunction<bool(const TResult&)>&& IsRetryable = nullptr,
+		double ExpiresAt = 0.0)
+	{
+		TSharedRef<TFetch<TResult>> Fetch = MakeShared<TFetch<TResult>>();
+		Fetch->URI = URI;
+		Fetch->Host = FDownloadGovernor::GetHost(URI);
+		Fetch->Priority = Priority;
+		Fetch->bIdempotent = bIdempotent;
+		Fetch->Start = MoveTemp(Start);
+		Fetch->GetBytes = MoveTemp(GetBytes);
+		Fetch->IsSuccess = MoveTemp(IsSuccess);
+		Fetch->IsRetryable = MoveTemp(IsRetryable);
+		Fetch->ExpiresAt = ExpiresAt;
+
+		TFuture<TResult> Future = Fetch->Promise.GetFuture();
+		StartAttempt(Fetch);
+		return Future;
+	}
+
+	TMap<FString, FHostStats> GetHostStats() const;
+	void LogStats(FOutputDevice& Ar) const;
+
+private:
+	template<typename TResult>
+	struct TFetch
+	{
+		FString URI;
+		FString Host;
+		EUBFDownloadPriority Priority = EUBFDownloadPriority::Render;
+		bool bIdempotent = false;
+		TFunction<TFuture<TResult>()> Start;
+		TFunction<int64(const TResult&)> GetBytes;
+		TFunction<bool(const TResult&)> IsSuccess;
+		TFunction<bool(const TResult&)> IsRetryable;
+		double ExpiresAt = 0.0;
+		TPromise<TResult> Promise;
+
+		FCriticalSection Lock;
+		int32 Attempt = 0;
+		// requests of the current attempt still running, 2 while a hedge is out
+		int32 NumOutstanding = 0;
+		bool bHedged = false;
+		bool bDone = false;
+	};
+
+	struct FHost
+	{
+		// latencies of the last successful requests in milliseconds, a ring buffer
+		TArray<float> LatencySamples;
+		int32 NextSample = 0;
+		int32 ConsecutiveFailures = 0;
+		double OpenUntil = 0.0;
+		bool bTripped = false;
+		bool bTrialInFlight = false;
+		FHostStats Stats;
+	};
+
+	template<typename TResult>
+	void StartAttempt(const TSharedRef<TFetch<TResult>>& Fetch)
+	{
+		if (!AllowRequest(Fetch->Host))
+		{
+			{
+				FScopeLock FetchLock(&Fetch->Lock);
+				Fetch->bDone = true;
+			}
+			Fetch->Promise.SetValue(TResult());
+			return;
+		}
+
+		{
+			FScopeLock FetchLock(&Fetch->Lock);
+			Fetch->Attempt++;
+			Fetch->bHedged = false;
+		}
+		LaunchRequest(Fetch, false);
+	}
+
+	template<typename TResult>
+	void LaunchRequest(const TSharedRef<TFetch<TResult>>& Fetch, bool bIsHedge)
+	{
+		int32 Attempt;
+		{
+			FScopeLock FetchLock(&Fetch->Lock);
+			Fetch->NumOutstanding++;
+			Attempt = Fetch->Attempt;
+		}
+
+		TWeakPtr<FDownloadResilience> WeakThis = AsShared();
+		TFunction<int64(const TResult&)> GetBytes = Fetch->GetBytes;
+		Governor.Schedule<TResult>(Fetch->URI, Fetch->Priority, [WeakThis, Fetch, bIsHedge, Attempt]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			if (const TSharedPtr<FDownloadResilience> Resilience = WeakThis.Pin(); Resilience && Fetch->bIdempotent && !bIsHedge)
+			{
+				Resilience->ArmHedge(Fetch, Attempt);
+			}
+
+			return Fetch->Start().Next([WeakThis, Fetch, bIsHedge, StartTime](const TResult& Result)
+			{
+				if (const TSharedPtr<FDownloadResilience> Resilience = WeakThis.Pin())
+				{
+					Resilience->HandleResult(Fetch, Result, FPlatformTime::Seconds() - StartTime, bIsHedge);
+				}
+				return Result;
+			});
+		}, MoveTemp(GetBytes));
+	}
+
+	template<typename TResult>
+	void ArmHedge(const TSharedRef<TFetch<TResult>>& Fetch, int32 Attempt)
+	{
+		const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+		if (!Settings->GetHedgeDownloads())
+			return;
+
+		// nothing is hedged before the host's p95 is known
+		const float HedgeDelayMilliseconds = GetHedgeDelayMilliseconds(Fetch->Host);
+		if (HedgeDelayMilliseconds <= 0.f)
+			return;
+
+		const float DelaySeconds = FMath::Max(HedgeDelayMilliseconds / 1000.f, Settings->GetMinHedgeDelaySeconds());
+		TWeakPtr<FDownloadResilience> WeakThis = AsShared();
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThis, Fetch, Attempt](float)
+		{
+			const TSharedPtr<FDownloadResilience> Resilience = WeakThis.Pin();
+			if (!Resilience)
+				return false;
+
+			{
+				FScopeLock FetchLock(&Fetch->Lock);
+				if (Fetch->bDone || Fetch->bHedged || Fetch->Attempt != Attempt || Fetch->NumOutstanding == 0)
+					return false;
+				Fetch->bHedged = true;
+			}
+
+			// hedges add load, so a struggling host doesn't get them
+			if (!Resilience->IsCircuitClosed(Fetch->Host))
+				return false;
+
+			Resilience->RecordHedge(Fetch->Host);
+			Resilience->LaunchRequest(Fetch, true);
+			return false;
+		}), DelaySeconds);
+	}
+
+	template<typename TResult>
+	void HandleResult(const TSharedRef<TFetch<TResult>>& Fetch, const TResult& Result, double LatencySeconds, bool bIsHedge)
+	{
+		const bool bSuccess = Fetch->IsSuccess(Result);
+		const bool bRetryable = !bSuccess && (!Fetch->IsRetryable || Fetch->IsRetryable(Result));
+		RecordAttempt(Fetch->Host, bSuccess, bSuccess || !bRetryable, LatencySeconds, bIsHedge);
+
+		int32 Attempt;
+		float DelaySeconds;
+		bool bFinished;
+		{
+			FScopeLock FetchLock(&Fetch->Lock);
+			Fetch->NumOutstanding--;
+			if (Fetch->bDone)
+				return;
+
+			// a failure waits for the other request of the attempt, it may still succeed
+			if (!bSuccess && Fetch->NumOutstanding > 0)
+				return;
+
+			Attempt = Fetch->Attempt;
+			DelaySeconds = GetRetryDelaySeconds(Attempt);
+			const bool bRetry = bRetryable && Attempt <= GetDefault<UFutureverseUBFControllerSettings>()->GetMaxDownloadRetries()
+				&& (Fetch->ExpiresAt <= 0.0 || FPlatformTime::Seconds() + DelaySeconds < Fetch->ExpiresAt);
+			Fetch->bDone = bFinished = !bRetry;
+		}
+
+		if (bFinished)
+		{
+			if (bSuccess && bIsHedge)
+			{
+				RecordHedgeWin(Fetch->Host);
+			}
+			Fetch->Promise.SetValue(Result);
+			return;
+		}
+
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("FDownloadResilience retrying %s in %.2f s (attempt %d)"), *Fetch->URI, DelaySeconds, Attempt + 1);
+		RecordRetry(Fetch->Host);
+
+		TWeakPtr<FDownloadResilience> WeakThis = AsShared();
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThis, Fetch](float)
+		{
+			if (const TSharedPtr<FDownloadResilience> Resilience = WeakThis.Pin())
+			{
+				Resilience->StartAttempt(Fetch);
+			}
+			else
+			{
+				Fetch->Promise.SetValue(TResult());
+			}
+			return false;
+		}), DelaySeconds);
+	}
+
+	// Circuit breaker, a tripped host admits a single trial request once its cooldown is over
+	bool AllowRequest(const FString& Host);
+	bool IsCircuitClosed(const FString& Host) const;
+
+	// bHostHealthy is set for successes and for failures the host answered deliberately (a 404), only other failures
+	// count toward the circuit breaker
+	void RecordAttempt(const FString& Host, bool bSuccess, bool bHostHealthy, double LatencySeconds, bool bIsHedge);
+	void RecordRetry(const FString& Host);
+	void RecordHedge(const FString& Host);
+	void RecordHedgeWin(const FString& Host);
+
+	float GetHedgeDelayMilliseconds(const FString& Host) const;
+	static float GetRetryDelaySeconds(int32 Attempt);
+	static float GetPercentile(const TArray<float>& SortedSamples, float Percentile);
+
+	FDownloadGovernor& Governor;
+
+	mutable FCriticalSection Lock;
+	TMap<FString, FHost> Hosts;
+};
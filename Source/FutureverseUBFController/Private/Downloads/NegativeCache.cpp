@@ -0,0 +1,161 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "Downloads/NegativeCache.h"
+
+#include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerSettings.h"
+#include "Interfaces/IHttpResponse.h"
+
+namespace NegativeCache
+{
+	const TCHAR* GetScopeName(EUBFNegativeCacheScope Scope)
+	{
+		switch (Scope)
+		{
+		case EUBFNegativeCacheScope::URI: return TEXT("URI");
+		case EUBFNegativeCacheScope::AssetRegister: return TEXT("AssetRegister");
+		case EUBFNegativeCacheScope::AssetProfile: return TEXT("AssetProfile");
+		case EUBFNegativeCacheScope::AssetRegisterLibrary: return TEXT("AssetRegisterLibrary");
+		default: return TEXT("Unknown");
+		}
+	}
+}
+
+bool FNegativeCache::Contains(EUBFNegativeCacheScope Scope, const FString& Key)
+{
+	FScopeLock ScopeLock(&Lock);
+	TMap<FString, double>& ScopeEntries = Entries[static_cast<int32>(Scope)];
+	const double* ExpiresAt = ScopeEntries.Find(Key);
+	if (ExpiresAt && FPlatformTime::Seconds() >= *ExpiresAt)
+	{
+		ScopeEntries.Remove(Key);
+		Counters.Evictions++;
+		ExpiresAt = nullptr;
+	}
+
+	if (!ExpiresAt)
+	{
+		Counters.Misses++;
+		return false;
+	}
+
+	Counters.Hits++;
+	return true;
+}
+
+void FNegativeCache::Add(EUBFNegativeCacheScope Scope, const FString& Key)
+{
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+	const float TTLSeconds = Settings->GetNegativeCacheTTLSeconds();
+	if (TTLSeconds <= 0.f || Key.IsEmpty())
+		return;
+
+	UE_LOG(LogFutureverseUBFController, Verbose, TEXT("FNegativeCache::Add %s %s fails locally for %.0f s"), NegativeCache::GetScopeName(Scope), *Key, TTLSeconds);
+
+	FScopeLock ScopeLock(&Lock);
+	const double Now = FPlatformTime::Seconds();
+	if (!Entries[static_cast<int32>(Scope)].Contains(Key))
+	{
+		MakeRoom(Now);
+	}
+	Entries[static_cast<int32>(Scope)].Add(Key, Now + TTLSeconds);
+}
+
+void FNegativeCache::Remove(EUBFNegativeCacheScope Scope, const FString& Key)
+{
+	FScopeLock ScopeLock(&Lock);
+	Entries[static_cast<int32>(Scope)].Remove(Key);
+}
+
+void FNegativeCache::Clear()
+{
+	FScopeLock ScopeLock(&Lock);
+	for (TMap<FString, double>& ScopeEntries : Entries)
+	{
+		ScopeEntries.Empty();
+	}
+}
+
+int32 FNegativeCache::Num() const
+{
+	FScopeLock ScopeLock(&Lock);
+	int32 NumEntries = 0;
+	for (const TMap<FString, double>& ScopeEntries : Entries)
+	{
+		NumEntries += ScopeEntries.Num();
+	}
+	return NumEntries;
+}
+
+void FNegativeCache::AppendMemoryReport(FUBFMemoryReport& Report) const
+{
+	FScopeLock ScopeLock(&Lock);
+	Report.AddCounters(TEXT("NegativeCache"), Counters);
+
+	for (int32 Scope = 0; Scope < static_cast<int32>(EUBFNegativeCacheScope::Num); ++Scope)
+	{
+		for (const auto& Entry : Entries[Scope])
+		{
+			Report.Add(TEXT("NegativeCache"), NegativeCache::GetScopeName(static_cast<EUBFNegativeCacheScope>(Scope)),
+				Entry.Key.GetAllocatedSize() + sizeof(double));
+		}
+	}
+}
+
+EUBFLookupFailure FNegativeCache::ClassifyResponseCode(int32 ResponseCode)
+{
+	switch (ResponseCode)
+	{
+	case EHttpResponseCodes::BadRequest:
+	case EHttpResponseCodes::Forbidden:
+	case EHttpResponseCodes::NotFound:
+	case EHttpResponseCodes::Gone:
+		return EUBFLookupFailure::Permanent;
+	default:
+		return EUBFLookupFailure::Transient;
+	}
+}
+
+void FNegativeCache::MakeRoom(double Now)
+{
+	const int32 MaxEntries = GetDefault<UFutureverseUBFControllerSettings>()->GetMaxNegativeCacheEntries();
+	int32 NumEntries = 0;
+	for (TMap<FString, double>& ScopeEntries : Entries)
+	{
+		for (auto It = ScopeEntries.CreateIterator(); It; ++It)
+		{
+			if (Now >= It.Value())
+			{
+				It.RemoveCurrent();
+				Counters.Evictions++;
+			}
+		}
+		NumEntries += ScopeEntries.Num();
+	}
+
+	while (MaxEntries > 0 && NumEntries >= MaxEntries)
+	{
+		TMap<FString, double>* OldestScope = nullptr;
+		const FString* OldestKey = nullptr;
+		double OldestExpiry = TNumericLimits<double>::Max();
+		for (TMap<FString, double>& ScopeEntries : Entries)
+		{
+			for (const auto& Entry : ScopeEntries)
+			{
+				if (Entry.Value < OldestExpiry)
+				{
+					OldestScope = &ScopeEntries;
+					OldestKey = &Entry.Key;
+					OldestExpiry = Entry.Value;
+				}
+			}
+		}
+
+		if (!OldestScope)
+			break;
+
+		OldestScope->Remove(FString(*OldestKey));
+		Counters.Evictions++;
+		NumEntries--;
+	}
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FutureverseUBFControllerStats.h"
+
+enum class EUBFLookupFailure : uint8
+{
+	// no response, a timeout, throttling or a server error, worth asking again
+	Transient,
+	// the server answered that the thing doesn't exist
+	Permanent
+};
+
+enum class EUBFNegativeCacheScope : uint8
+{
+	// a download URI that answered 404 or similar
+	URI,
+	// an asset the Asset Register has no profile URI for, keyed by collection and token
+	AssetRegister,
+	// an asset whose profile document has no entry for it, keyed by asset and profile URI
+	AssetProfile,
+	// an asset the Asset Register querying library failed to look up, keyed by collection and token. Not a miss, its
+	// profile URI is queried directly instead of asking the library again
+	AssetRegisterLibrary,
+	Num
+};
+
+/**
+ * Remembers lookups that failed permanently so repeated renders of the same asset fail locally instead of waiting
+ * on the same request again. Entries expire after UFutureverseUBFControllerSettings::NegativeCacheTTLSeconds,
+ * transient failures are never recorded.
+ */
+class FNegativeCache
+{
+public:
+	// True while Key has an unexpired miss, counted as a hit
+	bool Contains(EUBFNegativeCacheScope Scope, const FString& Key);
+	void Add(EUBFNegativeCacheScope Scope, const FString& Key);
+	void Remove(EUBFNegativeCacheScope Scope, const FString& Key);
+	void Clear();
+
+	int32 Num() const;
+	void AppendMemoryReport(FUBFMemoryReport& Report) const;
+
+	// 400, 403, 404 and 410 are permanent, S3 answers 403 for missing objects of buckets that can't be listed
+	static EUBFLookupFailure ClassifyResponseCode(int32 ResponseCode);
+
+private:
+	// Drops expired entries, then the ones closest to expiring until there is room for one more, called with Lock held
+	void MakeRoom(double Now);
+
+	mutable FCriticalSection Lock;
+	// expiry time per key
+	TMap<FString, double> Entries[static_cast<int32>(EUBFNegativeCacheScope::Num)];
+	FUBFCacheCounters Counters;
+};
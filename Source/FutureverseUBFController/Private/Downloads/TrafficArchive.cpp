@@ -0,0 +1,403 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "Downloads/TrafficArchive.h"
+
+#include "FutureverseUBFControllerLog.h"
+#include "Containers/Ticker.h"
+#include "Downloads/ControllerDownloadManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace TrafficArchive
+{
+	constexpr uint32 Magic = 0x54464255; // "UBFT"
+	constexpr int32 Version = 1;
+
+	const TCHAR* GetKindName(EUBFTrafficKind Kind)
+	{
+		switch (Kind)
+		{
+		case EUBFTrafficKind::String: return TEXT("String");
+		case EUBFTrafficKind::Data: return TEXT("Data");
+		case EUBFTrafficKind::Head: return TEXT("Head");
+		case EUBFTrafficKind::AssetRegister: return TEXT("AssetRegister");
+		case EUBFTrafficKind::Sylo: return TEXT("Sylo");
+		default: return TEXT("Unknown");
+		}
+	}
+}
+
+FUBFTrafficResponse FUBFTrafficResponse::FromString(bool bSuccess, const FString& Value, int32 ResponseCode)
+{
+	FUBFTrafficResponse Response;
+	Response.bSuccess = bSuccess;
+	Response.ResponseCode = ResponseCode;
+
+	const FTCHARToUTF8 Converter(*Value, Value.Len());
+	Response.Payload.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	return Response;
+}
+
+FString FUBFTrafficResponse::GetPayloadAsString() const
+{
+	const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Payload.GetData()), Payload.Num());
+	return FString(Converter.Length(), Converter.Get());
+}
+
+void FTrafficArchive::StartFromCommandLine()
+{
+	FString Path;
+	if (FParse::Value(FCommandLine::Get(), TEXT("UBFReplayTraffic="), Path))
+	{
+		float Scale = 1.f;
+		FParse::Value(FCommandLine::Get(), TEXT("UBFReplayLatencyScale="), Scale);
+		StartReplay(Path, Scale);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("UBFRecordTraffic="), Path))
+	{
+		StartRecording(Path);
+	}
+}
+
+void FTrafficArchive::StartRecording(const FString& Path)
+{
+	FScopeLock ScopeLock(&Lock);
+	Mode = EMode::Record;
+	RecordingPath = ResolvePath(Path);
+	for (int32 Kind = 0; Kind < static_cast<int32>(EUBFTrafficKind::Num); ++Kind)
+	{
+		Recordings[Kind].Empty();
+		Counters[Kind] = FKindCounters();
+	}
+
+	UE_LOG(LogFutureverseUBFController, Log, TEXT("FTrafficArchive::StartRecording recording controller traffic to %s"), *RecordingPath);
+}
+
+bool FTrafficArchive::SaveRecording() const
+{
+	FScopeLock ScopeLock(&Lock);
+	if (Mode != EMode::Record)
+		return false;
+
+	return Save(RecordingPath);
+}
+
+bool FTrafficArchive::StopRecording()
+{
+	FScopeLock ScopeLock(&Lock);
+	if (Mode != EMode::Record)
+		return false;
+
+	const bool bSaved = Save(RecordingPath);
+	Mode = EMode::Off;
+	for (int32 Kind = 0; Kind < static_cast<int32>(EUBFTrafficKind::Num); ++Kind)
+	{
+		Recordings[Kind].Empty();
+	}
+	return bSaved;
+}
+
+bool FTrafficArchive::StartReplay(const FString& Path, float InLatencyScale)
+{
+	FScopeLock ScopeLock(&Lock);
+	Mode = EMode::Off;
+	RecordingPath = ResolvePath(Path);
+	LatencyScale = FMath::Max(InLatencyScale, 0.f);
+	for (int32 Kind = 0; Kind < static_cast<int32>(EUBFTrafficKind::Num); ++Kind)
+	{
+		Counters[Kind] = FKindCounters();
+	}
+
+	if (!Load(RecordingPath))
+		return false;
+
+	Mode = EMode::Replay;
+	UE_LOG(LogFutureverseUBFController, Log, TEXT("FTrafficArchive::StartReplay replaying controller traffic from %s at %.2fx latency"),
+		*RecordingPath, LatencyScale);
+	return true;
+}
+
+void FTrafficArchive::StopReplay()
+{
+	FScopeLock ScopeLock(&Lock);
+	if (Mode != EMode::Replay)
+		return;
+
+	Mode = EMode::Off;
+	for (int32 Kind = 0; Kind < static_cast<int32>(EUBFTrafficKind::Num); ++Kind)
+	{
+		Recordings[Kind].Empty();
+	}
+}
+
+bool FTrafficArchive::IsRecording() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Mode == EMode::Record;
+}
+
+bool FTrafficArchive::IsReplaying() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Mode == EMode::Replay;
+}
+
+TFuture<FUBFTrafficResponse> FTrafficArchive::Exchange(EUBFTrafficKind Kind, const FString& Key,
+	TFunctionRef<TFuture<FUBFTrafficResponse>()> Fetch)
+{
+	EMode CurrentMode;
+	{
+		FScopeLock ScopeLock(&Lock);
+		CurrentMode = Mode;
+	}
+
+	if (CurrentMode == EMode::Replay)
+		return Replay(Kind, Key);
+
+	if (CurrentMode == EMode::Off)
+		return Fetch();
+
+	const double StartTime = FPlatformTime::Seconds();
+	return Fetch().Next([this, Kind, Key, StartTime](const FUBFTrafficResponse& Response)
+	{
+		Record(Kind, Key, StartTime, Response);
+		return Response;
+	});
+}
+
+void FTrafficArchive::Record(EUBFTrafficKind Kind, const FString& Key, double StartTime, const FUBFTrafficResponse& Response)
+{
+	FScopeLock ScopeLock(&Lock);
+	// a request that was in flight when the recording stopped
+	if (Mode != EMode::Record)
+		return;
+
+	FRecordedResponse& Recorded = Recordings[static_cast<int32>(Kind)].FindOrAdd(Key).Responses.AddDefaulted_GetRef();
+	Recorded.LatencySeconds = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+	Recorded.Response = Response;
+
+	FKindCounters& KindCounters = Counters[static_cast<int32>(Kind)];
+	KindCounters.Requests++;
+	KindCounters.Bytes += Response.Payload.Num();
+}
+
+TFuture<FUBFTrafficResponse> FTrafficArchive::Replay(EUBFTrafficKind Kind, const FString& Key)
+{
+	FUBFTrafficResponse Response;
+	float Delay = 0.f;
+	{
+		FScopeLock ScopeLock(&Lock);
+		FKindCounters& KindCounters = Counters[static_cast<int32>(Kind)];
+		KindCounters.Requests++;
+
+		FRecording* Recording = Recordings[static_cast<int32>(Kind)].Find(Key);
+		if (!Recording || Recording->Responses.IsEmpty())
+		{
+			KindCounters.Misses++;
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("FTrafficArchive::Replay %s %s was not recorded"), TrafficArchive::GetKindName(Kind), *Key);
+			return MakeFulfilledPromise<FUBFTrafficResponse>(FUBFTrafficResponse()).GetFuture();
+		}
+
+		const FRecordedResponse& Recorded = Recording->Responses[FMath::Min(Recording->NextIndex, Recording->Responses.Num() - 1)];
+		Recording->NextIndex++;
+		Response = Recorded.Response;
+		Delay = Recorded.LatencySeconds * LatencyScale;
+		KindCounters.Bytes += Response.Payload.Num();
+	}
+
+	TSharedPtr<TPromise<FUBFTrafficResponse>> Promise = MakeShareable(new TPromise<FUBFTrafficResponse>());
+	TFuture<FUBFTrafficResponse> Future = Promise->GetFuture();
+
+	// answered from the ticker like a network response would be, never from inside the request
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Promise, Response = MoveTemp(Response)](float) mutable
+	{
+		Promise->SetValue(MoveTemp(Response));
+		return false;
+	}), Delay);
+
+	return Future;
+}
+
+bool FTrafficArchive::Save(const FString& Path) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = TrafficArchive::Magic;
+	int32 Version = TrafficArchive::Version;
+	Writer << Magic << Version;
+
+	int32 NumResponses = 0;
+	for (int32 Kind = 0; Kind < static_cast<int32>(EUBFTrafficKind::Num); ++Kind)
+	{
+		int32 NumKeys = Recordings[Kind].Num();
+		Writer << NumKeys;
+		for (const auto& Recording : Recordings[Kind])
+		{
+			FString Key = Recording.Key;
+			int32 NumKeyResponses = Recording.Value.Responses.Num();
+			Writer << Key << NumKeyResponses;
+			for (const FRecordedResponse& Recorded : Recording.Value.Responses)
+			{
+				float LatencySeconds = Recorded.LatencySeconds;
+				bool bSuccess = Recorded.Response.bSuccess;
+				int32 ResponseCode = Recorded.Response.ResponseCode;
+				Writer << LatencySeconds << bSuccess << ResponseCode;
+				Writer << const_cast<TArray<uint8>&>(Recorded.Response.Payload);
+			}
+			NumResponses += NumKeyResponses;
+		}
+	}
+
+	if (!FFileHelper::SaveArrayToFile(Bytes, *Path))
+	{
+		UE_LOG(LogFutureverseUBFController, Error, TEXT("FTrafficArchive::Save failed to write %s"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogFutureverseUBFController, Log, TEXT("FTrafficArchive::Save wrote %d responses (%.1f KB) to %s"), NumResponses, Bytes.Num() / 1024.0, *Path);
+	return true;
+}
+
+bool FTrafficArchive::Load(const FString& Path)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+	{
+		UE_LOG(LogFutureverseUBFController, Error, TEXT("FTrafficArchive::Load failed to read %s"), *Path);
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Reader << Magic << Version;
+	if (Magic != TrafficArchive::Magic || Version != TrafficArchive::Version)
+	{
+		UE_LOG(LogFutureverseUBFController, Error, TEXT("FTrafficArchive::Load %s is not a version %d traffic archive"), *Path, TrafficArchive::Version);
+		return false;
+	}
+
+	int32 NumResponses = 0;
+	for (int32 Kind = 0; Kind < static_cast<int32>(EUBFTrafficKind::Num) && !Reader.IsError(); ++Kind)
+	{
+		Recordings[Kind].Empty();
+
+		int32 NumKeys = 0;
+		Reader << NumKeys;
+		for (int32 KeyIndex = 0; KeyIndex < NumKeys && !Reader.IsError(); ++KeyIndex)
+		{
+			FString Key;
+			int32 NumKeyResponses = 0;
+			Reader << Key << NumKeyResponses;
+			if (NumKeyResponses < 0 || NumKeyResponses > Reader.TotalSize())
+			{
+				Reader.SetError();
+				break;
+			}
+
+			FRecording& Recording = Recordings[Kind].FindOrAdd(Key);
+			Recording.Responses.SetNum(NumKeyResponses);
+			for (FRecordedResponse& Recorded : Recording.Responses)
+			{
+				Reader << Recorded.LatencySeconds << Recorded.Response.bSuccess << Recorded.Response.ResponseCode;
+				Reader << Recorded.Response.Payload;
+			}
+			NumResponses += NumKeyResponses;
+		}
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogFutureverseUBFController, Error, TEXT("FTrafficArchive::Load %s is truncated or corrupt"), *Path);
+		for (int32 Kind = 0; Kind < static_cast<int32>(EUBFTrafficKind::Num); ++Kind)
+		{
+			Recordings[Kind].Empty();
+		}
+		return false;
+	}
+
+	UE_LOG(LogFutureverseUBFController, Log, TEXT("FTrafficArchive::Load read %d responses from %s"), NumResponses, *Path);
+	return true;
+}
+
+void FTrafficArchive::LogStats(FOutputDevice& Ar) const
+{
+	FScopeLock ScopeLock(&Lock);
+	switch (Mode)
+	{
+	case EMode::Record:
+		Ar.Logf(TEXT("Traffic: recording to %s"), *RecordingPath);
+		break;
+	case EMode::Replay:
+		Ar.Logf(TEXT("Traffic: replaying %s at %.2fx latency"), *RecordingPath, LatencyScale);
+		break;
+	default:
+		Ar.Logf(TEXT("Traffic: not recording or replaying"));
+		return;
+	}
+
+	for (int32 Kind = 0; Kind < static_cast<int32>(EUBFTrafficKind::Num); ++Kind)
+	{
+		const FKindCounters& KindCounters = Counters[Kind];
+		Ar.Logf(TEXT("%s: %d keys, %d requests, %d not recorded, %.1f KB"), TrafficArchive::GetKindName(static_cast<EUBFTrafficKind>(Kind)),
+			Recordings[Kind].Num(), KindCounters.Requests, KindCounters.Misses, KindCounters.Bytes / 1024.0);
+	}
+}
+
+FString FTrafficArchive::ResolvePath(const FString& Path)
+{
+	const FString TrimmedPath = Path.TrimStartAndEnd();
+	if (TrimmedPath.IsEmpty() || !FPaths::IsRelative(TrimmedPath))
+		return TrimmedPath;
+
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TrimmedPath);
+}
+
+namespace TrafficArchive
+{
+	static FAutoConsoleCommand RecordCommand(
+		TEXT("ubf.Traffic.Record"),
+		TEXT("ubf.Traffic.Record <Path>: records every profile, catalog, graph, Asset Register and Sylo response the controller receives, saved at shutdown or with ubf.Traffic.Stop"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (Args.Num() < 1)
+			{
+				UE_LOG(LogFutureverseUBFController, Warning, TEXT("ubf.Traffic.Record expects a path"));
+				return;
+			}
+			FControllerDownloadManager::GetInstance()->GetTrafficArchive().StartRecording(Args[0]);
+		}));
+
+	static FAutoConsoleCommand ReplayCommand(
+		TEXT("ubf.Traffic.Replay"),
+		TEXT("ubf.Traffic.Replay <Path> [LatencyScale]: answers the controller's requests from a recording instead of the network"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (Args.Num() < 1)
+			{
+				UE_LOG(LogFutureverseUBFController, Warning, TEXT("ubf.Traffic.Replay expects a path"));
+				return;
+			}
+			FControllerDownloadManager::GetInstance()->GetTrafficArchive().StartReplay(Args[0], Args.Num() > 1 ? FCString::Atof(*Args[1]) : 1.f);
+		}));
+
+	static FAutoConsoleCommand StopCommand(
+		TEXT("ubf.Traffic.Stop"),
+		TEXT("Saves and stops the current recording, or stops replaying"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FTrafficArchive& Archive = FControllerDownloadManager::GetInstance()->GetTrafficArchive();
+			Archive.StopRecording();
+			Archive.StopReplay();
+		}));
+
+	static FAutoConsoleCommandWithOutputDevice StatusCommand(
+		TEXT("ubf.Traffic"),
+		TEXT("Prints what is being recorded or replayed, with requests, unrecorded requests and bytes per kind of request"),
+		FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+		{
+			FControllerDownloadManager::GetInstance()->GetTrafficArchive().LogStats(Ar);
+		}));
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EUBFTrafficKind : uint8
+{
+	// FDownloadRequestManager string loads (profiles and catalogs), keyed by resolved URI
+	String,
+	// FDownloadRequestManager data loads (graphs and artifacts), keyed by resolved URI
+	Data,
+	// HEAD requests telling a missing URI from a transient error, keyed by resolved URI
+	Head,
+	// Asset Register queries: GraphQL profile queries keyed by endpoint and asset, querying library calls keyed by
+	// function and asset or query
+	AssetRegister,
+	// Sylo DID resolutions, keyed by DID
+	Sylo,
+	Num
+};
+
+// A response as it is recorded, converted from and to the result type of each request path
+struct FUBFTrafficResponse
+{
+	bool bSuccess = false;
+	// HTTP status where the request path exposes one, 0 otherwise
+	int32 ResponseCode = 0;
+	TArray<uint8> Payload;
+
+	static FUBFTrafficResponse FromString(bool bSuccess, const FString& Value, int32 ResponseCode = 0);
+	FString GetPayloadAsString() const;
+};
+
+/**
+ * Records every response behind the controller's network requests with its latency, and serves the recording back
+ * in a later session so a real player's load can be benchmarked without the network. Replay is deterministic: each
+ * request gets the recorded responses for its key in their recorded order, the last one is repeated once they run out,
+ * and requests that weren't recorded fail without reaching the network.
+ * Started with -UBFRecordTraffic=<path> or -UBFReplayTraffic=<path> [-UBFReplayLatencyScale=<scale>], or the
+ * ubf.Traffic.* console commands. Relative paths are resolved against the project's Saved directory.
+ */
+class FTrafficArchive
+{
+public:
+	void StartFromCommandLine();
+
+	// Drops whatever was recorded or loaded for replay before
+	void StartRecording(const FString& Path);
+	// Writes the recording to its path, recording continues
+	bool SaveRecording() const;
+	// Writes the recording and stops
+	bool StopRecording();
+
+	// Recorded latencies are multiplied by LatencyScale, 0 answers every request on the next tick
+	bool StartReplay(const FString& Path, float LatencyScale = 1.f);
+	void StopReplay();
+
+	bool IsRecording() const;
+	bool IsReplaying() const;
+	bool IsActive() const { return IsRecording() || IsReplaying(); }
+
+	// Returns Fetch() when neither recording nor replaying. While recording, Fetch is called right away and its
+	// response recorded under Kind and Key. While replaying, Fetch is never called
+	TFuture<FUBFTrafficResponse> Exchange(EUBFTrafficKind Kind, const FString& Key, TFunctionRef<TFuture<FUBFTrafficResponse>()> Fetch);
+
+	void LogStats(FOutputDevice& Ar) const;
+
+	static FString ResolvePath(const FString& Path);
+
+private:
+	struct FRecordedResponse
+	{
+		float LatencySeconds = 0.f;
+		FUBFTrafficResponse Response;
+	};
+
+	struct FRecording
+	{
+		TArray<FRecordedResponse> Responses;
+		// next response served while replaying
+		int32 NextIndex = 0;
+	};
+
+	struct FKindCounters
+	{
+		int32 Requests = 0;
+		int32 Misses = 0;
+		int64 Bytes = 0;
+	};
+
+	void Record(EUBFTrafficKind Kind, const FString& Key, double StartTime, const FUBFTrafficResponse& Response);
+	TFuture<FUBFTrafficResponse> Replay(EUBFTrafficKind Kind, const FString& Key);
+
+	bool Save(const FString& Path) const;
+	bool Load(const FString& Path);
+
+	enum class EMode : uint8 { Off, Record, Replay };
+
+	mutable FCriticalSection Lock;
+	EMode Mode = EMode::Off;
+	FString RecordingPath;
+	float LatencyScale = 1.f;
+	TMap<FString, FRecording> Recordings[static_cast<int32>(EUBFTrafficKind::Num)];
+	FKindCounters Counters[static_cast<int32>(EUBFTrafficKind::Num)];
+};
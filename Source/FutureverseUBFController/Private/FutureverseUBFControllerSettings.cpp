@@ -2,7 +2,89 @@
 
 #include "FutureverseUBFControllerSettings.h"
 
+namespace
+{
+	FString ResolveProjectRelativePath(const FString& Path)
+	{
+		if (Path.IsEmpty() || !FPaths::IsRelative(Path))
+			return Path;
+	
+		return FPaths::Combine(FPaths::ProjectDir(), Path);
+	}
+}
+
 UFutureverseUBFControllerSettings::UFutureverseUBFControllerSettings()
 {
 	CategoryName = TEXT("Plugins");
 }
+
+void UFutureverseUBFControllerSettings::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	FString Value;
+	if (FParse::Value(FCommandLine::Get(), TEXT("UBFAssetProfilePath="), Value))
+	{
+		CommandLineAssetProfilePath = Value.TrimStartAndEnd();
+	}
+	if (FParse::Value(FCommandLine::Get(), TEXT("UBFAssetRegisterURL="), Value))
+	{
+		CommandLineAssetRegisterURL = Value.TrimStartAndEnd();
+	}
+	if (FParse::Value(FCommandLine::Get(), TEXT("UBFSnapshot="), Value))
+	{
+		CommandLineSnapshotPath = Value.TrimStartAndEnd();
+	}
+	if (FParse::Value(FCommandLine::Get(), TEXT("UBFBundles="), Value, false))
+	{
+		TArray<FString> Paths;
+		Value.ParseIntoArray(Paths, TEXT(","), true);
+		CommandLineBundlePaths = MoveTemp(Paths);
+	}
+}
+
+FString UFutureverseUBFControllerSettings::GetDefaultAssetProfilePath() const
+{
+	if (CommandLineAssetProfilePath.IsSet())
+		return CommandLineAssetProfilePath.GetValue();
+	
+	return DefaultAssetProfilePath.TrimStartAndEnd();
+}
+
+FString UFutureverseUBFControllerSettings::GetAssetRegisterGraphQLURL() const
+{
+	if (CommandLineAssetRegisterURL.IsSet())
+		return CommandLineAssetRegisterURL.GetValue();
+	
+	return AssetRegisterGraphQLURL.TrimStartAndEnd();
+}
+
+FString UFutureverseUBFControllerSettings::GetSnapshotPath() const
+{
+	return ResolveProjectRelativePath(CommandLineSnapshotPath.Get(SnapshotPath.TrimStartAndEnd()));
+}
+
+FString UFutureverseUBFControllerSettings::GetSessionSnapshotPath() const
+{
+	const FString Path = SessionSnapshotPath.TrimStartAndEnd();
+	if (Path.IsEmpty() || !FPaths::IsRelative(Path))
+		return Path;
+
+	return FPaths::Combine(FPaths::ProjectSavedDir(), Path);
+}
+
+TArray<FString> UFutureverseUBFControllerSettings::GetBundlePaths() const
+{
+	const TArray<FString>& Paths = CommandLineBundlePaths.IsSet() ? CommandLineBundlePaths.GetValue() : BundlePaths;
+
+	TArray<FString> ResolvedPaths;
+	for (const FString& Path : Paths)
+	{
+		const FString ResolvedPath = ResolveProjectRelativePath(Path.TrimStartAndEnd());
+		if (!ResolvedPath.IsEmpty())
+		{
+			ResolvedPaths.Add(ResolvedPath);
+		}
+	}
+	return ResolvedPaths;
+}
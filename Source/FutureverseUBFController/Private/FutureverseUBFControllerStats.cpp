@@ -0,0 +1,364 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "FutureverseUBFControllerStats.h"
+
+#include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerSubsystem.h"
+#include "AssetProfile/AssetProfileRegistrySubsystem.h"
+#include "Downloads/ControllerDownloadManager.h"
+#include "InventoryComponents/UBFInventoryComponent.h"
+#include "UObject/UObjectIterator.h"
+
+LLM_DEFINE_TAG(FutureverseUBFController);
+LLM_DEFINE_TAG(FutureverseUBFController_AssetProfiles);
+LLM_DEFINE_TAG(FutureverseUBFController_Catalogs);
+LLM_DEFINE_TAG(FutureverseUBFController_ItemRegistry);
+LLM_DEFINE_TAG(FutureverseUBFController_RenderRequests);
+
+CSV_DEFINE_CATEGORY_MODULE(FUTUREVERSEUBFCONTROLLER_API, FutureverseUBFController, true);
+
+DEFINE_STAT(STAT_UBFAssetProfilesMemory);
+DEFINE_STAT(STAT_UBFAssetProfilesCount);
+DEFINE_STAT(STAT_UBFCatalogsMemory);
+DEFINE_STAT(STAT_UBFVariantCatalogsCount);
+DEFINE_STAT(STAT_UBFCatalogElementsCount);
+DEFINE_STAT(STAT_UBFSharedCatalogsCount);
+DEFINE_STAT(STAT_UBFItemRegistryMemory);
+DEFINE_STAT(STAT_UBFItemRegistryCount);
+DEFINE_STAT(STAT_UBFRenderRequestsMemory);
+DEFINE_STAT(STAT_UBFRenderRequestsCount);
+DEFINE_STAT(STAT_UBFPendingCatalogLoadsCount);
+DEFINE_STAT(STAT_UBFBindingObjectsCreated);
+DEFINE_STAT(STAT_UBFSharedRenderExecutions);
+DEFINE_STAT(STAT_UBFVariantUpgrades);
+DEFINE_STAT(STAT_UBFVariantDowngrades);
+DEFINE_STAT(STAT_UBFActiveDownloads);
+DEFINE_STAT(STAT_UBFQueuedDownloads);
+DEFINE_STAT(STAT_UBFAssetProfileCacheHits);
+DEFINE_STAT(STAT_UBFAssetProfileCacheMisses);
+DEFINE_STAT(STAT_UBFAssetProfileEvictions);
+DEFINE_STAT(STAT_UBFCatalogCacheHits);
+DEFINE_STAT(STAT_UBFCatalogCacheMisses);
+DEFINE_STAT(STAT_UBFPendingProfileLoadsCount);
+DEFINE_STAT(STAT_UBFPendingParsesCount);
+DEFINE_STAT(STAT_UBFCatalogParseHits);
+DEFINE_STAT(STAT_UBFCatalogParseMisses);
+DEFINE_STAT(STAT_UBFProfileLoadP50);
+DEFINE_STAT(STAT_UBFProfileLoadP95);
+DEFINE_STAT(STAT_UBFCatalogLoadP50);
+DEFINE_STAT(STAT_UBFCatalogLoadP95);
+DEFINE_STAT(STAT_UBFParsingGraphP50);
+DEFINE_STAT(STAT_UBFParsingGraphP95);
+DEFINE_STAT(STAT_UBFRenderP50);
+DEFINE_STAT(STAT_UBFRenderP95);
+
+namespace FutureverseUBFControllerStats
+{
+	constexpr int32 MaxLatencySamples = 256;
+	
+	thread_local int32 ContinuationDepth = 0;
+}
+
+FUBFContinuationScope::FUBFContinuationScope()
+{
+#if CSV_PROFILER
+	if (FutureverseUBFControllerStats::ContinuationDepth++ == 0 && IsInGameThread())
+	{
+		StartTime = FPlatformTime::Seconds();
+	}
+#endif
+}
+
+FUBFContinuationScope::~FUBFContinuationScope()
+{
+#if CSV_PROFILER
+	if (--FutureverseUBFControllerStats::ContinuationDepth == 0 && StartTime > 0.0)
+	{
+		CSV_CUSTOM_STAT(FutureverseUBFController, GameThreadContinuationMs, static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0),
+			ECsvCustomStatOp::Accumulate);
+	}
+#endif
+}
+
+void FUBFCacheCounters::Log(FOutputDevice& Ar, const FString& CacheName) const
+{
+	Ar.Logf(TEXT("%s: %llu hits, %llu misses (%.1f%% hit rate), %llu evictions"), *CacheName, Hits, Misses, GetHitRate() * 100.0, Evictions);
+}
+
+void FUBFMemoryReport::Add(const FString& CacheName, const FString& CollectionId, SIZE_T Bytes)
+{
+	Caches.FindOrAdd(CacheName).FindOrAdd(CollectionId.IsEmpty() ? TEXT("(none)") : CollectionId).Add(Bytes);
+}
+
+void FUBFMemoryReport::AddCounters(const FString& CacheName, const FUBFCacheCounters& Counters)
+{
+	CacheCounters.Add(CacheName, Counters);
+}
+
+void FUBFMemoryReport::Log(FOutputDevice& Ar) const
+{
+	SIZE_T TotalBytes = 0;
+	
+	for (const auto& Cache : Caches)
+	{
+		FUBFMemoryUsage CacheTotal;
+		for (const auto& Collection : Cache.Value)
+		{
+			CacheTotal.Entries += Collection.Value.Entries;
+			CacheTotal.Bytes += Collection.Value.Bytes;
+		}
+		TotalBytes += CacheTotal.Bytes;
+		
+		Ar.Logf(TEXT("%s: %d entries, %.1f KB"), *Cache.Key, CacheTotal.Entries, CacheTotal.Bytes / 1024.0);
+
+		TArray<FString> CollectionIds;
+		Cache.Value.GetKeys(CollectionIds);
+		CollectionIds.Sort([&Cache](const FString& A, const FString& B)
+		{
+			return Cache.Value[A].Bytes > Cache.Value[B].Bytes;
+		});
+		
+		for (const FString& CollectionId : CollectionIds)
+		{
+			const FUBFMemoryUsage& Usage = Cache.Value[CollectionId];
+			Ar.Logf(TEXT("    %-64s %6d entries %10.1f KB"), *CollectionId, Usage.Entries, Usage.Bytes / 1024.0);
+		}
+	}
+	
+	Ar.Logf(TEXT("Total: %.1f KB"), TotalBytes / 1024.0);
+	
+	for (const auto& Counters : CacheCounters)
+	{
+		Counters.Value.Log(Ar, Counters.Key);
+	}
+}
+
+FUBFRuntimeStats& FUBFRuntimeStats::Get()
+{
+	static FUBFRuntimeStats Instance;
+	return Instance;
+}
+
+double FUBFRuntimeStats::BeginLoad(EUBFLoadStage Stage)
+{
+	switch (Stage)
+	{
+	case EUBFLoadStage::AssetProfile: INC_DWORD_STAT(STAT_UBFPendingProfileLoadsCount); break;
+	case EUBFLoadStage::Catalog: INC_DWORD_STAT(STAT_UBFPendingCatalogLoadsCount); break;
+	case EUBFLoadStage::ParsingGraph: INC_DWORD_STAT(STAT_UBFPendingParsesCount); break;
+	default: break;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	Stages[static_cast<int32>(Stage)].NumInFlight++;
+	return FPlatformTime::Seconds();
+}
+
+void FUBFRuntimeStats::EndLoad(EUBFLoadStage Stage, double StartTime, bool bSuccess)
+{
+	switch (Stage)
+	{
+	case EUBFLoadStage::AssetProfile: DEC_DWORD_STAT(STAT_UBFPendingProfileLoadsCount); break;
+	case EUBFLoadStage::Catalog: DEC_DWORD_STAT(STAT_UBFPendingCatalogLoadsCount); break;
+	case EUBFLoadStage::ParsingGraph: DEC_DWORD_STAT(STAT_UBFPendingParsesCount); break;
+	default: break;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	Stages[static_cast<int32>(Stage)].NumInFlight--;
+	if (bSuccess)
+	{
+		AddLatencyLocked(Stage, FPlatformTime::Seconds() - StartTime);
+	}
+}
+
+void FUBFRuntimeStats::AddLatency(EUBFLoadStage Stage, double Seconds)
+{
+	FScopeLock ScopeLock(&Lock);
+	AddLatencyLocked(Stage, Seconds);
+}
+
+void FUBFRuntimeStats::AddLatencyLocked(EUBFLoadStage Stage, double Seconds)
+{
+	FStage& LoadStage = Stages[static_cast<int32>(Stage)];
+	const float LatencyMilliseconds = static_cast<float>(Seconds * 1000.0);
+	if (LoadStage.LatencySamples.Num() < FutureverseUBFControllerStats::MaxLatencySamples)
+	{
+		LoadStage.LatencySamples.Add(LatencyMilliseconds);
+	}
+	else
+	{
+		LoadStage.LatencySamples[LoadStage.NextSample] = LatencyMilliseconds;
+	}
+	LoadStage.NextSample = (LoadStage.NextSample + 1) % FutureverseUBFControllerStats::MaxLatencySamples;
+
+#if STATS
+	TArray<float> SortedSamples = LoadStage.LatencySamples;
+	SortedSamples.Sort();
+	const float P50 = GetPercentile(SortedSamples, 0.5f);
+	const float P95 = GetPercentile(SortedSamples, 0.95f);
+	switch (Stage)
+	{
+	case EUBFLoadStage::AssetProfile: SET_FLOAT_STAT(STAT_UBFProfileLoadP50, P50); SET_FLOAT_STAT(STAT_UBFProfileLoadP95, P95); break;
+	case EUBFLoadStage::Catalog: SET_FLOAT_STAT(STAT_UBFCatalogLoadP50, P50); SET_FLOAT_STAT(STAT_UBFCatalogLoadP95, P95); break;
+	case EUBFLoadStage::ParsingGraph: SET_FLOAT_STAT(STAT_UBFParsingGraphP50, P50); SET_FLOAT_STAT(STAT_UBFParsingGraphP95, P95); break;
+	case EUBFLoadStage::Render: SET_FLOAT_STAT(STAT_UBFRenderP50, P50); SET_FLOAT_STAT(STAT_UBFRenderP95, P95); break;
+	default: break;
+	}
+#endif
+}
+
+int32 FUBFRuntimeStats::GetNumInFlight(EUBFLoadStage Stage) const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Stages[static_cast<int32>(Stage)].NumInFlight;
+}
+
+float FUBFRuntimeStats::GetPercentile(EUBFLoadStage Stage, float Percentile) const
+{
+	TArray<float> SortedSamples;
+	{
+		FScopeLock ScopeLock(&Lock);
+		SortedSamples = Stages[static_cast<int32>(Stage)].LatencySamples;
+	}
+	SortedSamples.Sort();
+	return GetPercentile(SortedSamples, Percentile);
+}
+
+int32 FUBFRuntimeStats::GetNumSamples(EUBFLoadStage Stage) const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Stages[static_cast<int32>(Stage)].LatencySamples.Num();
+}
+
+float FUBFRuntimeStats::GetPercentile(const TArray<float>& SortedSamples, float Percentile)
+{
+	if (SortedSamples.IsEmpty())
+		return 0.f;
+
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+	return SortedSamples[Index];
+}
+
+void FUBFRuntimeStats::Reset()
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		for (FStage& Stage : Stages)
+		{
+			Stage.LatencySamples.Reset();
+			Stage.NextSample = 0;
+		}
+	}
+
+	SET_FLOAT_STAT(STAT_UBFProfileLoadP50, 0.f);
+	SET_FLOAT_STAT(STAT_UBFProfileLoadP95, 0.f);
+	SET_FLOAT_STAT(STAT_UBFCatalogLoadP50, 0.f);
+	SET_FLOAT_STAT(STAT_UBFCatalogLoadP95, 0.f);
+	SET_FLOAT_STAT(STAT_UBFParsingGraphP50, 0.f);
+	SET_FLOAT_STAT(STAT_UBFParsingGraphP95, 0.f);
+	SET_FLOAT_STAT(STAT_UBFRenderP50, 0.f);
+	SET_FLOAT_STAT(STAT_UBFRenderP95, 0.f);
+}
+
+void FUBFRuntimeStats::Log(FOutputDevice& Ar) const
+{
+	for (int32 Index = 0; Index < static_cast<int32>(EUBFLoadStage::Num); ++Index)
+	{
+		const EUBFLoadStage Stage = static_cast<EUBFLoadStage>(Index);
+		Ar.Logf(TEXT("%s: %d in flight, latency p50 %.0f ms p95 %.0f ms p99 %.0f ms over the last %d"), GetStageName(Stage),
+			GetNumInFlight(Stage), GetPercentile(Stage, 0.5f), GetPercentile(Stage, 0.95f), GetPercentile(Stage, 0.99f), GetNumSamples(Stage));
+	}
+}
+
+const TCHAR* FUBFRuntimeStats::GetStageName(EUBFLoadStage Stage)
+{
+	switch (Stage)
+	{
+	case EUBFLoadStage::AssetProfile: return TEXT("AssetProfile");
+	case EUBFLoadStage::Catalog: return TEXT("Catalog");
+	case EUBFLoadStage::ParsingGraph: return TEXT("ParsingGraph");
+	case EUBFLoadStage::Render: return TEXT("Render");
+	default: return TEXT("Unknown");
+	}
+}
+
+namespace FutureverseUBFControllerStats
+{
+	static FAutoConsoleCommandWithWorldArgsAndOutputDevice MemoryCommand(
+		TEXT("ubf.Memory"),
+		TEXT("Dumps entry counts and approximate bytes per collection for the FutureverseUBFController caches"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			FUBFMemoryReport Report;
+			
+			if (const UAssetProfileRegistrySubsystem* AssetProfileRegistry = UAssetProfileRegistrySubsystem::Get(World))
+			{
+				AssetProfileRegistry->AppendMemoryReport(Report);
+			}
+
+			if (const UFutureverseUBFControllerSubsystem* ControllerSubsystem = UFutureverseUBFControllerSubsystem::Get(World))
+			{
+				ControllerSubsystem->AppendMemoryReport(Report);
+			}
+
+			FControllerDownloadManager::GetInstance()->GetNegativeCache().AppendMemoryReport(Report);
+
+			for (TObjectIterator<UUBFInventoryComponent> It; It; ++It)
+			{
+				if (It->GetWorld() == World)
+				{
+					It->AppendMemoryReport(Report);
+				}
+			}
+
+			Report.Log(Ar);
+		}));
+
+	static FAutoConsoleCommandWithWorldArgsAndOutputDevice StatsCommand(
+		TEXT("ubf.Stats"),
+		TEXT("Prints in-flight loads, rolling latency percentiles per stage, cache hit rates and download queue depths of the FutureverseUBFController pipeline"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			FUBFRuntimeStats::Get().Log(Ar);
+			
+			if (const UAssetProfileRegistrySubsystem* AssetProfileRegistry = UAssetProfileRegistrySubsystem::Get(World))
+			{
+				AssetProfileRegistry->GetCacheCounters().Log(Ar, TEXT("AssetProfiles"));
+			}
+
+			if (const UFutureverseUBFControllerSubsystem* ControllerSubsystem = UFutureverseUBFControllerSubsystem::Get(World))
+			{
+				ControllerSubsystem->LogRuntimeStats(Ar);
+			}
+
+			int32 NumActive = 0;
+			int32 NumWaiting = 0;
+			for (const auto& Host : FControllerDownloadManager::GetInstance()->GetGovernor().GetHostStats())
+			{
+				NumActive += Host.Value.NumActive;
+				NumWaiting += Host.Value.NumWaiting;
+			}
+			Ar.Logf(TEXT("Downloads: %d active, %d queued, see ubf.Downloads for each host"), NumActive, NumWaiting);
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs ResetStatsCommand(
+		TEXT("ubf.Stats.Reset"),
+		TEXT("Resets the latency samples and cache counters printed by ubf.Stats and ubf.Memory, to measure a specific stretch of play"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			FUBFRuntimeStats::Get().Reset();
+			
+			if (UAssetProfileRegistrySubsystem* AssetProfileRegistry = UAssetProfileRegistrySubsystem::Get(World))
+			{
+				AssetProfileRegistry->ResetCacheCounters();
+			}
+
+			if (UFutureverseUBFControllerSubsystem* ControllerSubsystem = UFutureverseUBFControllerSubsystem::Get(World))
+			{
+				ControllerSubsystem->ResetRuntimeStats();
+			}
+			
+			UE_LOG(LogFutureverseUBFController, Log, TEXT("ubf.Stats.Reset counters and latency samples cleared"));
+		}));
+}
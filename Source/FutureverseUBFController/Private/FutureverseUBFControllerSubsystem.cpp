@@ -2,9 +2,12 @@
 
 #include "FutureverseUBFControllerSubsystem.h"
 
+#include "AssetIdUtils.h"
 #include "BlueprintUBFLibrary.h"
 #include "FutureverseAssetLoadData.h"
 #include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerSettings.h"
+#include "FutureverseUBFControllerStats.h"
 #include "UBFLogData.h"
 #include "AssetProfile/AssetProfileRegistrySubsystem.h"
 #include "Util/UBFUtils.h"
@@ -13,17 +16,117 @@
 #include "ExecutionSets/ExecutionSetResult.h"
 #include "GlobalArtifactProvider/GlobalArtifactProviderSubsystem.h"
 #include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Hash/CityHash.h"
+#include "Bindings/BindingObjectReferencer.h"
 #include "LoadActions/LoadActionUtils.h"
+#include "Catalogs/SharedCatalogStore.h"
+#include "Downloads/ControllerDownloadManager.h"
 #include "LoadActions/LoadAssetCatalogAction.h"
 #include "LoadActions/LoadAssetProfilesAction.h"
+#include "LoadActions/ExtractTraitsAction.h"
+
+namespace
+{
+	void MarkRenderStageDegraded(FUBFRenderDeadlineReport& Report, EUBFRenderStage Stage)
+	{
+		Report.DegradedStages.AddUnique(Stage);
+		if (Report.ExhaustedStage == EUBFRenderStage::None)
+			Report.ExhaustedStage = Stage;
+	}
+
+	// Rebuilds a saved trait with its UBF type, false for types that can't be rebuilt from their string value
+	bool MakeSessionTraitHandle(const FUBFSessionTrait& Trait, UBF::FDynamicHandle& OutHandle)
+	{
+		if (Trait.Type.Equals(TEXT("string"), ESearchCase::IgnoreCase))
+		{
+			OutHandle = UBF::FDynamicHandle::String(Trait.Value);
+			return true;
+		}
+		if (Trait.Type.Equals(TEXT("boolean"), ESearchCase::IgnoreCase) || Trait.Type.Equals(TEXT("bool"), ESearchCase::IgnoreCase))
+		{
+			OutHandle = UBF::FDynamicHandle::Bool(Trait.Value.ToBool());
+			return true;
+		}
+		if (Trait.Type.Equals(TEXT("int"), ESearchCase::IgnoreCase) && Trait.Value.IsNumeric())
+		{
+			OutHandle = UBF::FDynamicHandle::Int(FCString::Atoi(*Trait.Value));
+			return true;
+		}
+		if (Trait.Type.Equals(TEXT("float"), ESearchCase::IgnoreCase) && Trait.Value.IsNumeric())
+		{
+			OutHandle = UBF::FDynamicHandle::Float(FCString::Atof(*Trait.Value));
+			return true;
+		}
+		return false;
+	}
+}
+
+UFutureverseUBFControllerSubsystem::FRenderItemInfo::FRenderItemInfo()
+{
+	INC_DWORD_STAT(STAT_UBFRenderRequestsCount);
+}
+
+UFutureverseUBFControllerSubsystem::FRenderItemInfo::~FRenderItemInfo()
+{
+	DEC_DWORD_STAT(STAT_UBFRenderRequestsCount);
+	DEC_MEMORY_STAT_BY(STAT_UBFRenderRequestsMemory, TrackedMemory);
+}
+
+void UFutureverseUBFControllerSubsystem::FRenderItemInfo::UpdateTrackedMemory()
+{
+	DEC_MEMORY_STAT_BY(STAT_UBFRenderRequestsMemory, TrackedMemory);
+	TrackedMemory = GetApproximateMemoryUsage();
+	INC_MEMORY_STAT_BY(STAT_UBFRenderRequestsMemory, TrackedMemory);
+}
+
+SIZE_T UFutureverseUBFControllerSubsystem::FRenderItemInfo::GetApproximateMemoryUsage() const
+{
+	SIZE_T Size = sizeof(FRenderItemInfo) + InputMap.GetAllocatedSize() + AssetProfiles.GetAllocatedSize();
+	
+	if (RenderData.IsValid())
+	{
+		Size += sizeof(FUBFRenderDataContainer) + RenderData->GetMetadataJson().Len() * sizeof(TCHAR);
+		for (const FUBFContextTreeData& ContextTreeData : RenderData->GetContextTreeRef())
+		{
+			Size += sizeof(FUBFContextTreeData) + ContextTreeData.RootNodeID.GetAllocatedSize()
+				+ ContextTreeData.ProfileURI.GetAllocatedSize() + ContextTreeData.Relationships.GetAllocatedSize();
+		}
+	}
+	
+	return Size;
+}
+
+const FAssetProfile& UFutureverseUBFControllerSubsystem::FRenderItemInfo::GetAssetProfile(const FString& AssetId) const
+{
+	const FAssetProfilePtr* AssetProfile = AssetProfiles.Find(AssetId);
+	return AssetProfile && AssetProfile->IsValid() ? **AssetProfile : FAssetProfile::Invalid();
+}
 
 UFutureverseUBFControllerSubsystem::UFutureverseUBFControllerSubsystem()
 {
 	MemoryCacheLoader = MakeShared<FMemoryCacheLoader>();
+	CatalogStore = MakeShared<FSharedCatalogStore>();
+	BindingObjectReferencer = MakeShared<FBindingObjectReferencer>();
+}
+
+TSharedPtr<UFutureverseUBFControllerSubsystem::FRenderItemInfo> UFutureverseUBFControllerSubsystem::MakeRenderItemInfo(float TimeBudgetSeconds)
+{
+	LLM_SCOPE_BYTAG(FutureverseUBFController_RenderRequests);
+	
+	InFlightRenderItemInfos.RemoveAllSwap([](const TWeakPtr<FRenderItemInfo>& RenderItemInfo) { return !RenderItemInfo.IsValid(); });
+	
+	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeShared<FRenderItemInfo>();
+	RenderItemInfo->RequestTime = FPlatformTime::Seconds();
+	CSV_CUSTOM_STAT(FutureverseUBFController, RendersStarted, 1, ECsvCustomStatOp::Accumulate);
+	RenderItemInfo->Deadline = FUBFRenderDeadline::FromBudget(TimeBudgetSeconds);
+	RenderItemInfo->DeadlineReport.BudgetSeconds = RenderItemInfo->Deadline.BudgetSeconds;
+	InFlightRenderItemInfos.Add(RenderItemInfo);
+	return RenderItemInfo;
 }
 
 void UFutureverseUBFControllerSubsystem::RenderItem(UUBFItem* Item, const FString& VariantID, UUBFRuntimeController* Controller,
-	const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete)
+	const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete, float TimeBudgetSeconds)
 {
 	if (!IsValid(Item))
 	{
@@ -37,7 +140,7 @@ void UFutureverseUBFControllerSubsystem::RenderItem(UUBFItem* Item, const FStrin
 		return;
 	}
 	
-	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeShared<FRenderItemInfo>();
+	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeRenderItemInfo(TimeBudgetSeconds);
 	RenderItemInfo->Controller = Controller;
 	RenderItemInfo->InputMap = InputMap;
 	RenderItemInfo->OnComplete = OnComplete;
@@ -45,23 +148,34 @@ void UFutureverseUBFControllerSubsystem::RenderItem(UUBFItem* Item, const FStrin
 	// TODO what if item becomes invalid while we load this?
 	// TODO what if subsystem becomes invalid while we load this?
 	
-	Item->EnsureProfileURILoaded().Next([this, Item, RenderItemInfo, VariantID](bool bResult)
+	EnterRenderStage(*RenderItemInfo, EUBFRenderStage::ItemData);
+	LoadActionUtils::WithDeadline(Item->EnsureProfileURILoaded(), RenderItemInfo->Deadline).Next(
+		[this, Item, RenderItemInfo, VariantID](const TOptional<bool>& bResult)
 	{
-		if (!bResult)
+		FUBFContinuationScope ContinuationScope;
+		if (!IsSubsystemValid()) return;
+
+		if (!bResult.IsSet())
 		{
-			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::RenderItem Failed to ensure ProfileURI was loaded"));
+			FailRenderDeadline(RenderItemInfo);
 			return;
 		}
 		
-		if (!IsSubsystemValid()) return;
+		if (!bResult.GetValue())
+		{
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::RenderItem Failed to ensure ProfileURI was loaded"));
+			FailSharedRender(RenderItemInfo);
+			return;
+		}
 			
 		RenderItemInfo->RenderData = FUBFRenderDataContainer::GetFromData(Item->GetCachedRenderData(), VariantID);
+		RenderItemInfo->UpdateTrackedMemory();
 		RenderItemInternal(RenderItemInfo);
 	});
 }
 
 void UFutureverseUBFControllerSubsystem::RenderItemTree(UUBFItem* Item, const FString& VariantID, 
-	UUBFRuntimeController* Controller, const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete)
+	UUBFRuntimeController* Controller, const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete, float TimeBudgetSeconds)
 {
 	if (!IsValid(Item))
 	{
@@ -75,7 +189,7 @@ void UFutureverseUBFControllerSubsystem::RenderItemTree(UUBFItem* Item, const FS
 		return;
 	}
 
-	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeShared<FRenderItemInfo>();
+	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeRenderItemInfo(TimeBudgetSeconds);
 	RenderItemInfo->Controller = Controller;
 	RenderItemInfo->InputMap = InputMap;
 	RenderItemInfo->OnComplete = OnComplete;
@@ -83,63 +197,78 @@ void UFutureverseUBFControllerSubsystem::RenderItemTree(UUBFItem* Item, const FS
 	// TODO what if item becomes invalid while we load this?
 	// TODO what if subsystem becomes invalid while we load this?
 	
-	Item->EnsureContextTreeLoaded().Next([this, Item, RenderItemInfo, VariantID](bool bResult)
+	EnterRenderStage(*RenderItemInfo, EUBFRenderStage::ItemData);
+	LoadActionUtils::WithDeadline(Item->EnsureContextTreeLoaded(), RenderItemInfo->Deadline).Next(
+		[this, Item, RenderItemInfo, VariantID](const TOptional<bool>& bResult)
 	{
-		if (!bResult)
+		FUBFContinuationScope ContinuationScope;
+		if (!IsSubsystemValid()) return;
+
+		if (!bResult.IsSet())
 		{
-			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::RenderItemTree Failed to ensure ContextTree was loaded"));
+			FailRenderDeadline(RenderItemInfo);
 			return;
 		}
 		
-		if (!IsSubsystemValid()) return;
+		if (!bResult.GetValue())
+		{
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::RenderItemTree Failed to ensure ContextTree was loaded"));
+			FailSharedRender(RenderItemInfo);
+			return;
+		}
 		
 		RenderItemInfo->RenderData = FUBFRenderDataContainer::GetFromData(Item->GetCachedRenderData(), VariantID);
+		RenderItemInfo->UpdateTrackedMemory();
 
 		RenderItemTreeInternal(RenderItemInfo);
 	});
 }
 
 void UFutureverseUBFControllerSubsystem::RenderItemFromRenderData(const FUBFRenderData& RenderData, const FString& VariantID, 
-	UUBFRuntimeController* Controller, const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete)
+	UUBFRuntimeController* Controller, const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete, float TimeBudgetSeconds)
 {
-	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeShared<FRenderItemInfo>();
+	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeRenderItemInfo(TimeBudgetSeconds);
 	RenderItemInfo->RenderData = FUBFRenderDataContainer::GetFromData(RenderData, VariantID);
 	RenderItemInfo->Controller = Controller;
 	RenderItemInfo->InputMap = InputMap;
 	RenderItemInfo->OnComplete = OnComplete;
+	RenderItemInfo->UpdateTrackedMemory();
 	
 	RenderItemInternal(RenderItemInfo);
 }
 
 void UFutureverseUBFControllerSubsystem::RenderItemTreeFromRenderData(const FUBFRenderData& RenderData, const FString& VariantID, 
-	UUBFRuntimeController* Controller, const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete)
+	UUBFRuntimeController* Controller, const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete, float TimeBudgetSeconds)
 {
-	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeShared<FRenderItemInfo>();
+	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeRenderItemInfo(TimeBudgetSeconds);
 	RenderItemInfo->RenderData = FUBFRenderDataContainer::GetFromData(RenderData, VariantID);
 	RenderItemInfo->Controller = Controller;
 	RenderItemInfo->InputMap = InputMap;
 	RenderItemInfo->OnComplete = OnComplete;
+	RenderItemInfo->UpdateTrackedMemory();
 	
 	RenderItemTreeInternal(RenderItemInfo);
 }
 
-TFuture<TMap<FString, UUBFBindingObject*>> UFutureverseUBFControllerSubsystem::GetTraitsForItem(
+TFuture<TSharedPtr<FBindingObjectLease>> UFutureverseUBFControllerSubsystem::GetTraitsForItem(
 	const FString& ParsingGraphId, const TWeakObjectPtr<UUBFRuntimeController>& Controller, const TMap<FString, UBF::FDynamicHandle>& ParsingInputs) const
 {
-	TSharedPtr<TPromise<TMap<FString, UUBFBindingObject*>>> Promise = MakeShareable(new TPromise<TMap<FString, UUBFBindingObject*>>());
-	TFuture<TMap<FString, UUBFBindingObject*>> Future = Promise->GetFuture();
+	TSharedPtr<TPromise<TSharedPtr<FBindingObjectLease>>> Promise = MakeShareable(new TPromise<TSharedPtr<FBindingObjectLease>>());
+	TFuture<TSharedPtr<FBindingObjectLease>> Future = Promise->GetFuture();
 	
 	if (!IsSubsystemValid() || !Controller.IsValid() || !IsValid(Controller.Get()) || !IsValid(Controller->RootComponent))
 	{
-		TMap<FString, UBF::FDynamicHandle> Traits;
-		Promise->SetValue(UBFUtils::AsBindingObjectMap(Traits));
+		Promise->SetValue(nullptr);
 		return Future;
 	}
 	
-	const auto OnParsingGraphComplete = [this, Promise](bool Success, const TSharedPtr<UBF::FExecutionSetResult>& Result)
+	const double StartTime = FUBFRuntimeStats::Get().BeginLoad(EUBFLoadStage::ParsingGraph);
+	const auto OnParsingGraphComplete = [this, Promise, StartTime](bool Success, const TSharedPtr<UBF::FExecutionSetResult>& Result)
 	{
+		FUBFContinuationScope ContinuationScope;
+		FUBFRuntimeStats::Get().EndLoad(EUBFLoadStage::ParsingGraph, StartTime, Success);
 		// inject outputs of the parsing graph as the inputs of the graph to execute
-		Promise->SetValue(UBFUtils::AsBindingObjectMap(Result->GetAllOutputs()));
+		Promise->SetValue(BindingObjectReferencer->Acquire(Result->GetAllOutputs()));
 	};
 
 	UBF::FExecutionInstanceData ParsingBlueprintData(ParsingGraphId);
@@ -151,13 +280,30 @@ TFuture<TMap<FString, UUBFBindingObject*>> UFutureverseUBFControllerSubsystem::G
 	return Future;
 }
 
+TFuture<FUBFTraitExtractionBatchResult> UFutureverseUBFControllerSubsystem::ExtractTraits(const TArray<FUBFTraitExtractionRequest>& Requests,
+	int32 MaxParallelism)
+{
+	if (!HeadlessRootComponent)
+	{
+		HeadlessRootComponent = NewObject<USceneComponent>(this, TEXT("UBFHeadlessRoot"), RF_Transient);
+	}
+
+	if (MaxParallelism <= 0)
+	{
+		MaxParallelism = GetDefault<UFutureverseUBFControllerSettings>()->GetMaxParallelTraitExtractions();
+	}
+	
+	TSharedPtr<FExtractTraitsAction> ExtractTraitsAction = MakeShared<FExtractTraitsAction>();
+	return ExtractTraitsAction->TryExtractTraits(this, HeadlessRootComponent, Requests, MaxParallelism);
+}
+
 bool UFutureverseUBFControllerSubsystem::IsSubsystemValid() const
 {
 	return IsValid(this) && bIsInitialized;
 }
 
 void UFutureverseUBFControllerSubsystem::ParseInputsThenExecute(TSharedPtr<FRenderItemInfo> RenderItemInfo,
-								const bool bShouldBuildContextTree) const
+								const bool bShouldBuildContextTree)
 {
 	// get metadata json string from original json
 	UE_LOG(LogFutureverseUBFController, VeryVerbose, TEXT("UFutureverseUBFControllerSubsystem::ParseInputs Parsing Metadata: %s"), *RenderItemInfo->RenderData->GetMetadataJson());
@@ -166,23 +312,413 @@ void UFutureverseUBFControllerSubsystem::ParseInputsThenExecute(TSharedPtr<FRend
 		{TEXT("metadata"), UBF::FDynamicHandle::String(RenderItemInfo->RenderData->GetMetadataJson()) }
 	};
 				
-	const auto ParsingGraphId = RenderItemInfo->AssetProfiles.Get(RenderItemInfo->RenderData->GetAssetID()).GetParsingBlueprintId(RenderItemInfo->RenderData->GetVariantID());
-	GetTraitsForItem(ParsingGraphId, RenderItemInfo->Controller, ParsingInputs).Next(
-		[this, RenderItemInfo, bShouldBuildContextTree]
-		(const TMap<FString, UUBFBindingObject*>& Traits)
+	const FString& ParsingGraphId = RenderItemInfo->GetAssetProfile(RenderItemInfo->RenderData->GetAssetID()).GetParsingBlueprintId(RenderItemInfo->RenderData->GetVariantID());
+
+	EnterRenderStage(*RenderItemInfo, EUBFRenderStage::ParsingGraph);
+	const bool bUseRestoredTraits = RenderItemInfo->bRestoredFromSession && RenderItemInfo->PreviousParsedTraits.IsValid()
+		&& RenderItemInfo->PreviousParsingBlueprintId == ParsingGraphId;
+	if (bUseRestoredTraits || !CanCoverRenderStage(*RenderItemInfo, EUBFRenderStage::ParsingGraph))
+	{
+		// the traits of the last render of the same item are as good as parsing again, without them only the caller's inputs are left
+		if (RenderItemInfo->PreviousParsedTraits.IsValid() && RenderItemInfo->PreviousParsingBlueprintId == ParsingGraphId)
+		{
+			RenderItemInfo->InputMap.Append(RenderItemInfo->PreviousParsedTraits->GetBindingObjects());
+			RenderItemInfo->BindingObjectLeases.Add(RenderItemInfo->PreviousParsedTraits);
+			RenderItemInfo->ParsingBlueprintId = ParsingGraphId;
+			RenderItemInfo->ParsedTraits = RenderItemInfo->PreviousParsedTraits;
+		}
+		else
+		{
+			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::ParseInputs budget left for %s can't cover parsing, rendering without traits"), *RenderItemInfo->RenderData->GetAssetID());
+		}
+		RenderItemInfo->UpdateTrackedMemory();
+		ExecuteSharedRender(RenderItemInfo, bShouldBuildContextTree);
+		return;
+	}
+	
+	LoadActionUtils::WithDeadline(GetTraitsForItem(ParsingGraphId, RenderItemInfo->Controller, ParsingInputs), RenderItemInfo->Deadline).Next(
+		[this, RenderItemInfo, bShouldBuildContextTree, ParsingGraphId]
+		(const TOptional<TSharedPtr<FBindingObjectLease>>& OptionalTraits)
 	{
+		FUBFContinuationScope ContinuationScope;
 		if (!IsSubsystemValid()) return;
-			
-		RenderItemInfo->InputMap.Append(Traits);
-		ExecuteGraph(RenderItemInfo, bShouldBuildContextTree);
+
+		if (!OptionalTraits.IsSet())
+		{
+			FailRenderDeadline(RenderItemInfo);
+			return;
+		}
+		
+		const TSharedPtr<FBindingObjectLease>& Traits = OptionalTraits.GetValue();
+		if (!Traits.IsValid())
+		{
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::ParseInputs %s lost its controller before parsing. Cannot render."), *RenderItemInfo->RenderData->GetAssetID());
+			HandOverSharedRender(RenderItemInfo, bShouldBuildContextTree);
+			return;
+		}
+		
+		RenderItemInfo->InputMap.Append(Traits->GetBindingObjects());
+		RenderItemInfo->BindingObjectLeases.Add(Traits);
+		RenderItemInfo->ParsingBlueprintId = ParsingGraphId;
+		RenderItemInfo->ParsedTraits = Traits;
+		ExecuteSharedRender(RenderItemInfo, bShouldBuildContextTree);
 	});
 }
 
-void UFutureverseUBFControllerSubsystem::ExecuteGraph(TSharedPtr<FRenderItemInfo> RenderItemInfo, const bool bShouldBuildContextTree) const
+FString UFutureverseUBFControllerSubsystem::DescribeSharedRender(const FRenderItemInfo& RenderItemInfo, const bool bShouldBuildContextTree)
+{
+	// every field is length prefixed so values containing separators can't make two different renders look the same
+	FString Description;
+	const auto AppendField = [&Description](const FString& Field)
+	{
+		Description.Appendf(TEXT("%d:"), Field.Len());
+		Description.Append(Field);
+	};
+	
+	AppendField(RenderItemInfo.RenderData->GetAssetID());
+	AppendField(RenderItemInfo.RenderData->GetProfileURI());
+	AppendField(RenderItemInfo.RenderData->GetVariantID());
+	AppendField(RenderItemInfo.RenderData->GetMetadataJson());
+	Description.AppendChar(bShouldBuildContextTree ? TEXT('1') : TEXT('0'));
+	
+	// inputs are described in key order so maps built in a different order still match
+	TArray<FString> InputKeys;
+	RenderItemInfo.InputMap.GetKeys(InputKeys);
+	InputKeys.Sort();
+	
+	for (const FString& InputKey : InputKeys)
+	{
+		const UUBFBindingObject* Input = RenderItemInfo.InputMap.FindRef(InputKey);
+		AppendField(InputKey);
+		AppendField(IsValid(Input) ? Input->ToString() : FString());
+	}
+
+	if (bShouldBuildContextTree)
+	{
+		for (const FUBFContextTreeData& ContextTreeData : RenderItemInfo.RenderData->GetContextTreeRef())
+		{
+			AppendField(ContextTreeData.RootNodeID);
+			AppendField(ContextTreeData.ProfileURI);
+			for (const FUBFContextTreeRelationshipData& Relationship : ContextTreeData.Relationships)
+			{
+				AppendField(Relationship.RelationshipID);
+				AppendField(Relationship.ChildAssetID);
+				AppendField(Relationship.ProfileURI);
+			}
+		}
+	}
+
+	return Description;
+}
+
+uint64 UFutureverseUBFControllerSubsystem::HashRenderData(const FUBFRenderData& RenderData)
+{
+	// length prefixed like DescribeSharedRender
+	FString Description;
+	const auto AppendField = [&Description](const FString& Field)
+	{
+		Description.Appendf(TEXT("%d:"), Field.Len());
+		Description.Append(Field);
+	};
+
+	AppendField(RenderData.AssetID);
+	AppendField(RenderData.ProfileURI);
+	AppendField(RenderData.MetadataJson);
+	for (const FUBFContextTreeData& ContextTreeData : RenderData.ContextTree)
+	{
+		AppendField(ContextTreeData.RootNodeID);
+		AppendField(ContextTreeData.ProfileURI);
+		for (const FUBFContextTreeRelationshipData& Relationship : ContextTreeData.Relationships)
+		{
+			AppendField(Relationship.RelationshipID);
+			AppendField(Relationship.ChildAssetID);
+			AppendField(Relationship.ProfileURI);
+		}
+	}
+
+	const FTCHARToUTF8 DescriptionUtf8(*Description);
+	return CityHash64(DescriptionUtf8.Get(), DescriptionUtf8.Length());
+}
+
+bool UFutureverseUBFControllerSubsystem::TryJoinSharedRender(const TSharedPtr<FRenderItemInfo>& RenderItemInfo, const bool bShouldBuildContextTree)
+{
+	// a render with a budget may degrade or fail on its own, so it neither waits on nor holds up other renders.
+	// A restored render is checked against the network afterwards, which only applies to its own controller
+	if (!GetDefault<UFutureverseUBFControllerSettings>()->GetShareIdenticalRenders() || RenderItemInfo->Deadline.IsSet()
+		|| RenderItemInfo->bRestoredFromSession)
+		return false;
+
+	FString Description = DescribeSharedRender(*RenderItemInfo, bShouldBuildContextTree);
+	const FTCHARToUTF8 DescriptionUtf8(*Description);
+	FString SharedRenderKey = FString::Printf(TEXT("%016llx"), CityHash64(DescriptionUtf8.Get(), DescriptionUtf8.Length()));
+	
+	if (FSharedRender* SharedRender = SharedRenders.Find(SharedRenderKey))
+	{
+		// the key is only a hash, a render whose inputs differ from the in-flight one renders on its own
+		if (!SharedRender->Description.Equals(Description, ESearchCase::CaseSensitive))
+			return false;
+		
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::TryJoinSharedRender %s joins an identical in-flight render"), *RenderItemInfo->RenderData->GetAssetID());
+		SharedRender->Followers.Add(RenderItemInfo);
+		return true;
+	}
+
+	SharedRenders.Add(SharedRenderKey).Description = MoveTemp(Description);
+	RenderItemInfo->SharedRenderKey = MoveTemp(SharedRenderKey);
+	SharedRenderCounters.Misses++;
+	return false;
+}
+
+void UFutureverseUBFControllerSubsystem::ExecuteSharedRender(TSharedPtr<FRenderItemInfo> RenderItemInfo, const bool bShouldBuildContextTree)
+{
+	TArray<TSharedPtr<FRenderItemInfo>> Followers;
+	FSharedRender SharedRender;
+	if (!RenderItemInfo->SharedRenderKey.IsEmpty() && SharedRenders.RemoveAndCopyValue(RenderItemInfo->SharedRenderKey, SharedRender))
+	{
+		Followers = MoveTemp(SharedRender.Followers);
+	}
+	RenderItemInfo->SharedRenderKey.Reset();
+
+	// every controller still executes on its own root component, only resolution and parsing are shared
+	for (const TSharedPtr<FRenderItemInfo>& Follower : Followers)
+	{
+		Follower->AssetProfiles = RenderItemInfo->AssetProfiles;
+		Follower->InputMap = RenderItemInfo->InputMap;
+		Follower->BindingObjectLeases = RenderItemInfo->BindingObjectLeases;
+		Follower->ParsingBlueprintId = RenderItemInfo->ParsingBlueprintId;
+		Follower->ParsedTraits = RenderItemInfo->ParsedTraits;
+		Follower->UpdateTrackedMemory();
+		
+		SharedRenderCounters.Hits++;
+		INC_DWORD_STAT(STAT_UBFSharedRenderExecutions);
+		ExecuteGraph(Follower, bShouldBuildContextTree);
+	}
+	
+	ExecuteGraph(RenderItemInfo, bShouldBuildContextTree);
+}
+
+void UFutureverseUBFControllerSubsystem::FailSharedRender(const TSharedPtr<FRenderItemInfo>& RenderItemInfo)
+{
+	TArray<TSharedPtr<FRenderItemInfo>> Followers;
+	FSharedRender SharedRender;
+	if (!RenderItemInfo->SharedRenderKey.IsEmpty() && SharedRenders.RemoveAndCopyValue(RenderItemInfo->SharedRenderKey, SharedRender))
+	{
+		Followers = MoveTemp(SharedRender.Followers);
+	}
+	RenderItemInfo->SharedRenderKey.Reset();
+	
+	for (const TSharedPtr<FRenderItemInfo>& Follower : Followers)
+	{
+		Follower->OnComplete.ExecuteIfBound(false, FUBFExecutionReport::Failure());
+	}
+	RenderItemInfo->OnComplete.ExecuteIfBound(false, FUBFExecutionReport::Failure());
+	CSV_CUSTOM_STAT(FutureverseUBFController, RendersFailed, Followers.Num() + 1, ECsvCustomStatOp::Accumulate);
+}
+
+void UFutureverseUBFControllerSubsystem::HandOverSharedRender(const TSharedPtr<FRenderItemInfo>& RenderItemInfo, const bool bShouldBuildContextTree)
+{
+	const FString SharedRenderKey = RenderItemInfo->SharedRenderKey;
+	FSharedRender SharedRender;
+	if (!SharedRenderKey.IsEmpty())
+	{
+		SharedRenders.RemoveAndCopyValue(SharedRenderKey, SharedRender);
+	}
+	RenderItemInfo->SharedRenderKey.Reset();
+	RenderItemInfo->OnComplete.ExecuteIfBound(false, FUBFExecutionReport::Failure());
+	int32 NumFailed = 1;
+
+	// the first follower whose controller is still alive parses for the rest instead
+	TSharedPtr<FRenderItemInfo> NewLeader;
+	while (!SharedRender.Followers.IsEmpty())
+	{
+		TSharedPtr<FRenderItemInfo> Follower = SharedRender.Followers[0];
+		SharedRender.Followers.RemoveAt(0);
+		if (Follower->Controller.IsValid() && IsValid(Follower->Controller->RootComponent))
+		{
+			NewLeader = MoveTemp(Follower);
+			break;
+		}
+		
+		Follower->OnComplete.ExecuteIfBound(false, FUBFExecutionReport::Failure());
+		NumFailed++;
+	}
+	CSV_CUSTOM_STAT(FutureverseUBFController, RendersFailed, NumFailed, ECsvCustomStatOp::Accumulate);
+	
+	if (!NewLeader.IsValid())
+		return;
+
+	UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::HandOverSharedRender %s is parsed by the next render waiting on it"), *NewLeader->RenderData->GetAssetID());
+	NewLeader->AssetProfiles = RenderItemInfo->AssetProfiles;
+	NewLeader->UpdateTrackedMemory();
+	if (!SharedRender.Followers.IsEmpty())
+	{
+		NewLeader->SharedRenderKey = SharedRenderKey;
+		SharedRenders.Add(SharedRenderKey, MoveTemp(SharedRender));
+	}
+	ParseInputsThenExecute(NewLeader, bShouldBuildContextTree);
+}
+
+bool UFutureverseUBFControllerSubsystem::GetLastDeadlineReport(UUBFRuntimeController* Controller, FUBFRenderDeadlineReport& OutReport) const
+{
+	const FUBFRenderDeadlineReport* Report = DeadlineReports.Find(Controller);
+	if (!Report)
+		return false;
+
+	OutReport = *Report;
+	return true;
+}
+
+void UFutureverseUBFControllerSubsystem::EnterRenderStage(FRenderItemInfo& RenderItemInfo, EUBFRenderStage Stage)
+{
+	if (!RenderItemInfo.Deadline.IsSet())
+		return;
+
+	const double Now = FPlatformTime::Seconds();
+	if (RenderItemInfo.Stage != EUBFRenderStage::None)
+	{
+		const float Seconds = static_cast<float>(Now - RenderItemInfo.StageStartTime);
+		RenderItemInfo.DeadlineReport.StageSeconds.FindOrAdd(RenderItemInfo.Stage) += Seconds;
+		
+		float* Estimate = RenderStageEstimates.Find(RenderItemInfo.Stage);
+		if (Estimate)
+		{
+			*Estimate = FMath::Lerp(*Estimate, Seconds, 0.2f);
+		}
+		else
+		{
+			RenderStageEstimates.Add(RenderItemInfo.Stage, Seconds);
+		}
+	}
+	
+	RenderItemInfo.Stage = Stage;
+	RenderItemInfo.StageStartTime = Now;
+}
+
+bool UFutureverseUBFControllerSubsystem::CanCoverRenderStage(FRenderItemInfo& RenderItemInfo, EUBFRenderStage Stage)
+{
+	if (!RenderItemInfo.Deadline.IsSet())
+		return true;
+	
+	// a stage no render with a budget has finished yet is assumed to fit
+	const float* Estimate = RenderStageEstimates.Find(Stage);
+	if (!RenderItemInfo.Deadline.HasExpired() && (!Estimate || RenderItemInfo.Deadline.CanCover(*Estimate)))
+		return true;
+
+	MarkRenderStageDegraded(RenderItemInfo.DeadlineReport, Stage);
+	return false;
+}
+
+void UFutureverseUBFControllerSubsystem::PrepareDeadlineFallbacks(FRenderItemInfo& RenderItemInfo, TArray<FFutureverseAssetLoadData>& LoadDatas)
+{
+	if (!RenderItemInfo.Deadline.IsSet())
+		return;
+
+	PruneControllerRenderStates();
+	const FControllerRenderState* RenderState = ControllerRenderStates.Find(RenderItemInfo.Controller);
+	const TSharedPtr<FRenderItemInfo> PreviousRenderItemInfo = RenderState ? RenderState->RenderItemInfo : nullptr;
+	const bool bSameAsset = PreviousRenderItemInfo.IsValid() && PreviousRenderItemInfo->RenderData.IsValid()
+		&& PreviousRenderItemInfo->RenderData->GetAssetID() == RenderItemInfo.RenderData->GetAssetID();
+	if (bSameAsset && PreviousRenderItemInfo->ParsedTraits.IsValid()
+		&& PreviousRenderItemInfo->RenderData->GetMetadataJson() == RenderItemInfo.RenderData->GetMetadataJson())
+	{
+		RenderItemInfo.PreviousParsingBlueprintId = PreviousRenderItemInfo->ParsingBlueprintId;
+		RenderItemInfo.PreviousParsedTraits = PreviousRenderItemInfo->ParsedTraits;
+	}
+
+	const auto AreCatalogsLoaded = [this, &LoadDatas](const FString& VariantID)
+	{
+		for (FFutureverseAssetLoadData LoadData : LoadDatas)
+		{
+			LoadData.VariantID = VariantID;
+			if (!IsCatalogLoaded(LoadData))
+				return false;
+		}
+		return true;
+	};
+
+	const FString VariantID = RenderItemInfo.RenderData->GetVariantID();
+	if (AreCatalogsLoaded(VariantID))
+		return;
+
+	// profiles are usually cached by the time catalogs are, so both estimates together are the worst case
+	const float* ProfileEstimate = RenderStageEstimates.Find(EUBFRenderStage::AssetProfile);
+	const float* CatalogEstimate = RenderStageEstimates.Find(EUBFRenderStage::Catalog);
+	if (!CatalogEstimate || RenderItemInfo.Deadline.CanCover(*CatalogEstimate + (ProfileEstimate ? *ProfileEstimate : 0.f)))
+		return;
+
+	TArray<FString, TInlineAllocator<2>> FallbackVariantIDs;
+	if (bSameAsset)
+	{
+		FallbackVariantIDs.Add(PreviousRenderItemInfo->RenderData->GetVariantID());
+	}
+	FallbackVariantIDs.AddUnique(GetDefault<UFutureverseUBFControllerSettings>()->GetDeadlineFallbackVariantID());
+
+	for (const FString& FallbackVariantID : FallbackVariantIDs)
+	{
+		if (FallbackVariantID.IsEmpty() || FallbackVariantID == VariantID || !AreCatalogsLoaded(FallbackVariantID))
+			continue;
+
+		UE_LOG(LogFutureverseUBFController, Log, TEXT("UFutureverseUBFControllerSubsystem::PrepareDeadlineFallbacks %s renders variant %s instead of %s, the budget left can't cover loading its catalogs"),
+			*RenderItemInfo.RenderData->GetAssetID(), *FallbackVariantID, *VariantID);
+		
+		RenderItemInfo.RenderData = FUBFRenderDataContainer::GetFromData(RenderItemInfo.RenderData->GetRenderData(), FallbackVariantID);
+		for (FFutureverseAssetLoadData& LoadData : LoadDatas)
+		{
+			LoadData.VariantID = FallbackVariantID;
+		}
+		RenderItemInfo.DeadlineReport.FallbackVariantID = FallbackVariantID;
+		MarkRenderStageDegraded(RenderItemInfo.DeadlineReport, EUBFRenderStage::Catalog);
+		RenderItemInfo.UpdateTrackedMemory();
+		return;
+	}
+}
+
+void UFutureverseUBFControllerSubsystem::FinishDeadlineReport(FRenderItemInfo& RenderItemInfo)
+{
+	FUBFRenderDeadlineReport& Report = RenderItemInfo.DeadlineReport;
+	if (!Report.bExceeded)
+	{
+		EnterRenderStage(RenderItemInfo, EUBFRenderStage::None);
+	}
+	else if (RenderItemInfo.Stage != EUBFRenderStage::None)
+	{
+		// a stage cut short by the deadline would drag its estimate down
+		Report.StageSeconds.FindOrAdd(RenderItemInfo.Stage) += static_cast<float>(FPlatformTime::Seconds() - RenderItemInfo.StageStartTime);
+		RenderItemInfo.Stage = EUBFRenderStage::None;
+	}
+	
+	Report.ElapsedSeconds = static_cast<float>(FPlatformTime::Seconds() - (RenderItemInfo.Deadline.ExpiresAt - RenderItemInfo.Deadline.BudgetSeconds));
+	if (RenderItemInfo.Controller.IsValid())
+	{
+		DeadlineReports.Add(RenderItemInfo.Controller, Report);
+	}
+}
+
+void UFutureverseUBFControllerSubsystem::FailRenderDeadline(const TSharedPtr<FRenderItemInfo>& RenderItemInfo)
+{
+	FUBFRenderDeadlineReport& Report = RenderItemInfo->DeadlineReport;
+	Report.bExceeded = true;
+	Report.ExhaustedStage = RenderItemInfo->Stage;
+	FinishDeadlineReport(*RenderItemInfo);
+
+	UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::FailRenderDeadline %s ran out of its %.2f s budget during %s"),
+		RenderItemInfo->RenderData.IsValid() ? *RenderItemInfo->RenderData->GetAssetID() : TEXT("item"), Report.BudgetSeconds,
+		*UEnum::GetValueAsString(Report.ExhaustedStage));
+	FailSharedRender(RenderItemInfo);
+}
+
+void UFutureverseUBFControllerSubsystem::ExecuteGraph(TSharedPtr<FRenderItemInfo> RenderItemInfo, const bool bShouldBuildContextTree)
 {
+	EnterRenderStage(*RenderItemInfo, EUBFRenderStage::RenderGraph);
+	if (RenderItemInfo->Deadline.HasExpired())
+	{
+		FailRenderDeadline(RenderItemInfo);
+		return;
+	}
+	
 	FBlueprintExecutionData ExecutionData;
 
-	FString RenderBlueprintId = RenderItemInfo->AssetProfiles.Get(RenderItemInfo->RenderData->GetAssetID()).GetRenderBlueprintId(RenderItemInfo->RenderData->GetVariantID());
+	const FString& RenderBlueprintId = RenderItemInfo->GetAssetProfile(RenderItemInfo->RenderData->GetAssetID()).GetRenderBlueprintId(RenderItemInfo->RenderData->GetVariantID());
 
 	if (bShouldBuildContextTree)
 	{
@@ -211,6 +747,7 @@ void UFutureverseUBFControllerSubsystem::ExecuteGraph(TSharedPtr<FRenderItemInfo
 	if (InstanceID.IsEmpty())
 	{
 		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::ExecuteGraph no InstanceID found, cannot Execute"));
+		FailSharedRender(RenderItemInfo);
 		return;
 	}
 					
@@ -219,25 +756,59 @@ void UFutureverseUBFControllerSubsystem::ExecuteGraph(TSharedPtr<FRenderItemInfo
 		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::ExecuteGraph ResolvedInput %s"), *Input.Value->ToString());
 	}
 	
-	if (!RenderItemInfo->Controller.IsValid() || !IsValid(RenderItemInfo->Controller.Get()) && !IsValid(RenderItemInfo->Controller->RootComponent))
+	if (!RenderItemInfo->Controller.IsValid() || !IsValid(RenderItemInfo->Controller.Get()) || !IsValid(RenderItemInfo->Controller->RootComponent))
 	{
 		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::ExecuteGraph null Controller or null root component provided. Cannot render."));
+		FailSharedRender(RenderItemInfo);
 		return;
 	}
 	
+	if (RenderItemInfo->bDeferRenderState)
+	{
+		CommitRenderState(RenderItemInfo);
+	}
+	RenderItemInfo->bExecuted = true;
+	if (RenderItemInfo->Deadline.IsSet())
+	{
+		FinishDeadlineReport(*RenderItemInfo);
+	}
+	RecordSessionRender(*RenderItemInfo);
+	FUBFRuntimeStats::Get().AddLatency(EUBFLoadStage::Render, FPlatformTime::Seconds() - RenderItemInfo->RequestTime);
+	CSV_CUSTOM_STAT(FutureverseUBFController, RendersExecuted, 1, ECsvCustomStatOp::Accumulate);
 	RenderItemInfo->Controller->ExecuteBlueprint(InstanceID, ExecutionData, RenderItemInfo->OnComplete);
+
+	if (RenderItemInfo->bRestoredFromSession)
+	{
+		RevalidateSessionRender(RenderItemInfo);
+	}
 }
 
 TFuture<FLoadLinkedAssetProfilesResult> UFutureverseUBFControllerSubsystem::EnsureAssetDatasLoaded(
-	const TArray<FFutureverseAssetLoadData>& LoadDatas)
+	const TArray<FFutureverseAssetLoadData>& LoadDatas, TFunction<void()> OnProfilesLoaded)
 {
 	TSharedPtr<TPromise<FLoadLinkedAssetProfilesResult>> Promise = MakeShared<TPromise<FLoadLinkedAssetProfilesResult>>();
 	
 	TArray<TFuture<FLoadAssetProfileResult>> Futures;
+
+	TFunction<void()> OnProfileLoaded;
+	if (OnProfilesLoaded)
+	{
+		if (LoadDatas.IsEmpty())
+		{
+			OnProfilesLoaded();
+		}
+		
+		const TSharedRef<int32> NumPendingProfiles = MakeShared<int32>(LoadDatas.Num());
+		OnProfileLoaded = [NumPendingProfiles, OnProfilesLoaded]()
+		{
+			if (--(*NumPendingProfiles) == 0)
+				OnProfilesLoaded();
+		};
+	}
 	
 	for (const auto& LoadData : LoadDatas)
 	{
-		Futures.Add(EnsureAssetDataLoaded(LoadData));
+		Futures.Add(EnsureAssetDataLoaded(LoadData, OnProfileLoaded));
 	}
 
 	LoadActionUtils::WhenAll(Futures).Next([Promise](const TArray<FLoadAssetProfileResult>& Results)
@@ -248,7 +819,8 @@ TFuture<FLoadLinkedAssetProfilesResult> UFutureverseUBFControllerSubsystem::Ensu
 		for (const auto& Result : Results)
 		{
 			OutResults.bSuccess &= Result.bSuccess;
-			OutResults.Value.Add(Result.Value.GetId(), Result.Value);
+			if (Result.Value.IsValid())
+				OutResults.Value.Add(Result.Value->GetId(), Result.Value);
 		}
 
 		Promise->SetValue(OutResults);
@@ -257,24 +829,32 @@ TFuture<FLoadLinkedAssetProfilesResult> UFutureverseUBFControllerSubsystem::Ensu
 	return Promise->GetFuture();
 }
 
-TFuture<FLoadAssetProfileResult> UFutureverseUBFControllerSubsystem::EnsureAssetDataLoaded(const FFutureverseAssetLoadData& LoadData)
+TFuture<FLoadAssetProfileResult> UFutureverseUBFControllerSubsystem::EnsureAssetDataLoaded(const FFutureverseAssetLoadData& LoadData,
+	TFunction<void()> OnProfileLoaded)
 {
 	TSharedPtr<TPromise<FLoadAssetProfileResult>> Promise = MakeShareable(new TPromise<FLoadAssetProfileResult>());
 	TFuture<FLoadAssetProfileResult> Future = Promise->GetFuture();
 	
-	EnsureAssetProfilesLoaded(LoadData).Next([LoadData, this, Promise]
+	EnsureAssetProfilesLoaded(LoadData).Next([LoadData, this, Promise, OnProfileLoaded]
 		(const FLoadAssetProfileResult& Result)
 	{
-		if (!IsSubsystemValid() || !Result.bSuccess)
+		FUBFContinuationScope ContinuationScope;
+		if (OnProfileLoaded && IsSubsystemValid())
+		{
+			OnProfileLoaded();
+		}
+		
+		if (!IsSubsystemValid() || !Result.bSuccess || LoadData.Deadline.HasExpired())
 		{
 			FLoadAssetProfileResult OutResult;
 			OutResult.SetFailure();
 			Promise->SetValue(OutResult);
 			return;
 		}
-		FAssetProfile AssetProfile = Result.Value;
+		const FAssetProfilePtr AssetProfile = Result.Value;
 		EnsureCatalogsLoaded(LoadData, AssetProfile).Next([Promise, AssetProfile, this](bool bResult)
 		{
+			FUBFContinuationScope ContinuationScope;
 			FLoadAssetProfileResult OutResult;
 			if (!IsSubsystemValid() || !bResult)
 			{
@@ -313,6 +893,7 @@ TFuture<FLoadAssetProfileResult> UFutureverseUBFControllerSubsystem::EnsureAsset
 	AssetProfileRegistry->GetAssetProfile(LoadData).Next([this, Promise]
 		(const FLoadAssetProfileResult& AssetProfileResult)
 	{
+		FUBFContinuationScope ContinuationScope;
 		FLoadAssetProfileResult OutResult;
 		if (!IsSubsystemValid())
 		{
@@ -337,22 +918,32 @@ TFuture<FLoadAssetProfileResult> UFutureverseUBFControllerSubsystem::EnsureAsset
 }
 
 TFuture<bool> UFutureverseUBFControllerSubsystem::EnsureCatalogsLoaded(const FFutureverseAssetLoadData& LoadData,
-	const FAssetProfile& AssetProfile) 
+	const FAssetProfilePtr& AssetProfile) 
 {
 	TSharedPtr<TPromise<bool>> Promise = MakeShareable(new TPromise<bool>());
 	TFuture<bool> Future = Promise->GetFuture();
 
 	if (IsCatalogLoaded(LoadData))
 	{
+		CatalogCacheCounters.Hits++;
+		INC_DWORD_STAT(STAT_UBFCatalogCacheHits);
+		
 		Promise->SetValue(true);
 		return Future;
 	}
 
+	CatalogCacheCounters.Misses++;
+	INC_DWORD_STAT(STAT_UBFCatalogCacheMisses);
+
 	TSharedPtr<FLoadAssetCatalogAction> LoadAssetCatalogAction = MakeShared<FLoadAssetCatalogAction>();
+	const double StartTime = FUBFRuntimeStats::Get().BeginLoad(EUBFLoadStage::Catalog);
 
-	LoadAssetCatalogAction->TryLoadAssetCatalog(AssetProfile, LoadData, MemoryCacheLoader)
-	.Next([this, Promise, LoadAssetCatalogAction](bool bSuccess)
+	LoadAssetCatalogAction->TryLoadAssetCatalog(AssetProfile, LoadData, MemoryCacheLoader, CatalogStore)
+	.Next([this, Promise, LoadAssetCatalogAction, AssetProfile, StartTime](bool bSuccess)
 	{
+		FUBFContinuationScope ContinuationScope;
+		FUBFRuntimeStats::Get().EndLoad(EUBFLoadStage::Catalog, StartTime, bSuccess);
+		
 		if (!IsSubsystemValid())
 		{
 			Promise->SetValue(false);
@@ -361,9 +952,13 @@ TFuture<bool> UFutureverseUBFControllerSubsystem::EnsureCatalogsLoaded(const FFu
 		
 		if (bSuccess)
 		{
-			UGlobalArtifactProviderSubsystem::Get(this)->RegisterCatalogs(LoadAssetCatalogAction->RenderCatalogMap);
-			UGlobalArtifactProviderSubsystem::Get(this)->RegisterCatalogs(LoadAssetCatalogAction->ParsingCatalogMap);
-			LoadedVariantCatalogs.Add(LoadAssetCatalogAction->LoadData.GetCombinedVariantID());
+			TArray<TSharedPtr<const FSharedCatalog, ESPMode::ThreadSafe>> Catalogs;
+			if (LoadAssetCatalogAction->RenderCatalog.IsValid())
+				Catalogs.Add(LoadAssetCatalogAction->RenderCatalog);
+			if (LoadAssetCatalogAction->ParsingCatalog.IsValid())
+				Catalogs.Add(LoadAssetCatalogAction->ParsingCatalog);
+			
+			AddLoadedVariantCatalog(LoadAssetCatalogAction->LoadData, AssetProfile, Catalogs);
 			
 			Promise->SetValue(true);
 		}
@@ -381,9 +976,831 @@ bool UFutureverseUBFControllerSubsystem::IsCatalogLoaded(const FFutureverseAsset
 	return LoadedVariantCatalogs.Contains(LoadData.GetCombinedVariantID());
 }
 
-void UFutureverseUBFControllerSubsystem::ExecuteItemGraph(TSharedPtr<FRenderItemInfo> RenderItemInfo, const bool bShouldBuildContextTree) const
+void UFutureverseUBFControllerSubsystem::AddLoadedVariantCatalog(const FFutureverseAssetLoadData& LoadData, const FAssetProfilePtr& AssetProfile,
+	const TArray<TSharedPtr<const FSharedCatalog, ESPMode::ThreadSafe>>& Catalogs)
+{
+	const FString CombinedVariantID = LoadData.GetCombinedVariantID();
+	
+	FLoadedVariantCatalog LoadedVariantCatalog;
+	LoadedVariantCatalog.CollectionId = LoadData.GetCollectionID();
+	LoadedVariantCatalog.AssetProfileId = AssetProfile.IsValid() ? AssetProfile->GetId() : FString();
+	
+	// retain before releasing a previous load of this variant so catalogs it keeps aren't registered again
+	for (const auto& Catalog : Catalogs)
+	{
+		RetainSharedCatalog(Catalog, LoadedVariantCatalog.CollectionId);
+		LoadedVariantCatalog.CatalogHashes.Add(Catalog->ContentHash);
+	}
+	
+	RemoveLoadedVariantCatalog(CombinedVariantID);
+	
+	INC_DWORD_STAT(STAT_UBFVariantCatalogsCount);
+	
+	LoadedVariantCatalogs.Add(CombinedVariantID, MoveTemp(LoadedVariantCatalog));
+}
+
+void UFutureverseUBFControllerSubsystem::RemoveLoadedVariantCatalog(const FString& CombinedVariantID)
+{
+	FLoadedVariantCatalog LoadedVariantCatalog;
+	if (!LoadedVariantCatalogs.RemoveAndCopyValue(CombinedVariantID, LoadedVariantCatalog))
+		return;
+	
+	DEC_DWORD_STAT(STAT_UBFVariantCatalogsCount);
+
+	for (const uint64 ContentHash : LoadedVariantCatalog.CatalogHashes)
+	{
+		ReleaseSharedCatalog(ContentHash);
+	}
+}
+
+void UFutureverseUBFControllerSubsystem::HandleAssetProfilesEvicted(const TArray<FAssetProfilePtr>& EvictedProfiles)
+{
+	TSet<FString> EvictedProfileIds;
+	for (const FAssetProfilePtr& EvictedProfile : EvictedProfiles)
+	{
+		EvictedProfileIds.Add(EvictedProfile->GetId());
+	}
+	
+	TArray<FString> ReleasedVariantIDs;
+	for (const auto& LoadedVariantCatalog : LoadedVariantCatalogs)
+	{
+		if (EvictedProfileIds.Contains(LoadedVariantCatalog.Value.AssetProfileId))
+			ReleasedVariantIDs.Add(LoadedVariantCatalog.Key);
+	}
+
+	for (const FString& CombinedVariantID : ReleasedVariantIDs)
+	{
+		RemoveLoadedVariantCatalog(CombinedVariantID);
+	}
+	
+	if (ReleasedVariantIDs.Num() > 0)
+	{
+		CatalogCacheCounters.Evictions += ReleasedVariantIDs.Num();
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::HandleAssetProfilesEvicted released the catalogs of %d variants, %d shared catalogs remaining"),
+			ReleasedVariantIDs.Num(), RegisteredCatalogs.Num());
+	}
+}
+
+void UFutureverseUBFControllerSubsystem::RetainSharedCatalog(const TSharedPtr<const FSharedCatalog, ESPMode::ThreadSafe>& Catalog,
+	const FString& CollectionId)
+{
+	FRegisteredCatalog& RegisteredCatalog = RegisteredCatalogs.FindOrAdd(Catalog->ContentHash);
+	if (RegisteredCatalog.NumVariants++ > 0)
+		return;
+	
+	LLM_SCOPE_BYTAG(FutureverseUBFController_Catalogs);
+	
+	RegisteredCatalog.Catalog = Catalog;
+	RegisteredCatalog.CollectionId = CollectionId;
+	RegisteredCatalogBytes += Catalog->ApproximateBytes;
+	
+	UGlobalArtifactProviderSubsystem::Get(this)->RegisterCatalogs(Catalog->Elements);
+	
+	INC_DWORD_STAT(STAT_UBFSharedCatalogsCount);
+	INC_DWORD_STAT_BY(STAT_UBFCatalogElementsCount, Catalog->Elements.Num());
+	INC_MEMORY_STAT_BY(STAT_UBFCatalogsMemory, Catalog->ApproximateBytes);
+}
+
+void UFutureverseUBFControllerSubsystem::ReleaseSharedCatalog(const uint64 ContentHash)
+{
+	FRegisteredCatalog* RegisteredCatalog = RegisteredCatalogs.Find(ContentHash);
+	if (!RegisteredCatalog || --RegisteredCatalog->NumVariants > 0)
+		return;
+
+	const auto Catalog = RegisteredCatalog->Catalog;
+	RegisteredCatalogs.Remove(ContentHash);
+	RegisteredCatalogBytes -= Catalog->ApproximateBytes;
+	
+	DEC_DWORD_STAT(STAT_UBFSharedCatalogsCount);
+	DEC_DWORD_STAT_BY(STAT_UBFCatalogElementsCount, Catalog->Elements.Num());
+	DEC_MEMORY_STAT_BY(STAT_UBFCatalogsMemory, Catalog->ApproximateBytes);
+}
+
+void UFutureverseUBFControllerSubsystem::PinRenderedAssets(const TWeakObjectPtr<UUBFRuntimeController>& Controller,
+	const TArray<FFutureverseAssetLoadData>& LoadDatas)
+{
+	if (!Controller.IsValid())
+		return;
+	
+	PruneControllerRenderStates();
+	
+	FControllerRenderState RenderState;
+	for (const FFutureverseAssetLoadData& LoadData : LoadDatas)
+	{
+		RenderState.AssetIds.Add(LoadData.AssetID);
+	}
+
+	UAssetProfileRegistrySubsystem* AssetProfileRegistry = UAssetProfileRegistrySubsystem::Get(GetWorld());
+	for (const FString& AssetId : RenderState.AssetIds)
+	{
+		if (AssetProfileRegistry)
+			AssetProfileRegistry->PinAssetProfile(AssetId);
+	}
+
+	// pin the new assets before releasing the previous ones so assets shared between both renders stay pinned
+	FControllerRenderState PreviousRenderState;
+	if (ControllerRenderStates.RemoveAndCopyValue(Controller, PreviousRenderState))
+	{
+		ReleaseRenderState(PreviousRenderState);
+	}
+	
+	ControllerRenderStates.Add(Controller, MoveTemp(RenderState));
+}
+
+void UFutureverseUBFControllerSubsystem::ReleaseRenderState(const FControllerRenderState& RenderState)
+{
+	UAssetProfileRegistrySubsystem* AssetProfileRegistry = UAssetProfileRegistrySubsystem::Get(GetWorld());
+	for (const FString& AssetId : RenderState.AssetIds)
+	{
+		if (AssetProfileRegistry)
+			AssetProfileRegistry->UnpinAssetProfile(AssetId);
+	}
+}
+
+void UFutureverseUBFControllerSubsystem::PruneControllerRenderStates()
+{
+	for (auto It = ControllerRenderStates.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			ReleaseRenderState(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+	
+	for (auto It = DeadlineReports.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+			It.RemoveCurrent();
+	}
+}
+
+void UFutureverseUBFControllerSubsystem::SetRenderedTreeRelationship(UUBFRuntimeController* Controller, const FString& ParentAssetID,
+	const FUBFContextTreeRelationshipData& Relationship, const FOnComplete& OnComplete)
+{
+	const auto EditContextTree = [&ParentAssetID, &Relationship](TArray<FUBFContextTreeData>& ContextTree)
+	{
+		FUBFContextTreeData* ParentNode = ContextTree.FindByPredicate([&ParentAssetID](const FUBFContextTreeData& ContextTreeData)
+		{
+			return ContextTreeData.RootNodeID == ParentAssetID;
+		});
+		if (!ParentNode)
+		{
+			ParentNode = &ContextTree.Emplace_GetRef();
+			ParentNode->RootNodeID = ParentAssetID;
+		}
+
+		FUBFContextTreeRelationshipData* ExistingRelationship = ParentNode->Relationships.FindByPredicate(
+			[&Relationship](const FUBFContextTreeRelationshipData& RelationshipData) { return RelationshipData.RelationshipID == Relationship.RelationshipID; });
+		if (ExistingRelationship)
+		{
+			*ExistingRelationship = Relationship;
+		}
+		else
+		{
+			ParentNode->Relationships.Add(Relationship);
+		}
+		return true;
+	};
+	
+	UpdateRenderedTree(Controller, EditContextTree, {FFutureverseAssetLoadData(Relationship.ChildAssetID, Relationship.ProfileURI)}, OnComplete);
+}
+
+void UFutureverseUBFControllerSubsystem::RemoveRenderedTreeRelationship(UUBFRuntimeController* Controller, const FString& ParentAssetID,
+	const FString& RelationshipID, const FOnComplete& OnComplete)
 {
-	const auto& AssetProfile = RenderItemInfo->AssetProfiles.Get(RenderItemInfo->RenderData->GetAssetID());
+	const auto EditContextTree = [&ParentAssetID, &RelationshipID](TArray<FUBFContextTreeData>& ContextTree)
+	{
+		FUBFContextTreeData* ParentNode = ContextTree.FindByPredicate([&ParentAssetID](const FUBFContextTreeData& ContextTreeData)
+		{
+			return ContextTreeData.RootNodeID == ParentAssetID;
+		});
+		
+		const FUBFContextTreeRelationshipData* Relationship = ParentNode ? ParentNode->Relationships.FindByPredicate(
+			[&RelationshipID](const FUBFContextTreeRelationshipData& RelationshipData) { return RelationshipData.RelationshipID == RelationshipID; }) : nullptr;
+		if (!Relationship)
+			return false;
+
+		const FString ChildAssetID = Relationship->ChildAssetID;
+		ParentNode->Relationships.RemoveAll([&RelationshipID](const FUBFContextTreeRelationshipData& RelationshipData)
+		{
+			return RelationshipData.RelationshipID == RelationshipID;
+		});
+
+		// drop the child's own node unless another relationship still attaches it
+		const bool bChildStillAttached = ContextTree.ContainsByPredicate([&ChildAssetID](const FUBFContextTreeData& ContextTreeData)
+		{
+			return ContextTreeData.Relationships.ContainsByPredicate([&ChildAssetID](const FUBFContextTreeRelationshipData& RelationshipData)
+			{
+				return RelationshipData.ChildAssetID == ChildAssetID;
+			});
+		});
+		if (!bChildStillAttached)
+		{
+			ContextTree.RemoveAll([&ChildAssetID](const FUBFContextTreeData& ContextTreeData) { return ContextTreeData.RootNodeID == ChildAssetID; });
+		}
+		return true;
+	};
+	
+	UpdateRenderedTree(Controller, EditContextTree, {}, OnComplete);
+}
+
+void UFutureverseUBFControllerSubsystem::UpdateRenderedTree(UUBFRuntimeController* Controller,
+	TFunctionRef<bool(TArray<FUBFContextTreeData>&)> EditContextTree, const TArray<FFutureverseAssetLoadData>& NewLoadDatas, const FOnComplete& OnComplete)
+{
+	PruneControllerRenderStates();
+	
+	const FControllerRenderState* RenderState = ControllerRenderStates.Find(Controller);
+	const TSharedPtr<FRenderItemInfo> PreviousRenderItemInfo = RenderState ? RenderState->RenderItemInfo : nullptr;
+	if (!PreviousRenderItemInfo.IsValid() || !PreviousRenderItemInfo->bRenderTree || !PreviousRenderItemInfo->bExecuted)
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::UpdateRenderedTree Controller has no completed RenderItemTree to update. Use RenderItemTree instead."));
+		OnComplete.ExecuteIfBound(false, FUBFExecutionReport::Failure());
+		return;
+	}
+
+	// the previous render stays untouched so a failed update leaves the controller state as it was
+	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeRenderItemInfo();
+	RenderItemInfo->RenderData = MakeShared<FUBFRenderDataContainer>(*PreviousRenderItemInfo->RenderData);
+	RenderItemInfo->Controller = Controller;
+	RenderItemInfo->InputMap = PreviousRenderItemInfo->InputMap;
+	RenderItemInfo->BindingObjectLeases = PreviousRenderItemInfo->BindingObjectLeases;
+	RenderItemInfo->AssetProfiles = PreviousRenderItemInfo->AssetProfiles;
+	RenderItemInfo->ParsingBlueprintId = PreviousRenderItemInfo->ParsingBlueprintId;
+	RenderItemInfo->ParsedTraits = PreviousRenderItemInfo->ParsedTraits;
+	RenderItemInfo->OnComplete = OnComplete;
+	RenderItemInfo->bRenderTree = true;
+	RenderItemInfo->bDeferRenderState = true;
+
+	if (!EditContextTree(RenderItemInfo->RenderData->GetContextTreeRef()))
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::UpdateRenderedTree relationship not found in the tree rendered for %s"), *RenderItemInfo->RenderData->GetAssetID());
+		OnComplete.ExecuteIfBound(false, FUBFExecutionReport::Failure());
+		return;
+	}
+	RenderItemInfo->UpdateTrackedMemory();
+
+	TArray<FFutureverseAssetLoadData> LoadDatasToResolve = NewLoadDatas;
+	for (FFutureverseAssetLoadData& LoadData : LoadDatasToResolve)
+	{
+		LoadData.VariantID = RenderItemInfo->RenderData->GetVariantID();
+	}
+
+	// the root's traits are already in InputMap, so the parsing graph is skipped and only the render graph runs again
+	EnsureAssetDatasLoaded(LoadDatasToResolve).Next([this, RenderItemInfo](const FLoadLinkedAssetProfilesResult& Result)
+	{
+		FUBFContinuationScope ContinuationScope;
+		if (!IsSubsystemValid()) return;
+
+		if (!Result.bSuccess)
+		{
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::UpdateRenderedTree failed to load the new node for %s"), *RenderItemInfo->RenderData->GetAssetID());
+			FailSharedRender(RenderItemInfo);
+			return;
+		}
+
+		for (const auto& AssetProfile : Result.Value)
+		{
+			RenderItemInfo->AssetProfiles.Add(AssetProfile.Value->GetId(), AssetProfile.Value);
+		}
+		RenderItemInfo->UpdateTrackedMemory();
+		ExecuteGraph(RenderItemInfo, true);
+	});
+}
+
+void UFutureverseUBFControllerSubsystem::CommitRenderState(const TSharedPtr<FRenderItemInfo>& RenderItemInfo)
+{
+	PinRenderedAssets(RenderItemInfo->Controller, GetRenderedLoadDatas(*RenderItemInfo));
+	if (FControllerRenderState* RenderState = ControllerRenderStates.Find(RenderItemInfo->Controller))
+	{
+		RenderState->RenderItemInfo = RenderItemInfo;
+	}
+}
+
+TArray<FFutureverseAssetLoadData> UFutureverseUBFControllerSubsystem::GetRenderedLoadDatas(const FRenderItemInfo& RenderItemInfo)
+{
+	TArray<FFutureverseAssetLoadData> LoadDatas;
+	if (RenderItemInfo.bRenderTree)
+	{
+		LoadDatas = RenderItemInfo.RenderData->GetLinkedAssetLoadData();
+	}
+	else
+	{
+		LoadDatas.Add(FFutureverseAssetLoadData(RenderItemInfo.RenderData->GetAssetID(), RenderItemInfo.RenderData->GetProfileURI()));
+	}
+	
+	for (FFutureverseAssetLoadData& LoadData : LoadDatas)
+	{
+		LoadData.VariantID = RenderItemInfo.RenderData->GetVariantID();
+	}
+	return LoadDatas;
+}
+
+void UFutureverseUBFControllerSubsystem::CopyInputsWithoutTraits(const FRenderItemInfo& Source, FRenderItemInfo& Target)
+{
+	Target.InputMap = Source.InputMap;
+	if (Source.ParsedTraits.IsValid())
+	{
+		for (const auto& Trait : Source.ParsedTraits->GetBindingObjects())
+		{
+			Target.InputMap.Remove(Trait.Key);
+		}
+	}
+	for (const TSharedPtr<FBindingObjectLease>& BindingObjectLease : Source.BindingObjectLeases)
+	{
+		if (BindingObjectLease != Source.ParsedTraits)
+			Target.BindingObjectLeases.Add(BindingObjectLease);
+	}
+}
+
+void UFutureverseUBFControllerSubsystem::SwitchRenderedVariant(UUBFRuntimeController* Controller, const FString& VariantID, const FOnComplete& OnComplete)
+{
+	PruneControllerRenderStates();
+	
+	const FControllerRenderState* RenderState = ControllerRenderStates.Find(Controller);
+	const TSharedPtr<FRenderItemInfo> PreviousRenderItemInfo = RenderState ? RenderState->RenderItemInfo : nullptr;
+	if (!PreviousRenderItemInfo.IsValid() || !PreviousRenderItemInfo->bExecuted)
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::SwitchRenderedVariant Controller has no completed render to switch. Use RenderItem or RenderItemTree instead."));
+		OnComplete.ExecuteIfBound(false, FUBFExecutionReport::Failure());
+		return;
+	}
+
+	// the caller's inputs without the traits parsed for the previous variant
+	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeRenderItemInfo();
+	RenderItemInfo->RenderData = FUBFRenderDataContainer::GetFromData(PreviousRenderItemInfo->RenderData->GetRenderData(), VariantID);
+	RenderItemInfo->Controller = Controller;
+	RenderItemInfo->OnComplete = OnComplete;
+	RenderItemInfo->bRenderTree = PreviousRenderItemInfo->bRenderTree;
+	// a switch that fails leaves the previous variant as the controller's last render
+	RenderItemInfo->bDeferRenderState = true;
+	CopyInputsWithoutTraits(*PreviousRenderItemInfo, *RenderItemInfo);
+	RenderItemInfo->UpdateTrackedMemory();
+
+	const TArray<FFutureverseAssetLoadData> LoadDatas = GetRenderedLoadDatas(*RenderItemInfo);
+
+	EnsureAssetDatasLoaded(LoadDatas).Next([this, RenderItemInfo, PreviousRenderItemInfo](const FLoadLinkedAssetProfilesResult& Result)
+	{
+		FUBFContinuationScope ContinuationScope;
+		if (!IsSubsystemValid()) return;
+
+		if (!Result.bSuccess && !RenderItemInfo->bRenderTree)
+		{
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::SwitchRenderedVariant failed to load variant %s of %s"),
+				*RenderItemInfo->RenderData->GetVariantID(), *RenderItemInfo->RenderData->GetAssetID());
+			FailSharedRender(RenderItemInfo);
+			return;
+		}
+		RenderItemInfo->AssetProfiles = Result.Value;
+		RenderItemInfo->UpdateTrackedMemory();
+
+		const FAssetProfile& AssetProfile = RenderItemInfo->GetAssetProfile(RenderItemInfo->RenderData->GetAssetID());
+		const FString& ParsingBlueprintId = AssetProfile.GetParsingBlueprintId(RenderItemInfo->RenderData->GetVariantID());
+		const bool bCanReuseTraits = PreviousRenderItemInfo->ParsedTraits.IsValid() && !ParsingBlueprintId.IsEmpty()
+			&& ParsingBlueprintId == PreviousRenderItemInfo->ParsingBlueprintId
+			&& !AssetProfile.GetRenderBlueprintId(RenderItemInfo->RenderData->GetVariantID()).IsEmpty();
+		if (!bCanReuseTraits)
+		{
+			VariantSwitchCounters.Misses++;
+			ExecuteItemGraph(RenderItemInfo, RenderItemInfo->bRenderTree);
+			return;
+		}
+
+		VariantSwitchCounters.Hits++;
+		RenderItemInfo->InputMap.Append(PreviousRenderItemInfo->ParsedTraits->GetBindingObjects());
+		RenderItemInfo->BindingObjectLeases.Add(PreviousRenderItemInfo->ParsedTraits);
+		RenderItemInfo->ParsingBlueprintId = ParsingBlueprintId;
+		RenderItemInfo->ParsedTraits = PreviousRenderItemInfo->ParsedTraits;
+		RenderItemInfo->UpdateTrackedMemory();
+		ExecuteGraph(RenderItemInfo, RenderItemInfo->bRenderTree);
+	});
+}
+
+void UFutureverseUBFControllerSubsystem::SetSessionSlot(UUBFRuntimeController* Controller, const FString& Slot)
+{
+	if (!IsValid(Controller))
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::SetSessionSlot was provided invalid Controller."));
+		return;
+	}
+
+	if (Slot.IsEmpty())
+	{
+		SessionSlots.Remove(Controller);
+		return;
+	}
+
+	if (GetDefault<UFutureverseUBFControllerSettings>()->GetSessionSnapshotPath().IsEmpty())
+	{
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::SetSessionSlot session snapshots are disabled, %s won't be saved"), *Slot);
+		return;
+	}
+
+	// the snapshot written at shutdown needs the source of every catalog the slot's renders load
+	FControllerDownloadManager::GetInstance()->SetCaptureCatalogSources(true);
+	SessionSlots.Add(Controller, Slot);
+
+	const FControllerRenderState* RenderState = ControllerRenderStates.Find(Controller);
+	if (RenderState && RenderState->RenderItemInfo.IsValid() && RenderState->RenderItemInfo->bExecuted)
+	{
+		RecordSessionRender(*RenderState->RenderItemInfo);
+	}
+}
+
+bool UFutureverseUBFControllerSubsystem::RestoreSessionSlot(const FString& Slot, UUBFRuntimeController* Controller,
+	const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete, const FUBFRenderData& CurrentRenderData)
+{
+	if (!IsValid(Controller))
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::RestoreSessionSlot was provided invalid Controller. Cannot Render."));
+		return false;
+	}
+
+	const FUBFSessionRender* Render = SessionSnapshot.IsValid() ? SessionSnapshot->FindRender(Slot) : nullptr;
+	if (!Render)
+	{
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::RestoreSessionSlot nothing saved for %s"), *Slot);
+		return false;
+	}
+
+	SetSessionSlot(Controller, Slot);
+
+	TSharedPtr<FRenderItemInfo> RenderItemInfo = MakeRenderItemInfo();
+	RenderItemInfo->RenderData = FUBFRenderDataContainer::GetFromData(Render->RenderData, Render->VariantID);
+	RenderItemInfo->Controller = Controller;
+	RenderItemInfo->InputMap = InputMap;
+	RenderItemInfo->OnComplete = OnComplete;
+	RenderItemInfo->bRenderTree = Render->bRenderTree;
+	RenderItemInfo->bRestoredFromSession = true;
+	if (CurrentRenderData.IsValid())
+	{
+		RenderItemInfo->CurrentSessionRenderData = FUBFRenderDataContainer::GetFromData(CurrentRenderData, Render->VariantID);
+	}
+	
+	// outputs that weren't saved or can't be rebuilt with their type make RevalidateSessionRender parse again
+	if (!Render->ParsingBlueprintId.IsEmpty())
+	{
+		RenderItemInfo->bSavedTraitsIncomplete = Render->bTraitsIncomplete;
+		TMap<FString, UBF::FDynamicHandle> Traits;
+		for (const auto& Trait : Render->Traits)
+		{
+			UBF::FDynamicHandle Handle = UBF::FDynamicHandle::String(Trait.Value.Value);
+			if (!MakeSessionTraitHandle(Trait.Value, Handle))
+			{
+				UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::RestoreSessionSlot trait %s has type %s, which can't be restored"), *Trait.Key, *Trait.Value.Type);
+				RenderItemInfo->bSavedTraitsIncomplete = true;
+				continue;
+			}
+			Traits.Add(Trait.Key, Handle);
+		}
+		RenderItemInfo->PreviousParsingBlueprintId = Render->ParsingBlueprintId;
+		RenderItemInfo->PreviousParsedTraits = BindingObjectReferencer->Acquire(Traits);
+	}
+	RenderItemInfo->UpdateTrackedMemory();
+
+	UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::RestoreSessionSlot restoring %s variant %s into %s"),
+		*Render->RenderData.AssetID, *Render->VariantID, *Slot);
+	if (RenderItemInfo->bRenderTree)
+	{
+		RenderItemTreeInternal(RenderItemInfo);
+	}
+	else
+	{
+		RenderItemInternal(RenderItemInfo);
+	}
+	return true;
+}
+
+void UFutureverseUBFControllerSubsystem::RecordSessionRender(const FRenderItemInfo& RenderItemInfo)
+{
+	const FString* Slot = SessionSlots.Find(RenderItemInfo.Controller);
+	if (!Slot)
+		return;
+
+	FSessionSlotRender& SlotRender = SessionSlotRenders.FindOrAdd(*Slot);
+	SlotRender.Render.Slot = *Slot;
+	SlotRender.Render.RenderData = RenderItemInfo.RenderData->GetRenderData();
+	SlotRender.Render.VariantID = RenderItemInfo.RenderData->GetVariantID();
+	SlotRender.Render.bRenderTree = RenderItemInfo.bRenderTree;
+	SlotRender.Render.ParsingBlueprintId = RenderItemInfo.ParsedTraits.IsValid() ? RenderItemInfo.ParsingBlueprintId : FString();
+	SlotRender.Render.Traits.Reset();
+	SlotRender.Render.bTraitsIncomplete = false;
+	if (RenderItemInfo.ParsedTraits.IsValid())
+	{
+		for (const auto& Trait : RenderItemInfo.ParsedTraits->GetBindingObjects())
+		{
+			if (!IsValid(Trait.Value))
+				continue;
+			
+			FUBFSessionTrait SessionTrait;
+			SessionTrait.Type = Trait.Value->GetType();
+			SessionTrait.Value = Trait.Value->ToString();
+			
+			// resources, arrays and other outputs have no value that survives as a string
+			UBF::FDynamicHandle Handle = UBF::FDynamicHandle::String(SessionTrait.Value);
+			if (MakeSessionTraitHandle(SessionTrait, Handle))
+			{
+				SlotRender.Render.Traits.Add(Trait.Key, MoveTemp(SessionTrait));
+			}
+			else
+			{
+				SlotRender.Render.bTraitsIncomplete = true;
+			}
+		}
+	}
+	
+	SlotRender.AssetProfiles.Reset();
+	for (const auto& AssetProfile : RenderItemInfo.AssetProfiles)
+	{
+		SlotRender.AssetProfiles.Add(AssetProfile.Value);
+	}
+}
+
+void UFutureverseUBFControllerSubsystem::SaveSessionSnapshot()
+{
+	const FString Path = GetDefault<UFutureverseUBFControllerSettings>()->GetSessionSnapshotPath();
+	if (Path.IsEmpty() || SessionSlotRenders.IsEmpty())
+		return;
+
+	TArray<FUBFSessionRender> Renders;
+	TArray<FAssetProfilePtr> AssetProfiles;
+	for (const auto& SlotRender : SessionSlotRenders)
+	{
+		Renders.Add(SlotRender.Value.Render);
+		for (const FAssetProfilePtr& AssetProfile : SlotRender.Value.AssetProfiles)
+		{
+			AssetProfiles.AddUnique(AssetProfile);
+		}
+	}
+
+	// built while the previous snapshot is still mounted, restored catalogs that never reached the network come from it
+	const TArray<uint8> Data = FUBFSessionSnapshot::Build(Renders, AssetProfiles);
+	
+	// the previous snapshot may be mapped from the file about to be replaced
+	if (SessionSnapshot.IsValid())
+	{
+		SessionSnapshot->Unmount();
+		SessionSnapshot.Reset();
+	}
+	
+	if (FFileHelper::SaveArrayToFile(Data, *Path))
+	{
+		UE_LOG(LogFutureverseUBFController, Log, TEXT("UFutureverseUBFControllerSubsystem::SaveSessionSnapshot wrote %d renders to %s"), Renders.Num(), *Path);
+	}
+	else
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::SaveSessionSnapshot could not write %s"), *Path);
+	}
+}
+
+void UFutureverseUBFControllerSubsystem::RevalidateSessionRender(const TSharedPtr<FRenderItemInfo>& RenderItemInfo)
+{
+	const bool bRenderDataChanged = RenderItemInfo->CurrentSessionRenderData.IsValid()
+		&& HashRenderData(RenderItemInfo->CurrentSessionRenderData->GetRenderData()) != HashRenderData(RenderItemInfo->RenderData->GetRenderData());
+	const bool bUsedIncompleteTraits = RenderItemInfo->ParsedTraits.IsValid() && RenderItemInfo->ParsedTraits == RenderItemInfo->PreviousParsedTraits
+		&& RenderItemInfo->bSavedTraitsIncomplete;
+	
+	const TArray<FFutureverseAssetLoadData> LoadDatas = GetRenderedLoadDatas(*RenderItemInfo);
+	TArray<TFuture<bool>> Checks;
+	for (const FFutureverseAssetLoadData& LoadData : LoadDatas)
+	{
+		const FAssetProfilePtr* RestoredProfile = RenderItemInfo->AssetProfiles.Find(LoadData.AssetID);
+		Checks.Add(HasSessionAssetChanged(LoadData, RestoredProfile ? *RestoredProfile : nullptr));
+	}
+
+	LoadActionUtils::WhenAll(Checks).Next([this, RenderItemInfo, LoadDatas, bRenderDataChanged, bUsedIncompleteTraits](const TArray<bool>& ChangedAssets)
+	{
+		FUBFContinuationScope ContinuationScope;
+		if (!IsSubsystemValid()) return;
+
+		const bool bAssetChanged = ChangedAssets.Contains(true);
+		if (!bAssetChanged && !bRenderDataChanged && !bUsedIncompleteTraits)
+		{
+			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::RevalidateSessionRender restored %s is current"), *RenderItemInfo->RenderData->GetAssetID());
+			return;
+		}
+
+		if (bAssetChanged)
+		{
+			UE_LOG(LogFutureverseUBFController, Log, TEXT("UFutureverseUBFControllerSubsystem::RevalidateSessionRender %s changed since the session snapshot was written"), *RenderItemInfo->RenderData->GetAssetID());
+			
+			// other restores load from the network from now on
+			if (SessionSnapshot.IsValid())
+			{
+				SessionSnapshot->Unmount();
+			}
+
+			// the restored profile's catalog URIs are the ones whose cached content is outdated
+			for (int32 Index = 0; Index < LoadDatas.Num(); ++Index)
+			{
+				if (!ChangedAssets[Index])
+					continue;
+
+				const FAssetProfile& RestoredProfile = RenderItemInfo->GetAssetProfile(LoadDatas[Index].AssetID);
+				if (const FAssetProfileVariant* Variant = RestoredProfile.FindVariant(LoadDatas[Index].VariantID))
+				{
+					CatalogStore->ForgetUri(Variant->GetRenderCatalogUri());
+					CatalogStore->ForgetUri(Variant->GetParsingCatalogUri());
+				}
+				RemoveLoadedVariantCatalog(LoadDatas[Index].GetCombinedVariantID());
+			}
+		}
+		else if (bRenderDataChanged)
+		{
+			UE_LOG(LogFutureverseUBFController, Log, TEXT("UFutureverseUBFControllerSubsystem::RevalidateSessionRender metadata or context tree of %s changed since the session snapshot was written"), *RenderItemInfo->RenderData->GetAssetID());
+		}
+		else
+		{
+			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::RevalidateSessionRender restored %s used saved traits, parsing them again"), *RenderItemInfo->RenderData->GetAssetID());
+		}
+
+		// nothing to refresh if the controller has moved on to another render
+		const FControllerRenderState* RenderState = ControllerRenderStates.Find(RenderItemInfo->Controller);
+		if (!RenderState || RenderState->RenderItemInfo != RenderItemInfo)
+			return;
+
+		// the caller was already told about the restored render, this one completes silently
+		TSharedPtr<FRenderItemInfo> FreshRenderItemInfo = MakeRenderItemInfo();
+		FreshRenderItemInfo->RenderData = RenderItemInfo->CurrentSessionRenderData.IsValid() ? RenderItemInfo->CurrentSessionRenderData : RenderItemInfo->RenderData;
+		FreshRenderItemInfo->Controller = RenderItemInfo->Controller;
+		FreshRenderItemInfo->bRenderTree = RenderItemInfo->bRenderTree;
+		CopyInputsWithoutTraits(*RenderItemInfo, *FreshRenderItemInfo);
+		FreshRenderItemInfo->UpdateTrackedMemory();
+		if (FreshRenderItemInfo->bRenderTree)
+		{
+			RenderItemTreeInternal(FreshRenderItemInfo);
+		}
+		else
+		{
+			RenderItemInternal(FreshRenderItemInfo);
+		}
+	});
+}
+
+TFuture<bool> UFutureverseUBFControllerSubsystem::HasSessionAssetChanged(const FFutureverseAssetLoadData& LoadData,
+	const FAssetProfilePtr& RestoredProfile)
+{
+	TSharedPtr<TPromise<bool>> Promise = MakeShareable(new TPromise<bool>());
+	TFuture<bool> Future = Promise->GetFuture();
+
+	UAssetProfileRegistrySubsystem* AssetProfileRegistry = UAssetProfileRegistrySubsystem::Get(GetWorld());
+	if (!AssetProfileRegistry || !RestoredProfile.IsValid())
+	{
+		Promise->SetValue(false);
+		return Future;
+	}
+
+	AssetProfileRegistry->RefreshAssetProfile(LoadData).Next([this, Promise, LoadData, RestoredProfile]
+		(const FLoadAssetProfileResult& Result)
+	{
+		FUBFContinuationScope ContinuationScope;
+		// an asset that can't be reached keeps what the snapshot had
+		if (!IsSubsystemValid() || !Result.bSuccess || !Result.Value.IsValid())
+		{
+			Promise->SetValue(false);
+			return;
+		}
+
+		if (Result.Value->ToString() != RestoredProfile->ToString())
+		{
+			Promise->SetValue(true);
+			return;
+		}
+
+		const FLoadedVariantCatalog* LoadedVariantCatalog = LoadedVariantCatalogs.Find(LoadData.GetCombinedVariantID());
+		const FAssetProfileVariant* Variant = RestoredProfile->FindVariant(LoadData.VariantID);
+		if (!LoadedVariantCatalog || !Variant)
+		{
+			Promise->SetValue(false);
+			return;
+		}
+
+		// the same catalogs FLoadAssetCatalogAction loads for the variant
+		FControllerDownloadManager* DownloadManager = FControllerDownloadManager::GetInstance();
+		TArray<TFuture<UBF::FLoadStringResult>> CatalogLoads;
+		if (!Variant->GetRenderBlueprintId().IsEmpty() && !Variant->GetRenderCatalogUri().IsEmpty())
+		{
+			CatalogLoads.Add(DownloadManager->LoadStringFromNetwork(TEXT("Catalog"), Variant->GetRenderCatalogUri(), EUBFDownloadPriority::Prefetch));
+		}
+		if (!Variant->GetParsingBlueprintId().IsEmpty() && !Variant->GetParsingCatalogUri().IsEmpty())
+		{
+			CatalogLoads.Add(DownloadManager->LoadStringFromNetwork(TEXT("Catalog"), Variant->GetParsingCatalogUri(), EUBFDownloadPriority::Prefetch));
+		}
+
+		const TArray<uint64, TInlineAllocator<2>> CatalogHashes = LoadedVariantCatalog->CatalogHashes;
+		LoadActionUtils::WhenAll(CatalogLoads).Next([Promise, CatalogHashes](const TArray<UBF::FLoadStringResult>& Results)
+		{
+			FUBFContinuationScope ContinuationScope;
+			bool bChanged = false;
+			for (const UBF::FLoadStringResult& CatalogResult : Results)
+			{
+				bChanged |= CatalogResult.bSuccess && !CatalogHashes.Contains(FSharedCatalogStore::HashContent(CatalogResult.Value));
+			}
+			Promise->SetValue(bChanged);
+		});
+	});
+
+	return Future;
+}
+
+void UFutureverseUBFControllerSubsystem::AppendMemoryReport(FUBFMemoryReport& Report) const
+{
+	Report.AddCounters(TEXT("VariantCatalogs"), CatalogCacheCounters);
+
+	// a hit is a render that reused the resolution and parse of an identical in-flight render
+	Report.AddCounters(TEXT("SharedRenders"), SharedRenderCounters);
+	Report.AddCounters(TEXT("VariantSwitches"), VariantSwitchCounters);
+	Report.AddCounters(TEXT("CatalogParses"), CatalogStore->GetParseCounters());
+	
+	for (const auto& LoadedVariantCatalog : LoadedVariantCatalogs)
+	{
+		Report.Add(TEXT("VariantCatalogs"), LoadedVariantCatalog.Value.CollectionId,
+			LoadedVariantCatalog.Key.GetAllocatedSize() + sizeof(FLoadedVariantCatalog));
+	}
+
+	for (const auto& RegisteredCatalog : RegisteredCatalogs)
+	{
+		Report.Add(TEXT("SharedCatalogs"), RegisteredCatalog.Value.CollectionId, RegisteredCatalog.Value.Catalog->ApproximateBytes);
+	}
+
+	for (const TWeakPtr<FRenderItemInfo>& WeakRenderItemInfo : InFlightRenderItemInfos)
+	{
+		if (const TSharedPtr<FRenderItemInfo> RenderItemInfo = WeakRenderItemInfo.Pin())
+		{
+			const FString CollectionId = RenderItemInfo->RenderData.IsValid()
+				? AssetIdUtils::GetCollectionID(RenderItemInfo->RenderData->GetAssetID()) : FString();
+			Report.Add(TEXT("InFlightRenderRequests"), CollectionId, RenderItemInfo->GetApproximateMemoryUsage());
+		}
+	}
+}
+
+void UFutureverseUBFControllerSubsystem::LogRuntimeStats(FOutputDevice& Ar) const
+{
+	int32 NumInFlightRenders = 0;
+	for (const TWeakPtr<FRenderItemInfo>& RenderItemInfo : InFlightRenderItemInfos)
+	{
+		NumInFlightRenders += RenderItemInfo.IsValid() ? 1 : 0;
+	}
+	int32 NumSharedRenderFollowers = 0;
+	for (const auto& SharedRender : SharedRenders)
+	{
+		NumSharedRenderFollowers += SharedRender.Value.Followers.Num();
+	}
+	Ar.Logf(TEXT("Renders: %d in flight, %d waiting on an identical render"), NumInFlightRenders, NumSharedRenderFollowers);
+
+	CatalogCacheCounters.Log(Ar, TEXT("LoadedVariantCatalogs"));
+	CatalogStore->GetParseCounters().Log(Ar, TEXT("CatalogParses"));
+	// a hit reuses the traits parsed for an identical render or for the previous variant instead of running the parsing graph
+	SharedRenderCounters.Log(Ar, TEXT("SharedRenders"));
+	VariantSwitchCounters.Log(Ar, TEXT("VariantSwitches"));
+}
+
+void UFutureverseUBFControllerSubsystem::RecordCsvStats() const
+{
+	const FUBFRuntimeStats& RuntimeStats = FUBFRuntimeStats::Get();
+	CSV_CUSTOM_STAT(FutureverseUBFController, PendingProfileLoads, RuntimeStats.GetNumInFlight(EUBFLoadStage::AssetProfile), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(FutureverseUBFController, PendingCatalogLoads, RuntimeStats.GetNumInFlight(EUBFLoadStage::Catalog), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(FutureverseUBFController, PendingParses, RuntimeStats.GetNumInFlight(EUBFLoadStage::ParsingGraph), ECsvCustomStatOp::Set);
+
+	int32 NumInFlightRenders = 0;
+	for (const TWeakPtr<FRenderItemInfo>& RenderItemInfo : InFlightRenderItemInfos)
+	{
+		NumInFlightRenders += RenderItemInfo.IsValid() ? 1 : 0;
+	}
+	CSV_CUSTOM_STAT(FutureverseUBFController, InFlightRenders, NumInFlightRenders, ECsvCustomStatOp::Set);
+
+	int32 NumActiveDownloads = 0;
+	int32 NumQueuedDownloads = 0;
+	for (const auto& Host : FControllerDownloadManager::GetInstance()->GetGovernor().GetHostStats())
+	{
+		NumActiveDownloads += Host.Value.NumActive;
+		NumQueuedDownloads += Host.Value.NumWaiting;
+	}
+	CSV_CUSTOM_STAT(FutureverseUBFController, ActiveDownloads, NumActiveDownloads, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(FutureverseUBFController, QueuedDownloads, NumQueuedDownloads, ECsvCustomStatOp::Set);
+
+	if (const UAssetProfileRegistrySubsystem* AssetProfileRegistry = UAssetProfileRegistrySubsystem::Get(GetWorld()))
+	{
+		CSV_CUSTOM_STAT(FutureverseUBFController, AssetProfiles, AssetProfileRegistry->GetNumAssetProfiles(), ECsvCustomStatOp::Set);
+	}
+	CSV_CUSTOM_STAT(FutureverseUBFController, LoadedVariantCatalogs, LoadedVariantCatalogs.Num(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(FutureverseUBFController, RegisteredCatalogs, RegisteredCatalogs.Num(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(FutureverseUBFController, RegisteredCatalogMB, static_cast<float>(RegisteredCatalogBytes / (1024.0 * 1024.0)), ECsvCustomStatOp::Set);
+}
+
+void UFutureverseUBFControllerSubsystem::ResetRuntimeStats()
+{
+	CatalogCacheCounters = FUBFCacheCounters();
+	SharedRenderCounters = FUBFCacheCounters();
+	VariantSwitchCounters = FUBFCacheCounters();
+	CatalogStore->ResetParseCounters();
+	SET_DWORD_STAT(STAT_UBFCatalogCacheHits, 0);
+	SET_DWORD_STAT(STAT_UBFCatalogCacheMisses, 0);
+}
+
+void UFutureverseUBFControllerSubsystem::ExecuteItemGraph(TSharedPtr<FRenderItemInfo> RenderItemInfo, const bool bShouldBuildContextTree)
+{
+	const FAssetProfile& AssetProfile = RenderItemInfo->GetAssetProfile(RenderItemInfo->RenderData->GetAssetID());
 		
 	if (!AssetProfile.GetParsingBlueprintId(RenderItemInfo->RenderData->GetVariantID()).IsEmpty())
 	{
@@ -394,11 +1811,11 @@ void UFutureverseUBFControllerSubsystem::ExecuteItemGraph(TSharedPtr<FRenderItem
 	if (AssetProfile.GetRenderBlueprintId(RenderItemInfo->RenderData->GetVariantID()).IsEmpty())
 	{
 		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::ExecuteItemGraph Item %s provided invalid Rendering Graph Instance. Cannot render."), *RenderItemInfo->RenderData->GetAssetID());
-		RenderItemInfo->OnComplete.ExecuteIfBound(false, FUBFExecutionReport::Failure());
+		FailSharedRender(RenderItemInfo);
 		return;
 	}
 	
-	ExecuteGraph(RenderItemInfo, bShouldBuildContextTree);
+	ExecuteSharedRender(RenderItemInfo, bShouldBuildContextTree);
 }
 
 void UFutureverseUBFControllerSubsystem::CreateBlueprintInstancesFromContextTree(TSharedPtr<FRenderItemInfo> RenderItemInfo,
@@ -408,7 +1825,7 @@ void UFutureverseUBFControllerSubsystem::CreateBlueprintInstancesFromContextTree
 	{
 		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::CreateBlueprintInstancesFromContextTree Can't build context tree beacuse UBFContextTree is empty."));
 		
-		auto ParentNodeRenderBlueprint = RenderItemInfo->AssetProfiles.Get(RootAssetId).GetRenderBlueprintId(RenderItemInfo->RenderData->GetVariantID());
+		auto ParentNodeRenderBlueprint = RenderItemInfo->GetAssetProfile(RootAssetId).GetRenderBlueprintId(RenderItemInfo->RenderData->GetVariantID());
 		UBF::FExecutionInstanceData BlueprintInstance(ParentNodeRenderBlueprint);
 		OutBlueprintInstances.Reset();
 		OutBlueprintInstances.Add(BlueprintInstance);
@@ -425,7 +1842,7 @@ void UFutureverseUBFControllerSubsystem::CreateBlueprintInstancesFromContextTree
 			continue;
 		}
 		
-		auto ParentNodeRenderBlueprint = RenderItemInfo->AssetProfiles.Get(ContextTreeData.RootNodeID).GetRenderBlueprintId(RenderItemInfo->RenderData->GetVariantID());
+		auto ParentNodeRenderBlueprint = RenderItemInfo->GetAssetProfile(ContextTreeData.RootNodeID).GetRenderBlueprintId(RenderItemInfo->RenderData->GetVariantID());
 		UBF::FExecutionInstanceData BlueprintInstance(ParentNodeRenderBlueprint);
 
 		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UFutureverseUBFControllerSubsystem::CreateBlueprintInstancesFromContextTree Adding BlueprintInstance to mapping with Key: %s Value: %s.")
@@ -451,7 +1868,7 @@ void UFutureverseUBFControllerSubsystem::CreateBlueprintInstancesFromContextTree
 					continue;
 				}
 
-				auto ChildNodeRenderBlueprint = RenderItemInfo->AssetProfiles.Get(Relationship.ChildAssetID).GetRenderBlueprintId(RenderItemInfo->RenderData->GetVariantID());
+				auto ChildNodeRenderBlueprint = RenderItemInfo->GetAssetProfile(Relationship.ChildAssetID).GetRenderBlueprintId(RenderItemInfo->RenderData->GetVariantID());
 				UBF::FExecutionInstanceData NewBlueprintInstance(ChildNodeRenderBlueprint);
 				AssetIdToInstanceMap.Add(Relationship.ChildAssetID, NewBlueprintInstance);
 			}
@@ -473,6 +1890,38 @@ void UFutureverseUBFControllerSubsystem::Deinitialize()
 {
 	Super::Deinitialize();
 
+	FTSTicker::GetCoreTicker().RemoveTicker(CsvTickerHandle);
+	if (UAssetProfileRegistrySubsystem* AssetProfileRegistry = GetGameInstance()->GetSubsystem<UAssetProfileRegistrySubsystem>())
+	{
+		AssetProfileRegistry->OnAssetProfilesEvicted.Remove(AssetProfilesEvictedHandle);
+	}
+	
+	SaveSessionSnapshot();
+	FControllerDownloadManager::GetInstance()->GetTrafficArchive().SaveRecording();
+	SessionSlots.Reset();
+	SessionSlotRenders.Reset();
+
+	DEC_DWORD_STAT_BY(STAT_UBFVariantCatalogsCount, LoadedVariantCatalogs.Num());
+	for (const auto& RegisteredCatalog : RegisteredCatalogs)
+	{
+		DEC_DWORD_STAT(STAT_UBFSharedCatalogsCount);
+		DEC_DWORD_STAT_BY(STAT_UBFCatalogElementsCount, RegisteredCatalog.Value.Catalog->Elements.Num());
+		DEC_MEMORY_STAT_BY(STAT_UBFCatalogsMemory, RegisteredCatalog.Value.Catalog->ApproximateBytes);
+	}
+	LoadedVariantCatalogs.Reset();
+	RegisteredCatalogs.Reset();
+	RegisteredCatalogBytes = 0;
+	InFlightRenderItemInfos.Reset();
+	SharedRenders.Reset();
+	
+	for (const auto& ControllerRenderState : ControllerRenderStates)
+	{
+		ReleaseRenderState(ControllerRenderState.Value);
+	}
+	ControllerRenderStates.Reset();
+	DeadlineReports.Reset();
+	RenderStageEstimates.Reset();
+
 	bIsInitialized = false;
 }
 
@@ -480,6 +1929,32 @@ void UFutureverseUBFControllerSubsystem::Initialize(FSubsystemCollectionBase& Co
 {
 	Super::Initialize(Collection);
 
+#if CSV_PROFILER
+	TWeakObjectPtr<UFutureverseUBFControllerSubsystem> WeakThis = this;
+	CsvTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThis](float)
+	{
+		if (WeakThis.IsValid() && FCsvProfiler::Get()->IsCapturing())
+		{
+			WeakThis->RecordCsvStats();
+		}
+		return true;
+	}));
+#endif
+
+	UAssetProfileRegistrySubsystem* AssetProfileRegistry = Collection.InitializeDependency<UAssetProfileRegistrySubsystem>();
+	if (AssetProfileRegistry)
+	{
+		AssetProfilesEvictedHandle = AssetProfileRegistry->OnAssetProfilesEvicted.AddUObject(this, &UFutureverseUBFControllerSubsystem::HandleAssetProfilesEvicted);
+	}
+
+	// mounted after the configured snapshots so restored renders are answered from it first
+	FControllerDownloadManager::GetInstance()->MountConfiguredSnapshots();
+	const FString SessionSnapshotPath = GetDefault<UFutureverseUBFControllerSettings>()->GetSessionSnapshotPath();
+	if (!SessionSnapshotPath.IsEmpty())
+	{
+		SessionSnapshot = FUBFSessionSnapshot::Open(SessionSnapshotPath);
+	}
+
 	bIsInitialized = true;
 }
 
@@ -488,19 +1963,48 @@ void UFutureverseUBFControllerSubsystem::RenderItemInternal(TSharedPtr<FRenderIt
 	
 	FFutureverseAssetLoadData LoadData = FFutureverseAssetLoadData(RenderItemInfo->RenderData->GetAssetID(), RenderItemInfo->RenderData->GetProfileURI());
 	LoadData.VariantID = RenderItemInfo->RenderData->GetVariantID();
+	LoadData.Deadline = RenderItemInfo->Deadline;
 	
-	EnsureAssetDataLoaded(LoadData).Next([this, RenderItemInfo, LoadData]
-		(const FLoadAssetProfileResult& Result)
+	TArray<FFutureverseAssetLoadData> LoadDatas = {LoadData};
+	PrepareDeadlineFallbacks(*RenderItemInfo, LoadDatas);
+	LoadData = LoadDatas[0];
+	
+	PinRenderedAssets(RenderItemInfo->Controller, {LoadData});
+	if (FControllerRenderState* RenderState = ControllerRenderStates.Find(RenderItemInfo->Controller))
+	{
+		RenderState->RenderItemInfo = RenderItemInfo;
+	}
+
+	if (TryJoinSharedRender(RenderItemInfo, false))
+		return;
+	
+	EnterRenderStage(*RenderItemInfo, EUBFRenderStage::AssetProfile);
+	const TFunction<void()> OnProfileLoaded = [this, RenderItemInfo]()
 	{
+		EnterRenderStage(*RenderItemInfo, EUBFRenderStage::Catalog);
+	};
+	
+	LoadActionUtils::WithDeadline(EnsureAssetDataLoaded(LoadData, OnProfileLoaded), RenderItemInfo->Deadline).Next([this, RenderItemInfo, LoadData]
+		(const TOptional<FLoadAssetProfileResult>& OptionalResult)
+	{
+		FUBFContinuationScope ContinuationScope;
 		if (!IsSubsystemValid()) return;
-			
+
+		if (!OptionalResult.IsSet())
+		{
+			FailRenderDeadline(RenderItemInfo);
+			return;
+		}
+		
+		const FLoadAssetProfileResult& Result = OptionalResult.GetValue();
 		if (!Result.bSuccess)
 		{
 			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::RenderItem Item %s provided invalid AssetProfile. Cannot render."), *RenderItemInfo->RenderData->GetAssetID());
-			RenderItemInfo->OnComplete.ExecuteIfBound(false, FUBFExecutionReport::Failure());
+			FailSharedRender(RenderItemInfo);
 			return;
 		}
 		RenderItemInfo->AssetProfiles.Add(LoadData.AssetID, Result.Value);
+		RenderItemInfo->UpdateTrackedMemory();
 		ExecuteItemGraph(RenderItemInfo, false);
 	});
 }
@@ -512,21 +2016,48 @@ void UFutureverseUBFControllerSubsystem::RenderItemTreeInternal(TSharedPtr<FRend
 	for (FFutureverseAssetLoadData& AssetLoadData : AssetLoadDatas)
 	{
 		AssetLoadData.VariantID = RenderItemInfo->RenderData->GetVariantID();
+		AssetLoadData.Deadline = RenderItemInfo->Deadline;
 	}
+	PrepareDeadlineFallbacks(*RenderItemInfo, AssetLoadDatas);
 
 	if (AssetLoadDatas.IsEmpty())
 		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::RenderItemTree AssetLoadDatas empty for Item %s."), *RenderItemInfo->RenderData->GetAssetID());
+
+	RenderItemInfo->bRenderTree = true;
+	PinRenderedAssets(RenderItemInfo->Controller, AssetLoadDatas);
+	if (FControllerRenderState* RenderState = ControllerRenderStates.Find(RenderItemInfo->Controller))
+	{
+		RenderState->RenderItemInfo = RenderItemInfo;
+	}
+
+	if (TryJoinSharedRender(RenderItemInfo, true))
+		return;
 	
-	EnsureAssetDatasLoaded(AssetLoadDatas).Next([this, RenderItemInfo]
-		(const FLoadLinkedAssetProfilesResult& Result)
+	EnterRenderStage(*RenderItemInfo, EUBFRenderStage::AssetProfile);
+	const TFunction<void()> OnProfilesLoaded = [this, RenderItemInfo]()
 	{
+		EnterRenderStage(*RenderItemInfo, EUBFRenderStage::Catalog);
+	};
+	
+	LoadActionUtils::WithDeadline(EnsureAssetDatasLoaded(AssetLoadDatas, OnProfilesLoaded), RenderItemInfo->Deadline).Next([this, RenderItemInfo]
+		(const TOptional<FLoadLinkedAssetProfilesResult>& OptionalResult)
+	{
+		FUBFContinuationScope ContinuationScope;
 		if (!IsSubsystemValid()) return;
+
+		if (!OptionalResult.IsSet())
+		{
+			FailRenderDeadline(RenderItemInfo);
+			return;
+		}
 		
+		const FLoadLinkedAssetProfilesResult& Result = OptionalResult.GetValue();
 		if (!Result.bSuccess)
 		{
 			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UFutureverseUBFControllerSubsystem::RenderItemTree Item %s asset tree failed to load one or many AssetDatas. This will cause asset tree to not render fully"), *RenderItemInfo->RenderData->GetAssetID());
 		}
 		RenderItemInfo->AssetProfiles = Result.Value;
+		RenderItemInfo->UpdateTrackedMemory();
 		ExecuteItemGraph(RenderItemInfo, true);
 	});
 }
@@ -539,4 +2070,37 @@ UFutureverseUBFControllerSubsystem* UFutureverseUBFControllerSubsystem::Get(cons
 	}
 
 	return nullptr;
-}
\ No newline at end of file
+}
+namespace FutureverseUBFControllerTraits
+{
+	static FAutoConsoleCommandWithWorldAndArgs ExtractTraitsCommand(
+		TEXT("ubf.Traits.Extract"),
+		TEXT("ubf.Traits.Extract <AssetId> <ProfileURI> [Count] [Parallelism]. Runs the parsing graph Count times without a controller and logs items/s"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UFutureverseUBFControllerSubsystem* ControllerSubsystem = UFutureverseUBFControllerSubsystem::Get(World);
+			if (Args.Num() < 2 || !ControllerSubsystem)
+			{
+				UE_LOG(LogFutureverseUBFController, Warning, TEXT("ubf.Traits.Extract requires an AssetId, a ProfileURI and a running game instance"));
+				return;
+			}
+
+			FUBFTraitExtractionRequest Request;
+			Request.AssetID = Args[0];
+			Request.ProfileURI = Args[1];
+
+			TArray<FUBFTraitExtractionRequest> Requests;
+			Requests.Init(Request, Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 1);
+			
+			ControllerSubsystem->ExtractTraits(Requests, Args.Num() > 3 ? FCString::Atoi(*Args[3]) : 0).Next(
+				[](const FUBFTraitExtractionBatchResult& BatchResult)
+			{
+				if (BatchResult.Results.IsEmpty()) return;
+				
+				for (const auto& Trait : BatchResult.Results[0].Traits)
+				{
+					UE_LOG(LogFutureverseUBFController, Log, TEXT("ubf.Traits.Extract %s = %s"), *Trait.Key, *Trait.Value);
+				}
+			});
+		}));
+}
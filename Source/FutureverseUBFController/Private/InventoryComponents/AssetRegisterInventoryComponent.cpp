@@ -6,46 +6,113 @@
 #include "AssetRegisterQueryingLibrary.h"
 #include "FutureverseUBFControllerLog.h"
 #include "FutureverseUBFControllerSettings.h"
+#include "JsonObjectConverter.h"
 #include "MetadataJsonUtils.h"
+#include "Async/Async.h"
+#include "Downloads/ControllerDownloadManager.h"
+#include "Hash/CityHash.h"
 #include "Items/AssetRegisterUBFItem.h"
 #include "Items/UBFItem.h"
+#include "Schemas/Unions/NFTAssetLink.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace AssetRegisterInventory
+{
+	// Hash of the asset's child links in a stable order, 0 if the response didn't include them
+	uint64 HashAssetLinks(const FAsset& Asset)
+	{
+		const UNFTAssetLinkObject* NFTAssetLink = Cast<UNFTAssetLinkObject>(Asset.LinkWrapper.Links);
+		if (!NFTAssetLink)
+			return 0;
+
+		TArray<FString> Links;
+		Links.Reserve(NFTAssetLink->Data.ChildLinks.Num());
+		for (const FLink& ChildLink : NFTAssetLink->Data.ChildLinks)
+		{
+			// length prefixed so ids containing separators can't make two link sets look the same
+			Links.Add(FString::Printf(TEXT("%d:%s%d:%s%d:%s"), ChildLink.Path.Len(), *ChildLink.Path,
+				ChildLink.Asset.CollectionId.Len(), *ChildLink.Asset.CollectionId, ChildLink.Asset.TokenId.Len(), *ChildLink.Asset.TokenId));
+		}
+		Links.Sort();
+
+		const FTCHARToUTF8 Utf8(*FString::Join(Links, TEXT("")));
+		// never 0, so an asset that lost all its links still differs from one whose links weren't reported
+		return CityHash64(Utf8.Get(), Utf8.Length()) | 1;
+	}
+}
 
 
 void UAssetRegisterInventoryComponent::RequestFuturepassInventory(const FString& OwnerAddress,
 	const FOnRequestCompleted& OnRequestCompleted)
 {
-	GetAssetsRequestCompleted.BindDynamic(this, &ThisClass::HandleGetFuturepassInventory);
-	
 	FAssetConnection AssetConnectionInput;
 	AssetConnectionInput.Addresses = {OwnerAddress};
 	AssetConnectionInput.First = NumberOfItemsToQuery;
-	UAssetRegisterQueryingLibrary::GetAssets(AssetConnectionInput, GetAssetsRequestCompleted);
-	
-	OnInventoryRequestCompleted = OnRequestCompleted;
+	RequestAssets(AssetConnectionInput, OnRequestCompleted);
 }
 
 void UAssetRegisterInventoryComponent::RequestFuturepassInventoryByCollectionAndOwner(const FString& OwnerAddress,
 	const TArray<FString>& CollectionIds, const FOnRequestCompleted& OnRequestCompleted)
 {
-	GetAssetsRequestCompleted.BindDynamic(this, &ThisClass::HandleGetFuturepassInventory);
-	
 	FAssetConnection AssetConnectionInput;
 	AssetConnectionInput.Addresses = {OwnerAddress};
 	AssetConnectionInput.CollectionIds = CollectionIds;
 	AssetConnectionInput.First = NumberOfItemsToQuery;
-	UAssetRegisterQueryingLibrary::GetAssets(AssetConnectionInput, GetAssetsRequestCompleted);
-	
-	OnInventoryRequestCompleted = OnRequestCompleted;
+	RequestAssets(AssetConnectionInput, OnRequestCompleted);
 }
 
 void UAssetRegisterInventoryComponent::RequestFuturepassInventoryWithInput(const FAssetConnection& AssetConnectionInput,
 	const FOnRequestCompleted& OnRequestCompleted)
 {
-	GetAssetsRequestCompleted.BindDynamic(this, &ThisClass::HandleGetFuturepassInventory);
+	RequestAssets(AssetConnectionInput, OnRequestCompleted);
+}
 
-	UAssetRegisterQueryingLibrary::GetAssets(AssetConnectionInput, GetAssetsRequestCompleted);
-	
+void UAssetRegisterInventoryComponent::RequestAssets(const FAssetConnection& AssetConnectionInput,
+	const FOnRequestCompleted& OnRequestCompleted)
+{
 	OnInventoryRequestCompleted = OnRequestCompleted;
+	
+	FTrafficArchive& TrafficArchive = FControllerDownloadManager::GetInstance()->GetTrafficArchive();
+	if (!TrafficArchive.IsActive())
+	{
+		GetAssetsRequestCompleted.BindDynamic(this, &ThisClass::HandleGetFuturepassInventory);
+		UAssetRegisterQueryingLibrary::GetAssets(AssetConnectionInput, GetAssetsRequestCompleted);
+		return;
+	}
+	
+	// keyed by the whole query so different pages, owners and filters are recorded apart
+	FString QueryJson;
+	FJsonObjectConverter::UStructToJsonObjectString(AssetConnectionInput, QueryJson, 0, 0, 0, nullptr, false);
+	
+	TWeakObjectPtr<UAssetRegisterInventoryComponent> WeakThis = this;
+	TrafficArchive.Exchange(EUBFTrafficKind::AssetRegister, TEXT("GetAssets ") + QueryJson, [this, &AssetConnectionInput]()
+	{
+		TSharedRef<TPromise<FUBFTrafficResponse>> Promise = MakeShared<TPromise<FUBFTrafficResponse>>();
+		TFuture<FUBFTrafficResponse> Future = Promise->GetFuture();
+		
+		// the assets are recorded in the form the inventory is built from, the links the library parses into objects
+		// are reduced to their hash
+		RecordGetAssets = [Promise](bool bSuccess, const TArray<FInventoryAsset>& InventoryAssets)
+		{
+			Promise->SetValue(FUBFTrafficResponse::FromString(bSuccess, bSuccess ? WriteInventoryAssets(InventoryAssets) : FString()));
+		};
+		GetAssetsRequestCompleted.BindDynamic(this, &ThisClass::HandleGetFuturepassInventory);
+		UAssetRegisterQueryingLibrary::GetAssets(AssetConnectionInput, GetAssetsRequestCompleted);
+		
+		return Future;
+	})
+	.Next([WeakThis](const FUBFTrafficResponse& Response)
+	{
+		// replayed responses complete off the game thread
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Response]()
+		{
+			if (!WeakThis.IsValid()) return;
+			
+			TArray<FInventoryAsset> InventoryAssets;
+			const bool bSuccess = Response.bSuccess && ReadInventoryAssets(Response.GetPayloadAsString(), InventoryAssets);
+			WeakThis->UpdateInventory(bSuccess, InventoryAssets);
+		});
+	});
 }
 
 FUBFItemData UAssetRegisterInventoryComponent::CreateItemDataFromAsset(const FAsset& Asset)
@@ -61,17 +128,138 @@ FUBFItemData UAssetRegisterInventoryComponent::CreateItemDataFromAsset(const FAs
 	return FUBFItemData(AssetID, AssetName, Asset.Collection.Location, Asset.TokenId, Asset.CollectionId, MetadataJson, Asset.OriginalJsonData);
 }
 
+UAssetRegisterInventoryComponent::FInventoryAsset UAssetRegisterInventoryComponent::CreateInventoryAsset(const FAsset& Asset)
+{
+	FInventoryAsset InventoryAsset;
+	InventoryAsset.ItemData = CreateItemDataFromAsset(Asset);
+	InventoryAsset.Profiles = Asset.Profiles;
+	InventoryAsset.LinksHash = AssetRegisterInventory::HashAssetLinks(Asset);
+	return InventoryAsset;
+}
+
+FString UAssetRegisterInventoryComponent::WriteInventoryAssets(const TArray<FInventoryAsset>& InventoryAssets)
+{
+	TArray<TSharedPtr<FJsonValue>> AssetValues;
+	AssetValues.Reserve(InventoryAssets.Num());
+	
+	for (const FInventoryAsset& InventoryAsset : InventoryAssets)
+	{
+		const FUBFItemData& ItemData = InventoryAsset.ItemData;
+		const TSharedRef<FJsonObject> AssetObject = MakeShared<FJsonObject>();
+		AssetObject->SetStringField(TEXT("assetId"), ItemData.AssetID);
+		AssetObject->SetStringField(TEXT("name"), ItemData.AssetName);
+		AssetObject->SetStringField(TEXT("contractId"), ItemData.ContractID);
+		AssetObject->SetStringField(TEXT("tokenId"), ItemData.TokenID);
+		AssetObject->SetStringField(TEXT("collectionId"), ItemData.CollectionID);
+		AssetObject->SetStringField(TEXT("metadataJson"), ItemData.MetadataJson);
+		if (ItemData.MetadataJsonObject.JsonObject.IsValid())
+		{
+			AssetObject->SetObjectField(TEXT("original"), ItemData.MetadataJsonObject.JsonObject);
+		}
+		
+		const TSharedRef<FJsonObject> ProfilesObject = MakeShared<FJsonObject>();
+		for (const auto& Profile : InventoryAsset.Profiles)
+		{
+			ProfilesObject->SetStringField(Profile.Key, Profile.Value);
+		}
+		AssetObject->SetObjectField(TEXT("profiles"), ProfilesObject);
+		
+		// as a string, json numbers lose the low bits of a 64 bit hash
+		AssetObject->SetStringField(TEXT("linksHash"), FString::Printf(TEXT("%llu"), InventoryAsset.LinksHash));
+		
+		AssetValues.Add(MakeShared<FJsonValueObject>(AssetObject));
+	}
+	
+	FString Json;
+	FJsonSerializer::Serialize(AssetValues, TJsonWriterFactory<>::Create(&Json));
+	return Json;
+}
+
+bool UAssetRegisterInventoryComponent::ReadInventoryAssets(const FString& Json, TArray<FInventoryAsset>& OutInventoryAssets)
+{
+	TArray<TSharedPtr<FJsonValue>> AssetValues;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), AssetValues))
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UAssetRegisterInventoryComponent::ReadInventoryAssets recorded assets could not be parsed"));
+		return false;
+	}
+	
+	OutInventoryAssets.Reset(AssetValues.Num());
+	for (const TSharedPtr<FJsonValue>& AssetValue : AssetValues)
+	{
+		const TSharedPtr<FJsonObject>* AssetObject;
+		if (!AssetValue.IsValid() || !AssetValue->TryGetObject(AssetObject)) continue;
+		
+		FInventoryAsset& InventoryAsset = OutInventoryAssets.AddDefaulted_GetRef();
+		FUBFItemData& ItemData = InventoryAsset.ItemData;
+		(*AssetObject)->TryGetStringField(TEXT("assetId"), ItemData.AssetID);
+		(*AssetObject)->TryGetStringField(TEXT("name"), ItemData.AssetName);
+		(*AssetObject)->TryGetStringField(TEXT("contractId"), ItemData.ContractID);
+		(*AssetObject)->TryGetStringField(TEXT("tokenId"), ItemData.TokenID);
+		(*AssetObject)->TryGetStringField(TEXT("collectionId"), ItemData.CollectionID);
+		(*AssetObject)->TryGetStringField(TEXT("metadataJson"), ItemData.MetadataJson);
+		
+		const TSharedPtr<FJsonObject>* OriginalObject;
+		if ((*AssetObject)->TryGetObjectField(TEXT("original"), OriginalObject))
+		{
+			ItemData.MetadataJsonObject.JsonObject = *OriginalObject;
+		}
+		
+		const TSharedPtr<FJsonObject>* ProfilesObject;
+		if ((*AssetObject)->TryGetObjectField(TEXT("profiles"), ProfilesObject))
+		{
+			for (const auto& Profile : (*ProfilesObject)->Values)
+			{
+				FString ProfileURI;
+				if (Profile.Value.IsValid() && Profile.Value->TryGetString(ProfileURI))
+					InventoryAsset.Profiles.Add(Profile.Key, ProfileURI);
+			}
+		}
+		
+		FString LinksHash;
+		if ((*AssetObject)->TryGetStringField(TEXT("linksHash"), LinksHash))
+		{
+			InventoryAsset.LinksHash = FCString::Strtoui64(*LinksHash, nullptr, 10);
+		}
+	}
+	
+	return true;
+}
+
 void UAssetRegisterInventoryComponent::HandleGetFuturepassInventory(bool bSuccess, const FAssets& Assets)
 {
 	GetAssetsRequestCompleted.Clear();
+	
+	TArray<FInventoryAsset> InventoryAssets;
+	if (bSuccess)
+	{
+		InventoryAssets.Reserve(Assets.Edges.Num());
+		for (const auto& AssetEdge : Assets.Edges)
+		{
+			InventoryAssets.Add(CreateInventoryAsset(AssetEdge.Node));
+		}
+	}
+	
+	if (RecordGetAssets)
+	{
+		// the inventory is updated from the recorded response once the traffic archive hands it back
+		TFunction<void(bool, const TArray<FInventoryAsset>&)> Record = MoveTemp(RecordGetAssets);
+		RecordGetAssets = nullptr;
+		Record(bSuccess, InventoryAssets);
+		return;
+	}
+	
+	UpdateInventory(bSuccess, InventoryAssets);
+}
 
+void UAssetRegisterInventoryComponent::UpdateInventory(bool bSuccess, const TArray<FInventoryAsset>& InventoryAssets)
+{
 	if (!bSuccess)
 	{
 		OnInventoryRequestCompleted.ExecuteIfBound();
 		return;
 	}
 	
-	Inventory.Empty();
 	// force use legacy asset profile uri if UseAssetRegisterProfiles is false
 	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
 	check(Settings);
@@ -80,37 +268,95 @@ void UAssetRegisterInventoryComponent::HandleGetFuturepassInventory(bool bSucces
 	{
 		bUseARAssetProfile = Settings->GetUseAssetRegisterProfiles();
 	}
-	for (auto& AssetEdge : Assets.Edges)
+
+	// existing items are matched by asset id so unchanged ones keep their loaded context trees and profile uris
+	TMap<FString, UUBFItem*> PreviousItems;
+	PreviousItems.Reserve(Inventory.Num());
+	for (UUBFItem* Item : Inventory)
 	{
-		const auto Asset = AssetEdge.Node;
-		UUBFItem* UBFItem = NewObject<UAssetRegisterUBFItem>(this);
-		const auto ItemData = CreateItemDataFromAsset(Asset);
+		if (IsValid(Item))
+			PreviousItems.Add(Item->GetAssetID(), Item);
+	}
 
+	FUBFInventoryDelta Delta;
+	TArray<UUBFItem*> NewInventory;
+	NewInventory.Reserve(InventoryAssets.Num());
+	
+	for (const FInventoryAsset& InventoryAsset : InventoryAssets)
+	{
+		const FUBFItemData& ItemData = InventoryAsset.ItemData;
+
+		FString AssetProfileURI;
 		if (!bUseARAssetProfile)
 		{
-			FString LegacyProfileURI = FPaths::Combine(Settings->GetDefaultAssetProfilePath(),
+			AssetProfileURI = FPaths::Combine(Settings->GetDefaultAssetProfilePath(),
 			FString::Printf(TEXT("%s.json"), *ItemData.ContractID));
-			LegacyProfileURI = LegacyProfileURI.Replace(TEXT(" "), TEXT(""));
-			UBFItem->SetAssetProfileURI(LegacyProfileURI);
+			AssetProfileURI = AssetProfileURI.Replace(TEXT(" "), TEXT(""));
 
-			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UAssetRegisterInventoryComponent::HandleGetFuturepassInventory using legacy assetprofile URI %s"), *LegacyProfileURI);
+			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UAssetRegisterInventoryComponent::UpdateInventory using legacy assetprofile URI %s"), *AssetProfileURI);
 		}
 		else
 		{
 			FString AssetProfilesKey = TEXT("asset-profile");
 			
-			if (Asset.Profiles.Contains(AssetProfilesKey))
-				UBFItem->SetAssetProfileURI(Asset.Profiles[AssetProfilesKey]);
+			if (InventoryAsset.Profiles.Contains(AssetProfilesKey))
+				AssetProfileURI = InventoryAsset.Profiles[AssetProfilesKey];
 		}
+
+		const uint64 LinksHash = InventoryAsset.LinksHash;
+
+		UUBFItem* PreviousItem = nullptr;
+		if (PreviousItems.RemoveAndCopyValue(ItemData.AssetID, PreviousItem))
+		{
+			// an empty uri means it is resolved lazily, keep whatever the item already resolved
+			const bool bProfileURIChanged = !AssetProfileURI.IsEmpty() && !AssetProfileURI.Equals(PreviousItem->GetProfileURI(), ESearchCase::CaseSensitive);
+			const bool bMetadataChanged = UUBFItem::HashMetadataJson(ItemData.MetadataJson) != PreviousItem->GetMetadataHash();
+			// equipping or unequipping changes the links, not the metadata, and the context tree is built from the links
+			const bool bLinksChanged = LinksHash != PreviousItem->GetLinksHash();
+			
+			if (bMetadataChanged || bProfileURIChanged || bLinksChanged)
+			{
+				PreviousItem->SetItemData(ItemData);
+				PreviousItem->SetLinksHash(LinksHash);
+				
+				// the context tree and a lazily resolved profile uri came from the previous metadata, clearing them makes
+				// the next render resolve both again (an empty uri is resolved lazily, as for new items)
+				PreviousItem->SetAssetProfileURI(AssetProfileURI);
+				PreviousItem->SetContextTree({});
+				
+				ItemRegistry->RegisterItem(PreviousItem->GetAssetID(), PreviousItem);
+				Delta.Changed.Add(PreviousItem);
+			}
+			
+			NewInventory.Add(PreviousItem);
+			continue;
+		}
+		
+		UUBFItem* UBFItem = NewObject<UAssetRegisterUBFItem>(this);
+		if (!AssetProfileURI.IsEmpty())
+			UBFItem->SetAssetProfileURI(AssetProfileURI);
 		
 		UBFItem->SetItemData(ItemData);
+		UBFItem->SetLinksHash(LinksHash);
 		UBFItem->SetItemRegistry(ItemRegistry);
 		
 		ItemRegistry->RegisterItem(UBFItem->GetAssetID(), UBFItem);
 		
-		Inventory.Add(UBFItem);
+		NewInventory.Add(UBFItem);
+		Delta.Added.Add(UBFItem);
+	}
+
+	for (const auto& RemovedItem : PreviousItems)
+	{
+		ItemRegistry->UnregisterItem(RemovedItem.Key);
+		Delta.Removed.Add(RemovedItem.Value);
 	}
 	
+	Inventory = MoveTemp(NewInventory);
+	
+	UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UAssetRegisterInventoryComponent::UpdateInventory %d items: %d added, %d changed, %d removed"),
+		Inventory.Num(), Delta.Added.Num(), Delta.Changed.Num(), Delta.Removed.Num());
+	
 	// FString HasPreviousPage = Assets.PageInfo.HasPreviousPage ? TEXT("true") : TEXT("false");
 	// FString HasNextPage = Assets.PageInfo.HasNextPage ? TEXT("true") : TEXT("false");
 	//
@@ -118,5 +364,10 @@ void UAssetRegisterInventoryComponent::HandleGetFuturepassInventory(bool bSucces
 	// 	TEXT("Inventory hasPreviousPage: %s hasNextPage: %s NextPage: %s"),
 	// 	*HasPreviousPage, *HasNextPage, *Assets.PageInfo.NextPage);
 
+	if (!Delta.IsEmpty())
+	{
+		OnInventoryUpdated.Broadcast(Delta);
+	}
+	
 	OnInventoryRequestCompleted.ExecuteIfBound();
 }
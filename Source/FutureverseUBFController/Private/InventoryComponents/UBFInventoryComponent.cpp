@@ -17,3 +17,25 @@ void UUBFInventoryComponent::RegisterItem(const FString& ItemId, UUBFItem* Item)
 {
 	ItemRegistry->RegisterItem(ItemId, Item);
 }
+
+TArray<UUBFItem*> UUBFInventoryComponent::GetItemsByCollection(const FString& CollectionId) const
+{
+	TArray<UUBFItem*> Items;
+	ItemRegistry->GetItemsByCollection(CollectionId, Items);
+	return Items;
+}
+
+TArray<UUBFItem*> UUBFInventoryComponent::GetItemsByContract(const FString& ContractId) const
+{
+	TArray<UUBFItem*> Items;
+	ItemRegistry->GetItemsByContract(ContractId, Items);
+	return Items;
+}
+
+void UUBFInventoryComponent::AppendMemoryReport(FUBFMemoryReport& Report) const
+{
+	if (ItemRegistry.IsValid())
+	{
+		ItemRegistry->AppendMemoryReport(Report);
+	}
+}
@@ -6,20 +6,27 @@
 #include "AssetRegisterQueryingLibrary.h"
 #include "FutureverseUBFControllerLog.h"
 #include "FutureverseUBFControllerSettings.h"
-#include "LoadActions/LoadActionUtils.h"
-#include "Schemas/Unions/NFTAssetLink.h"
+#include "Downloads/ControllerDownloadManager.h"
+#include "LoadActions/LoadAssetProfilesAction.h"
+#include "LoadActions/LoadContextTreeAction.h"
 
 
 
 TFuture<bool> UAssetRegisterUBFItem::LoadContextTree()
+{
+	TSharedPtr<FLoadContextTreeAction> LoadContextTreeAction = MakeShared<FLoadContextTreeAction>();
+	return LoadContextTreeAction->TryLoadContextTree(this, ItemRegistry);
+}
+
+TFuture<bool> UAssetRegisterUBFItem::LoadProfileURI()
 {
 	TSharedPtr<TPromise<bool>> Promise = MakeShared<TPromise<bool>>();
- 	TFuture<bool> Future = Promise->GetFuture();
+	TFuture<bool> Future = Promise->GetFuture();
 
 	TWeakObjectPtr<UAssetRegisterUBFItem> WeakThis = this;
-
-	UAssetRegisterQueryingLibrary::GetAssetLinks(ItemData.TokenID, ItemData.CollectionID).Next([WeakThis, Promise]
-		(const FLoadAssetResult& Result)
+	
+	// some items don't have profile uris uploaded to AssetRegister yet
+	const auto UseLegacyProfileURI = [WeakThis, Promise]()
 	{
 		if (!WeakThis.IsValid())
 		{
@@ -27,82 +34,87 @@ TFuture<bool> UAssetRegisterUBFItem::LoadContextTree()
 			return;
 		}
 		
-		const auto Asset = Result.Value;
-		TSharedPtr<TArray<FUBFContextTreeRelationshipData>> Relationships = MakeShared<TArray<FUBFContextTreeRelationshipData>>();
-
-		TArray<TFuture<bool>> ProfileFutures;
-		
-		if (const UNFTAssetLinkObject* NFTAssetLink = Cast<UNFTAssetLinkObject>(Asset.LinkWrapper.Links))
+		const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+		check(Settings);
+		if (!Settings)
 		{
-			for (const FLink& ChildLink : NFTAssetLink->Data.ChildLinks)
-			{
-				const FString ChildAssetID = FString::Printf(TEXT("%s:%s"), *ChildLink.Asset.CollectionId, *ChildLink.Asset.TokenId);
-				UUBFItem* ChildItem = WeakThis->ItemRegistry->GetItem(ChildAssetID);
-
-				if (!ChildItem)
-				{
-					UE_LOG(LogFutureverseUBFController, Verbose, TEXT("Failed to add Child Item: %s"), *ChildAssetID);
-					continue;
-				}
-
-				TFuture<bool> ProfileFuture = ChildItem->EnsureProfileURILoaded().Next(
-					[ChildLink, ChildAssetID, ChildItem, Relationships](const bool& Result)
-					{
-						if (Result)
-						{
-							Relationships->Add(FUBFContextTreeRelationshipData(ChildLink.Path, ChildAssetID, ChildItem->GetProfileURI()));
-						}
-
-						return Result;
-					});
-	
-				ProfileFutures.Add(MoveTemp(ProfileFuture));
-			}
-		}
-		else
-		{
-			UE_LOG(LogFutureverseUBFController, Warning, TEXT("UAssetRegisterUBFItem::HandleGetAssetLinks Failed to get NFTAssetLink for Asset: %s:%s"), *Asset.CollectionId, *Asset.TokenId);
+			UE_LOG(LogFutureverseUBFController, Error, TEXT("UAssetRegisterUBFItem::LoadProfileURI UFutureverseUBFControllerSettings was null. Could not fetch asset profile URI"));
+			Promise->SetValue(false);
+			return;
 		}
 		
-		LoadActionUtils::WhenAll(ProfileFutures).Next([WeakThis, Promise, Relationships](const TArray<bool>& Results)
-		{
-			const bool bAllSuccess = !Results.Contains(false);
+		FString LegacyProfileURI = FPaths::Combine(Settings->GetDefaultAssetProfilePath(),
+		FString::Printf(TEXT("%s.json"), *WeakThis->ItemData.ContractID));
+		LegacyProfileURI = LegacyProfileURI.Replace(TEXT(" "), TEXT(""));
+		WeakThis->ProfileURI = LegacyProfileURI;
 
-			if (!WeakThis.IsValid())
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UAssetRegisterUBFItem::LoadProfileURI using legacy assetprofile URI %s"), *WeakThis->ProfileURI);
+		Promise->SetValue(true);
+	};
+	
+	const FString CollectionID = ItemData.CollectionID;
+	const FString TokenID = ItemData.TokenID;
+	const FString AssetKey = FString::Printf(TEXT("%s:%s"), *CollectionID, *TokenID);
+	
+	// the direct query tells a missing profile from an error and remembers the former, so later renders of this asset
+	// go straight to the legacy URI
+	const auto QueryAssetRegister = [WeakThis, Promise, UseLegacyProfileURI, CollectionID, TokenID]()
+	{
+		FLoadAssetProfilesAction::GetAssetProfileURLFromAssetRegister(CollectionID, TokenID).Next([WeakThis, Promise, UseLegacyProfileURI]
+			(const FString& AssetProfileURL)
+		{
+			if (AssetProfileURL.IsEmpty() || !WeakThis.IsValid())
 			{
-				Promise->SetValue(false);
+				UseLegacyProfileURI();
 				return;
 			}
 			
-			WeakThis->EnsureProfileURILoaded().Next([WeakThis, Promise, Relationships, bAllSuccess](bool bResult)
+			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UAssetRegisterUBFItem::LoadProfileURI got assetprofile URI %s"), *AssetProfileURL);
+			WeakThis->ProfileURI = AssetProfileURL;
+			Promise->SetValue(true);
+		});
+	};
+	
+	FNegativeCache& NegativeCache = FControllerDownloadManager::GetInstance()->GetNegativeCache();
+	if (NegativeCache.Contains(EUBFNegativeCacheScope::AssetRegister, AssetKey))
+	{
+		UseLegacyProfileURI();
+		return Future;
+	}
+	
+	// the querying library failed for this asset before, asking it again would only add a second query per render
+	if (NegativeCache.Contains(EUBFNegativeCacheScope::AssetRegisterLibrary, AssetKey))
+	{
+		QueryAssetRegister();
+		return Future;
+	}
+	
+	TFuture<FLoadJsonResult> LibraryQuery;
+	FTrafficArchive& TrafficArchive = FControllerDownloadManager::GetInstance()->GetTrafficArchive();
+	if (!TrafficArchive.IsActive())
+	{
+		LibraryQuery = UAssetRegisterQueryingLibrary::GetAssetProfile(TokenID, CollectionID);
+	}
+	else
+	{
+		LibraryQuery = TrafficArchive.Exchange(EUBFTrafficKind::AssetRegister, FString::Printf(TEXT("GetAssetProfile %s"), *AssetKey),
+			[&CollectionID, &TokenID]()
+		{
+			return UAssetRegisterQueryingLibrary::GetAssetProfile(TokenID, CollectionID).Next([](const FLoadJsonResult& Result)
 			{
-				if (!WeakThis.IsValid())
-				{
-					Promise->SetValue(false);
-					return;
-				}
-				
-				TArray<FUBFContextTreeData> ContextTree;
-				ContextTree.Add(FUBFContextTreeData(WeakThis->ItemData.AssetID, *Relationships.Get(), WeakThis->GetProfileURI()));
-				WeakThis->SetContextTree(ContextTree);
-				
-				Promise->SetValue(bAllSuccess && bResult);
+				return FUBFTrafficResponse::FromString(Result.bSuccess, Result.Value);
 			});
+		})
+		.Next([](const FUBFTrafficResponse& Response)
+		{
+			FLoadJsonResult Result;
+			Result.bSuccess = Response.bSuccess;
+			Result.Value = Response.GetPayloadAsString();
+			return Result;
 		});
-	});
-
-	return Future;
-}
-
-TFuture<bool> UAssetRegisterUBFItem::LoadProfileURI()
-{
-	TSharedPtr<TPromise<bool>> Promise = MakeShared<TPromise<bool>>();
-	TFuture<bool> Future = Promise->GetFuture();
-
-	TWeakObjectPtr<UAssetRegisterUBFItem> WeakThis = this;
+	}
 	
-	UAssetRegisterQueryingLibrary::GetAssetProfile(ItemData.TokenID, ItemData.CollectionID).Next([WeakThis, Promise]
-		(const FLoadJsonResult& Result)
+	LibraryQuery.Next([WeakThis, Promise, QueryAssetRegister, AssetKey](const FLoadJsonResult& Result)
 	{
 		if (!WeakThis.IsValid())
 		{
@@ -110,34 +122,18 @@ TFuture<bool> UAssetRegisterUBFItem::LoadProfileURI()
 			return;
 		}
 		
-		// some items don't have profile uris uploaded to AssetRegister yet
-		if (!Result.bSuccess)
-		{
-			const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
-			check(Settings);
-			if (Settings)
-			{
-				FString LegacyProfileURI = FPaths::Combine(Settings->GetDefaultAssetProfilePath(),
-				FString::Printf(TEXT("%s.json"), *WeakThis->ItemData.ContractID));
-				LegacyProfileURI = LegacyProfileURI.Replace(TEXT(" "), TEXT(""));
-				WeakThis->ProfileURI = LegacyProfileURI;
-
-				UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UAssetRegisterUBFItem::LoadProfileURI using legacy assetprofile URI %s"), *WeakThis->ProfileURI);
-			}
-			else
-			{
-				UE_LOG(LogFutureverseUBFController, Error, TEXT("UAssetRegisterUBFItem::LoadProfileURI UFutureverseUBFControllerSettings was null. Could not fetch asset profile URI"));
-				Promise->SetValue(false);
-				return;
-			}
-		}
-		else
+		if (Result.bSuccess)
 		{
 			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UAssetRegisterUBFItem::LoadProfileURI got assetprofile URI %s"), *Result.Value);
 			WeakThis->ProfileURI = Result.Value;
+			Promise->SetValue(true);
+			return;
 		}
-	
-		Promise->SetValue(true);
+		
+		// the querying library doesn't say why it failed, the direct query finds out. Until the entry expires, later
+		// renders of this asset only send the direct query
+		FControllerDownloadManager::GetInstance()->GetNegativeCache().Add(EUBFNegativeCacheScope::AssetRegisterLibrary, AssetKey);
+		QueryAssetRegister();
 	});
 
 	return Future;
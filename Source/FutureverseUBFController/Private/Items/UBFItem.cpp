@@ -3,13 +3,46 @@
 
 #include "Items/UBFItem.h"
 
+#include "MetadataJsonUtils.h"
+#include "Hash/CityHash.h"
+
+SIZE_T FUBFItemData::GetAllocatedSize() const
+{
+	return AssetID.GetAllocatedSize() + AssetName.GetAllocatedSize() + ContractID.GetAllocatedSize()
+		+ TokenID.GetAllocatedSize() + CollectionID.GetAllocatedSize() + MetadataJson.GetAllocatedSize()
+		+ MetadataJsonUtils::GetApproximateAllocatedSize(MetadataJsonObject.JsonObject);
+}
+
 void UUBFItem::InitializeFromRenderData(const FUBFRenderData& RenderData)
 {
 	ItemData.AssetID = RenderData.AssetID;
 	ItemData.MetadataJson = RenderData.MetadataJson;
+	MetadataHash = HashMetadataJson(ItemData.MetadataJson);
 	ContextTree = RenderData.ContextTree;
 }
 
+uint64 UUBFItem::HashMetadataJson(const FString& MetadataJson)
+{
+	const FTCHARToUTF8 Utf8(*MetadataJson);
+	return CityHash64(Utf8.Get(), Utf8.Length());
+}
+
+SIZE_T UUBFItem::GetApproximateMemoryUsage() const
+{
+	SIZE_T Size = GetClass()->GetStructureSize() + ItemData.GetAllocatedSize() + ProfileURI.GetAllocatedSize() + ContextTree.GetAllocatedSize();
+	for (const FUBFContextTreeData& ContextTreeData : ContextTree)
+	{
+		Size += ContextTreeData.RootNodeID.GetAllocatedSize() + ContextTreeData.ProfileURI.GetAllocatedSize()
+			+ ContextTreeData.Relationships.GetAllocatedSize();
+		for (const FUBFContextTreeRelationshipData& Relationship : ContextTreeData.Relationships)
+		{
+			Size += Relationship.RelationshipID.GetAllocatedSize() + Relationship.ChildAssetID.GetAllocatedSize()
+				+ Relationship.ProfileURI.GetAllocatedSize();
+		}
+	}
+	return Size;
+}
+
 bool UUBFItem::IsContextTreeLoaded() const
 {
 	return !ContextTree.IsEmpty();
@@ -0,0 +1,353 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "Items/UBFItemStore.h"
+
+#include "AssetIdUtils.h"
+#include "Hash/CityHash.h"
+
+namespace
+{
+	// pool bytes lost to replaced strings before Remove compacts on its own
+	constexpr SIZE_T AutoCompactWastedBytes = 64 * 1024;
+}
+
+int32 FUBFItemStore::Add(const FUBFItemData& ItemData, const FString& ProfileURI)
+{
+	const FTCHARToUTF8 AssetId(*ItemData.AssetID);
+	const FUtf8StringView AssetIdView(reinterpret_cast<const UTF8CHAR*>(AssetId.Get()), AssetId.Length());
+	const uint32 Hash = HashString(AssetIdView);
+
+	const int32 SlotIndex = FindSlot(AssetIdView, Hash);
+	if (SlotIndex != INDEX_NONE)
+	{
+		const int32 Index = Slots[SlotIndex];
+		SetRow(Index, ItemData, ProfileURI);
+		RefreshFacade(Index);
+		return Index;
+	}
+
+	const int32 Index = Num();
+	for (TArray<FStringRef>& Column : Columns)
+	{
+		Column.AddDefaulted();
+	}
+	AssetIdHashes.Add(Hash);
+	CollectionHashes.AddDefaulted();
+	ContractHashes.AddDefaulted();
+	MetadataHashes.AddDefaulted();
+	Facades.AddDefaulted();
+
+	SetRow(Index, ItemData, ProfileURI);
+	InsertSlot(Index);
+	return Index;
+}
+
+bool FUBFItemStore::Remove(const FString& AssetId)
+{
+	const FTCHARToUTF8 AssetIdUtf8(*AssetId);
+	const FUtf8StringView AssetIdView(reinterpret_cast<const UTF8CHAR*>(AssetIdUtf8.Get()), AssetIdUtf8.Length());
+
+	const int32 SlotIndex = FindSlot(AssetIdView, HashString(AssetIdView));
+	if (SlotIndex == INDEX_NONE)
+		return false;
+
+	const int32 Index = Slots[SlotIndex];
+	Slots[SlotIndex] = RemovedSlot;
+
+	for (const TArray<FStringRef>& Column : Columns)
+	{
+		WastedBytes += Column[Index].Length;
+	}
+
+	// the last row moves into the hole so the columns stay dense
+	const int32 LastIndex = Num() - 1;
+	if (Index != LastIndex)
+	{
+		const int32 LastSlotIndex = FindSlot(GetView(LastIndex, EColumn::AssetId), AssetIdHashes[LastIndex]);
+		check(LastSlotIndex != INDEX_NONE);
+		Slots[LastSlotIndex] = Index;
+
+		for (TArray<FStringRef>& Column : Columns)
+		{
+			Column[Index] = Column[LastIndex];
+		}
+		AssetIdHashes[Index] = AssetIdHashes[LastIndex];
+		CollectionHashes[Index] = CollectionHashes[LastIndex];
+		ContractHashes[Index] = ContractHashes[LastIndex];
+		MetadataHashes[Index] = MetadataHashes[LastIndex];
+		Facades[Index] = Facades[LastIndex];
+	}
+
+	for (TArray<FStringRef>& Column : Columns)
+	{
+		Column.Pop();
+	}
+	AssetIdHashes.Pop();
+	CollectionHashes.Pop();
+	ContractHashes.Pop();
+	MetadataHashes.Pop();
+	Facades.Pop();
+
+	if (WastedBytes > AutoCompactWastedBytes && WastedBytes > static_cast<SIZE_T>(StringPool.Num()) / 2)
+	{
+		Compact();
+	}
+	return true;
+}
+
+void FUBFItemStore::Empty()
+{
+	StringPool.Empty();
+	WastedBytes = 0;
+	for (TArray<FStringRef>& Column : Columns)
+	{
+		Column.Empty();
+	}
+	AssetIdHashes.Empty();
+	CollectionHashes.Empty();
+	ContractHashes.Empty();
+	MetadataHashes.Empty();
+	Facades.Empty();
+	Slots.Empty();
+	NumUsedSlots = 0;
+}
+
+void FUBFItemStore::Reserve(int32 NumItems, int32 NumStringBytes)
+{
+	StringPool.Reserve(NumStringBytes);
+	for (TArray<FStringRef>& Column : Columns)
+	{
+		Column.Reserve(NumItems);
+	}
+	AssetIdHashes.Reserve(NumItems);
+	CollectionHashes.Reserve(NumItems);
+	ContractHashes.Reserve(NumItems);
+	MetadataHashes.Reserve(NumItems);
+	Facades.Reserve(NumItems);
+
+	const int32 Capacity = FMath::RoundUpToPowerOfTwo(FMath::Max(16, NumItems * 2));
+	if (Capacity > Slots.Num())
+	{
+		Rehash(Capacity);
+	}
+}
+
+int32 FUBFItemStore::FindIndex(const FString& AssetId) const
+{
+	const FTCHARToUTF8 AssetIdUtf8(*AssetId);
+	const FUtf8StringView AssetIdView(reinterpret_cast<const UTF8CHAR*>(AssetIdUtf8.Get()), AssetIdUtf8.Length());
+
+	const int32 SlotIndex = FindSlot(AssetIdView, HashString(AssetIdView));
+	return SlotIndex != INDEX_NONE ? Slots[SlotIndex] : INDEX_NONE;
+}
+
+FUtf8StringView FUBFItemStore::GetView(int32 Index, EColumn Column) const
+{
+	const FStringRef& Ref = Columns[static_cast<int32>(Column)][Index];
+	return FUtf8StringView(StringPool.GetData() + Ref.Offset, Ref.Length);
+}
+
+void FUBFItemStore::SetProfileURI(int32 Index, const FString& ProfileURI)
+{
+	SetString(Index, EColumn::ProfileURI, ProfileURI);
+	RefreshFacade(Index);
+}
+
+void FUBFItemStore::FindByCollection(const FString& CollectionId, TArray<int32>& OutIndices) const
+{
+	FindByHash(CollectionHashes, EColumn::CollectionId, CollectionId, OutIndices);
+}
+
+void FUBFItemStore::FindByContract(const FString& ContractId, TArray<int32>& OutIndices) const
+{
+	FindByHash(ContractHashes, EColumn::ContractId, ContractId, OutIndices);
+}
+
+FUBFItemData FUBFItemStore::MakeItemData(int32 Index) const
+{
+	const FString MetadataJson = GetString(Index, EColumn::MetadataJson);
+
+	FJsonObjectWrapper MetadataJsonObject;
+	if (!MetadataJson.IsEmpty())
+	{
+		MetadataJsonObject.JsonObjectFromString(MetadataJson);
+	}
+
+	return FUBFItemData(GetString(Index, EColumn::AssetId), GetString(Index, EColumn::AssetName), GetString(Index, EColumn::ContractId),
+		GetString(Index, EColumn::TokenId), GetString(Index, EColumn::CollectionId), MetadataJson, MetadataJsonObject);
+}
+
+UUBFItem* FUBFItemStore::GetItem(int32 Index, UObject* Outer, TSubclassOf<UUBFItem> ItemClass)
+{
+	if (!Facades.IsValidIndex(Index))
+		return nullptr;
+
+	if (UUBFItem* Facade = Facades[Index].Get())
+		return Facade;
+
+	UUBFItem* Facade = NewObject<UUBFItem>(Outer ? Outer : GetTransientPackage(), ItemClass ? ItemClass.Get() : UUBFItem::StaticClass());
+	Facade->SetItemData(MakeItemData(Index));
+	Facade->SetAssetProfileURI(GetString(Index, EColumn::ProfileURI));
+	Facades[Index] = Facade;
+	return Facade;
+}
+
+void FUBFItemStore::Compact()
+{
+	TArray<UTF8CHAR> OldPool = MoveTemp(StringPool);
+	StringPool.Reserve(OldPool.Num() - WastedBytes);
+
+	for (TArray<FStringRef>& Column : Columns)
+	{
+		for (FStringRef& Ref : Column)
+		{
+			if (Ref.Length == 0)
+				continue;
+
+			const uint32 NewOffset = StringPool.Num();
+			StringPool.Append(OldPool.GetData() + Ref.Offset, Ref.Length);
+			Ref.Offset = NewOffset;
+		}
+	}
+	WastedBytes = 0;
+}
+
+SIZE_T FUBFItemStore::GetAllocatedSize() const
+{
+	SIZE_T Size = StringPool.GetAllocatedSize() + AssetIdHashes.GetAllocatedSize() + CollectionHashes.GetAllocatedSize()
+		+ ContractHashes.GetAllocatedSize() + MetadataHashes.GetAllocatedSize() + Facades.GetAllocatedSize() + Slots.GetAllocatedSize();
+	for (const TArray<FStringRef>& Column : Columns)
+	{
+		Size += Column.GetAllocatedSize();
+	}
+	return Size;
+}
+
+FUBFItemStore::FStringRef FUBFItemStore::AddString(const FUtf8StringView& Value)
+{
+	FStringRef Ref;
+	if (Value.IsEmpty())
+		return Ref;
+
+	Ref.Offset = StringPool.Num();
+	Ref.Length = Value.Len();
+	StringPool.Append(Value.GetData(), Value.Len());
+	return Ref;
+}
+
+void FUBFItemStore::SetString(int32 Index, EColumn Column, const FString& Value)
+{
+	const FTCHARToUTF8 Utf8(*Value);
+	const FUtf8StringView View(reinterpret_cast<const UTF8CHAR*>(Utf8.Get()), Utf8.Length());
+
+	// most updates leave ids untouched, don't grow the pool for them
+	if (GetView(Index, Column).Equals(View, ESearchCase::CaseSensitive))
+		return;
+
+	FStringRef& Ref = Columns[static_cast<int32>(Column)][Index];
+	WastedBytes += Ref.Length;
+	Ref = AddString(View);
+}
+
+void FUBFItemStore::SetRow(int32 Index, const FUBFItemData& ItemData, const FString& ProfileURI)
+{
+	SetString(Index, EColumn::AssetId, ItemData.AssetID);
+	SetString(Index, EColumn::AssetName, ItemData.AssetName);
+	SetString(Index, EColumn::ContractId, ItemData.ContractID);
+	SetString(Index, EColumn::TokenId, ItemData.TokenID);
+	SetString(Index, EColumn::CollectionId, ItemData.CollectionID);
+	SetString(Index, EColumn::ProfileURI, ProfileURI);
+	SetString(Index, EColumn::MetadataJson, ItemData.MetadataJson);
+
+	const FTCHARToUTF8 CollectionId(*AssetIdUtils::FormatAssetId(ItemData.CollectionID));
+	const FTCHARToUTF8 ContractId(*AssetIdUtils::FormatAssetId(ItemData.ContractID));
+	CollectionHashes[Index] = HashString(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(CollectionId.Get()), CollectionId.Length()));
+	ContractHashes[Index] = HashString(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(ContractId.Get()), ContractId.Length()));
+	// same hash as UUBFItem::GetMetadataHash so refreshes can compare against either
+	MetadataHashes[Index] = UUBFItem::HashMetadataJson(ItemData.MetadataJson);
+}
+
+void FUBFItemStore::RefreshFacade(int32 Index)
+{
+	if (UUBFItem* Facade = Facades[Index].Get())
+	{
+		Facade->SetItemData(MakeItemData(Index));
+		Facade->SetAssetProfileURI(GetString(Index, EColumn::ProfileURI));
+	}
+}
+
+void FUBFItemStore::FindByHash(const TArray<uint32>& Hashes, EColumn Column, const FString& Value, TArray<int32>& OutIndices) const
+{
+	const FString FormattedValue = AssetIdUtils::FormatAssetId(Value);
+	const FTCHARToUTF8 Utf8(*FormattedValue);
+	const uint32 Hash = HashString(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Utf8.Get()), Utf8.Length()));
+
+	for (int32 Index = 0; Index < Hashes.Num(); ++Index)
+	{
+		// only rows that pass the hash scan touch the string pool
+		if (Hashes[Index] == Hash && AssetIdUtils::FormatAssetId(GetString(Index, Column)) == FormattedValue)
+		{
+			OutIndices.Add(Index);
+		}
+	}
+}
+
+uint32 FUBFItemStore::HashString(const FUtf8StringView& Value)
+{
+	return CityHash32(reinterpret_cast<const char*>(Value.GetData()), Value.Len());
+}
+
+int32 FUBFItemStore::FindSlot(const FUtf8StringView& AssetId, uint32 Hash) const
+{
+	if (Slots.IsEmpty())
+		return INDEX_NONE;
+
+	const uint32 Mask = Slots.Num() - 1;
+	for (uint32 Probe = 0, SlotIndex = Hash & Mask; Probe < static_cast<uint32>(Slots.Num()); ++Probe, SlotIndex = (SlotIndex + 1) & Mask)
+	{
+		const int32 Index = Slots[SlotIndex];
+		if (Index == EmptySlot)
+			return INDEX_NONE;
+
+		if (Index >= 0 && AssetIdHashes[Index] == Hash && GetView(Index, EColumn::AssetId).Equals(AssetId, ESearchCase::CaseSensitive))
+			return SlotIndex;
+	}
+	return INDEX_NONE;
+}
+
+void FUBFItemStore::InsertSlot(int32 Index)
+{
+	// removed slots count as used until the next rehash, keep the load factor at or under one half
+	if ((NumUsedSlots + 1) * 2 > Slots.Num())
+	{
+		Rehash(FMath::Max(16, static_cast<int32>(FMath::RoundUpToPowerOfTwo(Num() * 2))));
+		return;
+	}
+
+	const uint32 Mask = Slots.Num() - 1;
+	uint32 SlotIndex = AssetIdHashes[Index] & Mask;
+	while (Slots[SlotIndex] >= 0)
+	{
+		SlotIndex = (SlotIndex + 1) & Mask;
+	}
+
+	NumUsedSlots += Slots[SlotIndex] == EmptySlot ? 1 : 0;
+	Slots[SlotIndex] = Index;
+}
+
+void FUBFItemStore::Rehash(int32 NewCapacity)
+{
+	Slots.Init(EmptySlot, NewCapacity);
+	NumUsedSlots = Num();
+
+	const uint32 Mask = NewCapacity - 1;
+	for (int32 Index = 0; Index < Num(); ++Index)
+	{
+		uint32 SlotIndex = AssetIdHashes[Index] & Mask;
+		while (Slots[SlotIndex] != EmptySlot)
+		{
+			SlotIndex = (SlotIndex + 1) & Mask;
+		}
+		Slots[SlotIndex] = Index;
+	}
+}
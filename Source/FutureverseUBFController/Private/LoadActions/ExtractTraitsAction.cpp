@@ -0,0 +1,202 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "ExtractTraitsAction.h"
+
+#include "BlueprintUBFLibrary.h"
+#include "FutureverseAssetLoadData.h"
+#include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerStats.h"
+#include "FutureverseUBFControllerSubsystem.h"
+#include "Async/Async.h"
+#include "ExecutionSets/ExecutionSetData.h"
+#include "ExecutionSets/ExecutionSetResult.h"
+
+TFuture<FUBFTraitExtractionBatchResult> FExtractTraitsAction::TryExtractTraits(UFutureverseUBFControllerSubsystem* InSubsystem,
+	USceneComponent* InRootComponent, const TArray<FUBFTraitExtractionRequest>& InRequests, int32 InMaxParallelism)
+{
+	check(IsInGameThread());
+
+	Promise = MakeShared<TPromise<FUBFTraitExtractionBatchResult>>();
+	TFuture<FUBFTraitExtractionBatchResult> Future = Promise->GetFuture();
+
+	Subsystem = InSubsystem;
+	RootComponent = InRootComponent;
+	Requests = InRequests;
+	MaxParallelism = FMath::Max(1, InMaxParallelism);
+	StartTime = FPlatformTime::Seconds();
+
+	BatchResult.Results.SetNum(Requests.Num());
+	for (int32 Index = 0; Index < Requests.Num(); ++Index)
+	{
+		BatchResult.Results[Index].AssetID = Requests[Index].AssetID;
+	}
+
+	if (Requests.IsEmpty())
+	{
+		Promise->SetValue(BatchResult);
+		return Future;
+	}
+
+	StartPendingItems();
+	return Future;
+}
+
+void FExtractTraitsAction::StartPendingItems()
+{
+	check(IsInGameThread());
+
+	// items that complete synchronously (cached, no parsing graph) call back in here, the outer loop picks up their slot instead of recursing
+	if (bStartingItems) return;
+	TGuardValue<bool> StartingItemsGuard(bStartingItems, true);
+
+	while (true)
+	{
+		int32 Index = INDEX_NONE;
+		{
+			FScopeLock Lock(&CriticalSection);
+			if (NumInFlight >= MaxParallelism || NextIndex >= Requests.Num())
+				break;
+
+			Index = NextIndex++;
+			NumInFlight++;
+		}
+		StartItem(Index);
+	}
+}
+
+void FExtractTraitsAction::StartItem(int32 Index)
+{
+	if (!Subsystem.IsValid() || !Subsystem->IsSubsystemValid())
+	{
+		CompleteItem(Index, false, {});
+		return;
+	}
+
+	const FUBFTraitExtractionRequest& Request = Requests[Index];
+	FFutureverseAssetLoadData LoadData(Request.AssetID, Request.ProfileURI);
+	LoadData.VariantID = Request.VariantID;
+
+	TSharedPtr<FExtractTraitsAction> SharedThis = AsShared();
+	Subsystem->EnsureAssetDataLoaded(LoadData).Next([SharedThis, Index](const FLoadAssetProfileResult& Result)
+	{
+		FUBFContinuationScope ContinuationScope;
+		if (!Result.bSuccess || !Result.Value.IsValid())
+		{
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("FExtractTraitsAction::StartItem failed to load asset data for %s"), *SharedThis->Requests[Index].AssetID);
+			SharedThis->CompleteItem(Index, false, {});
+			return;
+		}
+
+		const FString ParsingGraphId = Result.Value->GetParsingBlueprintId(SharedThis->Requests[Index].VariantID);
+		if (ParsingGraphId.IsEmpty())
+		{
+			// nothing to parse, the item simply has no traits
+			SharedThis->CompleteItem(Index, true, {});
+			return;
+		}
+
+		// profile and catalog loads can complete on any thread, UBF execution happens on the game thread
+		if (IsInGameThread())
+		{
+			SharedThis->ExecuteParsingGraph(Index, ParsingGraphId);
+		}
+		else
+		{
+			AsyncTask(ENamedThreads::GameThread, [SharedThis, Index, ParsingGraphId]()
+			{
+				SharedThis->ExecuteParsingGraph(Index, ParsingGraphId);
+			});
+		}
+	});
+}
+
+void FExtractTraitsAction::ExecuteParsingGraph(int32 Index, const FString& ParsingGraphId)
+{
+	if (!RootComponent.IsValid())
+	{
+		CompleteItem(Index, false, {});
+		return;
+	}
+
+	TSharedPtr<FExtractTraitsAction> SharedThis = AsShared();
+	const double StartTime = FUBFRuntimeStats::Get().BeginLoad(EUBFLoadStage::ParsingGraph);
+	const auto OnParsingGraphComplete = [SharedThis, Index, StartTime](bool bSuccess, const TSharedPtr<UBF::FExecutionSetResult>& Result)
+	{
+		FUBFContinuationScope ContinuationScope;
+		FUBFRuntimeStats::Get().EndLoad(EUBFLoadStage::ParsingGraph, StartTime, bSuccess && Result.IsValid());
+		if (!Result.IsValid())
+		{
+			SharedThis->CompleteItem(Index, false, {});
+			return;
+		}
+
+		// outputs can wrap UObjects, so they are only converted on the game thread
+		if (IsInGameThread())
+		{
+			SharedThis->ConvertOutputs(Index, bSuccess, *Result);
+		}
+		else
+		{
+			AsyncTask(ENamedThreads::GameThread, [SharedThis, Index, bSuccess, Result]()
+			{
+				SharedThis->ConvertOutputs(Index, bSuccess, *Result);
+			});
+		}
+	};
+
+	UBF::FExecutionInstanceData ParsingBlueprintData(ParsingGraphId);
+	ParsingBlueprintData.AddInputs({{TEXT("metadata"), UBF::FDynamicHandle::String(Requests[Index].MetadataJson)}});
+	TSharedPtr<UBF::FExecutionSetData> ExecutionSetData = MakeShared<UBF::FExecutionSetData>(RootComponent.Get(), TArray{ParsingBlueprintData}, OnParsingGraphComplete);
+
+	UBF::Execute(ParsingBlueprintData.GetInstanceId(), ExecutionSetData);
+}
+
+void FExtractTraitsAction::ConvertOutputs(int32 Index, bool bSuccess, const UBF::FExecutionSetResult& Result)
+{
+	check(IsInGameThread());
+
+	const TMap<FString, UBF::FDynamicHandle> Outputs = Result.GetAllOutputs();
+	TMap<FString, FString> Traits;
+	Traits.Reserve(Outputs.Num());
+	for (const auto& Output : Outputs)
+	{
+		Traits.Add(Output.Key, Output.Value.ToString());
+	}
+	CompleteItem(Index, bSuccess, MoveTemp(Traits));
+}
+
+void FExtractTraitsAction::CompleteItem(int32 Index, bool bSuccess, TMap<FString, FString>&& Traits)
+{
+	bool bBatchComplete = false;
+	{
+		FScopeLock Lock(&CriticalSection);
+		FUBFTraitExtractionResult& Result = BatchResult.Results[Index];
+		Result.bSuccess = bSuccess;
+		Result.Traits = MoveTemp(Traits);
+
+		BatchResult.NumSucceeded += bSuccess ? 1 : 0;
+		NumInFlight--;
+		NumCompleted++;
+		bBatchComplete = NumCompleted == Requests.Num();
+	}
+
+	if (bBatchComplete)
+	{
+		BatchResult.Seconds = FPlatformTime::Seconds() - StartTime;
+		UE_LOG(LogFutureverseUBFController, Log, TEXT("FExtractTraitsAction extracted traits for %d/%d items in %.2fs (%.1f items/s, parallelism %d)"),
+			BatchResult.NumSucceeded, BatchResult.Results.Num(), BatchResult.Seconds, BatchResult.GetItemsPerSecond(), MaxParallelism);
+
+		Promise->SetValue(MoveTemp(BatchResult));
+		return;
+	}
+
+	TSharedPtr<FExtractTraitsAction> SharedThis = AsShared();
+	if (IsInGameThread())
+	{
+		StartPendingItems();
+	}
+	else
+	{
+		AsyncTask(ENamedThreads::GameThread, [SharedThis]() { SharedThis->StartPendingItems(); });
+	}
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ExecutionSets/ExecutionSetResult.h"
+#include "Traits/UBFTraitExtraction.h"
+
+class UFutureverseUBFControllerSubsystem;
+class USceneComponent;
+
+/**
+ * Runs the parsing graph for a batch of items with at most MaxParallelism items between profile load and graph completion.
+ * Graphs are executed and their outputs converted on the game thread against a transient root component, since outputs
+ * can reference UObjects. Only profile and catalog loads run off the game thread, so throughput is bound by the game thread.
+ */
+class FExtractTraitsAction : public TSharedFromThis<FExtractTraitsAction>
+{
+public:
+	TFuture<FUBFTraitExtractionBatchResult> TryExtractTraits(UFutureverseUBFControllerSubsystem* Subsystem, USceneComponent* RootComponent,
+		const TArray<FUBFTraitExtractionRequest>& InRequests, int32 InMaxParallelism);
+
+private:
+	// Starts items until MaxParallelism are in flight, game thread only
+	void StartPendingItems();
+	void StartItem(int32 Index);
+	void ExecuteParsingGraph(int32 Index, const FString& ParsingGraphId);
+	// Turns the graph outputs into trait strings, game thread only
+	void ConvertOutputs(int32 Index, bool bSuccess, const UBF::FExecutionSetResult& Result);
+	void CompleteItem(int32 Index, bool bSuccess, TMap<FString, FString>&& Traits);
+	
+	TWeakObjectPtr<UFutureverseUBFControllerSubsystem> Subsystem;
+	TWeakObjectPtr<USceneComponent> RootComponent;
+	TArray<FUBFTraitExtractionRequest> Requests;
+	int32 MaxParallelism = 1;
+
+	TSharedPtr<TPromise<FUBFTraitExtractionBatchResult>> Promise;
+	FUBFTraitExtractionBatchResult BatchResult;
+	double StartTime = 0.0;
+
+	FCriticalSection CriticalSection;
+	int32 NextIndex = 0;
+	int32 NumInFlight = 0;
+	int32 NumCompleted = 0;
+	bool bStartingItems = false;
+};
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "UBFRenderDeadline.h"
+#include "Containers/Ticker.h"
+
 namespace LoadActionUtils
 {
 	template<typename T>
@@ -32,4 +35,45 @@ namespace LoadActionUtils
 
 		return Promise->GetFuture();
 	}
+
+	// Resolves with the result of Future, or with an unset optional once Deadline expires if that comes first.
+	// Future keeps running after the deadline, its result is dropped
+	template<typename T>
+	TFuture<TOptional<T>> WithDeadline(TFuture<T>&& Future, const FUBFRenderDeadline& Deadline)
+	{
+		if (!Deadline.IsSet())
+		{
+			return Future.Next([](const T& Result) { return TOptional<T>(Result); });
+		}
+
+		struct FRace
+		{
+			FCriticalSection Lock;
+			bool bDone = false;
+			TPromise<TOptional<T>> Promise;
+
+			void Finish(TOptional<T>&& Result)
+			{
+				{
+					FScopeLock ScopeLock(&Lock);
+					if (bDone)
+						return;
+					bDone = true;
+				}
+				Promise.SetValue(MoveTemp(Result));
+			}
+		};
+		
+		TSharedRef<FRace> Race = MakeShared<FRace>();
+		TFuture<TOptional<T>> RaceFuture = Race->Promise.GetFuture();
+		
+		Future.Next([Race](const T& Result) { Race->Finish(TOptional<T>(Result)); });
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Race](float)
+		{
+			Race->Finish(TOptional<T>());
+			return false;
+		}), static_cast<float>(Deadline.GetRemainingSeconds()));
+		
+		return RaceFuture;
+	}
 }
\ No newline at end of file
@@ -3,60 +3,32 @@
 #include "LoadActions/LoadAssetCatalogAction.h"
 
 #include "FutureverseUBFControllerLog.h"
-#include "GlobalArtifactProvider/DownloadRequestManager.h"
-#include "Util/CatalogUtils.h"
+#include "FutureverseUBFControllerStats.h"
+#include "Downloads/ControllerDownloadManager.h"
 
-TFuture<bool> FLoadAssetCatalogAction::TryLoadAssetCatalog(const FAssetProfile& AssetProfile,
-															const FFutureverseAssetLoadData& InLoadData, const TSharedPtr<FMemoryCacheLoader>& MemoryCacheLoader)
+TFuture<bool> FLoadAssetCatalogAction::TryLoadAssetCatalog(const FAssetProfilePtr& AssetProfile,
+															const FFutureverseAssetLoadData& InLoadData, const TSharedPtr<FMemoryCacheLoader>& MemoryCacheLoader,
+															const TSharedPtr<FSharedCatalogStore>& InCatalogStore)
 {
 	Promise = MakeShareable(new TPromise<bool>());
 	TFuture<bool> Future = Promise->GetFuture();
 
 	bBlockCompletion = true;
 
-	TSharedPtr<FLoadAssetCatalogAction> SharedThis = AsShared();
 	AssetProfileLoaded = AssetProfile;
 	LoadData = InLoadData;
+	CatalogStore = InCatalogStore;
+	
+	const FAssetProfileVariant* Variant = AssetProfile.IsValid() ? AssetProfile->FindVariant(LoadData.VariantID) : nullptr;
 	
-	if (!AssetProfile.GetRenderBlueprintId(LoadData.VariantID).IsEmpty() && !AssetProfile.GetRenderCatalogUri(LoadData.VariantID).IsEmpty())
+	if (Variant && !Variant->GetRenderBlueprintId().IsEmpty() && !Variant->GetRenderCatalogUri().IsEmpty())
 	{
-		SharedThis->AddPendingLoad();
-		
-		FDownloadRequestManager::GetInstance()->LoadStringFromURI(TEXT("Catalog"),
-			AssetProfile.GetRenderCatalogUri(LoadData.VariantID))
-			.Next([SharedThis, AssetProfile, this](const UBF::FLoadStringResult& LoadResult)
-		{
-			if (!LoadResult.bSuccess)
-			{
-				UE_LOG(LogFutureverseUBFController, Warning, TEXT("Failed to load render catalog from %s"), *AssetProfile.GetRenderCatalogUri(LoadData.VariantID));
-				SharedThis->CompletePendingLoad();
-				return;
-			}
-				
-			CatalogUtils::ParseCatalog(LoadResult.Value, SharedThis->RenderCatalogMap);
-			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("Adding rendering catalog from %s"), *AssetProfile.GetRenderCatalogUri(LoadData.VariantID));
-			SharedThis->CompletePendingLoad();
-		});
+		LoadCatalog(Variant->GetRenderCatalogUri(), TEXT("render"), RenderCatalog);
 	}
 
-	if (!AssetProfile.GetParsingBlueprintId(LoadData.VariantID).IsEmpty() && !AssetProfile.GetParsingCatalogUri(LoadData.VariantID).IsEmpty())
+	if (Variant && !Variant->GetParsingBlueprintId().IsEmpty() && !Variant->GetParsingCatalogUri().IsEmpty())
 	{
-		SharedThis->AddPendingLoad();
-		
-		FDownloadRequestManager::GetInstance()->LoadStringFromURI(TEXT("Catalog"), AssetProfile.GetParsingCatalogUri(LoadData.VariantID))
-			.Next([SharedThis, AssetProfile, this](const UBF::FLoadStringResult& LoadResult)
-		{
-			if (!LoadResult.bSuccess)
-			{
-				UE_LOG(LogFutureverseUBFController, Warning, TEXT("Failed to load parsing catalog from %s"), *AssetProfile.GetParsingCatalogUri(LoadData.VariantID));
-				SharedThis->CompletePendingLoad();
-				return;
-			}
-						
-			CatalogUtils::ParseCatalog(LoadResult.Value, SharedThis->ParsingCatalogMap);
-			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("Adding parsing catalog from %s"), *AssetProfile.GetParsingCatalogUri(LoadData.VariantID));
-			SharedThis->CompletePendingLoad();
-		});
+		LoadCatalog(Variant->GetParsingCatalogUri(), TEXT("parsing"), ParsingCatalog);
 	}
 	
 	bBlockCompletion = false;
@@ -64,3 +36,34 @@ TFuture<bool> FLoadAssetCatalogAction::TryLoadAssetCatalog(const FAssetProfile&
 
 	return Future;
 }
+
+void FLoadAssetCatalogAction::LoadCatalog(const FString& CatalogUri, const TCHAR* CatalogType, FSharedCatalogPtr& OutCatalog)
+{
+	// identical URIs always share a catalog, no need to download it again
+	if (FSharedCatalogPtr ExistingCatalog = CatalogStore->FindByUri(CatalogUri))
+	{
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("Reusing %s catalog from %s"), CatalogType, *CatalogUri);
+		OutCatalog = ExistingCatalog;
+		return;
+	}
+	
+	TSharedPtr<FLoadAssetCatalogAction> SharedThis = AsShared();
+	SharedThis->AddPendingLoad();
+	
+	FControllerDownloadManager::GetInstance()->LoadStringFromURI(TEXT("Catalog"), CatalogUri, EUBFDownloadPriority::Render, LoadData.Deadline)
+		.Next([SharedThis, CatalogUri, CatalogType, &OutCatalog](const UBF::FLoadStringResult& LoadResult)
+	{
+		FUBFContinuationScope ContinuationScope;
+		if (!LoadResult.bSuccess)
+		{
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("Failed to load %s catalog from %s"), CatalogType, *CatalogUri);
+			SharedThis->bFailure = true;
+			SharedThis->CompletePendingLoad();
+			return;
+		}
+		
+		OutCatalog = SharedThis->CatalogStore->FindOrParse(CatalogUri, LoadResult.Value);
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("Adding %s catalog from %s"), CatalogType, *CatalogUri);
+		SharedThis->CompletePendingLoad();
+	});
+}
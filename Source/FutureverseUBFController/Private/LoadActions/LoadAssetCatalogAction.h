@@ -5,17 +5,23 @@
 #include "FutureverseAssetLoadData.h"
 
 #include "FutureverseUBFControllerSubsystem.h"
+#include "Catalogs/SharedCatalogStore.h"
 #include "ControllerLayers/AssetProfile.h"
-#include "GlobalArtifactProvider/CatalogElement.h"
 #include "LoadActions/LoadAction.h"
 
 class FLoadAssetCatalogAction : public TLoadAction<FLoadAssetCatalogAction>
 {
 public:
-	TFuture<bool> TryLoadAssetCatalog(const FAssetProfile& AssetProfile, const FFutureverseAssetLoadData& LoadData, const TSharedPtr<FMemoryCacheLoader>& MemoryCacheLoader);
+	TFuture<bool> TryLoadAssetCatalog(const FAssetProfilePtr& AssetProfile, const FFutureverseAssetLoadData& LoadData,
+		const TSharedPtr<FMemoryCacheLoader>& MemoryCacheLoader, const TSharedPtr<FSharedCatalogStore>& CatalogStore);
 	
-	FAssetProfile AssetProfileLoaded;
+	FAssetProfilePtr AssetProfileLoaded;
 	FFutureverseAssetLoadData LoadData;
-	TMap<FString, UBF::FCatalogElement> RenderCatalogMap;
-	TMap<FString, UBF::FCatalogElement> ParsingCatalogMap;
+	FSharedCatalogPtr RenderCatalog;
+	FSharedCatalogPtr ParsingCatalog;
+
+private:
+	void LoadCatalog(const FString& CatalogUri, const TCHAR* CatalogType, FSharedCatalogPtr& OutCatalog);
+	
+	TSharedPtr<FSharedCatalogStore> CatalogStore;
 };
@@ -6,9 +6,10 @@
 
 #include "FutureverseAssetLoadData.h"
 #include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerStats.h"
 #include "HttpModule.h"
 #include "ControllerLayers/AssetProfileUtils.h"
-#include "GlobalArtifactProvider/DownloadRequestManager.h"
+#include "Downloads/ControllerDownloadManager.h"
 #include "Interfaces/IHttpRequest.h"
 #include "Interfaces/IHttpResponse.h"
 
@@ -37,6 +38,7 @@ TFuture<bool> FLoadAssetProfilesAction::TryLoadAssetProfile(const FFutureverseAs
 	
 	const auto HandleURL = [SharedThis, ProfileRemotePath, LoadData](const UBF::FLoadStringResult& AssetProfileResult)
 	{
+		FUBFContinuationScope ContinuationScope;
 		if (!AssetProfileResult.bSuccess)
 		{
 			UE_LOG(LogFutureverseUBFController, Error, TEXT("UFutureverseUBFControllerSubsystem::LoadRemoteAssetProfile failed to load remote AssetProfile from %s"), *ProfileRemotePath);
@@ -69,21 +71,24 @@ TFuture<bool> FLoadAssetProfilesAction::TryLoadAssetProfile(const FFutureverseAs
 	if (Settings->GetUseAssetRegisterProfiles())
 	{
 		GetAssetProfileURLFromAssetRegister(LoadData.GetCollectionID(), LoadData.GetTokenID()).Next(
-		[SharedThis, HandleURL, this](const FString& OutURL)
+		[SharedThis, HandleURL, LoadData](const FString& OutURL)
 		{
+			FUBFContinuationScope ContinuationScope;
 			if (OutURL.IsEmpty())
 			{
 				SharedThis->Promise->SetValue(false);
 			}
 			else
 			{
-				FDownloadRequestManager::GetInstance()->LoadStringFromURI(TEXT("AssetProfile"), OutURL).Next(HandleURL);
+				FControllerDownloadManager::GetInstance()->LoadStringFromURI(TEXT("AssetProfile"), OutURL,
+					EUBFDownloadPriority::Render, LoadData.Deadline).Next(HandleURL);
 			}
 		});
 	}
 	else
 	{
-		FDownloadRequestManager::GetInstance()->LoadStringFromURI(TEXT("AssetProfile"), ProfileRemotePath).Next(HandleURL);
+		FControllerDownloadManager::GetInstance()->LoadStringFromURI(TEXT("AssetProfile"), ProfileRemotePath,
+			EUBFDownloadPriority::Render, LoadData.Deadline).Next(HandleURL);
 	}
 	
 	return Future;
@@ -92,15 +97,37 @@ TFuture<bool> FLoadAssetProfilesAction::TryLoadAssetProfile(const FFutureverseAs
 TFuture<FString> FLoadAssetProfilesAction::GetAssetProfileURLFromAssetRegister(
 	const FString& CollectionId, const FString& TokenId)
 {
-	// fetch remote asset profile, then parse and register all the blueprint instances and catalogs
-	TSharedPtr<TPromise<FString>> Promise = MakeShareable(new TPromise<FString>());
-	TFuture<FString> Future = Promise->GetFuture();
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+	check(Settings);
+	const FString URL = FControllerDownloadManager::GetInstance()->ResolveEndpoint(Settings->GetAssetRegisterGraphQLURL());
 
-	const TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
-	
-	const FString URL = "https://ar-api.futureverse.app/graphql";
-	// const FString URL = "https://ar-api.futureverse.cloud/graphql";
+	const FString AssetKey = FString::Printf(TEXT("%s:%s"), *CollectionId, *TokenId);
+	if (FControllerDownloadManager::GetInstance()->GetNegativeCache().Contains(EUBFNegativeCacheScope::AssetRegister, AssetKey))
+	{
+		UE_LOG(LogFutureverseUBFController, Verbose, TEXT("GetAssetProfileURLFromAssetRegister %s is a known miss"), *AssetKey);
+		return MakeFulfilledPromise<FString>(TEXT("")).GetFuture();
+	}
+
+	// a POST, so it is retried but never hedged. An asset without a profile is a valid answer and doesn't count
+	// against the circuit breaker of the Asset Register
+	return FControllerDownloadManager::GetInstance()->GetResilience().Fetch<FAssetRegisterResult>(URL, EUBFDownloadPriority::Render, false,
+		[URL, CollectionId, TokenId]() { return QueryAssetProfileURL(URL, CollectionId, TokenId); },
+		[](const FAssetRegisterResult& Result) { return static_cast<int64>(Result.AssetProfileURL.Len()); },
+		[](const FAssetRegisterResult& Result) { return !Result.bRetryable; })
+		.Next([AssetKey](const FAssetRegisterResult& Result)
+		{
+			FUBFContinuationScope ContinuationScope;
+			if (Result.bNotFound)
+			{
+				FControllerDownloadManager::GetInstance()->GetNegativeCache().Add(EUBFNegativeCacheScope::AssetRegister, AssetKey);
+			}
+			return Result.AssetProfileURL;
+		});
+}
 
+TFuture<FLoadAssetProfilesAction::FAssetRegisterResult> FLoadAssetProfilesAction::QueryAssetProfileURL(const FString& URL,
+	const FString& CollectionId, const FString& TokenId)
+{
 	const FString Content = R"(
 	{
 		"query": "query($assetIds: [AssetInput!]) { assetsByIds(assetIds: $assetIds) {profiles} }",
@@ -115,57 +142,45 @@ TFuture<FString> FLoadAssetProfilesAction::GetAssetProfileURLFromAssetRegister(
 		}
 	})";
 
+	// the raw GraphQL response is recorded so a replay parses it like the original session did
+	const FString TrafficKey = FString::Printf(TEXT("%s %s:%s"), *URL, *CollectionId, *TokenId);
+	return FControllerDownloadManager::GetInstance()->GetTrafficArchive().Exchange(EUBFTrafficKind::AssetRegister, TrafficKey,
+		[&URL, &Content]() { return PostAssetRegisterQuery(URL, Content); })
+		.Next([CollectionId, TokenId](const FUBFTrafficResponse& Response)
+		{
+			return ParseAssetRegisterResponse(Response, CollectionId, TokenId);
+		});
+}
+
+TFuture<FUBFTrafficResponse> FLoadAssetProfilesAction::PostAssetRegisterQuery(const FString& URL, const FString& Content)
+{
+	TSharedPtr<TPromise<FUBFTrafficResponse>> Promise = MakeShareable(new TPromise<FUBFTrafficResponse>());
+	TFuture<FUBFTrafficResponse> Future = Promise->GetFuture();
+
+	const TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+
 	Request->SetURL(URL);
 	Request->SetVerb(TEXT("POST"));
 	Request->SetHeader("content-type", "application/json");
 	Request->SetContentAsString(Content);
-	Request->SetTimeout(60);
+	Request->SetTimeout(GetDefault<UFutureverseUBFControllerSettings>()->GetAssetRegisterTimeoutSeconds());
 	
-	auto RequestCallback = [Promise, TokenId, CollectionId]
-	(FHttpRequestPtr Request, const FHttpResponsePtr& Response, bool bWasSuccessful) mutable
+	auto RequestCallback = [Promise, URL](FHttpRequestPtr Request, const FHttpResponsePtr& Response, bool bWasSuccessful) mutable
 	{
 		if (Response == nullptr)
 		{
-			UE_LOG(LogFutureverseUBFController, Error, TEXT("GetAssetProfileURLFromAssetRegister failed to load remote AssetProfile for %s:%s"), *CollectionId, *TokenId);
-			Promise->SetValue(TEXT(""));
+			Promise->SetValue(FUBFTrafficResponse());
 			return;
 		}
-		
-		if (bWasSuccessful && Response.IsValid())
-		{
-			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("GetAssetProfileURLFromAssetRegister Response: %s"), *Response->GetContentAsString());
-		
-			TSharedPtr<FJsonObject> JsonObject;
-			TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Response->GetContentAsString());
 
-			if (FJsonSerializer::Deserialize(Reader, JsonObject) && JsonObject.IsValid())
-			{
-				TSharedPtr<FJsonObject> DataObject = JsonObject->GetObjectField(TEXT("data"));
-
-				const TArray<TSharedPtr<FJsonValue>>* AssetsArray;
-				if (DataObject->TryGetArrayField(TEXT("assetsByIds"), AssetsArray) && AssetsArray->Num() > 0)
-				{
-					// todo: there could be multiple profiles?
-					TSharedPtr<FJsonObject> AssetObject = (*AssetsArray)[0]->AsObject();
-					if (AssetObject.IsValid())
-					{
-						TSharedPtr<FJsonObject> ProfilesObject = AssetObject->GetObjectField(TEXT("profiles"));
-						FString AssetProfileUrl = ProfilesObject->GetStringField(TEXT("asset-profile"));
-						
-						Promise->SetValue(AssetProfileUrl);
-					}
-				}
-			}
-			else
-			{
-				UE_LOG(LogFutureverseUBFController, Error, TEXT("GetAssetProfileURLFromAssetRegister Failed to prase ResponseJson: %s"), *Response->GetContentAsString());
-				Promise->SetValue(TEXT(""));
-			}
-		}
-		else
+		const int32 ResponseCode = Response->GetResponseCode();
+		if (ResponseCode == EHttpResponseCodes::TooManyRequests || ResponseCode == EHttpResponseCodes::ServiceUnavail)
 		{
-			Promise->SetValue(TEXT(""));
+			FControllerDownloadManager::GetInstance()->GetGovernor().ReportRetryAfter(URL,
+				FDownloadGovernor::ParseRetryAfter(Response->GetHeader(TEXT("Retry-After"))));
 		}
+		
+		Promise->SetValue(FUBFTrafficResponse::FromString(bWasSuccessful, Response->GetContentAsString(), ResponseCode));
 	};
 	
 	Request->OnProcessRequestComplete().BindLambda(RequestCallback);
@@ -173,3 +188,61 @@ TFuture<FString> FLoadAssetProfilesAction::GetAssetProfileURLFromAssetRegister(
 
 	return Future;
 }
+
+FLoadAssetProfilesAction::FAssetRegisterResult FLoadAssetProfilesAction::ParseAssetRegisterResponse(const FUBFTrafficResponse& Response,
+	const FString& CollectionId, const FString& TokenId)
+{
+	const int32 ResponseCode = Response.ResponseCode;
+	if (ResponseCode == 0)
+	{
+		UE_LOG(LogFutureverseUBFController, Error, TEXT("GetAssetProfileURLFromAssetRegister failed to load remote AssetProfile for %s:%s"), *CollectionId, *TokenId);
+		return {TEXT(""), true, false};
+	}
+	
+	if (ResponseCode == EHttpResponseCodes::TooManyRequests || ResponseCode >= EHttpResponseCodes::ServerError)
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("GetAssetProfileURLFromAssetRegister got response code %d for %s:%s"), ResponseCode, *CollectionId, *TokenId);
+		return {TEXT(""), true, false};
+	}
+	
+	if (FNegativeCache::ClassifyResponseCode(ResponseCode) == EUBFLookupFailure::Permanent)
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("GetAssetProfileURLFromAssetRegister got response code %d for %s:%s"), ResponseCode, *CollectionId, *TokenId);
+		return {TEXT(""), false, true};
+	}
+	
+	if (!Response.bSuccess)
+		return {TEXT(""), true, false};
+
+	const FString ResponseContent = Response.GetPayloadAsString();
+	UE_LOG(LogFutureverseUBFController, Verbose, TEXT("GetAssetProfileURLFromAssetRegister Response: %s"), *ResponseContent);
+
+	TSharedPtr<FJsonObject> JsonObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseContent);
+
+	if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+	{
+		// could be a proxy's error page, not a reason to stop asking
+		UE_LOG(LogFutureverseUBFController, Error, TEXT("GetAssetProfileURLFromAssetRegister Failed to prase ResponseJson: %s"), *ResponseContent);
+		return {TEXT(""), false, false};
+	}
+
+	const TSharedPtr<FJsonObject>* DataObject;
+	const TArray<TSharedPtr<FJsonValue>>* AssetsArray;
+	if (JsonObject->TryGetObjectField(TEXT("data"), DataObject)
+		&& (*DataObject)->TryGetArrayField(TEXT("assetsByIds"), AssetsArray) && AssetsArray->Num() > 0)
+	{
+		// todo: there could be multiple profiles?
+		TSharedPtr<FJsonObject> AssetObject = (*AssetsArray)[0]->AsObject();
+		const TSharedPtr<FJsonObject>* ProfilesObject;
+		FString AssetProfileUrl;
+		if (AssetObject.IsValid() && AssetObject->TryGetObjectField(TEXT("profiles"), ProfilesObject)
+			&& (*ProfilesObject)->TryGetStringField(TEXT("asset-profile"), AssetProfileUrl) && !AssetProfileUrl.IsEmpty())
+		{
+			return {AssetProfileUrl, false, false};
+		}
+	}
+	
+	UE_LOG(LogFutureverseUBFController, Warning, TEXT("GetAssetProfileURLFromAssetRegister found no asset profile for %s:%s"), *CollectionId, *TokenId);
+	return {TEXT(""), false, true};
+}
@@ -4,6 +4,7 @@
 
 #include "FutureverseAssetLoadData.h"
 #include "ControllerLayers/AssetProfile.h"
+#include "Downloads/TrafficArchive.h"
 #include "GlobalArtifactProvider/CacheLoading/MemoryCacheLoader.h"
 #include "LoadActions/LoadAction.h"
 
@@ -17,4 +18,21 @@ public:
 	static TFuture<FString> GetAssetProfileURLFromAssetRegister(const FString& CollectionId, const FString& TokenId);
 	
 	TMap<FString, FAssetProfile> AssetProfiles;
+
+private:
+	struct FAssetRegisterResult
+	{
+		// empty when the query failed or the asset has no profile
+		FString AssetProfileURL;
+		// no response, throttled or a server error, as opposed to an answer that will not change
+		bool bRetryable = false;
+		// the Asset Register answered that the asset has no profile, remembered by the negative cache
+		bool bNotFound = false;
+	};
+	
+	// The GraphQL request itself, issued once the download governor admits it
+	static TFuture<FAssetRegisterResult> QueryAssetProfileURL(const FString& URL, const FString& CollectionId, const FString& TokenId);
+	// Sent unless the traffic archive replays a recorded response instead
+	static TFuture<FUBFTrafficResponse> PostAssetRegisterQuery(const FString& URL, const FString& Content);
+	static FAssetRegisterResult ParseAssetRegisterResponse(const FUBFTrafficResponse& Response, const FString& CollectionId, const FString& TokenId);
 };
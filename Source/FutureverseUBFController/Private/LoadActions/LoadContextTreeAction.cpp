@@ -0,0 +1,367 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "LoadContextTreeAction.h"
+
+#include "AssetRegisterQueryingLibrary.h"
+#include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerSettings.h"
+#include "FutureverseUBFControllerStats.h"
+#include "LoadActionUtils.h"
+#include "Async/Async.h"
+#include "Downloads/ControllerDownloadManager.h"
+#include "InventoryComponents/ItemRegistry.h"
+#include "Serialization/JsonSerializer.h"
+
+TFuture<bool> FLoadContextTreeAction::TryLoadContextTree(UUBFItem* InRootItem, const TSharedPtr<FItemRegistry>& InItemRegistry)
+{
+	check(IsInGameThread());
+
+	Promise = MakeShared<TPromise<bool>>();
+	TFuture<bool> Future = Promise->GetFuture();
+
+	if (!InRootItem)
+	{
+		Promise->SetValue(false);
+		return Future;
+	}
+
+	RootItem = InRootItem;
+	ItemRegistry = InItemRegistry;
+
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+	check(Settings);
+	MaxDepth = Settings->GetMaxContextTreeDepth();
+	MaxNodes = Settings->GetMaxContextTreeNodes();
+	BatchSize = Settings->GetMaxParallelContextTreeRequests();
+
+	FNode& RootNode = Nodes.Emplace_GetRef();
+	RootNode.Item = InRootItem;
+	RootNode.AssetID = InRootItem->GetAssetID();
+	NodeIndices.Add(RootNode.AssetID, 0);
+	// children reference each other by collection:token, which may differ from the root's asset id
+	NodeIndices.Add(InRootItem->GetCombinedID(), 0);
+
+	StartTime = FPlatformTime::Seconds();
+	LevelStart = 0;
+	LevelEnd = 1;
+	LoadLevel();
+
+	return Future;
+}
+
+void FLoadContextTreeAction::LoadLevel()
+{
+	if (LevelStart >= LevelEnd || Nodes[LevelStart].Depth >= MaxDepth || !ItemRegistry.IsValid())
+	{
+		Finish();
+		return;
+	}
+
+	LevelStartTime = FPlatformTime::Seconds();
+	LoadBatch(LevelStart);
+}
+
+void FLoadContextTreeAction::LoadBatch(int32 BatchStart)
+{
+	const int32 BatchEnd = FMath::Min(BatchStart + BatchSize, LevelEnd);
+
+	TArray<TFuture<bool>> LinkFutures;
+	for (int32 NodeIndex = BatchStart; NodeIndex < BatchEnd; ++NodeIndex)
+	{
+		LinkFutures.Add(LoadNodeLinks(NodeIndex));
+	}
+
+	TSharedPtr<FLoadContextTreeAction> SharedThis = AsShared();
+	LoadActionUtils::WhenAll(LinkFutures).Next([SharedThis, BatchStart, BatchEnd](const TArray<bool>& Results)
+	{
+		const bool bLinksLoaded = !Results.Contains(false);
+		
+		SharedThis->RunOnGameThread([SharedThis, BatchStart, BatchEnd, bLinksLoaded]()
+		{
+			FUBFContinuationScope ContinuationScope;
+			SharedThis->bAllSuccess &= bLinksLoaded;
+			SharedThis->ProcessBatch(BatchStart, BatchEnd);
+		});
+	});
+}
+
+TFuture<bool> FLoadContextTreeAction::LoadNodeLinks(int32 NodeIndex)
+{
+	const UUBFItem* Item = Nodes[NodeIndex].Item.Get();
+	if (!Item)
+	{
+		return MakeFulfilledPromise<bool>(false).GetFuture();
+	}
+
+	// Nodes is not resized while a batch is in flight, every request only writes its own node
+	TSharedPtr<FLoadContextTreeAction> SharedThis = AsShared();
+	return FetchAssetLinks(Item->GetCollectionID(), Item->GetTokenID()).Next([SharedThis, NodeIndex]
+		(const TOptional<TArray<FLink>>& ChildLinks)
+	{
+		FUBFContinuationScope ContinuationScope;
+		FNode& Node = SharedThis->Nodes[NodeIndex];
+
+		if (ChildLinks.IsSet())
+		{
+			Node.ChildLinks = ChildLinks.GetValue();
+			return true;
+		}
+
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("FLoadContextTreeAction::LoadNodeLinks Failed to get NFTAssetLink for Asset: %s"), *Node.AssetID);
+		return false;
+	});
+}
+
+TFuture<TOptional<TArray<FLink>>> FLoadContextTreeAction::FetchAssetLinks(const FString& CollectionId, const FString& TokenId)
+{
+	const auto GetChildLinks = [](const FLoadAssetResult& Result) -> TOptional<TArray<FLink>>
+	{
+		if (const UNFTAssetLinkObject* NFTAssetLink = Cast<UNFTAssetLinkObject>(Result.Value.LinkWrapper.Links))
+			return NFTAssetLink->Data.ChildLinks;
+
+		return {};
+	};
+
+	FTrafficArchive& TrafficArchive = FControllerDownloadManager::GetInstance()->GetTrafficArchive();
+	if (!TrafficArchive.IsActive())
+		return UAssetRegisterQueryingLibrary::GetAssetLinks(TokenId, CollectionId).Next(GetChildLinks);
+
+	// the links are recorded rather than the asset, they are all the context tree reads from it
+	const FString TrafficKey = FString::Printf(TEXT("GetAssetLinks %s:%s"), *CollectionId, *TokenId);
+	return TrafficArchive.Exchange(EUBFTrafficKind::AssetRegister, TrafficKey, [&CollectionId, &TokenId, &GetChildLinks]()
+	{
+		return UAssetRegisterQueryingLibrary::GetAssetLinks(TokenId, CollectionId).Next([GetChildLinks](const FLoadAssetResult& Result)
+		{
+			const TOptional<TArray<FLink>> ChildLinks = GetChildLinks(Result);
+			if (!ChildLinks.IsSet())
+				return FUBFTrafficResponse();
+
+			TArray<TSharedPtr<FJsonValue>> LinkValues;
+			for (const FLink& ChildLink : ChildLinks.GetValue())
+			{
+				const TSharedRef<FJsonObject> LinkObject = MakeShared<FJsonObject>();
+				LinkObject->SetStringField(TEXT("path"), ChildLink.Path);
+				LinkObject->SetStringField(TEXT("collectionId"), ChildLink.Asset.CollectionId);
+				LinkObject->SetStringField(TEXT("tokenId"), ChildLink.Asset.TokenId);
+				LinkValues.Add(MakeShared<FJsonValueObject>(LinkObject));
+			}
+
+			FString LinksJson;
+			FJsonSerializer::Serialize(LinkValues, TJsonWriterFactory<>::Create(&LinksJson));
+			return FUBFTrafficResponse::FromString(true, LinksJson);
+		});
+	})
+	.Next([](const FUBFTrafficResponse& Response) -> TOptional<TArray<FLink>>
+	{
+		TArray<TSharedPtr<FJsonValue>> LinkValues;
+		if (!Response.bSuccess || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Response.GetPayloadAsString()), LinkValues))
+			return {};
+
+		TArray<FLink> ChildLinks;
+		for (const TSharedPtr<FJsonValue>& LinkValue : LinkValues)
+		{
+			const TSharedPtr<FJsonObject>* LinkObject;
+			if (!LinkValue.IsValid() || !LinkValue->TryGetObject(LinkObject)) continue;
+
+			FLink& ChildLink = ChildLinks.Emplace_GetRef();
+			(*LinkObject)->TryGetStringField(TEXT("path"), ChildLink.Path);
+			(*LinkObject)->TryGetStringField(TEXT("collectionId"), ChildLink.Asset.CollectionId);
+			(*LinkObject)->TryGetStringField(TEXT("tokenId"), ChildLink.Asset.TokenId);
+		}
+		return ChildLinks;
+	});
+}
+
+void FLoadContextTreeAction::ProcessBatch(int32 BatchStart, int32 BatchEnd)
+{
+	TArray<FPendingRelationship> PendingRelationships;
+	TArray<TFuture<bool>> ProfileFutures;
+
+	for (int32 ParentIndex = BatchStart; ParentIndex < BatchEnd; ++ParentIndex)
+	{
+		// AddChildNode grows Nodes, so the parent is only accessed by index from here on
+		const TArray<FLink> ChildLinks = MoveTemp(Nodes[ParentIndex].ChildLinks);
+
+		for (const FLink& ChildLink : ChildLinks)
+		{
+			const FString ChildAssetID = FString::Printf(TEXT("%s:%s"), *ChildLink.Asset.CollectionId, *ChildLink.Asset.TokenId);
+			int32 ChildIndex = INDEX_NONE;
+
+			if (const int32* ExistingIndex = NodeIndices.Find(ChildAssetID))
+			{
+				ChildIndex = *ExistingIndex;
+				if (ChildIndex == ParentIndex || CanReach(ChildIndex, ParentIndex))
+				{
+					UE_LOG(LogFutureverseUBFController, Warning, TEXT("FLoadContextTreeAction::ProcessBatch Ignoring link %s -> %s, it would create a cycle in the context tree of %s"),
+						*Nodes[ParentIndex].AssetID, *ChildAssetID, *Nodes[0].AssetID);
+					continue;
+				}
+			}
+			else
+			{
+				if (Nodes.Num() >= MaxNodes)
+				{
+					if (!bNodeLimitReached)
+					{
+						UE_LOG(LogFutureverseUBFController, Warning, TEXT("FLoadContextTreeAction::ProcessBatch Context tree of %s reached the limit of %d nodes, remaining links are ignored"),
+							*Nodes[0].AssetID, MaxNodes);
+						bNodeLimitReached = true;
+					}
+					continue;
+				}
+
+				UUBFItem* ChildItem = ItemRegistry->GetItem(ChildAssetID);
+				if (!ChildItem)
+				{
+					UE_LOG(LogFutureverseUBFController, Verbose, TEXT("Failed to add Child Item: %s"), *ChildAssetID);
+					continue;
+				}
+
+				ChildIndex = AddChildNode(ParentIndex, ChildAssetID, ChildItem);
+				ProfileFutures.Add(ChildItem->EnsureProfileURILoaded());
+			}
+
+			Nodes[ParentIndex].ChildIndices.Add(ChildIndex);
+			PendingRelationships.Add({ParentIndex, ChildIndex, ChildLink.Path});
+		}
+	}
+
+	TSharedPtr<FLoadContextTreeAction> SharedThis = AsShared();
+	LoadActionUtils::WhenAll(ProfileFutures).Next([SharedThis, BatchEnd, PendingRelationships = MoveTemp(PendingRelationships)](const TArray<bool>& Results)
+	{
+		const bool bProfilesLoaded = !Results.Contains(false);
+
+		SharedThis->RunOnGameThread([SharedThis, BatchEnd, bProfilesLoaded, PendingRelationships]()
+		{
+			FUBFContinuationScope ContinuationScope;
+			SharedThis->bAllSuccess &= bProfilesLoaded;
+
+			for (const FPendingRelationship& PendingRelationship : PendingRelationships)
+			{
+				const UUBFItem* ChildItem = SharedThis->Nodes[PendingRelationship.ChildIndex].Item.Get();
+				if (!ChildItem || !ChildItem->IsProfileURILoaded())
+					continue;
+
+				SharedThis->Nodes[PendingRelationship.ParentIndex].Relationships.Add(FUBFContextTreeRelationshipData(
+					PendingRelationship.RelationshipID, SharedThis->Nodes[PendingRelationship.ChildIndex].AssetID, ChildItem->GetProfileURI()));
+			}
+
+			if (BatchEnd < SharedThis->LevelEnd)
+			{
+				SharedThis->LoadBatch(BatchEnd);
+			}
+			else
+			{
+				SharedThis->CompleteLevel();
+			}
+		});
+	});
+}
+
+void FLoadContextTreeAction::CompleteLevel()
+{
+	const double Milliseconds = (FPlatformTime::Seconds() - LevelStartTime) * 1000.0;
+	LevelMilliseconds.Add(Milliseconds);
+
+	UE_LOG(LogFutureverseUBFController, Verbose, TEXT("FLoadContextTreeAction::CompleteLevel %s level %d: fetched links of %d nodes, found %d new nodes in %.1f ms"),
+		*Nodes[0].AssetID, Nodes[LevelStart].Depth, LevelEnd - LevelStart, Nodes.Num() - LevelEnd, Milliseconds);
+
+	LevelStart = LevelEnd;
+	LevelEnd = Nodes.Num();
+	LoadLevel();
+}
+
+void FLoadContextTreeAction::Finish()
+{
+	UUBFItem* Root = RootItem.Get();
+	if (!Root)
+	{
+		Promise->SetValue(false);
+		return;
+	}
+
+	TSharedPtr<FLoadContextTreeAction> SharedThis = AsShared();
+	Root->EnsureProfileURILoaded().Next([SharedThis](bool bResult)
+	{
+		SharedThis->RunOnGameThread([SharedThis, bResult]()
+		{
+			FUBFContinuationScope ContinuationScope;
+			UUBFItem* Root = SharedThis->RootItem.Get();
+			if (!Root)
+			{
+				SharedThis->Promise->SetValue(false);
+				return;
+			}
+
+			// the root is always present, other nodes only when something is attached to them
+			TArray<FUBFContextTreeData> ContextTree;
+			ContextTree.Add(FUBFContextTreeData(SharedThis->Nodes[0].AssetID, SharedThis->Nodes[0].Relationships, Root->GetProfileURI()));
+			for (int32 NodeIndex = 1; NodeIndex < SharedThis->Nodes.Num(); ++NodeIndex)
+			{
+				const FNode& Node = SharedThis->Nodes[NodeIndex];
+				const UUBFItem* Item = Node.Item.Get();
+				if (!Item || Node.Relationships.IsEmpty())
+					continue;
+
+				ContextTree.Add(FUBFContextTreeData(Node.AssetID, Node.Relationships, Item->GetProfileURI()));
+			}
+			Root->SetContextTree(ContextTree);
+
+			FString LevelTimings;
+			for (const double Milliseconds : SharedThis->LevelMilliseconds)
+			{
+				LevelTimings += FString::Printf(TEXT("%s%.1f"), LevelTimings.IsEmpty() ? TEXT("") : TEXT(", "), Milliseconds);
+			}
+			UE_LOG(LogFutureverseUBFController, Verbose, TEXT("FLoadContextTreeAction::Finish %s loaded %d nodes (%d tree entries) over %d levels in %.1f ms, per level ms: [%s]"),
+				*SharedThis->Nodes[0].AssetID, SharedThis->Nodes.Num(), ContextTree.Num(), SharedThis->LevelMilliseconds.Num(),
+				(FPlatformTime::Seconds() - SharedThis->StartTime) * 1000.0, *LevelTimings);
+
+			SharedThis->Promise->SetValue(SharedThis->bAllSuccess && bResult);
+		});
+	});
+}
+
+int32 FLoadContextTreeAction::AddChildNode(int32 ParentIndex, const FString& ChildAssetID, UUBFItem* ChildItem)
+{
+	const int32 ChildIndex = Nodes.Num();
+
+	FNode& ChildNode = Nodes.Emplace_GetRef();
+	ChildNode.Item = ChildItem;
+	ChildNode.AssetID = ChildAssetID;
+	ChildNode.Depth = Nodes[ParentIndex].Depth + 1;
+	NodeIndices.Add(ChildAssetID, ChildIndex);
+
+	return ChildIndex;
+}
+
+bool FLoadContextTreeAction::CanReach(int32 FromIndex, int32 ToIndex) const
+{
+	// a shared node can be reached through several parents, so walk the accepted edges instead of a single parent chain
+	TArray<int32> Stack = {FromIndex};
+	TSet<int32> Visited;
+	while (!Stack.IsEmpty())
+	{
+		const int32 Index = Stack.Pop();
+		if (Index == ToIndex)
+			return true;
+
+		bool bAlreadyVisited = false;
+		Visited.Add(Index, &bAlreadyVisited);
+		if (!bAlreadyVisited)
+		{
+			Stack.Append(Nodes[Index].ChildIndices);
+		}
+	}
+	return false;
+}
+
+void FLoadContextTreeAction::RunOnGameThread(TUniqueFunction<void()>&& Function)
+{
+	if (IsInGameThread())
+	{
+		Function();
+		return;
+	}
+
+	AsyncTask(ENamedThreads::GameThread, MoveTemp(Function));
+}
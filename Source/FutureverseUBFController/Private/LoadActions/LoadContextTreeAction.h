@@ -0,0 +1,78 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/UBFItem.h"
+#include "Schemas/Unions/NFTAssetLink.h"
+
+class FItemRegistry;
+
+/**
+ * Discovers an item's equipment tree breadth first through the Asset Register links of every node.
+ * Each depth level is fetched in parallel batches of at most BatchSize requests. Nodes shared between parents are
+ * fetched once, relationships that would close a cycle are dropped, and discovery stops at MaxDepth levels or MaxNodes nodes.
+ */
+class FLoadContextTreeAction : public TSharedFromThis<FLoadContextTreeAction>
+{
+public:
+	TFuture<bool> TryLoadContextTree(UUBFItem* InRootItem, const TSharedPtr<FItemRegistry>& InItemRegistry);
+
+private:
+	struct FNode
+	{
+		TWeakObjectPtr<UUBFItem> Item;
+		FString AssetID;
+		int32 Depth = 0;
+
+		TArray<FUBFContextTreeRelationshipData> Relationships;
+		// accepted edges, including ones still waiting for the child's profile uri
+		TArray<int32> ChildIndices;
+		// filled by the link request of this node while its level is loading
+		TArray<FLink> ChildLinks;
+	};
+
+	struct FPendingRelationship
+	{
+		int32 ParentIndex;
+		int32 ChildIndex;
+		FString RelationshipID;
+	};
+
+	void LoadLevel();
+	void LoadBatch(int32 BatchStart);
+	TFuture<bool> LoadNodeLinks(int32 NodeIndex);
+	// Child links of the asset, unset if the Asset Register didn't return them. Passed through the traffic archive
+	// while it records or replays
+	static TFuture<TOptional<TArray<FLink>>> FetchAssetLinks(const FString& CollectionId, const FString& TokenId);
+	// Adds the children found by the batch to the tree, then loads the profile uris of the new nodes
+	void ProcessBatch(int32 BatchStart, int32 BatchEnd);
+	void CompleteLevel();
+	void Finish();
+
+	int32 AddChildNode(int32 ParentIndex, const FString& ChildAssetID, UUBFItem* ChildItem);
+	bool CanReach(int32 FromIndex, int32 ToIndex) const;
+
+	void RunOnGameThread(TUniqueFunction<void()>&& Function);
+
+	TWeakObjectPtr<UUBFItem> RootItem;
+	TSharedPtr<FItemRegistry> ItemRegistry;
+	TSharedPtr<TPromise<bool>> Promise;
+
+	int32 MaxDepth = 1;
+	int32 MaxNodes = 1;
+	int32 BatchSize = 1;
+
+	// breadth first order, a level is the range [LevelStart, LevelEnd)
+	TArray<FNode> Nodes;
+	TMap<FString, int32> NodeIndices;
+	int32 LevelStart = 0;
+	int32 LevelEnd = 0;
+
+	double StartTime = 0.0;
+	double LevelStartTime = 0.0;
+	TArray<double> LevelMilliseconds;
+
+	bool bAllSuccess = true;
+	bool bNodeLimitReached = false;
+};
@@ -0,0 +1,551 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "Snapshots/AssetSnapshot.h"
+
+#include "AssetIdUtils.h"
+#include "FutureverseUBFControllerLog.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+namespace AssetSnapshotFormat
+{
+	// Case sensitive string -> id map, the default FString key funcs would merge strings that only differ in case
+	struct FStringIdKeyFuncs : TDefaultMapKeyFuncs<FString, uint32, false>
+	{
+		static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+		static uint32 GetKeyHash(const FString& Key) { return FCrc::StrCrc32(*Key); }
+	};
+
+	class FStringTableBuilder
+	{
+	public:
+		uint32 Add(const FString& Value)
+		{
+			if (const uint32* Existing = Ids.Find(Value))
+				return *Existing;
+
+			const uint32 Id = Strings.Num();
+			Strings.Add(Value);
+			Ids.Add(Value, Id);
+			return Id;
+		}
+
+		const TArray<FString>& GetStrings() const { return Strings; }
+
+	private:
+		TArray<FString> Strings;
+		TMap<FString, uint32, FDefaultSetAllocator, FStringIdKeyFuncs> Ids;
+	};
+
+	void WriteUInt32(TArray<uint8>& Out, uint32 Value)
+	{
+		const uint32 LittleEndianValue = INTEL_ORDER32(Value);
+		Out.Append(reinterpret_cast<const uint8*>(&LittleEndianValue), sizeof(uint32));
+	}
+
+	void PatchUInt32(TArray<uint8>& Out, uint32 Offset, uint32 Value)
+	{
+		const uint32 LittleEndianValue = INTEL_ORDER32(Value);
+		FMemory::Memcpy(Out.GetData() + Offset, &LittleEndianValue, sizeof(uint32));
+	}
+
+	void PadToAlignment(TArray<uint8>& Out)
+	{
+		while (Out.Num() % sizeof(uint32) != 0)
+		{
+			Out.Add(0);
+		}
+	}
+
+	// Open addressed table, capacity is a power of two at least twice the key count so probes stay short
+	void WriteIndex(TArray<uint8>& Out, const TArray<TPair<uint32, uint32>>& HashAndOffsets, uint32& OutCapacity, uint32& OutOffset)
+	{
+		OutCapacity = HashAndOffsets.IsEmpty() ? 0 : FMath::RoundUpToPowerOfTwo(static_cast<uint32>(HashAndOffsets.Num()) * 2);
+		OutOffset = Out.Num();
+
+		TArray<uint32> Slots;
+		Slots.SetNumZeroed(OutCapacity * 2);
+		for (const auto& HashAndOffset : HashAndOffsets)
+		{
+			uint32 Slot = HashAndOffset.Key & (OutCapacity - 1);
+			while (Slots[Slot * 2 + 1] != 0)
+			{
+				Slot = (Slot + 1) & (OutCapacity - 1);
+			}
+			Slots[Slot * 2] = HashAndOffset.Key;
+			Slots[Slot * 2 + 1] = HashAndOffset.Value;
+		}
+
+		for (const uint32 Value : Slots)
+		{
+			WriteUInt32(Out, Value);
+		}
+	}
+
+	constexpr uint32 NumStringsPerVariant = 5;
+	constexpr uint32 NumFieldsPerBlob = 4;
+}
+
+FAssetSnapshot::~FAssetSnapshot()
+{
+	delete MappedRegion;
+	delete MappedFile;
+}
+
+TSharedPtr<FAssetSnapshot> FAssetSnapshot::Open(const FString& Path)
+{
+	TSharedPtr<FAssetSnapshot> Snapshot = MakeShareable(new FAssetSnapshot());
+	Snapshot->SourcePath = Path;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	Snapshot->MappedFile = PlatformFile.OpenMapped(*Path);
+	if (Snapshot->MappedFile)
+	{
+		Snapshot->MappedRegion = Snapshot->MappedFile->MapRegion(0, Snapshot->MappedFile->GetFileSize());
+	}
+
+	if (Snapshot->MappedRegion)
+	{
+		Snapshot->Data = Snapshot->MappedRegion->GetMappedPtr();
+		Snapshot->Size = static_cast<uint32>(Snapshot->MappedRegion->GetMappedSize());
+	}
+	else
+	{
+		// platforms without memory mapped files fall back to a plain read
+		if (!FFileHelper::LoadFileToArray(Snapshot->OwnedData, *Path, FILEREAD_Silent))
+		{
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("FAssetSnapshot::Open could not read snapshot %s"), *Path);
+			return nullptr;
+		}
+		Snapshot->Data = Snapshot->OwnedData.GetData();
+		Snapshot->Size = Snapshot->OwnedData.Num();
+	}
+
+	if (!Snapshot->Validate())
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("FAssetSnapshot::Open snapshot %s is invalid or from an unsupported version"), *Path);
+		return nullptr;
+	}
+
+	UE_LOG(LogFutureverseUBFController, Verbose, TEXT("FAssetSnapshot::Open opened %s with %d profiles and %d catalogs"),
+		*Path, Snapshot->NumProfiles(), Snapshot->NumCatalogs());
+	return Snapshot;
+}
+
+TSharedPtr<FAssetSnapshot> FAssetSnapshot::FromMemory(TArray<uint8>&& InData)
+{
+	TSharedPtr<FAssetSnapshot> Snapshot = MakeShareable(new FAssetSnapshot());
+	Snapshot->OwnedData = MoveTemp(InData);
+	Snapshot->Data = Snapshot->OwnedData.GetData();
+	Snapshot->Size = Snapshot->OwnedData.Num();
+
+	return Snapshot->Validate() ? Snapshot : nullptr;
+}
+
+bool FAssetSnapshot::Validate()
+{
+	if (!Data || Size < sizeof(FHeader))
+		return false;
+
+	const FHeader& Header = GetHeader();
+	if (INTEL_ORDER32(Header.Magic) != Magic || INTEL_ORDER32(Header.Version) != Version || INTEL_ORDER32(Header.FileSize) != Size)
+		return false;
+
+	const auto SectionFits = [this](uint32 Offset, uint64 SectionSize)
+	{
+		return Offset >= sizeof(FHeader) && static_cast<uint64>(Offset) + SectionSize <= Size;
+	};
+	const auto IsValidCapacity = [](uint32 Capacity)
+	{
+		return Capacity == 0 || FMath::IsPowerOfTwo(Capacity);
+	};
+
+	if (!SectionFits(INTEL_ORDER32(Header.StringTableOffset), static_cast<uint64>(INTEL_ORDER32(Header.NumStrings)) * sizeof(uint32))
+		|| !SectionFits(INTEL_ORDER32(Header.ProfilesOffset), static_cast<uint64>(INTEL_ORDER32(Header.NumProfiles)) * 2 * sizeof(uint32))
+		|| !SectionFits(INTEL_ORDER32(Header.ProfileIndexOffset), static_cast<uint64>(INTEL_ORDER32(Header.ProfileIndexCapacity)) * sizeof(FIndexSlot))
+		|| !SectionFits(INTEL_ORDER32(Header.CatalogsOffset), static_cast<uint64>(INTEL_ORDER32(Header.NumCatalogs)) * 2 * sizeof(uint32))
+		|| !SectionFits(INTEL_ORDER32(Header.CatalogIndexOffset), static_cast<uint64>(INTEL_ORDER32(Header.CatalogIndexCapacity)) * sizeof(FIndexSlot))
+		|| !SectionFits(INTEL_ORDER32(Header.BlobsOffset), static_cast<uint64>(INTEL_ORDER32(Header.NumBlobs)) * AssetSnapshotFormat::NumFieldsPerBlob * sizeof(uint32))
+		|| !SectionFits(INTEL_ORDER32(Header.BlobIndexOffset), static_cast<uint64>(INTEL_ORDER32(Header.BlobIndexCapacity)) * sizeof(FIndexSlot))
+		|| !IsValidCapacity(INTEL_ORDER32(Header.ProfileIndexCapacity))
+		|| !IsValidCapacity(INTEL_ORDER32(Header.CatalogIndexCapacity))
+		|| !IsValidCapacity(INTEL_ORDER32(Header.BlobIndexCapacity)))
+	{
+		return false;
+	}
+
+	// records and strings are still bounds checked when decoded, the CRC catches truncated or corrupted files up front
+	return FCrc::MemCrc32(Data + sizeof(FHeader), Size - sizeof(FHeader)) == INTEL_ORDER32(Header.PayloadCrc);
+}
+
+bool FAssetSnapshot::ReadUInt32(uint32 Offset, uint32& OutValue) const
+{
+	if (static_cast<uint64>(Offset) + sizeof(uint32) > Size)
+		return false;
+
+	FMemory::Memcpy(&OutValue, Data + Offset, sizeof(uint32));
+	OutValue = INTEL_ORDER32(OutValue);
+	return true;
+}
+
+bool FAssetSnapshot::ReadString(uint32 StringIndex, FString& OutString) const
+{
+	const FHeader& Header = GetHeader();
+	uint32 StringOffset = 0;
+	uint32 Length = 0;
+
+	if (StringIndex >= INTEL_ORDER32(Header.NumStrings)
+		|| !ReadUInt32(INTEL_ORDER32(Header.StringTableOffset) + StringIndex * sizeof(uint32), StringOffset)
+		|| !ReadUInt32(StringOffset, Length)
+		|| static_cast<uint64>(StringOffset) + sizeof(uint32) + Length > Size)
+	{
+		return false;
+	}
+
+	const FUTF8ToTCHAR Converted(reinterpret_cast<const UTF8CHAR*>(Data + StringOffset + sizeof(uint32)), Length);
+	OutString = FString(Converted.Length(), Converted.Get());
+	return true;
+}
+
+bool FAssetSnapshot::StringEquals(uint32 StringIndex, const FUtf8StringView& Value) const
+{
+	const FHeader& Header = GetHeader();
+	uint32 StringOffset = 0;
+	uint32 Length = 0;
+
+	if (StringIndex >= INTEL_ORDER32(Header.NumStrings)
+		|| !ReadUInt32(INTEL_ORDER32(Header.StringTableOffset) + StringIndex * sizeof(uint32), StringOffset)
+		|| !ReadUInt32(StringOffset, Length)
+		|| static_cast<uint64>(StringOffset) + sizeof(uint32) + Length > Size)
+	{
+		return false;
+	}
+
+	return Length == static_cast<uint32>(Value.Len())
+		&& FMemory::Memcmp(Data + StringOffset + sizeof(uint32), Value.GetData(), Length) == 0;
+}
+
+uint32 FAssetSnapshot::HashKey(const FUtf8StringView& Key)
+{
+	return FCrc::MemCrc32(Key.GetData(), Key.Len());
+}
+
+uint32 FAssetSnapshot::FindRecord(uint32 IndexOffset, uint32 Capacity, const FString& Key) const
+{
+	if (Capacity == 0)
+		return 0;
+
+	const FTCHARToUTF8 Utf8Key(*Key);
+	const FUtf8StringView KeyView(reinterpret_cast<const UTF8CHAR*>(Utf8Key.Get()), Utf8Key.Length());
+	const uint32 KeyHash = HashKey(KeyView);
+
+	uint32 Slot = KeyHash & (Capacity - 1);
+	for (uint32 Probe = 0; Probe < Capacity; ++Probe)
+	{
+		uint32 SlotHash = 0;
+		uint32 RecordOffset = 0;
+		if (!ReadUInt32(IndexOffset + Slot * sizeof(FIndexSlot), SlotHash)
+			|| !ReadUInt32(IndexOffset + Slot * sizeof(FIndexSlot) + sizeof(uint32), RecordOffset)
+			|| RecordOffset == 0)
+		{
+			return 0;
+		}
+
+		// every record starts with its key string
+		uint32 KeyString = 0;
+		if (SlotHash == KeyHash && ReadUInt32(RecordOffset, KeyString) && StringEquals(KeyString, KeyView))
+			return RecordOffset;
+
+		Slot = (Slot + 1) & (Capacity - 1);
+	}
+
+	return 0;
+}
+
+bool FAssetSnapshot::DecodeProfile(uint32 RecordOffset, FAssetProfile& OutProfile) const
+{
+	uint32 IdString = 0;
+	uint32 NumVariants = 0;
+	if (!ReadUInt32(RecordOffset, IdString) || !ReadUInt32(RecordOffset + sizeof(uint32), NumVariants))
+		return false;
+
+	const uint64 VariantsSize = static_cast<uint64>(NumVariants) * AssetSnapshotFormat::NumStringsPerVariant * sizeof(uint32);
+	if (RecordOffset + 2 * sizeof(uint32) + VariantsSize > Size)
+		return false;
+
+	FString Id;
+	if (!ReadString(IdString, Id))
+		return false;
+
+	TArray<FAssetProfileVariant> Variants;
+	Variants.Reserve(NumVariants);
+
+	uint32 Offset = RecordOffset + 2 * sizeof(uint32);
+	for (uint32 VariantIndex = 0; VariantIndex < NumVariants; ++VariantIndex)
+	{
+		FString Strings[AssetSnapshotFormat::NumStringsPerVariant];
+		for (FString& String : Strings)
+		{
+			uint32 StringIndex = 0;
+			if (!ReadUInt32(Offset, StringIndex) || !ReadString(StringIndex, String))
+				return false;
+			Offset += sizeof(uint32);
+		}
+
+		// catalog uris are stored resolved, so the relative path stays empty
+		Variants.Emplace(Strings[0], Strings[1], Strings[2], Strings[3], Strings[4]);
+	}
+
+	OutProfile = FAssetProfile(Id, Variants);
+	return true;
+}
+
+bool FAssetSnapshot::FindProfile(const FString& AssetId, FAssetProfile& OutProfile) const
+{
+	const FHeader& Header = GetHeader();
+	const uint32 IndexOffset = INTEL_ORDER32(Header.ProfileIndexOffset);
+	const uint32 Capacity = INTEL_ORDER32(Header.ProfileIndexCapacity);
+
+	uint32 RecordOffset = FindRecord(IndexOffset, Capacity, AssetIdUtils::FormatAssetId(AssetId));
+	if (RecordOffset == 0)
+	{
+		RecordOffset = FindRecord(IndexOffset, Capacity, AssetIdUtils::FormatAssetId(AssetIdUtils::ConvertAssetIdToOverrideId(AssetId)));
+	}
+
+	return RecordOffset != 0 && DecodeProfile(RecordOffset, OutProfile);
+}
+
+void FAssetSnapshot::GetAllProfiles(TArray<FAssetProfile>& OutProfiles) const
+{
+	const FHeader& Header = GetHeader();
+	const uint32 Count = INTEL_ORDER32(Header.NumProfiles);
+	OutProfiles.Reserve(OutProfiles.Num() + Count);
+
+	uint32 Offset = INTEL_ORDER32(Header.ProfilesOffset);
+	for (uint32 ProfileIndex = 0; ProfileIndex < Count; ++ProfileIndex)
+	{
+		uint32 NumVariants = 0;
+		FAssetProfile Profile;
+		if (!ReadUInt32(Offset + sizeof(uint32), NumVariants) || !DecodeProfile(Offset, Profile))
+		{
+			UE_LOG(LogFutureverseUBFController, Warning, TEXT("FAssetSnapshot::GetAllProfiles profile record %u in %s is corrupt"), ProfileIndex, *SourcePath);
+			return;
+		}
+
+		OutProfiles.Add(MoveTemp(Profile));
+		Offset += (2 + NumVariants * AssetSnapshotFormat::NumStringsPerVariant) * sizeof(uint32);
+	}
+}
+
+bool FAssetSnapshot::FindCatalogSource(const FString& URI, FString& OutSource) const
+{
+	const FHeader& Header = GetHeader();
+	const uint32 RecordOffset = FindRecord(INTEL_ORDER32(Header.CatalogIndexOffset), INTEL_ORDER32(Header.CatalogIndexCapacity), URI);
+
+	uint32 SourceString = 0;
+	return RecordOffset != 0 && ReadUInt32(RecordOffset + sizeof(uint32), SourceString) && ReadString(SourceString, OutSource);
+}
+
+uint32 FAssetSnapshot::FindBlobRecord(const FString& URI) const
+{
+	const FHeader& Header = GetHeader();
+	return FindRecord(INTEL_ORDER32(Header.BlobIndexOffset), INTEL_ORDER32(Header.BlobIndexCapacity), URI);
+}
+
+bool FAssetSnapshot::FindBlob(const FString& URI, TConstArrayView<uint8>& OutData, FString* OutTypeId) const
+{
+	const uint32 RecordOffset = FindBlobRecord(URI);
+
+	uint32 TypeString = 0;
+	uint32 DataOffset = 0;
+	uint32 DataSize = 0;
+	if (RecordOffset == 0
+		|| !ReadUInt32(RecordOffset + sizeof(uint32), TypeString)
+		|| !ReadUInt32(RecordOffset + 2 * sizeof(uint32), DataOffset)
+		|| !ReadUInt32(RecordOffset + 3 * sizeof(uint32), DataSize)
+		|| static_cast<uint64>(DataOffset) + DataSize > Size)
+	{
+		return false;
+	}
+
+	if (OutTypeId && !ReadString(TypeString, *OutTypeId))
+		return false;
+
+	OutData = TConstArrayView<uint8>(Data + DataOffset, DataSize);
+	return true;
+}
+
+bool FAssetSnapshot::ContainsBlob(const FString& URI) const
+{
+	return FindBlobRecord(URI) != 0;
+}
+
+int32 FAssetSnapshot::NumProfiles() const
+{
+	return INTEL_ORDER32(GetHeader().NumProfiles);
+}
+
+int32 FAssetSnapshot::NumCatalogs() const
+{
+	return INTEL_ORDER32(GetHeader().NumCatalogs);
+}
+
+int32 FAssetSnapshot::NumBlobs() const
+{
+	return INTEL_ORDER32(GetHeader().NumBlobs);
+}
+
+void FAssetSnapshotWriter::AddProfile(const FAssetProfile& AssetProfile)
+{
+	Profiles.Add(AssetIdUtils::FormatAssetId(AssetProfile.GetId()), AssetProfile);
+}
+
+void FAssetSnapshotWriter::AddCatalogSource(const FString& URI, const FString& Source)
+{
+	CatalogSources.Add(URI, Source);
+}
+
+void FAssetSnapshotWriter::AddBlob(const FString& URI, const FString& TypeId, TArray<uint8>&& Data)
+{
+	Blobs.Add(URI, FBlob{TypeId, MoveTemp(Data)});
+}
+
+TArray<uint8> FAssetSnapshotWriter::Build() const
+{
+	using namespace AssetSnapshotFormat;
+
+	FStringTableBuilder StringTable;
+	for (const auto& Profile : Profiles)
+	{
+		StringTable.Add(Profile.Key);
+		for (const FAssetProfileVariant& Variant : Profile.Value.GetVariants())
+		{
+			StringTable.Add(Variant.GetVariantId());
+			StringTable.Add(Variant.GetRenderBlueprintId());
+			StringTable.Add(Variant.GetParsingBlueprintId());
+			StringTable.Add(Variant.GetRenderCatalogUri());
+			StringTable.Add(Variant.GetParsingCatalogUri());
+		}
+	}
+	for (const auto& CatalogSource : CatalogSources)
+	{
+		StringTable.Add(CatalogSource.Key);
+		StringTable.Add(CatalogSource.Value);
+	}
+	for (const auto& Blob : Blobs)
+	{
+		StringTable.Add(Blob.Key);
+		StringTable.Add(Blob.Value.TypeId);
+	}
+
+	FAssetSnapshot::FHeader Header;
+	FMemory::Memzero(Header);
+
+	TArray<uint8> Out;
+	Out.AddZeroed(sizeof(FAssetSnapshot::FHeader));
+
+	// strings
+	const TArray<FString>& Strings = StringTable.GetStrings();
+	Header.NumStrings = Strings.Num();
+	Header.StringTableOffset = Out.Num();
+	Out.AddZeroed(Strings.Num() * sizeof(uint32));
+	for (int32 StringIndex = 0; StringIndex < Strings.Num(); ++StringIndex)
+	{
+		PatchUInt32(Out, Header.StringTableOffset + StringIndex * sizeof(uint32), Out.Num());
+
+		const FTCHARToUTF8 Utf8String(*Strings[StringIndex]);
+		WriteUInt32(Out, Utf8String.Length());
+		Out.Append(reinterpret_cast<const uint8*>(Utf8String.Get()), Utf8String.Length());
+	}
+	PadToAlignment(Out);
+
+	// profiles, keyed by the formatted id which is also stored as the record id
+	TArray<TPair<uint32, uint32>> ProfileSlots;
+	Header.NumProfiles = Profiles.Num();
+	Header.ProfilesOffset = Out.Num();
+	for (const auto& Profile : Profiles)
+	{
+		const FTCHARToUTF8 Utf8Key(*Profile.Key);
+		ProfileSlots.Emplace(FAssetSnapshot::HashKey(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Utf8Key.Get()), Utf8Key.Length())), Out.Num());
+
+		WriteUInt32(Out, StringTable.Add(Profile.Key));
+		WriteUInt32(Out, Profile.Value.GetVariants().Num());
+		for (const FAssetProfileVariant& Variant : Profile.Value.GetVariants())
+		{
+			WriteUInt32(Out, StringTable.Add(Variant.GetVariantId()));
+			WriteUInt32(Out, StringTable.Add(Variant.GetRenderBlueprintId()));
+			WriteUInt32(Out, StringTable.Add(Variant.GetParsingBlueprintId()));
+			WriteUInt32(Out, StringTable.Add(Variant.GetRenderCatalogUri()));
+			WriteUInt32(Out, StringTable.Add(Variant.GetParsingCatalogUri()));
+		}
+	}
+	WriteIndex(Out, ProfileSlots, Header.ProfileIndexCapacity, Header.ProfileIndexOffset);
+
+	// catalogs
+	TArray<TPair<uint32, uint32>> CatalogSlots;
+	Header.NumCatalogs = CatalogSources.Num();
+	Header.CatalogsOffset = Out.Num();
+	for (const auto& CatalogSource : CatalogSources)
+	{
+		const FTCHARToUTF8 Utf8Key(*CatalogSource.Key);
+		CatalogSlots.Emplace(FAssetSnapshot::HashKey(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Utf8Key.Get()), Utf8Key.Length())), Out.Num());
+
+		WriteUInt32(Out, StringTable.Add(CatalogSource.Key));
+		WriteUInt32(Out, StringTable.Add(CatalogSource.Value));
+	}
+	WriteIndex(Out, CatalogSlots, Header.CatalogIndexCapacity, Header.CatalogIndexOffset);
+
+	// blob bytes first so the records after them can point straight at their data
+	TArray<uint32> BlobDataOffsets;
+	BlobDataOffsets.Reserve(Blobs.Num());
+	for (const auto& Blob : Blobs)
+	{
+		BlobDataOffsets.Add(Out.Num());
+		Out.Append(Blob.Value.Data);
+		PadToAlignment(Out);
+	}
+
+	TArray<TPair<uint32, uint32>> BlobSlots;
+	Header.NumBlobs = Blobs.Num();
+	Header.BlobsOffset = Out.Num();
+	int32 BlobIndex = 0;
+	for (const auto& Blob : Blobs)
+	{
+		const FTCHARToUTF8 Utf8Key(*Blob.Key);
+		BlobSlots.Emplace(FAssetSnapshot::HashKey(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Utf8Key.Get()), Utf8Key.Length())), Out.Num());
+
+		WriteUInt32(Out, StringTable.Add(Blob.Key));
+		WriteUInt32(Out, StringTable.Add(Blob.Value.TypeId));
+		WriteUInt32(Out, BlobDataOffsets[BlobIndex++]);
+		WriteUInt32(Out, Blob.Value.Data.Num());
+	}
+	WriteIndex(Out, BlobSlots, Header.BlobIndexCapacity, Header.BlobIndexOffset);
+
+	Header.Magic = FAssetSnapshot::Magic;
+	Header.Version = FAssetSnapshot::Version;
+	Header.FileSize = Out.Num();
+	Header.PayloadCrc = FCrc::MemCrc32(Out.GetData() + sizeof(FAssetSnapshot::FHeader), Out.Num() - sizeof(FAssetSnapshot::FHeader));
+
+	const uint32* HeaderFields = reinterpret_cast<const uint32*>(&Header);
+	for (uint32 FieldIndex = 0; FieldIndex < sizeof(FAssetSnapshot::FHeader) / sizeof(uint32); ++FieldIndex)
+	{
+		PatchUInt32(Out, FieldIndex * sizeof(uint32), HeaderFields[FieldIndex]);
+	}
+
+	return Out;
+}
+
+bool FAssetSnapshotWriter::Save(const FString& Path) const
+{
+	const TArray<uint8> Data = Build();
+	if (!FFileHelper::SaveArrayToFile(Data, *Path))
+	{
+		UE_LOG(LogFutureverseUBFController, Error, TEXT("FAssetSnapshotWriter::Save failed to write %s"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogFutureverseUBFController, Log, TEXT("FAssetSnapshotWriter::Save wrote %d profiles, %d catalogs and %d blobs to %s (%d bytes)"),
+		Profiles.Num(), CatalogSources.Num(), Blobs.Num(), *Path, Data.Num());
+	return true;
+}
@@ -0,0 +1,16 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+
+#include "Snapshots/BundleURIResolver.h"
+
+#include "Downloads/ControllerDownloadManager.h"
+
+bool UBundleURIResolver::CanResolveURI(const FString& URI)
+{
+	return FControllerDownloadManager::GetInstance()->ContainsSnapshotBlob(URI);
+}
+
+TFuture<UBF::FLoadDataArrayResult> UBundleURIResolver::ResolveURI(const FString& TypeId, const FString& URI)
+{
+	return FControllerDownloadManager::GetInstance()->LoadDataFromURI(TypeId, URI);
+}
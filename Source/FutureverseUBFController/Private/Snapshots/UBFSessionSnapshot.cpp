@@ -0,0 +1,116 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "Snapshots/UBFSessionSnapshot.h"
+
+#include "FutureverseUBFControllerLog.h"
+#include "JsonObjectConverter.h"
+#include "Downloads/ControllerDownloadManager.h"
+#include "Snapshots/AssetSnapshot.h"
+
+namespace UBFSessionSnapshot
+{
+	const TCHAR* ManifestURI = TEXT("ubf-session://manifest");
+	const TCHAR* ManifestTypeId = TEXT("SessionManifest");
+}
+
+TSharedPtr<FUBFSessionSnapshot> FUBFSessionSnapshot::Open(const FString& Path)
+{
+	// nothing to restore on the first launch
+	if (!FPaths::FileExists(Path))
+		return nullptr;
+	
+	const TSharedPtr<FAssetSnapshot> Snapshot = FAssetSnapshot::Open(Path);
+	TConstArrayView<uint8> ManifestData;
+	if (!Snapshot.IsValid() || !Snapshot->FindBlob(UBFSessionSnapshot::ManifestURI, ManifestData))
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("FUBFSessionSnapshot::Open %s is not a session snapshot"), *Path);
+		return nullptr;
+	}
+
+	const FUTF8ToTCHAR ManifestJson(reinterpret_cast<const ANSICHAR*>(ManifestData.GetData()), ManifestData.Num());
+	FUBFSessionManifest Manifest;
+	if (!FJsonObjectConverter::JsonObjectStringToUStruct(FString(ManifestJson.Length(), ManifestJson.Get()), &Manifest)
+		|| Manifest.Version != Version)
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("FUBFSessionSnapshot::Open %s is invalid or from an unsupported version"), *Path);
+		return nullptr;
+	}
+
+	TSharedPtr<FUBFSessionSnapshot> SessionSnapshot = MakeShared<FUBFSessionSnapshot>();
+	for (FUBFSessionRender& Render : Manifest.Renders)
+	{
+		const FString Slot = Render.Slot;
+		SessionSnapshot->Renders.Add(Slot, MoveTemp(Render));
+	}
+	SessionSnapshot->Snapshot = Snapshot;
+	FControllerDownloadManager::GetInstance()->MountSnapshot(Snapshot);
+
+	UE_LOG(LogFutureverseUBFController, Log, TEXT("FUBFSessionSnapshot::Open %d renders to restore from %s"), SessionSnapshot->Renders.Num(), *Path);
+	return SessionSnapshot;
+}
+
+TArray<uint8> FUBFSessionSnapshot::Build(const TArray<FUBFSessionRender>& Renders, const TArray<FAssetProfilePtr>& AssetProfiles)
+{
+	FControllerDownloadManager* DownloadManager = FControllerDownloadManager::GetInstance();
+	const TMap<FString, FString> CapturedCatalogSources = DownloadManager->GetCapturedCatalogSources();
+
+	FAssetSnapshotWriter Writer;
+	const auto AddCatalogSource = [&Writer, &CapturedCatalogSources, DownloadManager](const FString& URI)
+	{
+		if (URI.IsEmpty() || Writer.ContainsCatalogSource(URI))
+			return;
+
+		FString Source;
+		if (const FString* CapturedSource = CapturedCatalogSources.Find(URI))
+		{
+			Writer.AddCatalogSource(URI, *CapturedSource);
+		}
+		else if (DownloadManager->FindSnapshotCatalog(URI, Source))
+		{
+			Writer.AddCatalogSource(URI, Source);
+		}
+	};
+
+	TSet<FString> VariantIDs;
+	for (const FUBFSessionRender& Render : Renders)
+	{
+		VariantIDs.Add(Render.VariantID);
+	}
+	
+	for (const FAssetProfilePtr& AssetProfile : AssetProfiles)
+	{
+		if (!AssetProfile.IsValid())
+			continue;
+		
+		Writer.AddProfile(*AssetProfile);
+		for (const FString& VariantID : VariantIDs)
+		{
+			if (const FAssetProfileVariant* Variant = AssetProfile->FindVariant(VariantID))
+			{
+				AddCatalogSource(Variant->GetRenderCatalogUri());
+				AddCatalogSource(Variant->GetParsingCatalogUri());
+			}
+		}
+	}
+
+	FUBFSessionManifest Manifest;
+	Manifest.Version = Version;
+	Manifest.Renders = Renders;
+	
+	FString ManifestJson;
+	FJsonObjectConverter::UStructToJsonObjectString(Manifest, ManifestJson);
+	const FTCHARToUTF8 ManifestUtf8(*ManifestJson);
+	Writer.AddBlob(UBFSessionSnapshot::ManifestURI, UBFSessionSnapshot::ManifestTypeId,
+		TArray<uint8>(reinterpret_cast<const uint8*>(ManifestUtf8.Get()), ManifestUtf8.Length()));
+	
+	return Writer.Build();
+}
+
+void FUBFSessionSnapshot::Unmount()
+{
+	if (Snapshot.IsValid())
+	{
+		FControllerDownloadManager::GetInstance()->UnmountSnapshot(Snapshot);
+		Snapshot.Reset();
+	}
+}
@@ -6,6 +6,7 @@
 #include "SyloSubsystem.h"
 #include "SyloUtils.h"
 #include "GraphProvider.h"
+#include "Downloads/ControllerDownloadManager.h"
 
 bool USyloURIResolver::CanResolveURI(const FString& URI)
 {
@@ -13,6 +14,33 @@ bool USyloURIResolver::CanResolveURI(const FString& URI)
 }
 
 TFuture<UBF::FLoadDataArrayResult> USyloURIResolver::ResolveURI(const FString& TypeId, const FString& URI)
+{
+	FTrafficArchive& TrafficArchive = FControllerDownloadManager::GetInstance()->GetTrafficArchive();
+	if (!TrafficArchive.IsActive())
+		return LoadSyloDID(URI);
+
+	return TrafficArchive.Exchange(EUBFTrafficKind::Sylo, URI, [this, &URI]()
+	{
+		return LoadSyloDID(URI).Next([](const UBF::FLoadDataArrayResult& Result)
+		{
+			FUBFTrafficResponse Response;
+			Response.bSuccess = Result.bSuccess;
+			Response.Payload = Result.Value;
+			return Response;
+		});
+	})
+	.Next([](const FUBFTrafficResponse& Response)
+	{
+		UBF::FLoadDataArrayResult Result;
+		if (Response.bSuccess)
+		{
+			Result.SetResult(Response.Payload);
+		}
+		return Result;
+	});
+}
+
+TFuture<UBF::FLoadDataArrayResult> USyloURIResolver::LoadSyloDID(const FString& URI) const
 {
 	TSharedPtr<TPromise<UBF::FLoadDataArrayResult>> Promise = MakeShared<TPromise<UBF::FLoadDataArrayResult>>();
 	if (USyloSubsystem* SyloSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<USyloSubsystem>())
@@ -0,0 +1,211 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "VariantPolicy/UBFVariantPolicySubsystem.h"
+
+#include "FutureverseUBFControllerLog.h"
+#include "FutureverseUBFControllerSettings.h"
+#include "FutureverseUBFControllerStats.h"
+#include "FutureverseUBFControllerSubsystem.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+void UUBFVariantPolicyRender::HandleRenderComplete(bool bSuccess, FUBFExecutionReport ExecutionReport)
+{
+	if (bSuccess)
+	{
+		RenderedVariantID = PendingVariantID;
+		FailedVariantID.Reset();
+	}
+	else
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UUBFVariantPolicyRender::HandleRenderComplete failed to render variant %s, it won't be retried until the policy picks another variant"), *PendingVariantID);
+		FailedVariantID = PendingVariantID;
+	}
+	PendingVariantID.Reset();
+
+	if (OnFirstRenderComplete.IsBound())
+	{
+		const FOnComplete OnComplete = OnFirstRenderComplete;
+		OnFirstRenderComplete.Unbind();
+		OnComplete.Execute(bSuccess, ExecutionReport);
+	}
+}
+
+UUBFVariantPolicySubsystem* UUBFVariantPolicySubsystem::Get(const UObject* WorldContext)
+{
+	if (const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull) : nullptr)
+	{
+		return World->GetSubsystem<UUBFVariantPolicySubsystem>();
+	}
+
+	return nullptr;
+}
+
+void UUBFVariantPolicySubsystem::RenderItemWithPolicy(UUBFItem* Item, UUBFRuntimeController* Controller, const FUBFVariantPolicy& Policy,
+	const TMap<FString, UUBFBindingObject*>& InputMap, bool bRenderTree, const FOnComplete& OnComplete)
+{
+	UFutureverseUBFControllerSubsystem* ControllerSubsystem = UFutureverseUBFControllerSubsystem::Get(this);
+	if (!ControllerSubsystem || !IsValid(Item) || !IsValid(Controller))
+	{
+		UE_LOG(LogFutureverseUBFController, Warning, TEXT("UUBFVariantPolicySubsystem::RenderItemWithPolicy was provided invalid Item or Controller. Cannot Render."));
+		OnComplete.ExecuteIfBound(false, FUBFExecutionReport::Failure());
+		return;
+	}
+
+	RemovePolicy(Controller);
+
+	UUBFVariantPolicyRender* Render = NewObject<UUBFVariantPolicyRender>(this);
+	Render->Controller = Controller;
+	Render->Policy = Policy;
+	Render->OnFirstRenderComplete = OnComplete;
+	// start cheap, the next update upgrades the characters that qualify for the full variant
+	Render->PendingVariantID = Policy.ReducedVariantID.IsEmpty() ? Policy.FullVariantID : Policy.ReducedVariantID;
+	Renders.Add(Render);
+
+	FOnComplete OnRenderComplete;
+	OnRenderComplete.BindUFunction(Render, GET_FUNCTION_NAME_CHECKED(UUBFVariantPolicyRender, HandleRenderComplete));
+	if (bRenderTree)
+	{
+		ControllerSubsystem->RenderItemTree(Item, Render->PendingVariantID, Controller, InputMap, OnRenderComplete);
+	}
+	else
+	{
+		ControllerSubsystem->RenderItem(Item, Render->PendingVariantID, Controller, InputMap, OnRenderComplete);
+	}
+}
+
+void UUBFVariantPolicySubsystem::RemovePolicy(UUBFRuntimeController* Controller)
+{
+	Renders.RemoveAll([Controller](const UUBFVariantPolicyRender* Render) { return Render->Controller == Controller; });
+}
+
+int32 UUBFVariantPolicySubsystem::GetNumFullVariantRenders() const
+{
+	int32 NumFullVariantRenders = 0;
+	for (const UUBFVariantPolicyRender* Render : Renders)
+	{
+		NumFullVariantRenders += Render->RenderedVariantID == Render->Policy.FullVariantID ? 1 : 0;
+	}
+	return NumFullVariantRenders;
+}
+
+void UUBFVariantPolicySubsystem::Tick(float DeltaTime)
+{
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < GetDefault<UFutureverseUBFControllerSettings>()->GetVariantPolicyUpdateInterval())
+		return;
+	TimeSinceUpdate = 0.f;
+
+	FVector ViewLocation;
+	if (!Renders.IsEmpty() && GetViewLocation(ViewLocation))
+	{
+		UpdateVariants(ViewLocation);
+	}
+}
+
+TStatId UUBFVariantPolicySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUBFVariantPolicySubsystem, STATGROUP_Tickables);
+}
+
+bool UUBFVariantPolicySubsystem::GetViewLocation(FVector& OutViewLocation) const
+{
+	const APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	if (!PlayerController || !PlayerController->PlayerCameraManager)
+		return false;
+
+	OutViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+	return true;
+}
+
+void UUBFVariantPolicySubsystem::UpdateVariants(const FVector& ViewLocation)
+{
+	Renders.RemoveAll([](const UUBFVariantPolicyRender* Render) { return !Render->Controller.IsValid(); });
+
+	TArray<UUBFVariantPolicyRender*> FullVariantCandidates;
+	for (UUBFVariantPolicyRender* Render : Renders)
+	{
+		Render->bWantsFullVariant = false;
+
+		// without a reduced variant there is nothing to switch to
+		const USceneComponent* RootComponent = Render->Controller->RootComponent;
+		if (Render->Policy.ReducedVariantID.IsEmpty() || !IsValid(RootComponent))
+			continue;
+
+		Render->DistanceSquared = FVector::DistSquared(ViewLocation, RootComponent->GetComponentLocation());
+		const AActor* Owner = RootComponent->GetOwner();
+		const bool bRendered = !Render->Policy.bReduceWhenNotRendered || !Owner || Owner->WasRecentlyRendered(0.5f);
+
+		const bool bIsFullVariant = (Render->IsBusy() ? Render->PendingVariantID : Render->RenderedVariantID) == Render->Policy.FullVariantID;
+		const double MaxDistance = bIsFullVariant ? Render->Policy.DowngradeDistance : Render->Policy.UpgradeDistance;
+		if (bRendered && Render->DistanceSquared <= FMath::Square(MaxDistance))
+		{
+			FullVariantCandidates.Add(Render);
+		}
+	}
+
+	// nearest characters get the full variant budget
+	FullVariantCandidates.Sort([](const UUBFVariantPolicyRender& A, const UUBFVariantPolicyRender& B) { return A.DistanceSquared < B.DistanceSquared; });
+	const UFutureverseUBFControllerSettings* Settings = GetDefault<UFutureverseUBFControllerSettings>();
+	const int32 MaxFullVariantRenders = Settings->GetMaxFullVariantRenders();
+	for (int32 Index = 0; Index < FullVariantCandidates.Num() && (MaxFullVariantRenders == 0 || Index < MaxFullVariantRenders); ++Index)
+	{
+		FullVariantCandidates[Index]->bWantsFullVariant = true;
+	}
+
+	TArray<UUBFVariantPolicyRender*> Switches;
+	for (UUBFVariantPolicyRender* Render : Renders)
+	{
+		const FString& VariantID = Render->bWantsFullVariant ? Render->Policy.FullVariantID : Render->Policy.ReducedVariantID;
+		if (Render->FailedVariantID != VariantID)
+		{
+			Render->FailedVariantID.Reset();
+		}
+		
+		if (!Render->IsBusy() && !VariantID.IsEmpty() && !Render->RenderedVariantID.IsEmpty()
+			&& Render->RenderedVariantID != VariantID && Render->FailedVariantID != VariantID)
+		{
+			Switches.Add(Render);
+		}
+	}
+
+	// downgrades first to release the budget they hold, then upgrades nearest first
+	Switches.Sort([](const UUBFVariantPolicyRender& A, const UUBFVariantPolicyRender& B)
+	{
+		if (A.bWantsFullVariant != B.bWantsFullVariant)
+			return !A.bWantsFullVariant;
+		return A.bWantsFullVariant ? A.DistanceSquared < B.DistanceSquared : A.DistanceSquared > B.DistanceSquared;
+	});
+
+	const int32 NumSwitches = FMath::Min(Switches.Num(), Settings->GetMaxVariantSwitchesPerUpdate());
+	for (int32 Index = 0; Index < NumSwitches; ++Index)
+	{
+		UUBFVariantPolicyRender* Render = Switches[Index];
+		SwitchVariant(Render, Render->bWantsFullVariant ? Render->Policy.FullVariantID : Render->Policy.ReducedVariantID);
+	}
+}
+
+void UUBFVariantPolicySubsystem::SwitchVariant(UUBFVariantPolicyRender* Render, const FString& VariantID)
+{
+	UFutureverseUBFControllerSubsystem* ControllerSubsystem = UFutureverseUBFControllerSubsystem::Get(this);
+	if (!ControllerSubsystem)
+		return;
+
+	UE_LOG(LogFutureverseUBFController, Verbose, TEXT("UUBFVariantPolicySubsystem::SwitchVariant %s -> %s at %.0f"),
+		*Render->RenderedVariantID, *VariantID, FMath::Sqrt(Render->DistanceSquared));
+	if (VariantID == Render->Policy.FullVariantID)
+	{
+		INC_DWORD_STAT(STAT_UBFVariantUpgrades);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_UBFVariantDowngrades);
+	}
+
+	Render->PendingVariantID = VariantID;
+	FOnComplete OnRenderComplete;
+	OnRenderComplete.BindUFunction(Render, GET_FUNCTION_NAME_CHECKED(UUBFVariantPolicyRender, HandleRenderComplete));
+	ControllerSubsystem->SwitchRenderedVariant(Render->Controller.Get(), VariantID, OnRenderComplete);
+}
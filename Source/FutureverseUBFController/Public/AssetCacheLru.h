@@ -0,0 +1,157 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/List.h"
+
+/**
+ * Recency order and byte accounting for a keyed cache. The cache itself keeps owning the values,
+ * this only decides which keys to drop once the count or byte budget is exceeded.
+ * Pinned keys are never returned as eviction candidates, pins can be taken before the key is added.
+ */
+class FAssetCacheLru
+{
+public:
+	FAssetCacheLru() = default;
+	FAssetCacheLru(const FAssetCacheLru&) = delete;
+	FAssetCacheLru& operator=(const FAssetCacheLru&) = delete;
+
+	~FAssetCacheLru()
+	{
+		Clear();
+	}
+
+	bool Contains(const FString& Key) const
+	{
+		return Entries.Contains(Key);
+	}
+
+	// Adds the key as most recently used, or updates its size and recency if it is already tracked
+	void Add(const FString& Key, SIZE_T Bytes)
+	{
+		if (FEntry* Entry = Entries.Find(Key))
+		{
+			TotalBytes -= Entry->Bytes;
+			Entry->Bytes = Bytes;
+			TotalBytes += Bytes;
+			MoveToHead(Entry->Node);
+			return;
+		}
+
+		Order.AddHead(Key);
+		Entries.Add(Key, FEntry{Order.GetHead(), Bytes});
+		TotalBytes += Bytes;
+	}
+
+	// Marks the key as most recently used, returns false if it is not tracked
+	bool Touch(const FString& Key)
+	{
+		if (FEntry* Entry = Entries.Find(Key))
+		{
+			MoveToHead(Entry->Node);
+			return true;
+		}
+		return false;
+	}
+
+	void Remove(const FString& Key)
+	{
+		FEntry Entry;
+		if (Entries.RemoveAndCopyValue(Key, Entry))
+		{
+			TotalBytes -= Entry.Bytes;
+			Order.RemoveNode(Entry.Node);
+		}
+	}
+
+	void Pin(const FString& Key)
+	{
+		PinCounts.FindOrAdd(Key)++;
+	}
+
+	void Unpin(const FString& Key)
+	{
+		if (int32* PinCount = PinCounts.Find(Key))
+		{
+			if (--(*PinCount) <= 0)
+			{
+				PinCounts.Remove(Key);
+			}
+		}
+	}
+
+	bool IsPinned(const FString& Key) const
+	{
+		return PinCounts.Contains(Key);
+	}
+
+	// Least recently used unpinned keys that need to go to fit within the budgets. A budget of 0 is unlimited
+	void GetEvictionCandidates(const int32 MaxEntries, const SIZE_T MaxBytes, TArray<FString>& OutKeys) const
+	{
+		int32 RemainingEntries = Entries.Num();
+		SIZE_T RemainingBytes = TotalBytes;
+
+		for (auto* Node = Order.GetTail(); Node; Node = Node->GetPrevNode())
+		{
+			const bool bOverCount = MaxEntries > 0 && RemainingEntries > MaxEntries;
+			const bool bOverBytes = MaxBytes > 0 && RemainingBytes > MaxBytes;
+			if (!bOverCount && !bOverBytes)
+				break;
+
+			const FString& Key = Node->GetValue();
+			if (IsPinned(Key))
+				continue;
+
+			OutKeys.Add(Key);
+			RemainingEntries--;
+			RemainingBytes -= Entries[Key].Bytes;
+		}
+	}
+
+	// Least recently used key that is not pinned, empty if every key is pinned
+	FString GetLeastRecentUnpinned() const
+	{
+		for (auto* Node = Order.GetTail(); Node; Node = Node->GetPrevNode())
+		{
+			if (!IsPinned(Node->GetValue()))
+				return Node->GetValue();
+		}
+		return FString();
+	}
+
+	void Clear()
+	{
+		Entries.Reset();
+		Order.Empty();
+		TotalBytes = 0;
+	}
+
+	int32 Num() const { return Entries.Num(); }
+	SIZE_T GetTotalBytes() const { return TotalBytes; }
+	int32 NumPinned() const { return PinCounts.Num(); }
+
+private:
+	using FNode = TDoubleLinkedList<FString>::TDoubleLinkedListNode;
+
+	struct FEntry
+	{
+		FNode* Node = nullptr;
+		SIZE_T Bytes = 0;
+	};
+
+	void MoveToHead(FNode* Node)
+	{
+		if (Node == Order.GetHead())
+			return;
+
+		Order.RemoveNode(Node, false);
+		Order.AddHead(Node);
+	}
+
+	// head is the most recently used key
+	TDoubleLinkedList<FString> Order;
+	TMap<FString, FEntry> Entries;
+	TMap<FString, int32> PinCounts;
+	SIZE_T TotalBytes = 0;
+};
@@ -10,27 +10,45 @@ public:
 	
 	bool Contains(const FString& AssetId) const
 	{
-		FString FormatedAssetId = AssetIdUtils::FormatAssetId(AssetId);
-		if (InternalMap.Contains(FormatedAssetId))
-			return true;
-
-		if (InternalMap.Contains(AssetIdUtils::ConvertAssetIdToOverrideId(AssetId)))
-			return true;
-
-		return false;
+		return Find(AssetId) != nullptr;
 	}
 	
+	// Returns a default constructed T when AssetId is not found
 	T Get(const FString& AssetId) const
+	{
+		const T* Value = Find(AssetId);
+		return Value ? *Value : T();
+	}
+	
+	// Doesn't allocate for ids that fit the inline key buffer, including the override fallback
+	const T* Find(const FString& AssetId) const
+	{
+		if (const T* Value = AssetIdUtils::IsFormattedAssetId(AssetId) ? InternalMap.Find(AssetId) : FindFormatted(AssetId))
+			return Value;
+
+		TStringBuilder<KeyBufferSize> OverrideKey;
+		AssetIdUtils::AppendFormattedOverrideId(OverrideKey, AssetId);
+		return FindByKey(*OverrideKey);
+	}
+	
+	// Key the value for AssetId is stored under, including the override fallback used by Contains and Get. Empty if not found
+	FString FindKey(const FString& AssetId) const
 	{
 		FString FormatedAssetId = AssetIdUtils::FormatAssetId(AssetId);
 		if (InternalMap.Contains(FormatedAssetId))
-			return InternalMap[FormatedAssetId];
+			return FormatedAssetId;
 
 		FString OverrideKey = AssetIdUtils::ConvertAssetIdToOverrideId(AssetId);
 		if (InternalMap.Contains(OverrideKey))
-			return InternalMap[OverrideKey];
+			return OverrideKey;
 
-		return T();
+		return FString();
+	}
+	
+	// Exact lookup without the override fallback used by Contains and Get
+	const T* FindExact(const FString& AssetId) const
+	{
+		return InternalMap.Find(AssetIdUtils::FormatAssetId(AssetId));
 	}
 	
 	void Add(const FString& AssetId, const T& Value)
@@ -45,6 +63,14 @@ public:
 	{
 		InternalMap.Reset();
 	}
+	int32 Num() const
+	{
+		return InternalMap.Num();
+	}
+	SIZE_T GetAllocatedSize() const
+	{
+		return InternalMap.GetAllocatedSize();
+	}
 
 	// Support for ranged-for iteration
 	FORCEINLINE auto begin() { return InternalMap.begin(); }
@@ -53,6 +79,21 @@ public:
 	FORCEINLINE auto end() const { return InternalMap.end(); }
 	
 private:
+	static constexpr int32 KeyBufferSize = 128;
+	
+	const T* FindFormatted(const FString& AssetId) const
+	{
+		TStringBuilder<KeyBufferSize> Key;
+		AssetIdUtils::AppendFormattedAssetId(Key, AssetId);
+		return FindByKey(*Key);
+	}
+	
+	// Looks Key up without building an FString, hashed the same way as the map's FString keys
+	const T* FindByKey(const TCHAR* Key) const
+	{
+		return InternalMap.FindByHash(FCrc::Strihash_DEPRECATED(Key), Key);
+	}
+	
 	TMap<FString, T> InternalMap;
 	
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Misc/StringBuilder.h"
+
 namespace AssetIdUtils
 {
 	inline FString GetCollectionID(const FString& CombinedID)
@@ -60,8 +62,40 @@ namespace AssetIdUtils
 		return AssetId.ToLower().Replace(TEXT(" "), TEXT("")).Replace(TEXT("-"), TEXT(""));
 	}
 
+	// True when FormatAssetId would return AssetId unchanged, lets lookups skip the formatting allocation
+	inline bool IsFormattedAssetId(const FString& AssetId)
+	{
+		for (const TCHAR Char : AssetId)
+		{
+			if (Char == TEXT(' ') || Char == TEXT('-') || FChar::ToLower(Char) != Char)
+				return false;
+		}
+		return true;
+	}
+
 	inline FString ConvertAssetIdToOverrideId(const FString& CombinedId)
 	{
 		return FString::Printf(TEXT("%s:%s"), *GetCollectionID(CombinedId), TEXT("override"));
 	}
+
+	// Appends FormatAssetId(AssetId) to Out, lookups use it with an inline builder to stay off the heap
+	inline void AppendFormattedAssetId(FStringBuilderBase& Out, FStringView AssetId)
+	{
+		for (const TCHAR Char : AssetId)
+		{
+			if (Char != TEXT(' ') && Char != TEXT('-'))
+				Out.AppendChar(FChar::ToLower(Char));
+		}
+	}
+
+	// Appends FormatAssetId(ConvertAssetIdToOverrideId(CombinedId)) to Out
+	inline void AppendFormattedOverrideId(FStringBuilderBase& Out, const FString& CombinedId)
+	{
+		int32 Index;
+		if (CombinedId.FindLastChar(TEXT(':'), Index))
+		{
+			AppendFormattedAssetId(Out, FStringView(CombinedId).Left(Index));
+		}
+		Out.Append(TEXT(":override"));
+	}
 };
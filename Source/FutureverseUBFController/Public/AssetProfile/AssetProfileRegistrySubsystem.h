@@ -3,13 +3,17 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "AssetCacheLru.h"
 #include "AssetIdMap.h"
+#include "FutureverseUBFControllerStats.h"
 #include "GraphProvider.h"
 #include "ControllerLayers/AssetProfile.h"
 #include "UObject/Object.h"
 #include "AssetProfileRegistrySubsystem.generated.h"
 
 struct FFutureverseAssetLoadData;
+class FAssetSnapshotWriter;
+enum class EUBFDownloadPriority : uint8;
 
 template<typename T>
 struct FUTUREVERSEUBFCONTROLLER_API TAssetProfileLoadResult
@@ -29,8 +33,10 @@ struct FUTUREVERSEUBFCONTROLLER_API TAssetProfileLoadResult
 	}
 };
 
-struct FLoadAssetProfileResult final : TAssetProfileLoadResult<FAssetProfile> {};
-struct FLoadLinkedAssetProfilesResult final : TAssetProfileLoadResult<TAssetIdMap<FAssetProfile>> {};
+struct FLoadAssetProfileResult final : TAssetProfileLoadResult<FAssetProfilePtr> {};
+struct FLoadLinkedAssetProfilesResult final : TAssetProfileLoadResult<TAssetIdMap<FAssetProfilePtr>> {};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAssetProfilesEvicted, const TArray<FAssetProfilePtr>&);
 
 /**
  * 
@@ -45,13 +51,46 @@ public:
 	
 	TFuture<FLoadAssetProfileResult> GetAssetProfile(const FFutureverseAssetLoadData& LoadData);
 
+	// Downloads the profile document again regardless of the cache and snapshots and replaces the cached entries,
+	// requests already holding the previous profile keep it
+	TFuture<FLoadAssetProfileResult> RefreshAssetProfile(const FFutureverseAssetLoadData& LoadData);
+
 	bool IsSubsystemValid() const;
+
+	// Pinned profiles are kept resident regardless of the cache budgets until every pin is released
+	void PinAssetProfile(const FString& AssetId);
+	void UnpinAssetProfile(const FString& AssetId);
+	
+	const FUBFCacheCounters& GetCacheCounters() const { return CacheCounters; }
+	void ResetCacheCounters();
+	int32 GetNumAssetProfiles() const { return AssetProfiles.Num(); }
+
+	void AppendMemoryReport(FUBFMemoryReport& Report) const;
+
+	// Broadcast with the profiles dropped by the cache budgets, requests still holding them keep them alive
+	FOnAssetProfilesEvicted OnAssetProfilesEvicted;
+
+	// Adds every resident profile to Writer
+	void AppendToSnapshot(FAssetSnapshotWriter& Writer) const;
 	
 	virtual void Deinitialize() override;
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 
 private:
-	TAssetIdMap<FAssetProfile> AssetProfiles;
+	void AddAssetProfile(FAssetProfile&& AssetProfile);
+	void RemoveAssetProfile(const FString& Key);
+	
+	// Drops least recently used unpinned profiles until the cache fits the budgets in UFutureverseUBFControllerSettings
+	void EvictAssetProfiles();
+
+	TFuture<FLoadAssetProfileResult> DownloadAssetProfile(const FFutureverseAssetLoadData& LoadData, EUBFDownloadPriority Priority);
+
+	// Adds the profile from a mounted snapshot, returns null if no snapshot has it
+	FAssetProfilePtr LoadSnapshotProfile(const FString& AssetId);
+	
+	TAssetIdMap<FAssetProfilePtr> AssetProfiles;
+	FAssetCacheLru AssetProfileLru;
+	FUBFCacheCounters CacheCounters;
 
 	bool bIsInitialized = false;
 };
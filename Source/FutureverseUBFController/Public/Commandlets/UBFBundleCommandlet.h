@@ -0,0 +1,26 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "UBFBundleCommandlet.generated.h"
+
+/**
+ * Resolves a list of collections into a single bundle holding their asset profiles, catalogs and graphs,
+ * and optionally every artifact the catalogs reference. Mount the result through BundlePaths or -UBFBundles=.
+ *
+ * UnrealEditor-Cmd <Project> -run=UBFBundle -Collections=7672:root:303204,7672:root:1234 -Output=Bundles/Event.ubfb [-Artifacts]
+ * UnrealEditor-Cmd <Project> -run=UBFBundle -CollectionData=/Game/Data/Collections.Collections -Environment=Production -Output=...
+ *
+ * -GraphTypes= overrides which catalog resource types are bundled when -Artifacts is not set (default Blueprint,BlueprintInstance,Graph)
+ */
+UCLASS()
+class FUTUREVERSEUBFCONTROLLER_API UUBFBundleCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UUBFBundleCommandlet();
+	
+	virtual int32 Main(const FString& Params) override;
+};
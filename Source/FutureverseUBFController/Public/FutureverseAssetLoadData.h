@@ -2,6 +2,7 @@
 
 #pragma once
 #include "AssetIdUtils.h"
+#include "UBFRenderDeadline.h"
 
 struct FFutureverseAssetLoadData
 {
@@ -11,6 +12,8 @@ struct FFutureverseAssetLoadData
 	FString AssetID;
 	FString VariantID = FString(TEXT("Default"));
 	FString ProfileURI;
+	// budget of the render this load is for, downloads for it give up once it runs out
+	FUBFRenderDeadline Deadline;
 
 	FString GetCombinedVariantID() const { return FString::Printf(TEXT("%s-%s"), *AssetID, *VariantID); }
 	
@@ -15,13 +15,186 @@ class FUTUREVERSEUBFCONTROLLER_API UFutureverseUBFControllerSettings : public UD
 	GENERATED_BODY()
 public:
 	UFutureverseUBFControllerSettings();
+	virtual void PostInitProperties() override;
 	
-	FString GetDefaultAssetProfilePath() const { return DefaultAssetProfilePath.TrimStartAndEnd(); } 
+	// -UBFAssetProfilePath= on the command line takes priority over the config value
+	FString GetDefaultAssetProfilePath() const;
 	bool GetUseAssetRegisterProfiles() const { return bUseAssetRegisterProfiles; } 
+	
+	// -UBFAssetRegisterURL= on the command line takes priority over the config value
+	FString GetAssetRegisterGraphQLURL() const;
+	const TMap<FString, FString>& GetEndpointOverrides() const { return EndpointOverrides; }
+
+	int32 GetMaxCachedAssetProfiles() const { return MaxCachedAssetProfiles; }
+	SIZE_T GetMaxAssetProfileCacheBytes() const { return static_cast<SIZE_T>(FMath::Max(MaxAssetProfileCacheMB, 0)) * 1024 * 1024; }
+	
+	// -UBFSnapshot= on the command line takes priority over the config value. Relative paths are resolved against the project directory
+	FString GetSnapshotPath() const;
+
+	// -UBFBundles= (comma separated) on the command line replaces the config value. Relative paths are resolved against the project directory
+	TArray<FString> GetBundlePaths() const;
+
+	int32 GetMaxParallelTraitExtractions() const { return FMath::Max(MaxParallelTraitExtractions, 1); }
+
+	int32 GetMaxContextTreeDepth() const { return FMath::Max(MaxContextTreeDepth, 1); }
+	int32 GetMaxContextTreeNodes() const { return FMath::Max(MaxContextTreeNodes, 1); }
+	int32 GetMaxParallelContextTreeRequests() const { return FMath::Max(MaxParallelContextTreeRequests, 1); }
+
+	bool GetShareIdenticalRenders() const { return bShareIdenticalRenders; }
+
+	int32 GetMaxFullVariantRenders() const { return FMath::Max(MaxFullVariantRenders, 0); }
+	int32 GetMaxVariantSwitchesPerUpdate() const { return FMath::Max(MaxVariantSwitchesPerUpdate, 1); }
+	float GetVariantPolicyUpdateInterval() const { return FMath::Max(VariantPolicyUpdateInterval, 0.f); }
+
+	int32 GetMaxConcurrentDownloadsPerHost() const { return FMath::Max(MaxConcurrentDownloadsPerHost, 1); }
+	int64 GetMaxDownloadBytesPerSecondPerHost() const { return static_cast<int64>(FMath::Max(MaxDownloadKBPerSecondPerHost, 0)) * 1024; }
+
+	int32 GetMaxDownloadRetries() const { return FMath::Max(MaxDownloadRetries, 0); }
+	float GetRetryBaseDelaySeconds() const { return FMath::Max(RetryBaseDelaySeconds, 0.f); }
+	float GetRetryMaxDelaySeconds() const { return FMath::Max(RetryMaxDelaySeconds, GetRetryBaseDelaySeconds()); }
+	bool GetHedgeDownloads() const { return bHedgeDownloads; }
+	float GetMinHedgeDelaySeconds() const { return FMath::Max(MinHedgeDelaySeconds, 0.f); }
+	int32 GetCircuitBreakerFailureThreshold() const { return FMath::Max(CircuitBreakerFailureThreshold, 1); }
+	float GetCircuitBreakerCooldownSeconds() const { return FMath::Max(CircuitBreakerCooldownSeconds, 0.f); }
+	float GetAssetRegisterTimeoutSeconds() const { return FMath::Max(AssetRegisterTimeoutSeconds, 1.f); }
+
+	float GetNegativeCacheTTLSeconds() const { return FMath::Max(NegativeCacheTTLSeconds, 0.f); }
+	int32 GetMaxNegativeCacheEntries() const { return FMath::Max(MaxNegativeCacheEntries, 0); }
+
+	const FString& GetDeadlineFallbackVariantID() const { return DeadlineFallbackVariantID; }
+
+	// Relative paths are resolved against the project's Saved directory, empty if session snapshots are disabled
+	FString GetSessionSnapshotPath() const;
 private:
+	// Command line overrides, parsed once when the settings are loaded
+	TOptional<FString> CommandLineAssetProfilePath;
+	TOptional<FString> CommandLineAssetRegisterURL;
+	TOptional<FString> CommandLineSnapshotPath;
+	TOptional<TArray<FString>> CommandLineBundlePaths;
+	
 	UPROPERTY(EditAnywhere, Config)
 	FString DefaultAssetProfilePath = "https://fv-ubf-assets-dev.s3.us-west-2.amazonaws.com/Genesis/Profiles/1.0/";
 
 	UPROPERTY(EditAnywhere, Config)
 	bool bUseAssetRegisterProfiles = false;
+
+	// GraphQL endpoint used when resolving asset profile URIs from the Asset Register
+	UPROPERTY(EditAnywhere, Config)
+	FString AssetRegisterGraphQLURL = "https://ar-api.futureverse.app/graphql";
+
+	// URI prefix replacements applied to every profile, catalog and Asset Register request issued by the controller.
+	// e.g. "https://fv-ubf-assets-dev.s3.us-west-2.amazonaws.com/" -> "http://127.0.0.1:8089/files/" to use a local stand-in server
+	UPROPERTY(EditAnywhere, Config)
+	TMap<FString, FString> EndpointOverrides;
+
+	// Least recently used asset profiles are evicted past these budgets, 0 disables the limit.
+	// Profiles of assets currently rendered by a controller are never evicted.
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	int32 MaxCachedAssetProfiles = 4096;
+
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	int32 MaxAssetProfileCacheMB = 32;
+
+	// Binary asset snapshot mounted at startup, profiles and catalogs found in it skip the network. Profiles also skip
+	// JSON parsing, catalogs are stored as their JSON source and still parsed on first use.
+	// Written from a live session with ubf.Snapshot.Save
+	UPROPERTY(EditAnywhere, Config)
+	FString SnapshotPath;
+
+	// Collection bundles built by UUBFBundleCommandlet, mounted at startup ahead of SnapshotPath.
+	// Profiles, catalogs, graphs and artifacts found in a bundle never reach the network
+	UPROPERTY(EditAnywhere, Config)
+	TArray<FString> BundlePaths;
+
+	// Items UFutureverseUBFControllerSubsystem::ExtractTraits keeps in flight at once (profile, catalog and parsing graph)
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 1))
+	int32 MaxParallelTraitExtractions = 16;
+
+	// Levels of Asset Register links followed when loading a context tree, 1 only attaches the item's direct children
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 1))
+	int32 MaxContextTreeDepth = 4;
+
+	// Nodes in one context tree including the root, links past the limit are ignored
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 1))
+	int32 MaxContextTreeNodes = 64;
+
+	// Asset Register link requests in flight at once while loading one level of a context tree
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 1))
+	int32 MaxParallelContextTreeRequests = 16;
+
+	// Renders of the same asset, variant, inputs and context tree that overlap in time resolve profiles and run the
+	// parsing graph once, then execute on each controller. Useful for crowds of identical characters
+	UPROPERTY(EditAnywhere, Config)
+	bool bShareIdenticalRenders = true;
+
+	// Characters managed by UUBFVariantPolicySubsystem that may render their full variant at once, nearest first. 0 disables the limit
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	int32 MaxFullVariantRenders = 16;
+
+	// Variant switches UUBFVariantPolicySubsystem starts per update, spreads the upgrades of a crowd over several frames
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 1))
+	int32 MaxVariantSwitchesPerUpdate = 2;
+
+	// Seconds between two variant policy updates
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	float VariantPolicyUpdateInterval = 0.25f;
+
+	// Profile, catalog and Asset Register requests in flight at once to one host, the rest wait in a queue with
+	// render fetches ahead of prefetches
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 1))
+	int32 MaxConcurrentDownloadsPerHost = 8;
+
+	// Bandwidth budget per host for the same requests, 0 disables the limit
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	int32 MaxDownloadKBPerSecondPerHost = 0;
+
+	// Extra attempts for a failed download, spaced by an exponential backoff from RetryBaseDelaySeconds up to
+	// RetryMaxDelaySeconds with random jitter
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	int32 MaxDownloadRetries = 3;
+
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	float RetryBaseDelaySeconds = 0.5f;
+
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	float RetryMaxDelaySeconds = 8.f;
+
+	// Profile, catalog, graph and artifact downloads still running after the p95 latency of their host get a duplicate
+	// request and the first answer wins. Asset Register queries are never hedged
+	UPROPERTY(EditAnywhere, Config)
+	bool bHedgeDownloads = true;
+
+	// Lower bound on the hedge delay. Requests aren't hedged until their host has enough latency samples for a p95
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	float MinHedgeDelaySeconds = 0.25f;
+
+	// Consecutive failed requests after which a host is not contacted for CircuitBreakerCooldownSeconds
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 1))
+	int32 CircuitBreakerFailureThreshold = 5;
+
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	float CircuitBreakerCooldownSeconds = 30.f;
+
+	// Timeout of a single Asset Register query, failed queries are retried like any other download
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 1))
+	float AssetRegisterTimeoutSeconds = 15.f;
+
+	// Seconds a permanent miss (404, an asset without an Asset Register profile, a profile document without the asset)
+	// is answered locally before it is requested again, 0 disables negative caching. Transient failures are never cached
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	float NegativeCacheTTLSeconds = 300.f;
+
+	// Remembered misses, the ones closest to expiring are dropped past the limit. 0 disables the limit
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	int32 MaxNegativeCacheEntries = 4096;
+
+	// Variant a render with a time budget falls back to when its catalogs are loaded and the requested variant's are
+	// not and can't be loaded in time. The variant the controller already shows is tried first
+	UPROPERTY(EditAnywhere, Config)
+	FString DeadlineFallbackVariantID = TEXT("Default");
+
+	// Written at shutdown with what the controllers given a session slot last rendered, restored on the next launch
+	// with UFutureverseUBFControllerSubsystem::RestoreSessionSlot. Empty disables session snapshots
+	UPROPERTY(EditAnywhere, Config)
+	FString SessionSnapshotPath = TEXT("UBF/Session.ubfs");
 };
@@ -0,0 +1,173 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+LLM_DECLARE_TAG_API(FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+LLM_DECLARE_TAG_API(FutureverseUBFController_AssetProfiles, FUTUREVERSEUBFCONTROLLER_API);
+LLM_DECLARE_TAG_API(FutureverseUBFController_Catalogs, FUTUREVERSEUBFCONTROLLER_API);
+LLM_DECLARE_TAG_API(FutureverseUBFController_ItemRegistry, FUTUREVERSEUBFCONTROLLER_API);
+LLM_DECLARE_TAG_API(FutureverseUBFController_RenderRequests, FUTUREVERSEUBFCONTROLLER_API);
+
+// Per-frame figures for soak and load runs captured with -csvCategories=FutureverseUBFController
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(FUTUREVERSEUBFCONTROLLER_API, FutureverseUBFController);
+
+DECLARE_STATS_GROUP(TEXT("FutureverseUBFController"), STATGROUP_FutureverseUBFController, STATCAT_Advanced);
+// Pipeline load, cache effectiveness and latency, the same figures ubf.Stats prints
+DECLARE_STATS_GROUP(TEXT("UBFStats"), STATGROUP_UBFStats, STATCAT_Advanced);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Asset Profiles Memory"), STAT_UBFAssetProfilesMemory, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Asset Profiles"), STAT_UBFAssetProfilesCount, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Registered Catalogs Memory"), STAT_UBFCatalogsMemory, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Loaded Variant Catalogs"), STAT_UBFVariantCatalogsCount, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Registered Catalog Elements"), STAT_UBFCatalogElementsCount, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Registered Shared Catalogs"), STAT_UBFSharedCatalogsCount, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Item Registry Memory"), STAT_UBFItemRegistryMemory, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Registered Items"), STAT_UBFItemRegistryCount, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("In-flight Render Requests Memory"), STAT_UBFRenderRequestsMemory, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("In-flight Render Requests"), STAT_UBFRenderRequestsCount, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Binding Objects Created"), STAT_UBFBindingObjectsCreated, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Shared Render Executions"), STAT_UBFSharedRenderExecutions, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Variant Upgrades"), STAT_UBFVariantUpgrades, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Variant Downgrades"), STAT_UBFVariantDowngrades, STATGROUP_FutureverseUBFController, FUTUREVERSEUBFCONTROLLER_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("In-flight Profile Loads"), STAT_UBFPendingProfileLoadsCount, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("In-flight Catalog Loads"), STAT_UBFPendingCatalogLoadsCount, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("In-flight Parsing Graphs"), STAT_UBFPendingParsesCount, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Downloads"), STAT_UBFActiveDownloads, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Queued Downloads"), STAT_UBFQueuedDownloads, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Asset Profile Cache Hits"), STAT_UBFAssetProfileCacheHits, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Asset Profile Cache Misses"), STAT_UBFAssetProfileCacheMisses, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Asset Profile Evictions"), STAT_UBFAssetProfileEvictions, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Catalog Cache Hits"), STAT_UBFCatalogCacheHits, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Catalog Cache Misses"), STAT_UBFCatalogCacheMisses, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Catalog Parse Hits"), STAT_UBFCatalogParseHits, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Catalog Parse Misses"), STAT_UBFCatalogParseMisses, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Profile Load p50 (ms)"), STAT_UBFProfileLoadP50, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Profile Load p95 (ms)"), STAT_UBFProfileLoadP95, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Catalog Load p50 (ms)"), STAT_UBFCatalogLoadP50, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Catalog Load p95 (ms)"), STAT_UBFCatalogLoadP95, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Parsing Graph p50 (ms)"), STAT_UBFParsingGraphP50, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Parsing Graph p95 (ms)"), STAT_UBFParsingGraphP95, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Render p50 (ms)"), STAT_UBFRenderP50, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Render p95 (ms)"), STAT_UBFRenderP95, STATGROUP_UBFStats, FUTUREVERSEUBFCONTROLLER_API);
+
+// Lookup and eviction counters of one bounded cache
+struct FUTUREVERSEUBFCONTROLLER_API FUBFCacheCounters
+{
+	uint64 Hits = 0;
+	uint64 Misses = 0;
+	uint64 Evictions = 0;
+
+	double GetHitRate() const
+	{
+		const uint64 Lookups = Hits + Misses;
+		return Lookups > 0 ? static_cast<double>(Hits) / Lookups : 0.0;
+	}
+
+	void Log(FOutputDevice& Ar, const FString& CacheName) const;
+};
+
+// Entry count and approximate bytes of one cache, grouped by collection
+struct FUTUREVERSEUBFCONTROLLER_API FUBFMemoryUsage
+{
+	int32 Entries = 0;
+	SIZE_T Bytes = 0;
+
+	void Add(SIZE_T InBytes)
+	{
+		Entries++;
+		Bytes += InBytes;
+	}
+};
+
+/**
+ * Collects FUBFMemoryUsage per cache and per collection, printed by the ubf.Memory console command
+ */
+class FUTUREVERSEUBFCONTROLLER_API FUBFMemoryReport
+{
+public:
+	void Add(const FString& CacheName, const FString& CollectionId, SIZE_T Bytes);
+	void AddCounters(const FString& CacheName, const FUBFCacheCounters& Counters);
+	
+	void Log(FOutputDevice& Ar) const;
+	
+private:
+	TMap<FString, TMap<FString, FUBFMemoryUsage>> Caches;
+	TMap<FString, FUBFCacheCounters> CacheCounters;
+};
+
+// Stages of the render pipeline whose loads ubf.Stats tracks
+enum class EUBFLoadStage : uint8
+{
+	AssetProfile,
+	Catalog,
+	ParsingGraph,
+	// from the render request to handing the render graph to the controller
+	Render,
+	Num
+};
+
+/**
+ * In-flight loads and rolling latency percentiles per pipeline stage, printed by the ubf.Stats console command.
+ * Cache hit and miss counters stay with their caches and are collected alongside
+ */
+class FUTUREVERSEUBFCONTROLLER_API FUBFRuntimeStats
+{
+public:
+	static FUBFRuntimeStats& Get();
+
+	// Returns the start time to pass to EndLoad
+	double BeginLoad(EUBFLoadStage Stage);
+	// Failed loads only leave the in-flight count, their latency isn't sampled
+	void EndLoad(EUBFLoadStage Stage, double StartTime, bool bSuccess);
+	// Samples a latency without in-flight tracking, for stages whose failures can't all be observed
+	void AddLatency(EUBFLoadStage Stage, double Seconds);
+
+	int32 GetNumInFlight(EUBFLoadStage Stage) const;
+	// Milliseconds, 0 without samples
+	float GetPercentile(EUBFLoadStage Stage, float Percentile) const;
+	int32 GetNumSamples(EUBFLoadStage Stage) const;
+	
+	// Drops the latency samples, loads in flight stay counted
+	void Reset();
+	
+	void Log(FOutputDevice& Ar) const;
+
+	static const TCHAR* GetStageName(EUBFLoadStage Stage);
+
+private:
+	struct FStage
+	{
+		int32 NumInFlight = 0;
+		// latencies of the last completed loads in milliseconds, a ring buffer
+		TArray<float> LatencySamples;
+		int32 NextSample = 0;
+	};
+
+	void AddLatencyLocked(EUBFLoadStage Stage, double Seconds);
+	static float GetPercentile(const TArray<float>& SortedSamples, float Percentile);
+	
+	FStage Stages[static_cast<int32>(EUBFLoadStage::Num)];
+	mutable FCriticalSection Lock;
+};
+
+// Adds the game thread time until the end of the scope to the GameThreadContinuationMs CSV stat, nested scopes count once.
+// Opened at the top of controller continuations, which run on the game thread when their future completes
+class FUTUREVERSEUBFCONTROLLER_API FUBFContinuationScope
+{
+public:
+	FUBFContinuationScope();
+	~FUBFContinuationScope();
+
+private:
+	double StartTime = 0.0;
+};
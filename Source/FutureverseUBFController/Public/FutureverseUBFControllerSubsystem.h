@@ -7,10 +7,15 @@
 #include "UBFRuntimeController.h"
 #include "ControllerLayers/AssetProfile.h"
 #include "AssetProfile/AssetProfileRegistrySubsystem.h"
+#include "GlobalArtifactProvider/CatalogElement.h"
 #include "GlobalArtifactProvider/CacheLoading/MemoryCacheLoader.h"
 #include "Items/UBFItem.h"
 #include "Items/UBFRenderDataContainer.h"
+#include "Snapshots/UBFSessionSnapshot.h"
+#include "Containers/Ticker.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Traits/UBFTraitExtraction.h"
+#include "UBFRenderDeadline.h"
 #include "FutureverseUBFControllerSubsystem.generated.h"
 
 struct FLoadAssetProfileResult;
@@ -19,6 +24,12 @@ class FLoadMultipleAssetDatasAction;
 class FLoadAssetProfilesAction;
 class UCollectionRemappings;
 class UCollectionAssetProfiles;
+class FUBFMemoryReport;
+class FSharedCatalogStore;
+class FBindingObjectReferencer;
+class FBindingObjectLease;
+class FExtractTraitsAction;
+struct FSharedCatalog;
 
 UENUM(BlueprintType)
 enum class EEnvironment : uint8
@@ -28,6 +39,52 @@ enum class EEnvironment : uint8
 	Production,
 };
 
+// Stages a render with a time budget goes through, in order
+UENUM(BlueprintType)
+enum class EUBFRenderStage : uint8
+{
+	None,
+	// UUBFItem::EnsureProfileURILoaded or EnsureContextTreeLoaded
+	ItemData,
+	AssetProfile,
+	Catalog,
+	ParsingGraph,
+	// handing the render graph to the controller
+	RenderGraph,
+};
+
+// How a render with a time budget spent it, see UFutureverseUBFControllerSubsystem::GetLastDeadlineReport
+USTRUCT(BlueprintType)
+struct FUBFRenderDeadlineReport
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	float BudgetSeconds = 0.f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float ElapsedSeconds = 0.f;
+
+	// the budget ran out before the render graph was handed to the controller, the render failed
+	UPROPERTY(BlueprintReadOnly)
+	bool bExceeded = false;
+
+	// stage running when the budget ran out, or else the first stage the rest of the budget couldn't cover
+	UPROPERTY(BlueprintReadOnly)
+	EUBFRenderStage ExhaustedStage = EUBFRenderStage::None;
+
+	// stages skipped or served from earlier renders to stay within the budget
+	UPROPERTY(BlueprintReadOnly)
+	TArray<EUBFRenderStage> DegradedStages;
+
+	// variant rendered instead of the requested one because its catalogs were already loaded, empty if none
+	UPROPERTY(BlueprintReadOnly)
+	FString FallbackVariantID;
+
+	UPROPERTY(BlueprintReadOnly)
+	TMap<EUBFRenderStage, float> StageSeconds;
+};
+
 /**
  * 
  */
@@ -40,26 +97,77 @@ public:
 	
 	static UFutureverseUBFControllerSubsystem* Get(const UObject* WorldContext);
 	
-	// Used for rendering an item by itself without asset tree
+	// Used for rendering an item by itself without asset tree.
+	// With TimeBudgetSeconds > 0 the render degrades or fails instead of handing the graph to Controller any later, see GetLastDeadlineReport
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnComplete"))
 	void RenderItem(UUBFItem* Item, const FString& VariantID, UUBFRuntimeController* Controller,
-		const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete);
+		const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete, float TimeBudgetSeconds = 0.f);
 	
 	// Used for rendering an item and other linked items using context tree
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnComplete"))
 	void RenderItemTree(UUBFItem* Item, const FString& VariantID, UUBFRuntimeController* Controller,
-		const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete);
+		const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete, float TimeBudgetSeconds = 0.f);
 	
 	// Used for rendering an item by itself without asset tree
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnComplete"))
 	void RenderItemFromRenderData(const FUBFRenderData& RenderData, const FString& VariantID, UUBFRuntimeController* Controller,
-		const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete);
+		const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete, float TimeBudgetSeconds = 0.f);
 
 	// Used for rendering an item by itself without asset tree
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnComplete"))
 	void RenderItemTreeFromRenderData(const FUBFRenderData& RenderData, const FString& VariantID, UUBFRuntimeController* Controller,
-		const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete);
+		const TMap<FString, UUBFBindingObject*>& InputMap, const FOnComplete& OnComplete, float TimeBudgetSeconds = 0.f);
+
+	// Adds ParentAssetID -> Relationship.ChildAssetID to the tree last rendered on Controller, or replaces the relationship with the same id.
+	// Only the new child's profile and catalogs are resolved, the rest of the tree and the root's traits are reused from the last render.
+	// The updated tree only replaces the last render once it executes, a failed update can be retried against the previous tree
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnComplete"))
+	void SetRenderedTreeRelationship(UUBFRuntimeController* Controller, const FString& ParentAssetID,
+		const FUBFContextTreeRelationshipData& Relationship, const FOnComplete& OnComplete);
 
+	// Removes a relationship from the tree last rendered on Controller and renders it again without resolving anything
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnComplete"))
+	void RemoveRenderedTreeRelationship(UUBFRuntimeController* Controller, const FString& ParentAssetID,
+		const FString& RelationshipID, const FOnComplete& OnComplete);
+
+	// Renders the item or tree last rendered on Controller again with another variant of its profiles.
+	// The parsed traits are reused when both variants use the same parsing graph, otherwise the new one runs
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnComplete"))
+	void SwitchRenderedVariant(UUBFRuntimeController* Controller, const FString& VariantID, const FOnComplete& OnComplete);
+
+	// How the last render with a time budget on Controller spent it. False if Controller never rendered with one
+	UFUNCTION(BlueprintCallable)
+	bool GetLastDeadlineReport(UUBFRuntimeController* Controller, FUBFRenderDeadlineReport& OutReport) const;
+
+	// What Controller renders from now on is saved as Slot at shutdown, see UFutureverseUBFControllerSettings::SessionSnapshotPath.
+	// An empty Slot stops saving Controller's renders
+	UFUNCTION(BlueprintCallable)
+	void SetSessionSlot(UUBFRuntimeController* Controller, const FString& Slot);
+
+	// Renders what Slot showed at the end of the previous session from its snapshot, without the network or the parsing graph.
+	// The assets are checked in the background afterwards and rendered again if they changed, or if some saved traits
+	// couldn't be restored with their type and the parsing graph has to run. CurrentRenderData is what the caller would render for Slot now, if it knows:
+	// when its metadata or context tree differ from the saved ones it is rendered in place of the restored render.
+	// False if Slot has nothing saved
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnComplete,CurrentRenderData"))
+	bool RestoreSessionSlot(const FString& Slot, UUBFRuntimeController* Controller, const TMap<FString, UUBFBindingObject*>& InputMap,
+		const FOnComplete& OnComplete, const FUBFRenderData& CurrentRenderData);
+
+	// Runs the parsing graph of every request without an actor or UUBFRuntimeController, for servers that only need trait values.
+	// Game thread only: graphs run and their outputs are converted on the game thread, profile and catalog loads overlap.
+	// MaxParallelism <= 0 uses UFutureverseUBFControllerSettings::GetMaxParallelTraitExtractions
+	TFuture<FUBFTraitExtractionBatchResult> ExtractTraits(const TArray<FUBFTraitExtractionRequest>& Requests, int32 MaxParallelism = 0);
+	
+	const FUBFCacheCounters& GetCatalogCacheCounters() const { return CatalogCacheCounters; }
+	
+	void AppendMemoryReport(FUBFMemoryReport& Report) const;
+	
+	// Render queue and cache counters for ubf.Stats
+	void LogRuntimeStats(FOutputDevice& Ar) const;
+	void ResetRuntimeStats();
+	// Samples pending loads, download queues and cache entry counts into the FutureverseUBFController CSV category
+	void RecordCsvStats() const;
+	
 	// Asset profiles contain the path for Blueprints, Parsing Blueprints and ResourceManifests associated with an UFuturePassInventoryItem
 	// Currently this data needs to provided by the experience using the below functions
 	
@@ -70,47 +178,239 @@ private:
 	class FRenderItemInfo
 	{
 	public:
+		FRenderItemInfo();
+		~FRenderItemInfo();
+
+		// Re-estimates the memory held by this request for the in-flight render stats
+		void UpdateTrackedMemory();
+		SIZE_T GetApproximateMemoryUsage() const;
+
+		// Loaded profile for AssetId, FAssetProfile::Invalid() if it isn't part of this request
+		const FAssetProfile& GetAssetProfile(const FString& AssetId) const;
+		
 		FUBFRenderDataPtr RenderData;
 		TWeakObjectPtr<UUBFRuntimeController> Controller;
 		TMap<FString, UUBFBindingObject*> InputMap;
-		TAssetIdMap<FAssetProfile> AssetProfiles;
+		TAssetIdMap<FAssetProfilePtr> AssetProfiles;
 		FOnComplete OnComplete;
+		// leased binding objects in InputMap, shared with requests copied from this one
+		TArray<TSharedPtr<FBindingObjectLease>> BindingObjectLeases;
+		// set while identical renders on other controllers wait for this one to resolve and parse
+		FString SharedRenderKey;
+		// parsing graph whose outputs were appended to InputMap and the lease holding them
+		FString ParsingBlueprintId;
+		TSharedPtr<FBindingObjectLease> ParsedTraits;
+
+		double RequestTime = 0.0;
+		// unset unless the render has a time budget
+		FUBFRenderDeadline Deadline;
+		FUBFRenderDeadlineReport DeadlineReport;
+		EUBFRenderStage Stage = EUBFRenderStage::None;
+		double StageStartTime = 0.0;
+		// traits of the controller's previous render of the same asset and metadata, used when the budget can't cover parsing
+		FString PreviousParsingBlueprintId;
+		TSharedPtr<FBindingObjectLease> PreviousParsedTraits;
+		
+		bool bRenderTree = false;
+		// restored from the session snapshot, PreviousParsedTraits holds the saved traits
+		bool bRestoredFromSession = false;
+		// some parsing graph outputs of the saved render couldn't be restored with their type
+		bool bSavedTraitsIncomplete = false;
+		// what the caller of RestoreSessionSlot said the slot shows now, unset if it didn't know
+		FUBFRenderDataPtr CurrentSessionRenderData;
+		// set once the graph has been handed to the controller, InputMap includes the parsed traits from then on
+		bool bExecuted = false;
+		// replaces the controller's render state and pins only once it executes, so a failed update keeps the previous one
+		bool bDeferRenderState = false;
+
+	private:
+		SIZE_T TrackedMemory = 0;
 	};
+
+	struct FLoadedVariantCatalog
+	{
+		FString CollectionId;
+		// id of the profile the catalogs were loaded for, they are released when it is evicted
+		FString AssetProfileId;
+		// content hashes of the shared render and parsing catalogs
+		TArray<uint64, TInlineAllocator<2>> CatalogHashes;
+	};
+
+	struct FRegisteredCatalog
+	{
+		TSharedPtr<const FSharedCatalog, ESPMode::ThreadSafe> Catalog;
+		FString CollectionId;
+		int32 NumVariants = 0;
+	};
+
+	// Assets the controller is currently rendering, pinned so the caches don't evict them
+	struct FControllerRenderState
+	{
+		TArray<FString> AssetIds;
+		
+		// last tree rendered on the controller, the base for incremental tree updates
+		TSharedPtr<FRenderItemInfo> RenderItemInfo;
+	};
+
+	// TimeBudgetSeconds <= 0 renders without a deadline
+	TSharedPtr<FRenderItemInfo> MakeRenderItemInfo(float TimeBudgetSeconds = 0.f);
 	
 	void RenderItemInternal(TSharedPtr<FRenderItemInfo> RenderItemInfo);
 	
 	void RenderItemTreeInternal(TSharedPtr<FRenderItemInfo> RenderItemInfo);
 	
-	void ExecuteItemGraph(TSharedPtr<FRenderItemInfo> RenderItemInfo, const bool bShouldBuildContextTree) const;
+	void ExecuteItemGraph(TSharedPtr<FRenderItemInfo> RenderItemInfo, const bool bShouldBuildContextTree);
 	
 	void CreateBlueprintInstancesFromContextTree(TSharedPtr<FRenderItemInfo> RenderItemInfo, const TArray<FUBFContextTreeData>& UBFContextTree,
 	                                        const FString& RootAssetId, TArray<UBF::FExecutionInstanceData>& OutBlueprintInstances) const;
 
 	void ParseInputsThenExecute(TSharedPtr<FRenderItemInfo> RenderItemInfo,
-	                            const bool bShouldBuildContextTree) const;
+	                            const bool bShouldBuildContextTree);
+
+	// What makes renders resolve and parse to the same execution data: asset, profile, variant, metadata, input values and context tree.
+	// Shared renders are keyed by its hash and only joined when the descriptions match
+	static FString DescribeSharedRender(const FRenderItemInfo& RenderItemInfo, const bool bShouldBuildContextTree);
+	// Hash of the asset, profile URI, metadata and context tree of RenderData
+	static uint64 HashRenderData(const FUBFRenderData& RenderData);
+	// Queues RenderItemInfo behind an identical in-flight render and returns true, or makes it the one others wait for
+	bool TryJoinSharedRender(const TSharedPtr<FRenderItemInfo>& RenderItemInfo, const bool bShouldBuildContextTree);
+	// Hands the resolved profiles and parsed inputs to every render waiting on RenderItemInfo, then executes all of them
+	void ExecuteSharedRender(TSharedPtr<FRenderItemInfo> RenderItemInfo, const bool bShouldBuildContextTree);
+	void FailSharedRender(const TSharedPtr<FRenderItemInfo>& RenderItemInfo);
+	// Fails RenderItemInfo, whose controller is gone before parsing, and has the first waiting render with a live
+	// controller parse for the rest
+	void HandOverSharedRender(const TSharedPtr<FRenderItemInfo>& RenderItemInfo, const bool bShouldBuildContextTree);
 
-	void ExecuteGraph(TSharedPtr<FRenderItemInfo> RenderItemInfo, const bool bShouldBuildContextTree) const;
+	void ExecuteGraph(TSharedPtr<FRenderItemInfo> RenderItemInfo, const bool bShouldBuildContextTree);
 
-	TFuture<FLoadLinkedAssetProfilesResult> EnsureAssetDatasLoaded(const TArray<struct FFutureverseAssetLoadData>& LoadDatas);
-	TFuture<FLoadAssetProfileResult> EnsureAssetDataLoaded(const FFutureverseAssetLoadData& LoadData);
+	// Starts timing Stage of a render with a deadline, the time spent in the previous stage refines its estimate
+	void EnterRenderStage(FRenderItemInfo& RenderItemInfo, EUBFRenderStage Stage);
+	// True if the rest of the budget covers the usual duration of Stage, records Stage as degraded otherwise
+	bool CanCoverRenderStage(FRenderItemInfo& RenderItemInfo, EUBFRenderStage Stage);
+	// Switches to a variant whose catalogs are already loaded when the budget can't cover loading the requested one's,
+	// and keeps the traits of the controller's previous render of the same item in case it can't cover parsing either
+	void PrepareDeadlineFallbacks(FRenderItemInfo& RenderItemInfo, TArray<FFutureverseAssetLoadData>& LoadDatas);
+	// Records the time spent so far and keeps the report for GetLastDeadlineReport
+	void FinishDeadlineReport(FRenderItemInfo& RenderItemInfo);
+	// Fails a render whose deadline expired during its current stage
+	void FailRenderDeadline(const TSharedPtr<FRenderItemInfo>& RenderItemInfo);
+
+	// OnProfilesLoaded runs once every profile has loaded or failed, before the catalogs are loaded
+	TFuture<FLoadLinkedAssetProfilesResult> EnsureAssetDatasLoaded(const TArray<struct FFutureverseAssetLoadData>& LoadDatas,
+		TFunction<void()> OnProfilesLoaded = nullptr);
+	TFuture<FLoadAssetProfileResult> EnsureAssetDataLoaded(const FFutureverseAssetLoadData& LoadData, TFunction<void()> OnProfileLoaded = nullptr);
 	
 	TFuture<FLoadAssetProfileResult> EnsureAssetProfilesLoaded(const FFutureverseAssetLoadData& LoadData) const;
-	TFuture<bool> EnsureCatalogsLoaded(const FFutureverseAssetLoadData& LoadData, const FAssetProfile& AssetProfile);
+	TFuture<bool> EnsureCatalogsLoaded(const FFutureverseAssetLoadData& LoadData, const FAssetProfilePtr& AssetProfile);
 	
 	bool IsCatalogLoaded(const FFutureverseAssetLoadData& LoadData) const;
 	
-	TFuture<TMap<FString, UUBFBindingObject*>> GetTraitsForItem(const FString& ParsingGraphId,
+	// Parsing graph outputs wrapped in leased binding objects, the lease has to be kept by the render request using them.
+	// Null when the controller or its root component is gone and nothing could be parsed
+	TFuture<TSharedPtr<FBindingObjectLease>> GetTraitsForItem(const FString& ParsingGraphId,
 		const TWeakObjectPtr<UUBFRuntimeController>& Controller, const TMap<FString, UBF::FDynamicHandle>& ParsingInputs) const;
 
 	bool IsSubsystemValid() const;
 	
-	TSet<FString> LoadedVariantCatalogs;
+	void AddLoadedVariantCatalog(const FFutureverseAssetLoadData& LoadData, const FAssetProfilePtr& AssetProfile,
+		const TArray<TSharedPtr<const FSharedCatalog, ESPMode::ThreadSafe>>& Catalogs);
+	void RemoveLoadedVariantCatalog(const FString& CombinedVariantID);
+	// Releases the variant catalogs loaded for profiles the registry evicted, pinned (rendered) profiles are never evicted
+	void HandleAssetProfilesEvicted(const TArray<FAssetProfilePtr>& EvictedProfiles);
+	
+	// Registers the catalog with UGlobalArtifactProviderSubsystem the first time any variant references it
+	void RetainSharedCatalog(const TSharedPtr<const FSharedCatalog, ESPMode::ThreadSafe>& Catalog, const FString& CollectionId);
+	// Frees the controller's copy once no loaded variant references the catalog. The artifact provider has no way to
+	// unregister catalogs, so only its element entries stay registered and a reload registers over them
+	void ReleaseSharedCatalog(uint64 ContentHash);
+
+	// Replaces the assets pinned for Controller with LoadDatas
+	void PinRenderedAssets(const TWeakObjectPtr<UUBFRuntimeController>& Controller, const TArray<FFutureverseAssetLoadData>& LoadDatas);
+	void ReleaseRenderState(const FControllerRenderState& RenderState);
+	void PruneControllerRenderStates();
+
+	// Pins what RenderItemInfo renders and makes it the controller's last render
+	void CommitRenderState(const TSharedPtr<FRenderItemInfo>& RenderItemInfo);
+
+	// Load datas of every asset RenderItemInfo renders, with its variant
+	static TArray<FFutureverseAssetLoadData> GetRenderedLoadDatas(const FRenderItemInfo& RenderItemInfo);
+
+	// Keeps what RenderItemInfo hands to its controller if the controller has a session slot
+	void RecordSessionRender(const FRenderItemInfo& RenderItemInfo);
+	void SaveSessionSnapshot();
+	// Renders a restored render again if any of its profiles or catalogs changed since the snapshot was written, if the
+	// caller's current render data differs from the saved one, or if it was rendered with saved traits that were incomplete
+	void RevalidateSessionRender(const TSharedPtr<FRenderItemInfo>& RenderItemInfo);
+	// Downloads LoadData's profile and catalogs again and compares them with RestoredProfile and the loaded catalogs
+	TFuture<bool> HasSessionAssetChanged(const FFutureverseAssetLoadData& LoadData, const FAssetProfilePtr& RestoredProfile);
+
+	// Copies the caller's inputs and their leases from Source, without the traits its parsing graph added
+	static void CopyInputsWithoutTraits(const FRenderItemInfo& Source, FRenderItemInfo& Target);
+
+	// Copies the last tree render on Controller, applies EditContextTree and renders it again after loading NewLoadDatas
+	void UpdateRenderedTree(UUBFRuntimeController* Controller, TFunctionRef<bool(TArray<FUBFContextTreeData>&)> EditContextTree,
+		const TArray<FFutureverseAssetLoadData>& NewLoadDatas, const FOnComplete& OnComplete);
+	
+	// CombinedVariantID -> catalogs registered with UGlobalArtifactProviderSubsystem for that variant
+	TMap<FString, FLoadedVariantCatalog> LoadedVariantCatalogs;
+	FUBFCacheCounters CatalogCacheCounters;
+
+	// Content hash -> shared catalog registered with UGlobalArtifactProviderSubsystem
+	TMap<uint64, FRegisteredCatalog> RegisteredCatalogs;
+	SIZE_T RegisteredCatalogBytes = 0;
+
+	TSharedPtr<FSharedCatalogStore> CatalogStore;
+	FDelegateHandle AssetProfilesEvictedHandle;
+
+	TSharedPtr<FBindingObjectReferencer> BindingObjectReferencer;
+
+	TMap<TWeakObjectPtr<UUBFRuntimeController>, FControllerRenderState> ControllerRenderStates;
+
+	struct FSharedRender
+	{
+		FString Description;
+		// renders waiting for the in-flight render with this description
+		TArray<TSharedPtr<FRenderItemInfo>> Followers;
+	};
+	
+	// shared render key -> the in-flight render others can join
+	TMap<FString, FSharedRender> SharedRenders;
+	FUBFCacheCounters SharedRenderCounters;
+	// a hit is a variant switch that kept the parsed traits of the previous variant
+	FUBFCacheCounters VariantSwitchCounters;
+
+	// usual seconds per stage of renders with a deadline, an exponential moving average
+	TMap<EUBFRenderStage, float> RenderStageEstimates;
+	TMap<TWeakObjectPtr<UUBFRuntimeController>, FUBFRenderDeadlineReport> DeadlineReports;
+
+	struct FSessionSlotRender
+	{
+		FUBFSessionRender Render;
+		TArray<FAssetProfilePtr> AssetProfiles;
+	};
+	
+	// snapshot of the previous session, unmounted as soon as one of its assets turns out to have changed
+	TSharedPtr<FUBFSessionSnapshot> SessionSnapshot;
+	TMap<TWeakObjectPtr<UUBFRuntimeController>, FString> SessionSlots;
+	// slot -> last render of a controller with that slot, kept past the controller for the snapshot written at shutdown
+	TMap<FString, FSessionSlotRender> SessionSlotRenders;
+
+	// records the CSV stats every frame while a CSV capture is running
+	FTSTicker::FDelegateHandle CsvTickerHandle;
+
+	// Weak references so in-flight requests can be inspected without extending their lifetime
+	TArray<TWeakPtr<FRenderItemInfo>> InFlightRenderItemInfos;
 
 	bool bIsInitialized = false;
 
 	TSharedPtr<FMemoryCacheLoader> MemoryCacheLoader = MakeShared<FMemoryCacheLoader>();
+
+	// Root for parsing graphs executed by ExtractTraits, never attached to an actor
+	UPROPERTY(Transient)
+	TObjectPtr<USceneComponent> HeadlessRootComponent;
 	
 	friend class UUBFInventoryItem;
+	friend class FExtractTraitsAction;
 	friend class FLoadMultipleAssetDatasAction;
 	friend class UCollectionTestWidget;
 
@@ -28,13 +28,32 @@ public:
 	void RequestFuturepassInventoryWithInput(const FAssetConnection& AssetConnectionInput, const FOnRequestCompleted& OnRequestCompleted);
 	
 private:
+	// The parts of an Asset Register asset the inventory is built from, and the form the traffic archive records it in
+	struct FInventoryAsset
+	{
+		FUBFItemData ItemData;
+		TMap<FString, FString> Profiles;
+		uint64 LinksHash = 0;
+	};
+	
+	// Passed through the traffic archive while it records or replays
+	void RequestAssets(const FAssetConnection& AssetConnectionInput, const FOnRequestCompleted& OnRequestCompleted);
+	
 	FUBFItemData CreateItemDataFromAsset(const FAsset& Asset);
+	FInventoryAsset CreateInventoryAsset(const FAsset& Asset);
+	
+	static FString WriteInventoryAssets(const TArray<FInventoryAsset>& InventoryAssets);
+	static bool ReadInventoryAssets(const FString& Json, TArray<FInventoryAsset>& OutInventoryAssets);
 	
 	UFUNCTION()
 	void HandleGetFuturepassInventory(bool bSuccess, const FAssets& Assets);
+	void UpdateInventory(bool bSuccess, const TArray<FInventoryAsset>& InventoryAssets);
 	
 	UPROPERTY()
 	FGetAssetsCompleted GetAssetsRequestCompleted;
+	
+	// set while a query is being recorded, takes the library's response instead of HandleGetFuturepassInventory
+	TFunction<void(bool, const TArray<FInventoryAsset>&)> RecordGetAssets;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(AllowPrivateAccess=true))
 	int32 NumberOfItemsToQuery = 500;
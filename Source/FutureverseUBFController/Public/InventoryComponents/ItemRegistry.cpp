@@ -1,18 +1,187 @@
 #include "ItemRegistry.h"
 
+#include "AssetIdUtils.h"
+#include "FutureverseUBFControllerStats.h"
+#include "Items/UBFItem.h"
+
+FItemRegistry::~FItemRegistry()
+{
+	DEC_DWORD_STAT_BY(STAT_UBFItemRegistryCount, TrackedCount);
+	DEC_MEMORY_STAT_BY(STAT_UBFItemRegistryMemory, TrackedMemory);
+}
+
 UUBFItem* FItemRegistry::GetItem(const FString& ItemId) const
 {
-	return ItemMap.Contains(ItemId) ? ItemMap[ItemId] : nullptr;
+	const FString Key = AssetIdUtils::FormatAssetId(ItemId);
+	
+	FReadScopeLock ReadLock(Lock);
+	const FEntry* Entry = ItemMap.Find(Key);
+	return Entry ? Entry->Item.Get() : nullptr;
 }
 
 void FItemRegistry::RegisterItem(const FString& ItemId, UUBFItem* Item)
 {
-	if (ItemMap.Contains(ItemId))
+	LLM_SCOPE_BYTAG(FutureverseUBFController_ItemRegistry);
+
+	const FString Key = AssetIdUtils::FormatAssetId(ItemId);
+	const FString CollectionKey = IsValid(Item) ? AssetIdUtils::FormatAssetId(Item->GetCollectionID()) : FString();
+	const FString ContractKey = IsValid(Item) ? AssetIdUtils::FormatAssetId(Item->GetContractID()) : FString();
+	
+	FWriteScopeLock WriteLock(Lock);
+	
+	FEntry& Entry = ItemMap.FindOrAdd(Key);
+	RemoveFromIndex(ItemsByCollection, Entry.CollectionKey, Key);
+	RemoveFromIndex(ItemsByContract, Entry.ContractKey, Key);
+	
+	Entry.Item = Item;
+	Entry.CollectionKey = CollectionKey;
+	Entry.ContractKey = ContractKey;
+	AddToIndex(ItemsByCollection, CollectionKey, Key);
+	AddToIndex(ItemsByContract, ContractKey, Key);
+
+	UpdateMemoryStats();
+}
+
+bool FItemRegistry::UnregisterItem(const FString& ItemId)
+{
+	const FString Key = AssetIdUtils::FormatAssetId(ItemId);
+	
+	FWriteScopeLock WriteLock(Lock);
+	
+	FEntry Entry;
+	if (!ItemMap.RemoveAndCopyValue(Key, Entry))
+		return false;
+	
+	RemoveFromIndex(ItemsByCollection, Entry.CollectionKey, Key);
+	RemoveFromIndex(ItemsByContract, Entry.ContractKey, Key);
+	UpdateMemoryStats();
+	return true;
+}
+
+void FItemRegistry::Empty()
+{
+	FWriteScopeLock WriteLock(Lock);
+	
+	ItemMap.Empty();
+	ItemsByCollection.Empty();
+	ItemsByContract.Empty();
+	UpdateMemoryStats();
+}
+
+void FItemRegistry::GetItemsByCollection(const FString& CollectionId, TArray<UUBFItem*>& OutItems) const
+{
+	const FString IndexKey = AssetIdUtils::FormatAssetId(CollectionId);
+	
+	FReadScopeLock ReadLock(Lock);
+	GetIndexedItems(ItemsByCollection, IndexKey, OutItems);
+}
+
+void FItemRegistry::GetItemsByContract(const FString& ContractId, TArray<UUBFItem*>& OutItems) const
+{
+	const FString IndexKey = AssetIdUtils::FormatAssetId(ContractId);
+	
+	FReadScopeLock ReadLock(Lock);
+	GetIndexedItems(ItemsByContract, IndexKey, OutItems);
+}
+
+int32 FItemRegistry::RemoveStaleItems()
+{
+	FWriteScopeLock WriteLock(Lock);
+
+	int32 NumRemoved = 0;
+	for (auto It = ItemMap.CreateIterator(); It; ++It)
 	{
-		ItemMap[ItemId] = Item;
+		if (It->Value.Item.IsValid())
+			continue;
+		
+		RemoveFromIndex(ItemsByCollection, It->Value.CollectionKey, It->Key);
+		RemoveFromIndex(ItemsByContract, It->Value.ContractKey, It->Key);
+		It.RemoveCurrent();
+		NumRemoved++;
 	}
-	else
+
+	if (NumRemoved > 0)
 	{
-		ItemMap.Add(ItemId, Item);
+		UpdateMemoryStats();
 	}
+	return NumRemoved;
+}
+
+int32 FItemRegistry::Num() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return ItemMap.Num();
+}
+
+void FItemRegistry::AppendMemoryReport(FUBFMemoryReport& Report) const
+{
+	FReadScopeLock ReadLock(Lock);
+	
+	for (const auto& Pair : ItemMap)
+	{
+		const UUBFItem* Item = Pair.Value.Item.Get();
+		const SIZE_T ItemSize = IsValid(Item) ? Item->GetApproximateMemoryUsage() : 0;
+		const SIZE_T EntrySize = Pair.Key.GetAllocatedSize() + Pair.Value.CollectionKey.GetAllocatedSize() + Pair.Value.ContractKey.GetAllocatedSize();
+		Report.Add(TEXT("ItemRegistry"), IsValid(Item) ? Item->GetCollectionID() : FString(), EntrySize + ItemSize);
+	}
+}
+
+void FItemRegistry::AddToIndex(TMap<FString, TSet<FString>>& Index, const FString& IndexKey, const FString& ItemKey)
+{
+	if (IndexKey.IsEmpty())
+		return;
+	
+	Index.FindOrAdd(IndexKey).Add(ItemKey);
+}
+
+void FItemRegistry::RemoveFromIndex(TMap<FString, TSet<FString>>& Index, const FString& IndexKey, const FString& ItemKey)
+{
+	if (IndexKey.IsEmpty())
+		return;
+	
+	TSet<FString>* ItemKeys = Index.Find(IndexKey);
+	if (!ItemKeys)
+		return;
+
+	ItemKeys->Remove(ItemKey);
+	if (ItemKeys->IsEmpty())
+	{
+		Index.Remove(IndexKey);
+	}
+}
+
+void FItemRegistry::GetIndexedItems(const TMap<FString, TSet<FString>>& Index, const FString& IndexKey, TArray<UUBFItem*>& OutItems) const
+{
+	const TSet<FString>* ItemKeys = Index.Find(IndexKey);
+	if (!ItemKeys)
+		return;
+
+	OutItems.Reserve(OutItems.Num() + ItemKeys->Num());
+	for (const FString& ItemKey : *ItemKeys)
+	{
+		const FEntry* Entry = ItemMap.Find(ItemKey);
+		if (UUBFItem* Item = Entry ? Entry->Item.Get() : nullptr)
+		{
+			OutItems.Add(Item);
+		}
+	}
+}
+
+SIZE_T FItemRegistry::GetAllocatedSize() const
+{
+	// top level containers only so registering stays O(1), the per collection sets are small next to ItemMap
+	return ItemMap.GetAllocatedSize() + ItemsByCollection.GetAllocatedSize() + ItemsByContract.GetAllocatedSize();
+}
+
+void FItemRegistry::UpdateMemoryStats()
+{
+	// container overhead only, the items themselves are reported by AppendMemoryReport
+	const SIZE_T NewMemory = GetAllocatedSize();
+	DEC_MEMORY_STAT_BY(STAT_UBFItemRegistryMemory, TrackedMemory);
+	INC_MEMORY_STAT_BY(STAT_UBFItemRegistryMemory, NewMemory);
+	TrackedMemory = NewMemory;
+
+	DEC_DWORD_STAT_BY(STAT_UBFItemRegistryCount, TrackedCount);
+	INC_DWORD_STAT_BY(STAT_UBFItemRegistryCount, ItemMap.Num());
+	TrackedCount = ItemMap.Num();
 }
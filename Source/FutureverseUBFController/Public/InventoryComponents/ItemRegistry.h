@@ -3,16 +3,54 @@
 #include "CoreMinimal.h"
 
 class UUBFItem;
+class FUBFMemoryReport;
 
+/**
+ * Asset id -> item lookup shared by an inventory and its items, with secondary indices by collection and contract id.
+ * Keys are formatted with AssetIdUtils::FormatAssetId. Items are held weakly, entries of destroyed items are skipped
+ * and removed by RemoveStaleItems. Reads take a shared lock so resolvers on worker threads can query the registry.
+ */
 class FUTUREVERSEUBFCONTROLLER_API FItemRegistry
 {
 public:
 	FItemRegistry(){}
-	virtual ~FItemRegistry() = default;
+	virtual ~FItemRegistry();
 	
 	UUBFItem* GetItem(const FString& ItemId) const;
 	void RegisterItem(const FString& ItemId, UUBFItem* Item);
+	bool UnregisterItem(const FString& ItemId);
+	void Empty();
+
+	void GetItemsByCollection(const FString& CollectionId, TArray<UUBFItem*>& OutItems) const;
+	void GetItemsByContract(const FString& ContractId, TArray<UUBFItem*>& OutItems) const;
+
+	// Drops entries whose items were garbage collected, returns the number removed
+	int32 RemoveStaleItems();
+
+	int32 Num() const;
+	void AppendMemoryReport(FUBFMemoryReport& Report) const;
 
 protected:
-	TMap<FString, UUBFItem*> ItemMap;
+	struct FEntry
+	{
+		TWeakObjectPtr<UUBFItem> Item;
+		// formatted index keys the entry was registered under, so re-registering can unlink them
+		FString CollectionKey;
+		FString ContractKey;
+	};
+	
+	void AddToIndex(TMap<FString, TSet<FString>>& Index, const FString& IndexKey, const FString& ItemKey);
+	void RemoveFromIndex(TMap<FString, TSet<FString>>& Index, const FString& IndexKey, const FString& ItemKey);
+	void GetIndexedItems(const TMap<FString, TSet<FString>>& Index, const FString& IndexKey, TArray<UUBFItem*>& OutItems) const;
+	
+	SIZE_T GetAllocatedSize() const;
+	void UpdateMemoryStats();
+
+	mutable FRWLock Lock;
+	TMap<FString, FEntry> ItemMap;
+	TMap<FString, TSet<FString>> ItemsByCollection;
+	TMap<FString, TSet<FString>> ItemsByContract;
+
+	SIZE_T TrackedMemory = 0;
+	int32 TrackedCount = 0;
 };
@@ -9,9 +9,30 @@
 
 class UUBFItem;
 class FItemRegistry;
+class FUBFMemoryReport;
 
 DECLARE_DYNAMIC_DELEGATE(FOnRequestCompleted);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnInventoryUpdatedEvent);
+
+// Items that changed between two inventory refreshes, unchanged items keep their loaded context trees and profile uris
+USTRUCT(BlueprintType)
+struct FUBFInventoryDelta
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	TArray<UUBFItem*> Added;
+
+	// items whose metadata or profile uri changed, updated in place
+	UPROPERTY(BlueprintReadOnly)
+	TArray<UUBFItem*> Changed;
+
+	UPROPERTY(BlueprintReadOnly)
+	TArray<UUBFItem*> Removed;
+
+	bool IsEmpty() const { return Added.IsEmpty() && Changed.IsEmpty() && Removed.IsEmpty(); }
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryUpdatedEvent, const FUBFInventoryDelta&, Delta);
 
 UCLASS(Abstract, Blueprintable)
 class FUTUREVERSEUBFCONTROLLER_API UUBFInventoryComponent : public UActorComponent
@@ -39,6 +60,15 @@ public:
 	UFUNCTION(BlueprintCallable)
 	virtual void RegisterItem(const FString& ItemId, UUBFItem* Item);
 
+	// Indexed lookups, cheaper than filtering GetInventory for large inventories
+	UFUNCTION(BlueprintCallable)
+	TArray<UUBFItem*> GetItemsByCollection(const FString& CollectionId) const;
+
+	UFUNCTION(BlueprintCallable)
+	TArray<UUBFItem*> GetItemsByContract(const FString& ContractId) const;
+
+	void AppendMemoryReport(FUBFMemoryReport& Report) const;
+
 protected:
 	UPROPERTY()
 	TArray<UUBFItem*> Inventory;
@@ -47,6 +47,9 @@ struct FUBFItemData
 	{
 		return FString::Printf(TEXT("%s:%s"), *CollectionID, *TokenID);
 	}
+
+	// Approximate heap usage including the metadata json DOM
+	SIZE_T GetAllocatedSize() const;
 	
 	FString ToString() const
 	{
@@ -111,6 +114,8 @@ struct FUBFRenderData
 
 	FUBFRenderData(const FString& AssetID, const FString& MetadataJson, const TArray<FUBFContextTreeData>& ContextTree, const FString& ProfileURI)
 		: AssetID(AssetID), MetadataJson(MetadataJson), ProfileURI(ProfileURI), ContextTree(ContextTree) {}
+
+	bool IsValid() const {return AssetID != FString("Invalid");}
 	
 	UPROPERTY(BlueprintReadOnly)
 	FString AssetID = "Invalid";
@@ -137,7 +142,7 @@ class FUTUREVERSEUBFCONTROLLER_API UUBFItem : public UObject
 	
 public:
 	UFUNCTION(BlueprintCallable)
-	void SetItemData(const FUBFItemData& NewItemData) { ItemData = NewItemData; }
+	void SetItemData(const FUBFItemData& NewItemData) { ItemData = NewItemData; MetadataHash = HashMetadataJson(ItemData.MetadataJson); }
 	
 	UFUNCTION(BlueprintCallable)
 	void SetContextTree(const TArray<FUBFContextTreeData>& NewContextTree) { ContextTree = NewContextTree; }
@@ -185,7 +190,20 @@ public:
 	virtual void InitializeFromRenderData(const FUBFRenderData& RenderData);
 
 	void SetItemRegistry(const TSharedPtr<FItemRegistry>& NewItemRegistry) { ItemRegistry = NewItemRegistry; }
+
+	// Approximate memory held by this item, used for memory accounting
+	SIZE_T GetApproximateMemoryUsage() const;
 	void SetAssetProfileURI(const FString& InProfileURI) { ProfileURI = InProfileURI; }
+	
+	// Hash of the metadata json, lets inventory refreshes detect changed items without comparing the json
+	uint64 GetMetadataHash() const { return MetadataHash; }
+	// CityHash64 of the UTF-8 bytes, unlike GetTypeHash(FString) it is case sensitive and wide enough to trust on its own
+	static uint64 HashMetadataJson(const FString& MetadataJson);
+
+	// Hash of the asset's child links as last reported with its item data, 0 if they weren't reported.
+	// The context tree is built from these links, so inventory refreshes compare it alongside the metadata hash
+	uint64 GetLinksHash() const { return LinksHash; }
+	void SetLinksHash(uint64 NewLinksHash) { LinksHash = NewLinksHash; }
 
 	UFUNCTION(BlueprintCallable)
 	bool IsContextTreeLoaded() const;
@@ -209,4 +227,7 @@ protected:
 	FUBFItemData ItemData;
 	
 	TSharedPtr<FItemRegistry> ItemRegistry;
+
+	uint64 MetadataHash = 0;
+	uint64 LinksHash = 0;
 };
@@ -0,0 +1,94 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/UBFItem.h"
+
+/**
+ * Non-UObject store for very large inventories, one row per item in struct-of-arrays columns.
+ * All strings live in a single UTF-8 pool addressed by offset and length, the metadata JSON DOM is never kept.
+ * Collection and contract filters scan contiguous hash columns. UUBFItem facades are only created when an item
+ * is handed to Blueprint and are refreshed when their row changes.
+ *
+ * Not thread safe, owned and used by one thread like an inventory component.
+ */
+class FUTUREVERSEUBFCONTROLLER_API FUBFItemStore
+{
+public:
+	enum class EColumn : uint8
+	{
+		AssetId,
+		AssetName,
+		ContractId,
+		TokenId,
+		CollectionId,
+		ProfileURI,
+		MetadataJson,
+		Num
+	};
+
+	// Adds the item or updates the row with the same asset id, returns the row index
+	int32 Add(const FUBFItemData& ItemData, const FString& ProfileURI);
+	bool Remove(const FString& AssetId);
+	void Empty();
+	void Reserve(int32 NumItems, int32 NumStringBytes);
+
+	int32 FindIndex(const FString& AssetId) const;
+	int32 Num() const { return MetadataHashes.Num(); }
+
+	// View into the string pool, invalidated by the next Add, Remove or Compact
+	FUtf8StringView GetView(int32 Index, EColumn Column) const;
+	FString GetString(int32 Index, EColumn Column) const { return FString(GetView(Index, Column)); }
+	uint64 GetMetadataHash(int32 Index) const { return MetadataHashes[Index]; }
+	void SetProfileURI(int32 Index, const FString& ProfileURI);
+
+	void FindByCollection(const FString& CollectionId, TArray<int32>& OutIndices) const;
+	void FindByContract(const FString& ContractId, TArray<int32>& OutIndices) const;
+
+	// Rebuilds the full item data, parsing the metadata json into MetadataJsonObject
+	FUBFItemData MakeItemData(int32 Index) const;
+	// Returns the cached facade of the row or creates one. Facades are plain UUBFItems holding a copy of the row
+	UUBFItem* GetItem(int32 Index, UObject* Outer, TSubclassOf<UUBFItem> ItemClass = UUBFItem::StaticClass());
+
+	// Rewrites the string pool without the bytes of replaced and removed strings
+	void Compact();
+
+	SIZE_T GetAllocatedSize() const;
+	SIZE_T GetWastedBytes() const { return WastedBytes; }
+
+private:
+	struct FStringRef
+	{
+		uint32 Offset = 0;
+		uint32 Length = 0;
+	};
+
+	static constexpr int32 EmptySlot = -1;
+	static constexpr int32 RemovedSlot = -2;
+
+	FStringRef AddString(const FUtf8StringView& Value);
+	void SetString(int32 Index, EColumn Column, const FString& Value);
+	void SetRow(int32 Index, const FUBFItemData& ItemData, const FString& ProfileURI);
+	void RefreshFacade(int32 Index);
+	void FindByHash(const TArray<uint32>& Hashes, EColumn Column, const FString& Value, TArray<int32>& OutIndices) const;
+
+	static uint32 HashString(const FUtf8StringView& Value);
+	int32 FindSlot(const FUtf8StringView& AssetId, uint32 Hash) const;
+	void InsertSlot(int32 Index);
+	void Rehash(int32 NewCapacity);
+
+	TArray<UTF8CHAR> StringPool;
+	SIZE_T WastedBytes = 0;
+
+	TArray<FStringRef> Columns[static_cast<int32>(EColumn::Num)];
+	TArray<uint32> AssetIdHashes;
+	TArray<uint32> CollectionHashes;
+	TArray<uint32> ContractHashes;
+	TArray<uint64> MetadataHashes;
+	TArray<TWeakObjectPtr<UUBFItem>> Facades;
+
+	// open addressed asset id -> row index, power of two capacity
+	TArray<int32> Slots;
+	int32 NumUsedSlots = 0;
+};
@@ -24,6 +24,7 @@ public:
 	TArray<FFutureverseAssetLoadData> GetLinkedAssetLoadData() const;
 
 	FString GetVariantID() const {return VariantID;}
+	const FUBFRenderData& GetRenderData() const { return RenderData; }
 private:
 	FString VariantID;
 	FUBFRenderData RenderData;
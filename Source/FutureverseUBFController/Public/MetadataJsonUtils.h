@@ -93,6 +93,46 @@ namespace MetadataJsonUtils
 		}
 	}
 	
+	// Approximate heap usage of a json DOM, used for memory accounting
+	inline SIZE_T GetApproximateAllocatedSize(const TSharedPtr<FJsonValue>& JsonValue);
+	
+	inline SIZE_T GetApproximateAllocatedSize(const TSharedPtr<FJsonObject>& JsonObject)
+	{
+		if (!JsonObject.IsValid()) return 0;
+
+		SIZE_T Size = sizeof(FJsonObject) + JsonObject->Values.GetAllocatedSize();
+		for (const auto& Pair : JsonObject->Values)
+		{
+			Size += Pair.Key.GetAllocatedSize() + GetApproximateAllocatedSize(Pair.Value);
+		}
+		return Size;
+	}
+
+	inline SIZE_T GetApproximateAllocatedSize(const TSharedPtr<FJsonValue>& JsonValue)
+	{
+		if (!JsonValue.IsValid()) return 0;
+
+		switch (JsonValue->Type)
+		{
+		case EJson::String:
+			return sizeof(FJsonValueString) + JsonValue->AsString().GetAllocatedSize();
+		case EJson::Object:
+			return sizeof(FJsonValueObject) + GetApproximateAllocatedSize(JsonValue->AsObject());
+		case EJson::Array:
+			{
+				const TArray<TSharedPtr<FJsonValue>>& Array = JsonValue->AsArray();
+				SIZE_T Size = sizeof(FJsonValueArray) + Array.GetAllocatedSize();
+				for (const TSharedPtr<FJsonValue>& Element : Array)
+				{
+					Size += GetApproximateAllocatedSize(Element);
+				}
+				return Size;
+			}
+		default:
+			return sizeof(FJsonValueNumber);
+		}
+	}
+	
 	inline FString GetAssetName(const TSharedPtr<FJsonObject>& JsonObject)
 	{
 		FString AssetName;
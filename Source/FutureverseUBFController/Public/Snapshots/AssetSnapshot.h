@@ -0,0 +1,147 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ControllerLayers/AssetProfile.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Versioned binary snapshot of resolved asset profiles, catalog sources and optionally raw blobs (graphs, artifacts).
+ * A snapshot carrying blobs is what UUBFBundleCommandlet writes as a collection bundle.
+ *
+ * Layout (little endian, offsets from the start of the file):
+ *   FHeader
+ *   String table   uint32 offset per string, then per string uint32 byte length + UTF-8 bytes
+ *   Profiles       uint32 id string, uint32 variant count, then 5 strings per variant
+ *                  (variant id, render graph, parsing graph, render catalog uri, parsing catalog uri)
+ *   Profile index  open addressed FIndexSlot table keyed by the formatted asset id
+ *   Catalogs       uint32 uri string, uint32 source string
+ *   Catalog index  open addressed FIndexSlot table keyed by the catalog uri
+ *   Blob data      raw bytes
+ *   Blobs          uint32 uri string, uint32 type id string, uint32 data offset, uint32 data size
+ *   Blob index     open addressed FIndexSlot table keyed by the blob uri
+ *
+ * Opening a snapshot maps the file and validates the header, bounds and CRC. Profiles and catalogs
+ * are only decoded when looked up.
+ *
+ * Catalogs are stored as their JSON source, not as parsed UBF::FCatalogElement maps, since that layout belongs to the
+ * UBF plugin. Every load of a snapshot catalog that FSharedCatalogStore no longer holds parses the JSON again, a
+ * snapshot only saves the catalog download.
+ */
+class FUTUREVERSEUBFCONTROLLER_API FAssetSnapshot
+{
+public:
+	static constexpr uint32 Magic = 0x53464255; // "UBFS"
+	static constexpr uint32 Version = 2;
+
+	~FAssetSnapshot();
+
+	// Maps the file when the platform supports it, otherwise reads it. Returns null if the file is missing or invalid
+	static TSharedPtr<FAssetSnapshot> Open(const FString& Path);
+	static TSharedPtr<FAssetSnapshot> FromMemory(TArray<uint8>&& Data);
+
+	bool FindProfile(const FString& AssetId, FAssetProfile& OutProfile) const;
+	void GetAllProfiles(TArray<FAssetProfile>& OutProfiles) const;
+
+	bool FindCatalogSource(const FString& URI, FString& OutSource) const;
+
+	// OutData points into the snapshot and is only valid while the snapshot is alive
+	bool FindBlob(const FString& URI, TConstArrayView<uint8>& OutData, FString* OutTypeId = nullptr) const;
+	bool ContainsBlob(const FString& URI) const;
+
+	int32 NumProfiles() const;
+	int32 NumCatalogs() const;
+	int32 NumBlobs() const;
+	const FString& GetSourcePath() const { return SourcePath; }
+
+private:
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 FileSize;
+		uint32 PayloadCrc;
+		uint32 NumStrings;
+		uint32 StringTableOffset;
+		uint32 NumProfiles;
+		uint32 ProfilesOffset;
+		uint32 ProfileIndexCapacity;
+		uint32 ProfileIndexOffset;
+		uint32 NumCatalogs;
+		uint32 CatalogsOffset;
+		uint32 CatalogIndexCapacity;
+		uint32 CatalogIndexOffset;
+		uint32 NumBlobs;
+		uint32 BlobsOffset;
+		uint32 BlobIndexCapacity;
+		uint32 BlobIndexOffset;
+	};
+
+	struct FIndexSlot
+	{
+		uint32 KeyHash;
+		// 0 marks an empty slot, records never start at offset 0
+		uint32 RecordOffset;
+	};
+
+	friend class FAssetSnapshotWriter;
+
+	FAssetSnapshot() = default;
+
+	bool Validate();
+
+	const FHeader& GetHeader() const { return *reinterpret_cast<const FHeader*>(Data); }
+	bool ReadUInt32(uint32 Offset, uint32& OutValue) const;
+	bool ReadString(uint32 StringIndex, FString& OutString) const;
+	bool StringEquals(uint32 StringIndex, const FUtf8StringView& Value) const;
+	bool DecodeProfile(uint32 RecordOffset, FAssetProfile& OutProfile) const;
+	uint32 FindRecord(uint32 IndexOffset, uint32 Capacity, const FString& Key) const;
+	uint32 FindBlobRecord(const FString& URI) const;
+
+	static uint32 HashKey(const FUtf8StringView& Key);
+
+	const uint8* Data = nullptr;
+	uint32 Size = 0;
+	FString SourcePath;
+
+	// one of these owns Data
+	TArray<uint8> OwnedData;
+	IMappedFileHandle* MappedFile = nullptr;
+	IMappedFileRegion* MappedRegion = nullptr;
+};
+
+/**
+ * Builds an FAssetSnapshot from profiles and catalog sources, e.g. the ones resident in a live session
+ */
+class FUTUREVERSEUBFCONTROLLER_API FAssetSnapshotWriter
+{
+public:
+	void AddProfile(const FAssetProfile& AssetProfile);
+	void AddCatalogSource(const FString& URI, const FString& Source);
+	void AddBlob(const FString& URI, const FString& TypeId, TArray<uint8>&& Data);
+
+	bool ContainsCatalogSource(const FString& URI) const { return CatalogSources.Contains(URI); }
+	bool ContainsBlob(const FString& URI) const { return Blobs.Contains(URI); }
+
+	TArray<uint8> Build() const;
+	bool Save(const FString& Path) const;
+
+	int32 NumProfiles() const { return Profiles.Num(); }
+	int32 NumCatalogs() const { return CatalogSources.Num(); }
+	int32 NumBlobs() const { return Blobs.Num(); }
+
+private:
+	struct FBlob
+	{
+		FString TypeId;
+		TArray<uint8> Data;
+	};
+	
+	// keyed by formatted asset id so later additions replace earlier ones
+	TMap<FString, FAssetProfile> Profiles;
+	TMap<FString, FString> CatalogSources;
+	TMap<FString, FBlob> Blobs;
+};
@@ -0,0 +1,19 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GlobalArtifactProvider/URIResolvers/URIResolverBase.h"
+#include "BundleURIResolver.generated.h"
+
+/**
+ * Serves graphs and artifacts stored in mounted collection bundles, so they are never requested from the network
+ */
+UCLASS()
+class FUTUREVERSEUBFCONTROLLER_API UBundleURIResolver : public UURIResolverBase
+{
+	GENERATED_BODY()
+public:
+	virtual bool CanResolveURI(const FString& URI) override;
+	virtual TFuture<UBF::FLoadDataArrayResult> ResolveURI(const FString& TypeId, const FString& URI) override;
+};
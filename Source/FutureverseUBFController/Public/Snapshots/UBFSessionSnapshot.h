@@ -0,0 +1,92 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ControllerLayers/AssetProfile.h"
+#include "Items/UBFItem.h"
+#include "UBFSessionSnapshot.generated.h"
+
+class FAssetSnapshot;
+
+// A parsing graph output saved with the UBF type it had, only scalar types can be rebuilt from the saved value
+USTRUCT()
+struct FUBFSessionTrait
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString Type;
+
+	UPROPERTY()
+	FString Value;
+};
+
+// What a controller with a session slot last rendered, see UFutureverseUBFControllerSubsystem::SetSessionSlot
+USTRUCT()
+struct FUBFSessionRender
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString Slot;
+
+	UPROPERTY()
+	FUBFRenderData RenderData;
+
+	UPROPERTY()
+	FString VariantID;
+
+	UPROPERTY()
+	bool bRenderTree = false;
+
+	// parsing graph the traits came from
+	UPROPERTY()
+	FString ParsingBlueprintId;
+
+	// parsing graph outputs with a scalar type, only used until the parsing graph has run again
+	UPROPERTY()
+	TMap<FString, FUBFSessionTrait> Traits;
+
+	// set if outputs of other types were left out of Traits
+	UPROPERTY()
+	bool bTraitsIncomplete = false;
+};
+
+USTRUCT()
+struct FUBFSessionManifest
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Version = 0;
+
+	UPROPERTY()
+	TArray<FUBFSessionRender> Renders;
+};
+
+/**
+ * Renders of the previous session with the profiles and catalog sources they used. Stored as an FAssetSnapshot whose
+ * manifest blob lists the renders, opening it mounts the snapshot so restored renders resolve without the network.
+ */
+class FUTUREVERSEUBFCONTROLLER_API FUBFSessionSnapshot
+{
+public:
+	static constexpr int32 Version = 2;
+
+	// Returns null if Path has no valid session snapshot
+	static TSharedPtr<FUBFSessionSnapshot> Open(const FString& Path);
+
+	// Catalog sources of the rendered variants come from captured downloads or mounted snapshots, catalogs found in neither are left out
+	static TArray<uint8> Build(const TArray<FUBFSessionRender>& Renders, const TArray<FAssetProfilePtr>& AssetProfiles);
+
+	const FUBFSessionRender* FindRender(const FString& Slot) const { return Renders.Find(Slot); }
+	int32 NumRenders() const { return Renders.Num(); }
+
+	// Stops answering profile and catalog lookups, the renders stay available
+	void Unmount();
+
+private:
+	TSharedPtr<const FAssetSnapshot> Snapshot;
+	TMap<FString, FUBFSessionRender> Renders;
+};
@@ -16,4 +16,8 @@ class FUTUREVERSEUBFCONTROLLER_API USyloURIResolver : public UURIResolverBase
 public:
 	virtual bool CanResolveURI(const FString& URI) override;
 	virtual TFuture<UBF::FLoadDataArrayResult> ResolveURI(const FString& TypeId, const FString& URI) override;
+
+private:
+	// Resolved through the Sylo subsystem unless the traffic archive replays a recorded response instead
+	TFuture<UBF::FLoadDataArrayResult> LoadSyloDID(const FString& URI) const;
 };
@@ -0,0 +1,33 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// One item to run the parsing graph for, the same inputs RenderItem derives from an UUBFItem
+struct FUTUREVERSEUBFCONTROLLER_API FUBFTraitExtractionRequest
+{
+	FString AssetID;
+	FString ProfileURI;
+	FString VariantID = FString(TEXT("Default"));
+	FString MetadataJson;
+};
+
+struct FUTUREVERSEUBFCONTROLLER_API FUBFTraitExtractionResult
+{
+	FString AssetID;
+	bool bSuccess = false;
+	
+	// parsing graph output name -> value as a string
+	TMap<FString, FString> Traits;
+};
+
+struct FUTUREVERSEUBFCONTROLLER_API FUBFTraitExtractionBatchResult
+{
+	// in the same order as the requests
+	TArray<FUBFTraitExtractionResult> Results;
+	int32 NumSucceeded = 0;
+	double Seconds = 0.0;
+
+	double GetItemsPerSecond() const { return Seconds > 0.0 ? Results.Num() / Seconds : 0.0; }
+};
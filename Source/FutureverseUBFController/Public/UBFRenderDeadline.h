@@ -0,0 +1,39 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Point in time by which a render has to be handed to its controller, carried through every stage and download of
+ * the render. A default constructed deadline never expires.
+ */
+struct FUBFRenderDeadline
+{
+	// BudgetSeconds <= 0 gives a deadline that never expires
+	static FUBFRenderDeadline FromBudget(float BudgetSeconds)
+	{
+		FUBFRenderDeadline Deadline;
+		if (BudgetSeconds > 0.f)
+		{
+			Deadline.BudgetSeconds = BudgetSeconds;
+			Deadline.ExpiresAt = FPlatformTime::Seconds() + BudgetSeconds;
+		}
+		return Deadline;
+	}
+
+	bool IsSet() const { return ExpiresAt > 0.0; }
+	bool HasExpired() const { return IsSet() && FPlatformTime::Seconds() >= ExpiresAt; }
+
+	double GetRemainingSeconds() const
+	{
+		return IsSet() ? FMath::Max(ExpiresAt - FPlatformTime::Seconds(), 0.0) : TNumericLimits<double>::Max();
+	}
+
+	// True if Seconds of work still fit in the remaining budget
+	bool CanCover(double Seconds) const { return GetRemainingSeconds() >= Seconds; }
+
+	// FPlatformTime::Seconds() at which the budget runs out, 0 if there is no budget
+	double ExpiresAt = 0.0;
+	float BudgetSeconds = 0.f;
+};
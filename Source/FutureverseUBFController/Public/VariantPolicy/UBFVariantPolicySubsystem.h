@@ -0,0 +1,104 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UBFRuntimeController.h"
+#include "Items/UBFItem.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UBFVariantPolicySubsystem.generated.h"
+
+USTRUCT(BlueprintType)
+struct FUTUREVERSEUBFCONTROLLER_API FUBFVariantPolicy
+{
+	GENERATED_BODY()
+
+	// Variant rendered while the character is close, visible and inside the full variant budget
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FString FullVariantID = TEXT("Default");
+
+	// Cheaper variant of the same profiles (e.g. low poly) rendered for every other character
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FString ReducedVariantID;
+
+	// Distance to the view below which the character is upgraded to FullVariantID
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float UpgradeDistance = 2000.f;
+
+	// Distance past which a full variant is reduced again, larger than UpgradeDistance so characters on the edge don't flip
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float DowngradeDistance = 2500.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bReduceWhenNotRendered = true;
+};
+
+/**
+ * Render and variant state of one controller managed by UUBFVariantPolicySubsystem
+ */
+UCLASS()
+class FUTUREVERSEUBFCONTROLLER_API UUBFVariantPolicyRender : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	TWeakObjectPtr<UUBFRuntimeController> Controller;
+	FUBFVariantPolicy Policy;
+
+	// variant of the last completed render, empty until the first render completes
+	FString RenderedVariantID;
+	// variant of the render in flight, empty while idle
+	FString PendingVariantID;
+	// last variant that failed to render, skipped while the policy keeps picking it and retried once it picked another one
+	FString FailedVariantID;
+
+	// caller's callback, only used for the first render
+	FOnComplete OnFirstRenderComplete;
+
+	double DistanceSquared = 0.0;
+	bool bWantsFullVariant = false;
+
+	bool IsBusy() const { return !PendingVariantID.IsEmpty(); }
+
+	UFUNCTION()
+	void HandleRenderComplete(bool bSuccess, FUBFExecutionReport ExecutionReport);
+};
+
+/**
+ * Picks the variant of managed characters from their distance to the view, their visibility and a global budget of
+ * full variant renders (UFutureverseUBFControllerSettings::GetMaxFullVariantRenders). Characters start on the reduced
+ * variant and are upgraded asynchronously, nearest first, through UFutureverseUBFControllerSubsystem::SwitchRenderedVariant,
+ * which keeps the parsed traits when both variants share a parsing graph.
+ */
+UCLASS()
+class FUTUREVERSEUBFCONTROLLER_API UUBFVariantPolicySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UUBFVariantPolicySubsystem* Get(const UObject* WorldContext);
+
+	// Renders Item on Controller and keeps switching its variant under Policy until RemovePolicy or the controller is destroyed
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnComplete"))
+	void RenderItemWithPolicy(UUBFItem* Item, UUBFRuntimeController* Controller, const FUBFVariantPolicy& Policy,
+		const TMap<FString, UUBFBindingObject*>& InputMap, bool bRenderTree, const FOnComplete& OnComplete);
+
+	// Stops managing Controller, it keeps the variant it currently renders
+	UFUNCTION(BlueprintCallable)
+	void RemovePolicy(UUBFRuntimeController* Controller);
+
+	int32 GetNumFullVariantRenders() const;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	bool GetViewLocation(FVector& OutViewLocation) const;
+	void UpdateVariants(const FVector& ViewLocation);
+	void SwitchVariant(UUBFVariantPolicyRender* Render, const FString& VariantID);
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UUBFVariantPolicyRender>> Renders;
+
+	float TimeSinceUpdate = 0.f;
+};
@@ -3,71 +3,89 @@
 
 #include "ControllerLayers/AssetProfile.h"
 
+namespace
+{
+	const FString EmptyString;
+}
+
 FAssetProfileVariant::FAssetProfileVariant(const FString& Id, const FString& RenderId, const FString& ParsingId,
 										   const FString& RenderCatalogUri, const FString& ParsingCatalogUri)
 		: VariantId(Id), RenderBlueprintId(RenderId), ParsingBlueprintId(ParsingId),
 			RenderCatalogUri(RenderCatalogUri), ParsingCatalogUri(ParsingCatalogUri)
 {
-	
+	ResolveCatalogUris();
 }
 
-FString FAssetProfileVariant::GetRenderBlueprintId() const
+void FAssetProfileVariant::SetRelativePath(const FString& NewRelativePath)
 {
-	return RenderBlueprintId;
+	RelativePath = NewRelativePath;
+	ResolveCatalogUris();
 }
 
-FString FAssetProfileVariant::GetRenderCatalogUri() const
+void FAssetProfileVariant::ResolveCatalogUris() const
 {
-	return RelativePath + RenderCatalogUri;
+	if (bCatalogUrisResolved && ResolvedRelativePath.Equals(RelativePath, ESearchCase::CaseSensitive))
+		return;
+
+	ResolvedRenderCatalogUri = RelativePath + RenderCatalogUri;
+	ResolvedParsingCatalogUri = RelativePath + ParsingCatalogUri;
+	ResolvedRelativePath = RelativePath;
+	bCatalogUrisResolved = true;
 }
 
-FString FAssetProfileVariant::GetParsingBlueprintId() const
+SIZE_T FAssetProfileVariant::GetAllocatedSize() const
 {
-	return ParsingBlueprintId;
+	return RelativePath.GetAllocatedSize() + VariantId.GetAllocatedSize() + RenderBlueprintId.GetAllocatedSize()
+		+ ParsingBlueprintId.GetAllocatedSize() + RenderCatalogUri.GetAllocatedSize() + ParsingCatalogUri.GetAllocatedSize()
+		+ ResolvedRenderCatalogUri.GetAllocatedSize() + ResolvedParsingCatalogUri.GetAllocatedSize() + ResolvedRelativePath.GetAllocatedSize();
 }
 
-FString FAssetProfileVariant::GetParsingCatalogUri() const
+FAssetProfile::FAssetProfile(const FString& Id, const TArray<FAssetProfileVariant>& Variants) : Id(Id), Variants(Variants)
 {
-	return RelativePath + ParsingCatalogUri;
+	BuildVariantIndex();
 }
 
-FString FAssetProfile::GetRenderBlueprintId(const FString& Variant) const
+const FAssetProfile& FAssetProfile::Invalid()
 {
-	int Index = GetIndexForVariant(Variant);
-	if (!Variants.IsValidIndex(Index)) return FString();
-
-	return Variants[Index].GetRenderBlueprintId();
+	static const FAssetProfile InvalidProfile;
+	return InvalidProfile;
 }
 
-FString FAssetProfile::GetRenderCatalogUri(const FString& Variant) const
+const FString& FAssetProfile::GetRenderBlueprintId(const FString& Variant) const
 {
-	int Index = GetIndexForVariant(Variant);
-	if (!Variants.IsValidIndex(Index)) return FString();
-
-	return Variants[Index].GetRenderCatalogUri();
+	const FAssetProfileVariant* ProfileVariant = FindVariant(Variant);
+	return ProfileVariant ? ProfileVariant->GetRenderBlueprintId() : EmptyString;
 }
 
-FString FAssetProfile::GetParsingBlueprintId(const FString& Variant) const
+const FString& FAssetProfile::GetRenderCatalogUri(const FString& Variant) const
 {
-	int Index = GetIndexForVariant(Variant);
-	if (!Variants.IsValidIndex(Index)) return FString();
+	const FAssetProfileVariant* ProfileVariant = FindVariant(Variant);
+	return ProfileVariant ? ProfileVariant->GetRenderCatalogUri() : EmptyString;
+}
 
-	return Variants[Index].GetParsingBlueprintId();
+const FString& FAssetProfile::GetParsingBlueprintId(const FString& Variant) const
+{
+	const FAssetProfileVariant* ProfileVariant = FindVariant(Variant);
+	return ProfileVariant ? ProfileVariant->GetParsingBlueprintId() : EmptyString;
 }
 
-FString FAssetProfile::GetParsingCatalogUri(const FString& Variant) const
+const FString& FAssetProfile::GetParsingCatalogUri(const FString& Variant) const
 {
-	int Index = GetIndexForVariant(Variant);
-	if (!Variants.IsValidIndex(Index)) return FString();
+	const FAssetProfileVariant* ProfileVariant = FindVariant(Variant);
+	return ProfileVariant ? ProfileVariant->GetParsingCatalogUri() : EmptyString;
+}
 
-	return Variants[Index].GetParsingCatalogUri();
+const FAssetProfileVariant* FAssetProfile::FindVariant(const FString& Variant) const
+{
+	const int Index = GetIndexForVariant(Variant);
+	return Variants.IsValidIndex(Index) ? &Variants[Index] : nullptr;
 }
 
 void FAssetProfile::OverrideRelativePaths(const FString& NewRelativePath)
 {
 	for (FAssetProfileVariant& Variant : Variants)
 	{
-		Variant.RelativePath = NewRelativePath;
+		Variant.SetRelativePath(NewRelativePath);
 	}
 }
 
@@ -76,6 +94,20 @@ void FAssetProfile::ModifyId(const FString& NewId)
 	Id = NewId;
 }
 
+SIZE_T FAssetProfile::GetAllocatedSize() const
+{
+	SIZE_T Size = Id.GetAllocatedSize() + Variants.GetAllocatedSize() + VariantIndex.GetAllocatedSize();
+	for (const FAssetProfileVariant& Variant : Variants)
+	{
+		Size += Variant.GetAllocatedSize();
+	}
+	for (const auto& Entry : VariantIndex)
+	{
+		Size += Entry.Key.GetAllocatedSize();
+	}
+	return Size;
+}
+
 FString FAssetProfile::ToString() const
 {
 	FString VariantsString;
@@ -88,6 +120,13 @@ FString FAssetProfile::ToString() const
 
 int FAssetProfile::GetIndexForVariant(const FString& Variant) const
 {
+	if (VariantIndex.Num() == Variants.Num())
+	{
+		const int32* Index = VariantIndex.Find(Variant);
+		return Index ? *Index : -1;
+	}
+	
+	// profiles created through reflection don't have the index built
 	for (int i = 0; i < Variants.Num(); i++)
 	{
 		if (Variants[i].GetVariantId() == Variant)
@@ -96,3 +135,24 @@ int FAssetProfile::GetIndexForVariant(const FString& Variant) const
 
 	return -1;
 }
+
+void FAssetProfile::PrepareForSharing()
+{
+	BuildVariantIndex();
+	for (const FAssetProfileVariant& Variant : Variants)
+	{
+		Variant.ResolveCatalogUris();
+	}
+}
+
+void FAssetProfile::BuildVariantIndex()
+{
+	VariantIndex.Reset();
+	VariantIndex.Reserve(Variants.Num());
+	
+	// first variant wins when ids repeat, matching the previous linear scan
+	for (int32 i = Variants.Num() - 1; i >= 0; i--)
+	{
+		VariantIndex.Add(Variants[i].GetVariantId(), i);
+	}
+}
@@ -15,13 +15,24 @@ public:
 	FAssetProfileVariant(const FString& Id, const FString& RenderId, const FString& ParsingId,
 		const FString& RenderCatalogUri, const FString& ParsingCatalogUri);
 
-	FString GetRenderBlueprintId() const;
-	FString GetRenderCatalogUri() const;
-	FString GetParsingBlueprintId() const;
-	FString GetParsingCatalogUri() const;
-	FString GetVariantId() const{return VariantId;}
+	const FString& GetRenderBlueprintId() const { return RenderBlueprintId; }
+	// Catalog URIs resolved against the relative path
+	const FString& GetRenderCatalogUri() const { ResolveCatalogUris(); return ResolvedRenderCatalogUri; }
+	const FString& GetParsingBlueprintId() const { return ParsingBlueprintId; }
+	const FString& GetParsingCatalogUri() const { ResolveCatalogUris(); return ResolvedParsingCatalogUri; }
+	const FString& GetVariantId() const{return VariantId;}
+	const FString& GetRelativePath() const { return RelativePath; }
 	bool IsValid() const {return VariantId != FString("Invalid");}
 
+	void SetRelativePath(const FString& NewRelativePath);
+
+	// Rebuilds the resolved URIs unless they were built from the current RelativePath. Variants built in code are
+	// resolved when constructed or given a path, variants populated through reflection resolve here on first read
+	void ResolveCatalogUris() const;
+
+	// Heap memory owned by this variant, excluding sizeof(FAssetProfileVariant)
+	SIZE_T GetAllocatedSize() const;
+
 	FString ToString() const
 	{
 		return FString::Printf(
@@ -35,9 +46,10 @@ public:
 		);
 	}
 	
+private:
 	UPROPERTY()
 	FString RelativePath;
-private:
+	
 	UPROPERTY()
 	FString VariantId = FString("Invalid");
 	
@@ -49,8 +61,19 @@ private:
 	FString RenderCatalogUri;
 	UPROPERTY()
 	FString ParsingCatalogUri;
+
+	mutable FString ResolvedRenderCatalogUri;
+	mutable FString ResolvedParsingCatalogUri;
+	// RelativePath the resolved URIs were built from
+	mutable FString ResolvedRelativePath;
+	mutable bool bCatalogUrisResolved = false;
 };
 
+struct FAssetProfile;
+
+// Registered profiles are immutable and shared between every request that renders them
+typedef TSharedPtr<const FAssetProfile, ESPMode::ThreadSafe> FAssetProfilePtr;
+
 
 USTRUCT(BlueprintType)
 struct UBFAPICONTROLLER_API FAssetProfile
@@ -58,26 +81,43 @@ struct UBFAPICONTROLLER_API FAssetProfile
 	GENERATED_BODY()
 public:
 	FAssetProfile(){}
-	FAssetProfile(const FString& Id, const TArray<FAssetProfileVariant>& Variants) : Id(Id), Variants(Variants){}
+	FAssetProfile(const FString& Id, const TArray<FAssetProfileVariant>& Variants);
 	
-	FString GetRenderBlueprintId(const FString& Variant) const;
-	FString GetRenderCatalogUri(const FString& Variant) const;
-	FString GetParsingBlueprintId(const FString& Variant) const;
-	FString GetParsingCatalogUri(const FString& Variant) const;
-	FString GetId() const {return Id;}
+	// Shared profile returned when a lookup fails, reports IsValid() false and empty ids for every variant
+	static const FAssetProfile& Invalid();
+	
+	const FString& GetRenderBlueprintId(const FString& Variant) const;
+	const FString& GetRenderCatalogUri(const FString& Variant) const;
+	const FString& GetParsingBlueprintId(const FString& Variant) const;
+	const FString& GetParsingCatalogUri(const FString& Variant) const;
+	const FString& GetId() const {return Id;}
 	bool IsValid() const {return Id != FString("Invalid");}
+	
+	const FAssetProfileVariant* FindVariant(const FString& Variant) const;
+	const TArray<FAssetProfileVariant>& GetVariants() const { return Variants; }
 
 	void OverrideRelativePaths(const FString& NewRelativePath);
 	void ModifyId(const FString& NewId);
 
+	// Builds the variant index and resolves every catalog URI, so a profile populated through reflection
+	// never writes its lazy caches once it is shared between threads
+	void PrepareForSharing();
+
+	// Heap memory owned by this profile, excluding sizeof(FAssetProfile)
+	SIZE_T GetAllocatedSize() const;
+
 	FString ToString() const;
 	
 private:
 	int GetIndexForVariant(const FString& Variant) const;
+	void BuildVariantIndex();
 	
 	UPROPERTY()
 	FString Id = FString("Invalid");
 	
 	UPROPERTY()
 	TArray<FAssetProfileVariant> Variants;
+
+	// VariantId -> index into Variants
+	TMap<FString, int32> VariantIndex;
 };
@@ -0,0 +1,89 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "Benchmarks/UBFBenchmark.h"
+
+#include "UBFAssetTestLog.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Misc/FileHelper.h"
+
+LLM_DEFINE_TAG(UBFBenchmark);
+
+namespace UBFBenchmark
+{
+	namespace
+	{
+#if STATS
+		// The call counters the allocators already keep for stat memory are only visible to FMalloc subclasses
+		struct FAllocatorCallCounters : FMalloc
+		{
+			static uint64 Get() { return static_cast<uint64>(TotalMallocCalls) + static_cast<uint64>(TotalReallocCalls); }
+		};
+#endif
+		
+		uint64 GetAllocatorCalls()
+		{
+#if STATS
+			return FAllocatorCallCounters::Get();
+#else
+			return 0;
+#endif
+		}
+
+		int64 GetTrackedBytes()
+		{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+			if (FLowLevelMemTracker::IsEnabled())
+			{
+				// tag amounts are only gathered once per frame otherwise
+				FLowLevelMemTracker::Get().UpdateStatsPerFrame();
+				return FLowLevelMemTracker::Get().GetTagAmountForTracker(ELLMTracker::Default, TEXT("UBFBenchmark"), ELLMTagSet::None);
+			}
+#endif
+			return 0;
+		}
+	}
+
+	FAllocationScope::FAllocationScope()
+		: StartAllocations(GetAllocatorCalls())
+		, StartBytes(GetTrackedBytes())
+	{
+	}
+
+	uint64 FAllocationScope::GetAllocations() const
+	{
+		return GetAllocatorCalls() - StartAllocations;
+	}
+
+	int64 FAllocationScope::GetBytes() const
+	{
+		return GetTrackedBytes() - StartBytes;
+	}
+
+	void Report(const FString& SuiteName, const TArray<FResult>& Results)
+	{
+		FString Csv = TEXT("Name,Iterations,NsPerOp,AllocsPerOp,BytesPerOp\n");
+		
+		UE_LOG(LogUBFAssetTest, Display, TEXT("---- %s ----"), *SuiteName);
+		for (const FResult& Result : Results)
+		{
+			UE_LOG(LogUBFAssetTest, Display, TEXT("%-48s %10.1f ns/op %8.2f allocs/op %10.1f bytes/op (%d iterations)"),
+				*Result.Name, Result.NsPerOp, Result.AllocsPerOp, Result.BytesPerOp, Result.Iterations);
+			
+			Csv += FString::Printf(TEXT("%s,%d,%.2f,%.3f,%.1f\n"),
+				*Result.Name, Result.Iterations, Result.NsPerOp, Result.AllocsPerOp, Result.BytesPerOp);
+		}
+
+		const FString CsvPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("UBFBenchmarks"), SuiteName + TEXT(".csv"));
+		if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+		{
+			UE_LOG(LogUBFAssetTest, Display, TEXT("Wrote %s"), *CsvPath);
+		}
+	}
+
+	void DoNotOptimize(int64 Value)
+	{
+		static volatile int64 Sink = 0;
+		Sink = Sink + Value;
+	}
+}
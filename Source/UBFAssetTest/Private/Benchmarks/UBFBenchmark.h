@@ -0,0 +1,79 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+LLM_DECLARE_TAG(UBFBenchmark);
+
+/**
+ * Minimal harness for microbenchmarks of controller hot paths.
+ * Measures wall time, allocator calls and the bytes the body leaves allocated.
+ */
+namespace UBFBenchmark
+{
+	struct FResult
+	{
+		FString Name;
+		int32 Iterations = 0;
+		double NsPerOp = 0.0;
+		double AllocsPerOp = 0.0;
+		double BytesPerOp = 0.0;
+	};
+
+	// Reads the allocator's call counters, which cover every thread, so run benchmarks in an idle world. Not available
+	// in shipping builds. Bytes are what LLM attributes to the UBFBenchmark tag, so the measured code has to run under
+	// LLM_SCOPE_BYTAG(UBFBenchmark) and the process with -llm, 0 otherwise
+	class FAllocationScope
+	{
+	public:
+		FAllocationScope();
+
+		uint64 GetAllocations() const;
+		int64 GetBytes() const;
+
+	private:
+		uint64 StartAllocations = 0;
+		int64 StartBytes = 0;
+	};
+
+	template<typename FunctionType>
+	FResult Run(const FString& Name, int32 Iterations, FunctionType&& Body)
+	{
+		Iterations = FMath::Max(1, Iterations);
+		
+		// warm caches and lazily initialised statics
+		for (int32 i = 0; i < FMath::Max(1, Iterations / 10); ++i)
+		{
+			Body();
+		}
+
+		FResult Result;
+		Result.Name = Name;
+		Result.Iterations = Iterations;
+		
+		{
+			LLM_SCOPE_BYTAG(UBFBenchmark);
+			const FAllocationScope AllocationScope;
+			const double StartTime = FPlatformTime::Seconds();
+			
+			for (int32 i = 0; i < Iterations; ++i)
+			{
+				Body();
+			}
+			
+			Result.NsPerOp = (FPlatformTime::Seconds() - StartTime) * 1e9 / Iterations;
+			Result.AllocsPerOp = static_cast<double>(AllocationScope.GetAllocations()) / Iterations;
+			Result.BytesPerOp = static_cast<double>(AllocationScope.GetBytes()) / Iterations;
+		}
+		
+		return Result;
+	}
+
+	// Logs the results and writes them to Saved/UBFBenchmarks/{SuiteName}.csv so runs can be compared
+	void Report(const FString& SuiteName, const TArray<FResult>& Results);
+
+	// Keeps the optimiser from discarding work whose result is otherwise unused
+	void DoNotOptimize(int64 Value);
+}
@@ -0,0 +1,259 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "AssetIdUtils.h"
+#include "Graph.h"
+#include "MetadataJsonUtils.h"
+#include "UBFAssetTestLog.h"
+#include "Benchmarks/UBFBenchmark.h"
+#include "ControllerLayers/AssetProfileUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Snapshots/AssetSnapshot.h"
+#include "Util/CatalogUtils.h"
+
+namespace UBFHelperBenchmarks
+{
+	// Multi-profile file in the same shape as the contract profiles, one entry per token
+	FString MakeMultiProfileJson(int32 NumTokens)
+	{
+		const FString Version = UBF::MaxSupportedGraphVersion.ToString();
+		
+		FString Json = TEXT("{");
+		for (int32 TokenIndex = 0; TokenIndex < NumTokens; ++TokenIndex)
+		{
+			Json += FString::Printf(TEXT("%s\"%d\":{\"profile_verison\":\"1.0\",\"ubf-variants\":{"
+				"\"Default\":{\"%s\":{\"render-instance\":\"render-%d\",\"render-catalog\":\"catalogs/render-%d.json\","
+				"\"parsing-instance\":\"parsing\",\"parsing-catalog\":\"catalogs/parsing.json\"}},"
+				"\"LowPoly\":{\"%s\":{\"render-instance\":\"render-low-%d\",\"render-catalog\":\"catalogs/render-low-%d.json\"}}}}"),
+				TokenIndex > 0 ? TEXT(",") : TEXT(""), TokenIndex, *Version, TokenIndex, TokenIndex, *Version, TokenIndex, TokenIndex);
+		}
+		Json += TEXT("}");
+		return Json;
+	}
+
+	FString MakeCatalogJson(int32 NumResources)
+	{
+		FString Json = TEXT("{\"resources\":[");
+		for (int32 ResourceIndex = 0; ResourceIndex < NumResources; ++ResourceIndex)
+		{
+			Json += FString::Printf(TEXT("%s{\"id\":\"resource-%d\",\"type\":\"Mesh\",\"uri\":\"https://example.com/resources/%d.glb\","
+				"\"hash\":\"%08x\"}"), ResourceIndex > 0 ? TEXT(",") : TEXT(""), ResourceIndex, ResourceIndex, GetTypeHash(ResourceIndex));
+		}
+		Json += TEXT("]}");
+		return Json;
+	}
+
+	// Nests objects and arrays Depth levels deep with the target field only present at the bottom
+	TSharedPtr<FJsonObject> MakeNestedMetadata(int32 Depth, int32 FieldsPerLevel)
+	{
+		TSharedPtr<FJsonObject> Leaf = MakeShared<FJsonObject>();
+		Leaf->SetStringField(TEXT("name"), TEXT("Deep Asset"));
+
+		TSharedPtr<FJsonObject> Current = Leaf;
+		for (int32 Level = 0; Level < Depth; ++Level)
+		{
+			TSharedPtr<FJsonObject> Parent = MakeShared<FJsonObject>();
+			for (int32 FieldIndex = 0; FieldIndex < FieldsPerLevel; ++FieldIndex)
+			{
+				Parent->SetStringField(FString::Printf(TEXT("trait_%d_%d"), Level, FieldIndex), TEXT("value"));
+			}
+
+			if (Level % 2 == 0)
+			{
+				Parent->SetObjectField(TEXT("properties"), Current);
+			}
+			else
+			{
+				TArray<TSharedPtr<FJsonValue>> Array;
+				Array.Add(MakeShared<FJsonValueString>(TEXT("filler")));
+				Array.Add(MakeShared<FJsonValueObject>(Current));
+				Parent->SetArrayField(TEXT("attributes"), Array);
+			}
+			Current = Parent;
+		}
+		return Current;
+	}
+
+	const TArray<FString>& GetAssetIdFormats()
+	{
+		static const TArray<FString> AssetIds =
+		{
+			TEXT("7672:root:303204:1234"),
+			TEXT("7672:root:303204:override"),
+			TEXT("7672:ROOT:0x1a2B3c4D5e6F7a8B9c0D1e2F3a4B5c6D7e8F9a0B:98765"),
+			TEXT("7672:root:303-204:12 34"),
+			TEXT("303204:1234"),
+			TEXT("1234"),
+			TEXT(""),
+		};
+		return AssetIds;
+	}
+
+	void RunAll(int32 Iterations)
+	{
+		TArray<UBFBenchmark::FResult> Results;
+
+		// Asset profiles
+		for (const int32 NumTokens : {1, 100, 10000})
+		{
+			const FString ProfileJson = MakeMultiProfileJson(NumTokens);
+			const int32 ProfileIterations = FMath::Max(1, Iterations / NumTokens);
+			Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("ParseAssetProfileJson/%d tokens"), NumTokens), ProfileIterations, [&ProfileJson]()
+			{
+				TArray<FAssetProfile> AssetProfiles;
+				AssetProfileUtils::ParseAssetProfileJson(ProfileJson, AssetProfiles);
+				UBFBenchmark::DoNotOptimize(AssetProfiles.Num());
+			}));
+		}
+
+		// Catalogs, -UBFBenchCatalog= allows benchmarking a recorded catalog instead of the generated one
+		FString CatalogJson;
+		FString CatalogPath;
+		if (!FParse::Value(FCommandLine::Get(), TEXT("UBFBenchCatalog="), CatalogPath) || !FFileHelper::LoadFileToString(CatalogJson, *CatalogPath))
+		{
+			CatalogJson = MakeCatalogJson(500);
+		}
+		{
+			TMap<FString, UBF::FCatalogElement> CatalogMap;
+			CatalogUtils::ParseCatalog(CatalogJson, CatalogMap);
+			UE_LOG(LogUBFAssetTest, Display, TEXT("UBFHelperBenchmarks catalog input has %d elements"), CatalogMap.Num());
+		}
+		Results.Add(UBFBenchmark::Run(TEXT("ParseCatalog"), FMath::Max(1, Iterations / 100), [&CatalogJson]()
+		{
+			TMap<FString, UBF::FCatalogElement> CatalogMap;
+			CatalogUtils::ParseCatalog(CatalogJson, CatalogMap);
+			UBFBenchmark::DoNotOptimize(CatalogMap.Num());
+		}));
+
+		// Asset ids, each iteration covers every format
+		const TArray<FString>& AssetIds = GetAssetIdFormats();
+		Results.Add(UBFBenchmark::Run(TEXT("AssetIdUtils::GetCollectionID"), Iterations, [&AssetIds]()
+		{
+			for (const FString& AssetId : AssetIds) UBFBenchmark::DoNotOptimize(AssetIdUtils::GetCollectionID(AssetId).Len());
+		}));
+		Results.Add(UBFBenchmark::Run(TEXT("AssetIdUtils::GetContractID"), Iterations, [&AssetIds]()
+		{
+			for (const FString& AssetId : AssetIds) UBFBenchmark::DoNotOptimize(AssetIdUtils::GetContractID(AssetId).Len());
+		}));
+		Results.Add(UBFBenchmark::Run(TEXT("AssetIdUtils::GetTokenID"), Iterations, [&AssetIds]()
+		{
+			for (const FString& AssetId : AssetIds) UBFBenchmark::DoNotOptimize(AssetIdUtils::GetTokenID(AssetId).Len());
+		}));
+		Results.Add(UBFBenchmark::Run(TEXT("AssetIdUtils::GetAssetID"), Iterations, [&AssetIds]()
+		{
+			for (const FString& AssetId : AssetIds) UBFBenchmark::DoNotOptimize(AssetIdUtils::GetAssetID(AssetId).Len());
+		}));
+		Results.Add(UBFBenchmark::Run(TEXT("AssetIdUtils::FormatAssetId"), Iterations, [&AssetIds]()
+		{
+			for (const FString& AssetId : AssetIds) UBFBenchmark::DoNotOptimize(AssetIdUtils::FormatAssetId(AssetId).Len());
+		}));
+		Results.Add(UBFBenchmark::Run(TEXT("AssetIdUtils::ConvertAssetIdToOverrideId"), Iterations, [&AssetIds]()
+		{
+			for (const FString& AssetId : AssetIds) UBFBenchmark::DoNotOptimize(AssetIdUtils::ConvertAssetIdToOverrideId(AssetId).Len());
+		}));
+
+		// Metadata
+		for (const int32 Depth : {4, 32})
+		{
+			const TSharedPtr<FJsonObject> Metadata = MakeNestedMetadata(Depth, 8);
+			Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("FindFieldRecursively/depth %d hit"), Depth), Iterations, [&Metadata]()
+			{
+				UBFBenchmark::DoNotOptimize(MetadataJsonUtils::FindFieldRecursively(Metadata, TEXT("name")).IsValid());
+			}));
+			Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("FindFieldRecursively/depth %d miss"), Depth), Iterations, [&Metadata]()
+			{
+				UBFBenchmark::DoNotOptimize(MetadataJsonUtils::FindFieldRecursively(Metadata, TEXT("missing")).IsValid());
+			}));
+		}
+
+		UBFBenchmark::Report(TEXT("Helpers"), Results);
+	}
+
+	// Same profiles through JSON and through a snapshot, ids are formatted the way the registry stores them
+	void RunSnapshot(int32 Iterations)
+	{
+		TArray<UBFBenchmark::FResult> Results;
+		const FString CollectionId = TEXT("7672:root:303204");
+		
+		for (const int32 NumTokens : {100, 10000})
+		{
+			const FString ProfileJson = MakeMultiProfileJson(NumTokens);
+			const int32 ProfileIterations = FMath::Max(1, Iterations / NumTokens);
+			
+			TArray<FAssetProfile> ParsedProfiles;
+			AssetProfileUtils::ParseAssetProfileJson(ProfileJson, ParsedProfiles);
+
+			FAssetSnapshotWriter Writer;
+			for (FAssetProfile& AssetProfile : ParsedProfiles)
+			{
+				AssetProfile.ModifyId(FString::Printf(TEXT("%s:%s"), *CollectionId, *AssetProfile.GetId()));
+				Writer.AddProfile(AssetProfile);
+			}
+			Writer.AddCatalogSource(TEXT("catalogs/parsing.json"), MakeCatalogJson(500));
+			
+			const TArray<uint8> SnapshotData = Writer.Build();
+			const FString SnapshotPath = FPaths::CreateTempFilename(*FPaths::ProjectSavedDir(), TEXT("UBFBenchSnapshot"), TEXT(".ubfs"));
+			FFileHelper::SaveArrayToFile(SnapshotData, *SnapshotPath);
+			UE_LOG(LogUBFAssetTest, Display, TEXT("UBFHelperBenchmarks snapshot with %d profiles is %d bytes, JSON is %d chars"),
+				Writer.NumProfiles(), SnapshotData.Num(), ProfileJson.Len());
+
+			Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("ParseAssetProfileJson/%d tokens"), NumTokens), ProfileIterations, [&ProfileJson]()
+			{
+				TArray<FAssetProfile> AssetProfiles;
+				AssetProfileUtils::ParseAssetProfileJson(ProfileJson, AssetProfiles);
+				UBFBenchmark::DoNotOptimize(AssetProfiles.Num());
+			}));
+			// includes copying the buffer, which is the cost of validating an in memory snapshot
+			Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("Snapshot FromMemory/%d tokens"), NumTokens), ProfileIterations, [&SnapshotData]()
+			{
+				TArray<uint8> Data = SnapshotData;
+				UBFBenchmark::DoNotOptimize(FAssetSnapshot::FromMemory(MoveTemp(Data)).IsValid());
+			}));
+			Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("Snapshot Open/%d tokens"), NumTokens), ProfileIterations, [&SnapshotPath]()
+			{
+				UBFBenchmark::DoNotOptimize(FAssetSnapshot::Open(SnapshotPath).IsValid());
+			}));
+
+			const TSharedPtr<FAssetSnapshot> Snapshot = FAssetSnapshot::Open(SnapshotPath);
+			if (Snapshot.IsValid())
+			{
+				const FString LastAssetId = FString::Printf(TEXT("%s:%d"), *CollectionId, NumTokens - 1);
+				Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("Snapshot FindProfile/%d tokens"), NumTokens), Iterations, [&Snapshot, &LastAssetId]()
+				{
+					FAssetProfile AssetProfile;
+					UBFBenchmark::DoNotOptimize(Snapshot->FindProfile(LastAssetId, AssetProfile));
+				}));
+				Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("Snapshot GetAllProfiles/%d tokens"), NumTokens), ProfileIterations, [&Snapshot]()
+				{
+					TArray<FAssetProfile> AssetProfiles;
+					Snapshot->GetAllProfiles(AssetProfiles);
+					UBFBenchmark::DoNotOptimize(AssetProfiles.Num());
+				}));
+			}
+			else
+			{
+				UE_LOG(LogUBFAssetTest, Error, TEXT("UBFHelperBenchmarks failed to open snapshot %s"), *SnapshotPath);
+			}
+
+			IFileManager::Get().Delete(*SnapshotPath);
+		}
+
+		UBFBenchmark::Report(TEXT("Snapshot"), Results);
+	}
+
+	static FAutoConsoleCommand BenchmarkCommand(
+		TEXT("ubf.Bench.Helpers"),
+		TEXT("Runs microbenchmarks for the JSON and asset id helpers used per item. Optional arg: Iterations (default 10000)"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			RunAll(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000);
+		}));
+
+	static FAutoConsoleCommand SnapshotBenchmarkCommand(
+		TEXT("ubf.Bench.Snapshot"),
+		TEXT("Compares ParseAssetProfileJson against loading the same profiles from a binary snapshot. Optional arg: Iterations (default 10000)"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			RunSnapshot(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000);
+		}));
+}
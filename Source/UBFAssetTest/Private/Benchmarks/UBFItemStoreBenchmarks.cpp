@@ -0,0 +1,171 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "UBFAssetTestLog.h"
+#include "Benchmarks/UBFBenchmark.h"
+#include "InventoryComponents/ItemRegistry.h"
+#include "Items/UBFItem.h"
+#include "Items/UBFItemStore.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace UBFItemStoreBenchmarks
+{
+	// Asset Register shaped metadata, roughly the size of a Party Bear with its traits
+	FString MakeMetadataJson(int32 TokenIndex)
+	{
+		FString Json = FString::Printf(TEXT("{\"node\":{\"metadata\":{\"properties\":{\"name\":\"Item #%d\",\"image\":\"https://example.com/images/%d.png\",\"attributes\":{"),
+			TokenIndex, TokenIndex);
+		for (int32 TraitIndex = 0; TraitIndex < 16; ++TraitIndex)
+		{
+			Json += FString::Printf(TEXT("%s\"trait_%d\":\"value_%d\""), TraitIndex > 0 ? TEXT(",") : TEXT(""), TraitIndex, (TokenIndex + TraitIndex) % 7);
+		}
+		Json += TEXT("}}}}}");
+		return Json;
+	}
+
+	TArray<FUBFItemData> MakeItemDatas(int32 NumItems)
+	{
+		TArray<FUBFItemData> ItemDatas;
+		ItemDatas.Reserve(NumItems);
+		for (int32 Index = 0; Index < NumItems; ++Index)
+		{
+			// a handful of collections so the filters return a realistic slice
+			const FString CollectionId = FString::Printf(TEXT("7672:root:%d"), 303204 + Index % 8);
+			const FString TokenId = FString::FromInt(Index);
+			ItemDatas.Add(FUBFItemData(FString::Printf(TEXT("%s:%s"), *CollectionId, *TokenId), FString::Printf(TEXT("Item #%d"), Index),
+				FString::Printf(TEXT("0x%040d"), 303204 + Index % 8), TokenId, CollectionId, MakeMetadataJson(Index), FJsonObjectWrapper()));
+		}
+		return ItemDatas;
+	}
+
+	double MeasureGarbageCollection()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+		return FPlatformTime::Seconds() - StartTime;
+	}
+
+	// Build cost, resident bytes and GC time of NumItems UUBFItems (the inventory model) against FUBFItemStore
+	void RunItemStore(int32 NumItems, int32 Iterations)
+	{
+		check(IsInGameThread());
+
+		TArray<UBFBenchmark::FResult> Results;
+		const TArray<FUBFItemData> ItemDatas = MakeItemDatas(NumItems);
+		const FString ProfileURI = TEXT("https://fv-ubf-assets-dev.s3.us-west-2.amazonaws.com/Genesis/Profiles/1.0/0x0000000000000000000000000000000000303204.json");
+
+		const double BaselineGCSeconds = MeasureGarbageCollection();
+
+		// UObject per item with the parsed metadata DOM, as UAssetRegisterInventoryComponent builds them
+		TArray<UUBFItem*> Items;
+		Items.Reserve(NumItems);
+		TSharedPtr<FItemRegistry> ItemRegistry = MakeShared<FItemRegistry>();
+		{
+			UBFBenchmark::FResult& Result = Results.AddDefaulted_GetRef();
+			Result.Name = FString::Printf(TEXT("Build UUBFItems/%d items"), NumItems);
+			Result.Iterations = NumItems;
+
+			LLM_SCOPE_BYTAG(UBFBenchmark);
+			const UBFBenchmark::FAllocationScope AllocationScope;
+			const double StartTime = FPlatformTime::Seconds();
+			for (const FUBFItemData& ItemData : ItemDatas)
+			{
+				FUBFItemData ItemDataWithObject = ItemData;
+				ItemDataWithObject.MetadataJsonObject.JsonObjectFromString(ItemData.MetadataJson);
+
+				UUBFItem* Item = NewObject<UUBFItem>(GetTransientPackage());
+				Item->SetItemData(ItemDataWithObject);
+				Item->SetAssetProfileURI(ProfileURI);
+				Item->AddToRoot();
+				ItemRegistry->RegisterItem(Item->GetAssetID(), Item);
+				Items.Add(Item);
+			}
+			Result.NsPerOp = (FPlatformTime::Seconds() - StartTime) * 1e9 / NumItems;
+			Result.AllocsPerOp = static_cast<double>(AllocationScope.GetAllocations()) / NumItems;
+			Result.BytesPerOp = static_cast<double>(AllocationScope.GetBytes()) / NumItems;
+		}
+
+		SIZE_T ItemBytes = 0;
+		for (const UUBFItem* Item : Items)
+		{
+			ItemBytes += Item->GetApproximateMemoryUsage();
+		}
+		const double ItemsGCSeconds = MeasureGarbageCollection();
+
+		FUBFItemStore Store;
+		{
+			UBFBenchmark::FResult& Result = Results.AddDefaulted_GetRef();
+			Result.Name = FString::Printf(TEXT("Build FUBFItemStore/%d items"), NumItems);
+			Result.Iterations = NumItems;
+
+			LLM_SCOPE_BYTAG(UBFBenchmark);
+			const UBFBenchmark::FAllocationScope AllocationScope;
+			const double StartTime = FPlatformTime::Seconds();
+			for (const FUBFItemData& ItemData : ItemDatas)
+			{
+				Store.Add(ItemData, ProfileURI);
+			}
+			Result.NsPerOp = (FPlatformTime::Seconds() - StartTime) * 1e9 / NumItems;
+			Result.AllocsPerOp = static_cast<double>(AllocationScope.GetAllocations()) / NumItems;
+			Result.BytesPerOp = static_cast<double>(AllocationScope.GetBytes()) / NumItems;
+		}
+		const double StoreGCSeconds = MeasureGarbageCollection();
+
+		UE_LOG(LogUBFAssetTest, Display, TEXT("UBFItemStoreBenchmarks %d items: UUBFItems %.1f KB (%.0f bytes/item), FUBFItemStore %.1f KB (%.0f bytes/item)"),
+			NumItems, ItemBytes / 1024.0, static_cast<double>(ItemBytes) / NumItems, Store.GetAllocatedSize() / 1024.0, static_cast<double>(Store.GetAllocatedSize()) / NumItems);
+		UE_LOG(LogUBFAssetTest, Display, TEXT("UBFItemStoreBenchmarks full GC: baseline %.2f ms, with UUBFItems %.2f ms, with FUBFItemStore %.2f ms"),
+			BaselineGCSeconds * 1000.0, ItemsGCSeconds * 1000.0, StoreGCSeconds * 1000.0);
+
+		const FString LastAssetId = ItemDatas.Last().AssetID;
+		const FString CollectionId = ItemDatas[0].CollectionID;
+
+		Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("FItemRegistry GetItem/%d items"), NumItems), Iterations, [&ItemRegistry, &LastAssetId]()
+		{
+			UBFBenchmark::DoNotOptimize(ItemRegistry->GetItem(LastAssetId) != nullptr);
+		}));
+		Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("FUBFItemStore FindIndex/%d items"), NumItems), Iterations, [&Store, &LastAssetId]()
+		{
+			UBFBenchmark::DoNotOptimize(Store.FindIndex(LastAssetId));
+		}));
+
+		const int32 FilterIterations = FMath::Max(1, Iterations / 100);
+		Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("UUBFItem collection scan/%d items"), NumItems), FilterIterations, [&Items, &CollectionId]()
+		{
+			int32 NumMatches = 0;
+			for (const UUBFItem* Item : Items)
+			{
+				NumMatches += Item->GetItemDataRef().CollectionID == CollectionId ? 1 : 0;
+			}
+			UBFBenchmark::DoNotOptimize(NumMatches);
+		}));
+		Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("FItemRegistry GetItemsByCollection/%d items"), NumItems), FilterIterations, [&ItemRegistry, &CollectionId]()
+		{
+			TArray<UUBFItem*> Matches;
+			ItemRegistry->GetItemsByCollection(CollectionId, Matches);
+			UBFBenchmark::DoNotOptimize(Matches.Num());
+		}));
+		Results.Add(UBFBenchmark::Run(FString::Printf(TEXT("FUBFItemStore FindByCollection/%d items"), NumItems), FilterIterations, [&Store, &CollectionId]()
+		{
+			TArray<int32> Matches;
+			Store.FindByCollection(CollectionId, Matches);
+			UBFBenchmark::DoNotOptimize(Matches.Num());
+		}));
+
+		for (UUBFItem* Item : Items)
+		{
+			Item->RemoveFromRoot();
+		}
+		Items.Empty();
+		ItemRegistry.Reset();
+		MeasureGarbageCollection();
+
+		UBFBenchmark::Report(TEXT("ItemStore"), Results);
+	}
+
+	static FAutoConsoleCommand ItemStoreBenchmarkCommand(
+		TEXT("ubf.Bench.ItemStore"),
+		TEXT("Compares memory, GC time and lookups of UUBFItem inventories against FUBFItemStore. Optional args: NumItems (default 10000) Iterations (default 10000)"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			RunItemStore(Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10000);
+		}));
+}
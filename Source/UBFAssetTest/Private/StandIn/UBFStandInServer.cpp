@@ -0,0 +1,277 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "StandIn/UBFStandInServer.h"
+
+#include "HttpPath.h"
+#include "HttpServerModule.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "IHttpRouter.h"
+#include "UBFAssetTestLog.h"
+#include "Containers/Ticker.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonSerializer.h"
+#include "StandIn/UBFStandInSettings.h"
+
+namespace UBFStandInServer
+{
+	FString SanitizeId(const FString& Id)
+	{
+		return Id.Replace(TEXT(":"), TEXT("_")).Replace(TEXT("/"), TEXT("_")).Replace(TEXT("\\"), TEXT("_"));
+	}
+
+	FHttpRequestHandler MakeHandler(TFunction<bool(const FHttpServerRequest&, const FHttpResultCallback&)>&& Function)
+	{
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+		return MoveTemp(Function);
+#else
+		return FHttpRequestHandler::CreateLambda(MoveTemp(Function));
+#endif
+	}
+	
+	static FAutoConsoleCommand StartCommand(
+		TEXT("ubf.StandIn.Start"),
+		TEXT("Starts the UBF stand-in server. Optional arg: Port"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const uint32 Port = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0;
+			FUBFStandInServer::Get().Start(Port);
+		}));
+
+	static FAutoConsoleCommand StopCommand(
+		TEXT("ubf.StandIn.Stop"),
+		TEXT("Stops the UBF stand-in server"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FUBFStandInServer::Get().Stop();
+		}));
+
+	static FAutoConsoleCommand StatusCommand(
+		TEXT("ubf.StandIn.Status"),
+		TEXT("Prints the UBF stand-in server conditions and counters"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			UE_LOG(LogUBFAssetTest, Display, TEXT("%s"), *FUBFStandInServer::Get().GetStatusString());
+		}));
+
+	static FAutoConsoleCommand LatencyCommand(
+		TEXT("ubf.StandIn.Latency"),
+		TEXT("Sets injected latency. Args: LatencyMs [JitterMs]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			FUBFStandInServer::FConditions& Conditions = FUBFStandInServer::Get().GetConditions();
+			Conditions.LatencyMs = Args.Num() > 0 ? FMath::Max(0.f, FCString::Atof(*Args[0])) : 0.f;
+			Conditions.LatencyJitterMs = Args.Num() > 1 ? FMath::Max(0.f, FCString::Atof(*Args[1])) : 0.f;
+		}));
+
+	static FAutoConsoleCommand BandwidthCommand(
+		TEXT("ubf.StandIn.Bandwidth"),
+		TEXT("Sets simulated bandwidth per response in KB/s, 0 for unlimited"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			FUBFStandInServer::Get().GetConditions().BandwidthKBps = Args.Num() > 0 ? FMath::Max(0, FCString::Atoi(*Args[0])) : 0;
+		}));
+
+	static FAutoConsoleCommand ErrorRateCommand(
+		TEXT("ubf.StandIn.ErrorRate"),
+		TEXT("Sets the probability [0, 1] of a request failing. Optional second arg: status code"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			FUBFStandInServer::FConditions& Conditions = FUBFStandInServer::Get().GetConditions();
+			Conditions.ErrorRate = Args.Num() > 0 ? FMath::Clamp(FCString::Atof(*Args[0]), 0.f, 1.f) : 0.f;
+			if (Args.Num() > 1)
+			{
+				Conditions.ErrorStatusCode = FCString::Atoi(*Args[1]);
+			}
+		}));
+}
+
+FUBFStandInServer& FUBFStandInServer::Get()
+{
+	static FUBFStandInServer Instance;
+	return Instance;
+}
+
+bool FUBFStandInServer::Start(uint32 Port)
+{
+	if (IsRunning())
+	{
+		UE_LOG(LogUBFAssetTest, Warning, TEXT("FUBFStandInServer::Start already running on port %u"), ActivePort);
+		return true;
+	}
+	
+	const UUBFStandInSettings* Settings = GetDefault<UUBFStandInSettings>();
+	check(Settings);
+
+	ActivePort = Port != 0 ? Port : Settings->Port;
+	RecordingsDirectory = Settings->GetRecordingsDirectory();
+	
+	Conditions.LatencyMs = Settings->LatencyMs;
+	Conditions.LatencyJitterMs = Settings->LatencyJitterMs;
+	Conditions.BandwidthKBps = Settings->BandwidthKBps;
+	Conditions.ErrorRate = Settings->ErrorRate;
+	Conditions.ErrorStatusCode = Settings->ErrorStatusCode;
+	RandomStream.Initialize(Settings->RandomSeed);
+
+	RequestsServed = 0;
+	RequestsMissing = 0;
+	ErrorsInjected = 0;
+	BytesServed = 0;
+
+	FHttpServerModule& HttpServerModule = FHttpServerModule::Get();
+	Router = HttpServerModule.GetHttpRouter(ActivePort, true);
+	if (!Router.IsValid())
+	{
+		UE_LOG(LogUBFAssetTest, Error, TEXT("FUBFStandInServer::Start failed to bind port %u"), ActivePort);
+		return false;
+	}
+
+	RouteHandles.Add(Router->BindRoute(FHttpPath(TEXT("/graphql")), EHttpServerRequestVerbs::VERB_POST,
+		UBFStandInServer::MakeHandler([this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			return HandleGraphQL(Request, OnComplete);
+		})));
+	
+	RouteHandles.Add(Router->BindRoute(FHttpPath(TEXT("/files")), EHttpServerRequestVerbs::VERB_GET,
+		UBFStandInServer::MakeHandler([this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			return HandleFile(Request, OnComplete);
+		})));
+
+	HttpServerModule.StartAllListeners();
+
+	UE_LOG(LogUBFAssetTest, Log, TEXT("FUBFStandInServer::Start listening on http://127.0.0.1:%u serving %s"), ActivePort, *RecordingsDirectory);
+	return true;
+}
+
+void FUBFStandInServer::Stop()
+{
+	if (!IsRunning()) return;
+	
+	for (const FHttpRouteHandle& RouteHandle : RouteHandles)
+	{
+		Router->UnbindRoute(RouteHandle);
+	}
+	RouteHandles.Reset();
+	Router.Reset();
+	
+	// the listener keeps its port until stopped, a later Start would not get it back otherwise
+	FHttpServerModule::Get().StopAllListeners();
+
+	UE_LOG(LogUBFAssetTest, Log, TEXT("FUBFStandInServer::Stop %s"), *GetStatusString());
+}
+
+FString FUBFStandInServer::GetStatusString() const
+{
+	return FString::Printf(TEXT("StandIn %s Port: %u Latency: %.1fms (+%.1fms jitter) Bandwidth: %dKB/s ErrorRate: %.3f (%d) "
+		"Served: %lld Missing: %lld ErrorsInjected: %lld Bytes: %lld"),
+		IsRunning() ? TEXT("running") : TEXT("stopped"), ActivePort, Conditions.LatencyMs, Conditions.LatencyJitterMs,
+		Conditions.BandwidthKBps, Conditions.ErrorRate, Conditions.ErrorStatusCode,
+		RequestsServed, RequestsMissing, ErrorsInjected, BytesServed);
+}
+
+bool FUBFStandInServer::HandleGraphQL(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const FUTF8ToTCHAR BodyConverter(reinterpret_cast<const ANSICHAR*>(Request.Body.GetData()), Request.Body.Num());
+	const FString Body(BodyConverter.Length(), BodyConverter.Get());
+
+	FString CollectionId;
+	FString TokenId;
+	
+	TSharedPtr<FJsonObject> JsonObject;
+	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Body);
+	if (FJsonSerializer::Deserialize(Reader, JsonObject) && JsonObject.IsValid())
+	{
+		const TSharedPtr<FJsonObject>* Variables;
+		const TArray<TSharedPtr<FJsonValue>>* AssetIds;
+		if (JsonObject->TryGetObjectField(TEXT("variables"), Variables)
+			&& (*Variables)->TryGetArrayField(TEXT("assetIds"), AssetIds) && AssetIds->Num() > 0)
+		{
+			if (const TSharedPtr<FJsonObject> AssetId = (*AssetIds)[0]->AsObject())
+			{
+				AssetId->TryGetStringField(TEXT("collectionId"), CollectionId);
+				AssetId->TryGetStringField(TEXT("tokenId"), TokenId);
+			}
+		}
+	}
+
+	const FString RecordingPath = FPaths::Combine(RecordingsDirectory, TEXT("graphql"),
+		UBFStandInServer::SanitizeId(CollectionId), UBFStandInServer::SanitizeId(TokenId) + TEXT(".json"));
+	
+	FString ResponseJson;
+	if (!FFileHelper::LoadFileToString(ResponseJson, *RecordingPath)
+		&& !FFileHelper::LoadFileToString(ResponseJson, *FPaths::Combine(RecordingsDirectory, TEXT("graphql"), TEXT("default.json"))))
+	{
+		UE_LOG(LogUBFAssetTest, Verbose, TEXT("FUBFStandInServer::HandleGraphQL no recording for %s:%s"), *CollectionId, *TokenId);
+		RequestsMissing++;
+		ResponseJson = TEXT("{\"data\":{\"assetsByIds\":[]}}");
+	}
+
+	const int64 PayloadBytes = ResponseJson.Len();
+	Respond(FHttpServerResponse::Create(ResponseJson, TEXT("application/json")), PayloadBytes, OnComplete);
+	return true;
+}
+
+bool FUBFStandInServer::HandleFile(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	FString RelativePath = Request.RelativePath.GetPath();
+	RelativePath.RemoveFromStart(TEXT("/files"));
+	RelativePath.RemoveFromStart(TEXT("/"));
+
+	if (RelativePath.IsEmpty() || RelativePath.Contains(TEXT("..")))
+	{
+		RequestsMissing++;
+		Respond(FHttpServerResponse::Error(EHttpServerResponseCodes::BadRequest), 0, OnComplete);
+		return true;
+	}
+
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *FPaths::Combine(RecordingsDirectory, TEXT("files"), RelativePath)))
+	{
+		UE_LOG(LogUBFAssetTest, Verbose, TEXT("FUBFStandInServer::HandleFile no recording for %s"), *RelativePath);
+		RequestsMissing++;
+		Respond(FHttpServerResponse::Error(EHttpServerResponseCodes::NotFound), 0, OnComplete);
+		return true;
+	}
+
+	const int64 PayloadBytes = FileData.Num();
+	const FString ContentType = RelativePath.EndsWith(TEXT(".json")) ? TEXT("application/json") : TEXT("application/octet-stream");
+	Respond(FHttpServerResponse::Create(MoveTemp(FileData), ContentType), PayloadBytes, OnComplete);
+	return true;
+}
+
+void FUBFStandInServer::Respond(TUniquePtr<FHttpServerResponse>&& Response, int64 PayloadBytes, const FHttpResultCallback& OnComplete)
+{
+	if (Conditions.ErrorRate > 0.f && RandomStream.FRand() < Conditions.ErrorRate)
+	{
+		ErrorsInjected++;
+		Response = FHttpServerResponse::Error(static_cast<EHttpServerResponseCodes>(Conditions.ErrorStatusCode));
+		PayloadBytes = 0;
+	}
+	else
+	{
+		RequestsServed++;
+		BytesServed += PayloadBytes;
+	}
+
+	float DelaySeconds = (Conditions.LatencyMs + RandomStream.FRand() * Conditions.LatencyJitterMs) / 1000.f;
+	if (Conditions.BandwidthKBps > 0)
+	{
+		DelaySeconds += static_cast<float>(PayloadBytes) / (Conditions.BandwidthKBps * 1024.f);
+	}
+
+	if (DelaySeconds <= 0.f)
+	{
+		OnComplete(MoveTemp(Response));
+		return;
+	}
+
+	// ticker delegates must be copyable so the response is shared rather than moved into the lambda
+	TSharedPtr<TUniquePtr<FHttpServerResponse>> SharedResponse = MakeShared<TUniquePtr<FHttpServerResponse>>(MoveTemp(Response));
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([SharedResponse, OnComplete](float)
+	{
+		OnComplete(MoveTemp(*SharedResponse));
+		return false;
+	}), DelaySeconds);
+}
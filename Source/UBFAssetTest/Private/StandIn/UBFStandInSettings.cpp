@@ -0,0 +1,36 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#include "StandIn/UBFStandInSettings.h"
+
+UUBFStandInSettings::UUBFStandInSettings()
+{
+	CategoryName = TEXT("Plugins");
+}
+
+void UUBFStandInSettings::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	FString Directory;
+	if (FParse::Value(FCommandLine::Get(), TEXT("UBFStandInRoot="), Directory))
+	{
+		CommandLineRecordingsDirectory = Directory;
+	}
+}
+
+FString UUBFStandInSettings::GetRecordingsDirectory() const
+{
+	const FString Directory = CommandLineRecordingsDirectory.Get(RecordingsDirectory);
+
+	if (Directory.IsEmpty())
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("UBFStandIn"));
+	}
+
+	if (FPaths::IsRelative(Directory))
+	{
+		return FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), Directory);
+	}
+
+	return Directory;
+}
@@ -1,15 +1,24 @@
 ﻿#include "UBFAssetTest.h"
 
+#include "Misc/CoreDelegates.h"
+#include "StandIn/UBFStandInServer.h"
+
 #define LOCTEXT_NAMESPACE "FUBFAssetTestModule"
 
 void FUBFAssetTestModule::StartupModule()
 {
-    
+    if (FParse::Param(FCommandLine::Get(), TEXT("UBFStandIn")))
+    {
+        FCoreDelegates::OnPostEngineInit.AddLambda([]()
+        {
+            FUBFStandInServer::Get().Start();
+        });
+    }
 }
 
 void FUBFAssetTestModule::ShutdownModule()
 {
-    
+    FUBFStandInServer::Get().Stop();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,66 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HttpResultCallback.h"
+#include "HttpRouteHandle.h"
+
+class IHttpRouter;
+struct FHttpServerRequest;
+struct FHttpServerResponse;
+
+/**
+ * In-process HTTP server that serves recorded Asset Register GraphQL, asset profile and catalog responses
+ * so the controller pipeline can be load tested without live services.
+ *
+ * Layout of the recordings directory:
+ *  graphql/{collectionId}/{tokenId}.json  response for the assetsByIds query, ':' in ids are replaced with '_'
+ *  graphql/default.json                   optional fallback for unknown assets
+ *  files/...                              served as GET /files/... e.g. profiles and catalogs
+ *
+ * Point the controller at it with UFutureverseUBFControllerSettings::EndpointOverrides or the
+ * -UBFAssetRegisterURL= and -UBFAssetProfilePath= command line arguments.
+ */
+class UBFASSETTEST_API FUBFStandInServer
+{
+public:
+	struct FConditions
+	{
+		float LatencyMs = 0.f;
+		float LatencyJitterMs = 0.f;
+		int32 BandwidthKBps = 0;
+		float ErrorRate = 0.f;
+		int32 ErrorStatusCode = 503;
+	};
+	
+	static FUBFStandInServer& Get();
+
+	// Starts listening using UUBFStandInSettings, Port overrides the configured port when non zero
+	bool Start(uint32 Port = 0);
+	void Stop();
+	bool IsRunning() const { return Router.IsValid(); }
+
+	FConditions& GetConditions() { return Conditions; }
+	FString GetStatusString() const;
+	
+private:
+	bool HandleGraphQL(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	bool HandleFile(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+
+	// Applies injected errors, latency and bandwidth before completing the request
+	void Respond(TUniquePtr<FHttpServerResponse>&& Response, int64 PayloadBytes, const FHttpResultCallback& OnComplete);
+	
+	TSharedPtr<IHttpRouter> Router;
+	TArray<FHttpRouteHandle> RouteHandles;
+	uint32 ActivePort = 0;
+	FString RecordingsDirectory;
+	
+	FConditions Conditions;
+	FRandomStream RandomStream;
+
+	int64 RequestsServed = 0;
+	int64 RequestsMissing = 0;
+	int64 ErrorsInjected = 0;
+	int64 BytesServed = 0;
+};
@@ -0,0 +1,56 @@
+// Copyright (c) 2025, Futureverse Corporation Limited. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "UBFStandInSettings.generated.h"
+
+/**
+ * Configuration for the local stand-in server that replays recorded Asset Register, profile and catalog responses
+ */
+UCLASS(Config=Engine, defaultconfig, meta = (DisplayName = "UBF Stand-In Server"))
+class UBFASSETTEST_API UUBFStandInSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+public:
+	UUBFStandInSettings();
+	virtual void PostInitProperties() override;
+
+	// Resolves RecordingsDirectory, -UBFStandInRoot= on the command line takes priority
+	FString GetRecordingsDirectory() const;
+	
+	UPROPERTY(EditAnywhere, Config)
+	int32 Port = 8089;
+
+	// Relative paths are resolved against the project directory. Defaults to Saved/UBFStandIn
+	UPROPERTY(EditAnywhere, Config)
+	FString RecordingsDirectory;
+
+	// Fixed delay added to every response
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	float LatencyMs = 0.f;
+
+	// Uniform random delay in [0, LatencyJitterMs] added on top of LatencyMs
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	float LatencyJitterMs = 0.f;
+
+	// Simulated per-response bandwidth, 0 means unlimited
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0))
+	int32 BandwidthKBps = 0;
+
+	// Probability in [0, 1] that a request fails with ErrorStatusCode
+	UPROPERTY(EditAnywhere, Config, meta = (ClampMin = 0, ClampMax = 1))
+	float ErrorRate = 0.f;
+
+	UPROPERTY(EditAnywhere, Config)
+	int32 ErrorStatusCode = 503;
+
+	// Seed for latency jitter and error injection so runs are reproducible
+	UPROPERTY(EditAnywhere, Config)
+	int32 RandomSeed = 0;
+
+private:
+	// -UBFStandInRoot=, parsed once when the settings are loaded
+	TOptional<FString> CommandLineRecordingsDirectory;
+};
@@ -23,6 +23,8 @@ public class UBFAssetTest : ModuleRules
                 "UMG",
                 "Json",
                 "JsonUtilities",
+                "HTTPServer",
+                "DeveloperSettings",
             }
         );
     }